@@ -0,0 +1,380 @@
+// Benchmark del DSP en el host: corre audio_dsp_process sobre senales sinteticas y un corpus
+// de WAV, con cada preset de EQ, frecuencia A2DP y tamano de bloque, y compara contra una
+// linea base guardada. Termina con error si algun grupo senal/preset empeora mas que la
+// tolerancia, descontando lo que cambio la velocidad de la maquina.
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sdkconfig.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "dsp_bench.h"
+#include "host_wav.h"
+
+#define TAG "DSP_BENCH"
+
+#define BENCH_SYNTH_FRAMES  44100   // Un segundo de cada senal sintetica
+#define BENCH_MAX_SIGNALS   32
+#define BENCH_GROUP_CASES   (DSP_BENCH_RATE_COUNT * DSP_BENCH_BLOCK_COUNT)
+#define BENCH_MAX_CASES     (BENCH_MAX_SIGNALS * EQ_MAX_PRESETS * BENCH_GROUP_CASES)
+#define BENCH_NAME_LEN      48
+#define BENCH_KEY_LEN       (BENCH_NAME_LEN + 32)
+#define BENCH_REF_KEY       "referencia"
+
+typedef struct {
+    char name[BENCH_NAME_LEN];
+    int16_t *pcm;               // Estereo intercalado
+    uint32_t frames;
+} bench_signal_t;
+
+typedef struct {
+    char key[BENCH_KEY_LEN];    // "<senal> <preset> <Hz> <bloque>"
+    float ns_per_frame;
+} bench_baseline_t;
+
+typedef struct {
+    const bench_signal_t *signal;
+    eq_preset_t preset;
+    uint32_t sample_rate;
+    size_t block_bytes;
+    float best_ns;              // Repeticion mas rapida, 0 si la senal no llena un bloque
+    float max_us;               // Peor bloque de esa repeticion
+} bench_case_t;
+
+static bench_signal_t signals[BENCH_MAX_SIGNALS];
+static int signal_count = 0;
+static bench_case_t cases[BENCH_MAX_CASES];
+static int case_count = 0;
+static bench_baseline_t baseline[BENCH_MAX_CASES];
+static int baseline_count = 0;
+static float ref_best_ns = 0.0f;
+static float ref_base_ns = 0.0f;    // 0 si la linea base no trae referencia
+
+// Trabajo fijo que no depende de audio_dsp: tres biquads float por canal, como el EQ. Se mide
+// intercalado con los casos y se guarda en la linea base, asi una maquina que anda mas lenta
+// durante toda la corrida no se confunde con una regresion del DSP.
+static float reference_ns_per_frame(const int16_t *pcm, uint32_t frames)
+{
+    static const float b0 = 0.2f, b1 = 0.4f, b2 = 0.2f, a1 = -0.6f, a2 = 0.2f;
+    float x1[6] = {0}, x2[6] = {0}, y1[6] = {0}, y2[6] = {0};
+    volatile float sink = 0.0f;
+    uint32_t start = esp_cpu_get_ccount();
+    for (uint32_t i = 0; i < frames; i++) {
+        for (int ch = 0; ch < 2; ch++) {
+            float x = pcm[2 * i + ch] / 32768.0f;
+            float sum = 0.0f;
+            for (int f = ch; f < 6; f += 2) {
+                float y = b0 * x + b1 * x1[f] + b2 * x2[f] - a1 * y1[f] - a2 * y2[f];
+                x2[f] = x1[f];
+                x1[f] = x;
+                y2[f] = y1[f];
+                y1[f] = y;
+                sum += y;
+            }
+            sink += sum;
+        }
+    }
+    uint32_t cycles = esp_cpu_get_ccount() - start;
+    return (float)cycles * 1000.0f / CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ / frames;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Uso: %s [-c corpus] [-b base.txt] [-u] [-r repeticiones] [-t tolerancia%%]\n"
+            "  -c  Directorio con WAV PCM de 16 bits que se suman a las senales sinteticas\n"
+            "  -b  Linea base de ns/frame por caso; sin -u falla si un grupo la supera\n"
+            "  -u  Reescribe la linea base con esta corrida\n"
+            "  -r  Repeticiones por caso, se toma la mas rapida (por defecto 9)\n"
+            "  -t  Tolerancia sobre la linea base en %% (por defecto 25)\n",
+            prog);
+}
+
+static bench_signal_t *new_signal(const char *name, uint32_t frames)
+{
+    if (signal_count == BENCH_MAX_SIGNALS) {
+        return NULL;
+    }
+    bench_signal_t *s = &signals[signal_count];
+    s->pcm = malloc((size_t)frames * DSP_BENCH_FRAME_BYTES);
+    if (s->pcm == NULL) {
+        return NULL;
+    }
+    // La clave de la linea base se separa por espacios
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    for (char *c = s->name; *c; c++) {
+        if (*c == ' ') {
+            *c = '_';
+        }
+    }
+    s->frames = frames;
+    signal_count++;
+    return s;
+}
+
+// Carga el WAV completo como estereo; la frecuencia del archivo no importa, se corre a todas
+static void load_wav(const char *dir, const char *file)
+{
+    char path[512];
+    host_wav_t wav;
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    if (!host_wav_open_read(&wav, path)) {
+        ESP_LOGW(TAG, "%s no es un WAV PCM de 16 bits, se ignora", path);
+        return;
+    }
+    uint32_t frames = wav.data_bytes / (2 * wav.channels);
+    bench_signal_t *s = frames > 0 ? new_signal(file, frames) : NULL;
+    if (s != NULL) {
+        size_t got = fread(s->pcm, 2 * wav.channels, frames, wav.file);
+        s->frames = (uint32_t)got;
+        if (wav.channels == 1) {
+            for (int64_t i = (int64_t)got - 1; i >= 0; i--) {
+                s->pcm[2 * i + 1] = s->pcm[i];
+                s->pcm[2 * i] = s->pcm[i];
+            }
+        }
+    }
+    host_wav_close(&wav, false);
+}
+
+static void load_corpus(const char *dir)
+{
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        ESP_LOGE(TAG, "No se pudo abrir el corpus %s", dir);
+        return;
+    }
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        size_t len = strlen(e->d_name);
+        if (len > 4 && strcasecmp(e->d_name + len - 4, ".wav") == 0) {
+            load_wav(dir, e->d_name);
+        }
+    }
+    closedir(d);
+}
+
+static void load_baseline(const char *path)
+{
+    char line[160];
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        ESP_LOGW(TAG, "Sin linea base en %s", path);
+        return;
+    }
+    while (fgets(line, sizeof(line), f) != NULL && baseline_count < BENCH_MAX_CASES) {
+        char name[BENCH_NAME_LEN];
+        unsigned preset, rate, block;
+        float ns;
+        if (line[0] == '#') {
+            continue;
+        }
+        if (sscanf(line, BENCH_REF_KEY " %f", &ns) == 1) {
+            ref_base_ns = ns;
+            continue;
+        }
+        if (sscanf(line, "%47s %u %u %u %f", name, &preset, &rate, &block, &ns) != 5) {
+            continue;
+        }
+        bench_baseline_t *b = &baseline[baseline_count++];
+        snprintf(b->key, sizeof(b->key), "%s %u %u %u", name, preset, rate, block);
+        b->ns_per_frame = ns;
+    }
+    fclose(f);
+}
+
+static void case_key(const bench_case_t *c, char *key)
+{
+    snprintf(key, BENCH_KEY_LEN, "%.47s %d %u %u", c->signal->name, c->preset, c->sample_rate,
+             (unsigned)c->block_bytes);
+}
+
+static const bench_baseline_t *find_baseline(const bench_case_t *c)
+{
+    char key[BENCH_KEY_LEN];
+    case_key(c, key);
+    for (int i = 0; i < baseline_count; i++) {
+        if (strcmp(baseline[i].key, key) == 0) {
+            return &baseline[i];
+        }
+    }
+    return NULL;
+}
+
+// Los casos de un mismo grupo senal/preset quedan contiguos, report() se apoya en eso
+static void build_cases(void)
+{
+    static const uint32_t rates[] = DSP_BENCH_RATES;
+    static const size_t blocks[] = DSP_BENCH_BLOCKS;
+    for (int s = 0; s < signal_count; s++) {
+        for (int p = 0; p < EQ_MAX_PRESETS; p++) {
+            for (int r = 0; r < DSP_BENCH_RATE_COUNT; r++) {
+                for (int b = 0; b < DSP_BENCH_BLOCK_COUNT; b++) {
+                    bench_case_t *c = &cases[case_count++];
+                    c->signal = &signals[s];
+                    c->preset = p;
+                    c->sample_rate = rates[r];
+                    c->block_bytes = blocks[b];
+                }
+            }
+        }
+    }
+}
+
+// Las repeticiones recorren todos los casos por turno: una racha lenta de la maquina cae en
+// una sola pasada de cada caso y el minimo la descarta
+static void run_cases(int reps)
+{
+    for (int rep = 0; rep < reps; rep++) {
+        for (int i = 0; i < case_count; i++) {
+            bench_case_t *c = &cases[i];
+            dsp_config_t config;
+            if (i % BENCH_GROUP_CASES == 0) {
+                float ref = reference_ns_per_frame(signals[0].pcm, signals[0].frames);
+                if (ref_best_ns == 0.0f || ref < ref_best_ns) {
+                    ref_best_ns = ref;
+                }
+            }
+            dsp_bench_result_t res = {0};
+            dsp_bench_preset_config(c->preset, &config);
+            dsp_bench_reset(c->sample_rate);
+            if (dsp_bench_run(c->signal->pcm, c->signal->frames, c->block_bytes, &config, &res) != ESP_OK) {
+                continue;   // La senal no llena un bloque
+            }
+            // El peor bloque tambien sale de la repeticion mas rapida, las otras llevan las
+            // interrupciones del sistema operativo
+            float ns = dsp_bench_ns_per_frame(&res);
+            if (c->best_ns == 0.0f || ns < c->best_ns) {
+                c->best_ns = ns;
+                c->max_us = dsp_bench_max_block_us(&res);
+            }
+        }
+    }
+}
+
+// Un caso suelto varia mucho entre corridas en una PC: el corte usa la media geometrica de la
+// razon contra la linea base en cada grupo senal/preset (todas las frecuencias y bloques),
+// dividida por la razon de la referencia
+static int report(float tolerance)
+{
+    int regressions = 0;
+    int checked = 0;
+    double machine = 1.0;
+    if (ref_base_ns > 0.0f) {
+        machine = ref_best_ns / ref_base_ns;
+        printf("Referencia: %.1f ns/frame, base %.1f (maquina x%.2f)\n", ref_best_ns, ref_base_ns, machine);
+    }
+    printf("%-20s %-16s %6s %6s %10s %12s %10s %8s\n",
+           "senal", "preset", "Hz", "bloque", "ns/frame", "frames/s", "max us", "vs base");
+    for (int g = 0; g < case_count; g += BENCH_GROUP_CASES) {
+        double log_ratio = 0.0;
+        int compared = 0;
+        float bass, mid, treble;
+        const char *preset_name = get_eq_preset_bands(cases[g].preset, &bass, &mid, &treble);
+        for (int i = g; i < g + BENCH_GROUP_CASES; i++) {
+            const bench_case_t *c = &cases[i];
+            if (c->best_ns <= 0.0f) {
+                continue;
+            }
+            const bench_baseline_t *base = find_baseline(c);
+            char ratio_str[16] = "-";
+            if (base != NULL && base->ns_per_frame > 0.0f) {
+                float ratio = c->best_ns / base->ns_per_frame;
+                snprintf(ratio_str, sizeof(ratio_str), "x%.2f", ratio);
+                log_ratio += log(ratio);
+                compared++;
+            }
+            printf("%-20s %-16s %6u %6u %10.1f %12.0f %10.1f %8s\n",
+                   c->signal->name, preset_name, c->sample_rate, (unsigned)c->block_bytes,
+                   c->best_ns, 1e9f / c->best_ns, c->max_us, ratio_str);
+        }
+        if (compared == 0) {
+            continue;
+        }
+        double ratio = exp(log_ratio / compared) / machine;
+        bool regressed = ratio > 1.0 + tolerance / 100.0;
+        printf("%-20s %-16s %49s x%.2f%s\n", cases[g].signal->name, preset_name, "grupo", ratio,
+               regressed ? "  REGRESION" : "");
+        checked++;
+        regressions += regressed;
+    }
+    if (baseline_count > 0) {
+        printf("%d grupos comparados, %d con regresion (tolerancia %.0f%%)\n", checked, regressions, tolerance);
+    }
+    return regressions;
+}
+
+static int write_baseline(const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        ESP_LOGE(TAG, "No se pudo escribir %s", path);
+        return 2;
+    }
+    fprintf(out, "# Linea base de dsp-bench: <senal> <preset> <Hz> <bloque bytes> <ns/frame>\n"
+                 "# Depende de la maquina; regenerar con: dsp-bench -b <este archivo> -u [-c corpus]\n");
+    fprintf(out, BENCH_REF_KEY " %.1f\n", ref_best_ns);
+    for (int i = 0; i < case_count; i++) {
+        char key[BENCH_KEY_LEN];
+        if (cases[i].best_ns > 0.0f) {
+            case_key(&cases[i], key);
+            fprintf(out, "%s %.1f\n", key, cases[i].best_ns);
+        }
+    }
+    fclose(out);
+    printf("Linea base escrita en %s\n", path);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *corpus = NULL;
+    const char *baseline_path = NULL;
+    bool update = false;
+    int reps = 9;
+    float tolerance = 25.0f;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:b:ur:t:h")) != -1) {
+        switch (opt) {
+        case 'c': corpus = optarg; break;
+        case 'b': baseline_path = optarg; break;
+        case 'u': update = true; break;
+        case 'r': reps = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+        case 't': tolerance = strtof(optarg, NULL); break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (update && baseline_path == NULL) {
+        usage(argv[0]);
+        return 2;
+    }
+    // audio_dsp_init informa cada reinicio, aca solo molesta
+    esp_log_level_set("AUDIO_DSP", ESP_LOG_WARN);
+
+    for (dsp_bench_signal_t sig = 0; sig < DSP_BENCH_SIGNAL_MAX; sig++) {
+        bench_signal_t *s = new_signal(dsp_bench_signal_name(sig), BENCH_SYNTH_FRAMES);
+        if (s != NULL) {
+            dsp_bench_fill_signal(sig, s->pcm, s->frames, 44100);
+        }
+    }
+    if (corpus != NULL) {
+        load_corpus(corpus);
+    }
+    if (baseline_path != NULL && !update) {
+        load_baseline(baseline_path);
+    }
+
+    build_cases();
+    run_cases(reps);
+    audio_dsp_deinit();
+    if (update) {
+        return write_baseline(baseline_path);
+    }
+    return report(tolerance) > 0 ? 1 : 0;
+}
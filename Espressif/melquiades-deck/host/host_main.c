@@ -0,0 +1,83 @@
+// Arranque del firmware en Linux: configura los drivers falsos y llama a app_main() como
+// lo haria el arranque de IDF. El shell UART queda en stdin/stdout y el SPP en un pty.
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "host_port.h"
+
+#define TAG "HOST"
+
+#define HOST_POLL_MS 100
+
+extern void app_main(void);
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int signo)
+{
+    stop_requested = 1;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Uso: %s [-i entrada.wav] [-l] [-o salida.wav] [-s traza] [-n nvs.bin] [-p enlace] [-t segundos]\n"
+            "  -i  WAV PCM de 16 bits que llega por A2DP como si fuera el telefono\n"
+            "  -l  Repite la entrada y la traza al terminar\n"
+            "  -o  WAV donde se guarda lo que sale por I2S\n"
+            "  -s  Traza de botones y pots a reproducir\n"
+            "  -n  Archivo donde persiste la NVS entre corridas\n"
+            "  -p  Enlace simbolico al pty del servidor SPP\n"
+            "  -t  Segundos de ejecucion; 0 termina al agotarse entrada y traza (por defecto corre hasta Ctrl+C)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL;
+    const char *trace = NULL;
+    bool loop = false;
+    double seconds = -1;
+    int opt;
+
+    host_freertos_init();
+    while ((opt = getopt(argc, argv, "i:lo:s:n:p:t:h")) != -1) {
+        switch (opt) {
+        case 'i': input = optarg; break;
+        case 'l': loop = true; break;
+        case 'o': host_i2s_set_sink(optarg); break;
+        case 's': trace = optarg; break;
+        case 'n': host_nvs_set_file(optarg); break;
+        case 'p': host_spp_set_link(optarg); break;
+        case 't': seconds = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    host_a2dp_set_source(input, loop);
+    host_io_set_trace(trace, loop);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    app_main();
+
+    int64_t deadline_us = seconds > 0 ? host_time_us() + (int64_t)(seconds * 1000000) : INT64_MAX;
+    while (!stop_requested && host_time_us() < deadline_us) {
+        if (seconds == 0 && host_a2dp_done() && host_io_done()) {
+            // Deja que el DMA termine de sacar lo ultimo que se escribio
+            usleep(500 * 1000);
+            break;
+        }
+        usleep(HOST_POLL_MS * 1000);
+    }
+    ESP_LOGI(TAG, "Fin de la ejecucion en %lld ms", (long long)(host_time_us() / 1000));
+    host_i2s_close();
+    fflush(stdout);
+    // Las tareas siguen en sus bucles: se sale sin esperarlas, como al cortar la alimentacion
+    _exit(0);
+}
@@ -0,0 +1,65 @@
+#ifndef ESP_A2DP_API_H
+#define ESP_A2DP_API_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+
+// La fuente A2DP del host lee un WAV PCM de 16 bits estereo y entrega bloques decodificados
+// al callback de datos, con los mismos eventos de conexion y configuracion que un telefono
+
+typedef enum {
+    ESP_A2D_CONNECTION_STATE_DISCONNECTED = 0,
+    ESP_A2D_CONNECTION_STATE_CONNECTING,
+    ESP_A2D_CONNECTION_STATE_CONNECTED,
+    ESP_A2D_CONNECTION_STATE_DISCONNECTING
+} esp_a2d_connection_state_t;
+
+typedef enum {
+    ESP_A2D_AUDIO_STATE_REMOTE_SUSPEND = 0,
+    ESP_A2D_AUDIO_STATE_STOPPED,
+    ESP_A2D_AUDIO_STATE_STARTED
+} esp_a2d_audio_state_t;
+
+typedef enum {
+    ESP_A2D_CONNECTION_STATE_EVT = 0,
+    ESP_A2D_AUDIO_STATE_EVT,
+    ESP_A2D_AUDIO_CFG_EVT,
+    ESP_A2D_MEDIA_CTRL_ACK_EVT,
+    ESP_A2D_PROF_STATE_EVT
+} esp_a2d_cb_event_t;
+
+#define ESP_A2D_MCT_SBC 0
+
+typedef struct {
+    uint8_t type;
+    union {
+        uint8_t sbc[4];
+    } cie;
+} esp_a2d_mcc_t;
+
+typedef union {
+    struct {
+        esp_a2d_connection_state_t state;
+        esp_bd_addr_t remote_bda;
+        int disc_rsn;
+    } conn_stat;
+    struct {
+        esp_a2d_audio_state_t state;
+        esp_bd_addr_t remote_bda;
+    } audio_stat;
+    struct {
+        esp_bd_addr_t remote_bda;
+        esp_a2d_mcc_t mcc;
+    } audio_cfg;
+} esp_a2d_cb_param_t;
+
+typedef void (*esp_a2d_cb_t)(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param);
+typedef void (*esp_a2d_sink_data_cb_t)(const uint8_t *buf, uint32_t len);
+
+esp_err_t esp_a2d_register_callback(esp_a2d_cb_t callback);
+esp_err_t esp_a2d_sink_register_data_callback(esp_a2d_sink_data_cb_t callback);
+esp_err_t esp_a2d_sink_init(void);
+esp_err_t esp_a2d_sink_connect(esp_bd_addr_t remote_bda);
+
+#endif // ESP_A2DP_API_H
@@ -0,0 +1,10 @@
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// En el host no hay IRAM/DRAM: los atributos de ubicacion quedan vacios
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define COREDUMP_DRAM_ATTR
+
+#endif // ESP_ATTR_H
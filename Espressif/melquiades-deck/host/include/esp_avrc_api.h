@@ -0,0 +1,25 @@
+#ifndef ESP_AVRC_API_H
+#define ESP_AVRC_API_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+
+typedef enum {
+    ESP_AVRC_CT_CONNECTION_STATE_EVT = 0,
+    ESP_AVRC_CT_PASSTHROUGH_RSP_EVT = 1
+} esp_avrc_ct_cb_event_t;
+
+typedef union {
+    struct {
+        bool connected;
+        esp_bd_addr_t remote_bda;
+    } conn_stat;
+} esp_avrc_ct_cb_param_t;
+
+typedef void (*esp_avrc_ct_cb_t)(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param_t *param);
+
+esp_err_t esp_avrc_ct_init(void);
+esp_err_t esp_avrc_ct_register_callback(esp_avrc_ct_cb_t callback);
+
+#endif // ESP_AVRC_API_H
@@ -0,0 +1,16 @@
+#ifndef ESP_BT_DEFS_H
+#define ESP_BT_DEFS_H
+
+#include <stdint.h>
+
+#define ESP_BD_ADDR_LEN             6
+#define ESP_BT_GAP_MAX_BDNAME_LEN   248
+
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef enum {
+    ESP_BT_STATUS_SUCCESS = 0,
+    ESP_BT_STATUS_FAIL
+} esp_bt_status_t;
+
+#endif // ESP_BT_DEFS_H
@@ -0,0 +1,9 @@
+#ifndef ESP_BT_DEVICE_H
+#define ESP_BT_DEVICE_H
+
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+
+esp_err_t esp_bt_dev_set_device_name(const char *name);
+
+#endif // ESP_BT_DEVICE_H
@@ -0,0 +1,10 @@
+#ifndef ESP_CPU_H
+#define ESP_CPU_H
+
+#include <stdint.h>
+
+// Ciclos equivalentes a CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ sacados del reloj monotono,
+// asi los contadores de ciclos del firmware se leen en las mismas unidades
+uint32_t esp_cpu_get_ccount(void);
+
+#endif // ESP_CPU_H
@@ -0,0 +1,8 @@
+#ifndef ESP_INTR_ALLOC_H
+#define ESP_INTR_ALLOC_H
+
+// Flags de asignacion de interrupciones: en el host solo se aceptan y se ignoran
+#define ESP_INTR_FLAG_LEVEL1    (1 << 1)
+#define ESP_INTR_FLAG_IRAM      (1 << 10)
+
+#endif // ESP_INTR_ALLOC_H
@@ -0,0 +1,51 @@
+#ifndef FREERTOS_FREERTOS_H
+#define FREERTOS_FREERTOS_H
+
+// FreeRTOS sobre pthreads para el build de host: mismos tipos y constantes que el port
+// del ESP32 con CONFIG_FREERTOS_HZ=100, implementados en port/host_freertos.c
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+// En el ESP32 es un spinlock entre cores; aqui todas las secciones criticas comparten un mutex
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define errQUEUE_FULL           0
+#define portMAX_DELAY           (TickType_t)0xffffffffUL
+#define configTICK_RATE_HZ      CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(x)        ((TickType_t)(((TickType_t)(x) * configTICK_RATE_HZ) / 1000))
+#define portNUM_PROCESSORS      2
+#define configMAX_PRIORITIES    25
+#define configMAX_TASK_NAME_LEN 16
+#define tskNO_AFFINITY          0x7FFFFFFF
+
+// Las "ISR" del host corren en hilos comunes, ceder no tiene sentido
+#define portYIELD_FROM_ISR()    do {} while (0)
+
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+#define portENTER_CRITICAL(m)       vPortEnterCritical(m)
+#define portEXIT_CRITICAL(m)        vPortExitCritical(m)
+#define portENTER_CRITICAL_ISR(m)   vPortEnterCritical(m)
+#define portEXIT_CRITICAL_ISR(m)    vPortExitCritical(m)
+
+BaseType_t xPortGetCoreID(void);
+BaseType_t xPortInIsrContext(void);
+
+#endif // FREERTOS_FREERTOS_H
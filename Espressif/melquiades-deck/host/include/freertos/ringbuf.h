@@ -0,0 +1,23 @@
+#ifndef FREERTOS_RINGBUF_H
+#define FREERTOS_RINGBUF_H
+
+#include "FreeRTOS.h"
+
+// Solo el modo RINGBUF_TYPE_BYTEBUF, el unico que usa el firmware (ring de audio)
+
+typedef struct RingbufferDef *RingbufHandle_t;
+
+typedef enum {
+    RINGBUF_TYPE_NOSPLIT = 0,
+    RINGBUF_TYPE_ALLOWSPLIT,
+    RINGBUF_TYPE_BYTEBUF
+} RingbufferType_t;
+
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t type);
+BaseType_t xRingbufferSend(RingbufHandle_t rb, const void *item, size_t size, TickType_t wait);
+void *xRingbufferReceiveUpTo(RingbufHandle_t rb, size_t *size, TickType_t wait, size_t max);
+void vRingbufferReturnItem(RingbufHandle_t rb, void *item);
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t rb);
+void vRingbufferDelete(RingbufHandle_t rb);
+
+#endif // FREERTOS_RINGBUF_H
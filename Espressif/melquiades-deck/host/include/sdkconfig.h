@@ -0,0 +1,12 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// Opciones del sdkconfig del proyecto que lee el firmware, con los mismos valores
+#define CONFIG_FREERTOS_HZ                      100
+#define CONFIG_FREERTOS_USE_TRACE_FACILITY      1
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS 1
+#define CONFIG_BTDM_CTRL_BR_EDR_MAX_ACL_CONN    2
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ       160
+#define CONFIG_LOG_DEFAULT_LEVEL                3
+
+#endif // SDKCONFIG_H
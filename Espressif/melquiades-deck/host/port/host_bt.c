@@ -0,0 +1,459 @@
+// Bluetooth del host: Bluedroid sin radio. A2DP recibe audio de un WAV que hace de telefono
+// y SPP atiende un pseudo terminal. Los callbacks del firmware corren serializados como en
+// la tarea BTC del ESP32.
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "esp_bt.h"
+#include "esp_bt_main.h"
+#include "esp_bt_device.h"
+#include "esp_gap_bt_api.h"
+#include "esp_a2dp_api.h"
+#include "esp_avrc_api.h"
+#include "esp_spp_api.h"
+#include "esp_log.h"
+#include "host_port.h"
+#include "host_wav.h"
+
+#define TAG "HOST_BT"
+
+#define A2DP_CHUNK_FRAMES   1024    // Frames por entrega al callback de datos (~23 ms a 44.1 kHz)
+#define SPP_READ_BYTES      512
+#define SPP_HANDLE          0x81    // Handle de la unica conexion SPP
+#define SPP_POLL_MS         100
+
+// Direccion local administrada de la fuente simulada
+static const esp_bd_addr_t host_src_bda = {0x02, 0x48, 0x4f, 0x53, 0x54, 0x01};
+
+typedef struct bt_event {
+    esp_spp_cb_event_t event;
+    esp_spp_cb_param_t param;
+    uint8_t data[SPP_READ_BYTES];
+    struct bt_event *next;
+} bt_event_t;
+
+// Los callbacks de Bluedroid nunca corren en paralelo
+static pthread_mutex_t btc_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static esp_a2d_cb_t a2d_cb = NULL;
+static esp_a2d_sink_data_cb_t a2d_data_cb = NULL;
+static const char *a2dp_source_path = NULL;
+static bool a2dp_source_loop = false;
+static volatile bool a2dp_done = true;
+
+static esp_spp_cb_t *spp_cb = NULL;
+static const char *spp_link = NULL;
+static int spp_master = -1;
+static volatile bool spp_connected = false;
+static pthread_mutex_t spp_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t spp_queue_cond = PTHREAD_COND_INITIALIZER;
+static bt_event_t *spp_queue_head = NULL;
+static bt_event_t *spp_queue_tail = NULL;
+
+void host_a2dp_set_source(const char *path, bool loop)
+{
+    a2dp_source_path = path;
+    a2dp_source_loop = loop;
+    a2dp_done = path == NULL;
+}
+
+bool host_a2dp_done(void)
+{
+    return a2dp_done;
+}
+
+void host_spp_set_link(const char *path)
+{
+    spp_link = path;
+}
+
+static void start_thread(void *(*fn)(void *), const char *name)
+{
+    pthread_t thread;
+    pthread_create(&thread, NULL, fn, NULL);
+    pthread_setname_np(thread, name);
+    pthread_detach(thread);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Controlador, Bluedroid, GAP y AVRCP: nada que hacer sin radio
+
+esp_err_t esp_bt_controller_mem_release(esp_bt_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_init(esp_bt_controller_config_t *cfg)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_enable(esp_bt_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_enable(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_dev_set_device_name(const char *name)
+{
+    ESP_LOGI(TAG, "Nombre del dispositivo: %s", name);
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_gap_register_callback(esp_bt_gap_cb_t callback)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_gap_set_scan_mode(esp_bt_connection_mode_t c_mode, esp_bt_discovery_mode_t d_mode)
+{
+    return ESP_OK;
+}
+
+int esp_bt_gap_get_bond_device_num(void)
+{
+    return 0;
+}
+
+esp_err_t esp_bt_gap_get_bond_device_list(int *dev_num, esp_bd_addr_t *dev_list)
+{
+    *dev_num = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_avrc_ct_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_avrc_ct_register_callback(esp_avrc_ct_cb_t callback)
+{
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------------------------
+// A2DP: el WAV se entrega en bloques al ritmo de su frecuencia de muestreo
+
+static void a2d_event(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param)
+{
+    pthread_mutex_lock(&btc_lock);
+    a2d_cb(event, param);
+    pthread_mutex_unlock(&btc_lock);
+}
+
+// Octeto 0 del codec SBC: bit 7 = 16 kHz, 6 = 32 kHz, 5 = 44.1 kHz, 4 = 48 kHz
+static uint8_t sbc_rate_bits(uint32_t rate)
+{
+    switch (rate) {
+    case 16000: return 0x80;
+    case 32000: return 0x40;
+    case 44100: return 0x20;
+    case 48000: return 0x10;
+    default:    return 0;
+    }
+}
+
+static void *a2dp_source_thread(void *arg)
+{
+    static uint8_t in[A2DP_CHUNK_FRAMES * 4];
+    static uint8_t out[A2DP_CHUNK_FRAMES * 4];
+    host_wav_t wav;
+    esp_a2d_cb_param_t param;
+
+    if (!host_wav_open_read(&wav, a2dp_source_path) || wav.channels < 1 || wav.channels > 2 ||
+        sbc_rate_bits(wav.sample_rate) == 0) {
+        ESP_LOGE(TAG, "%s no es un WAV PCM de 16 bits mono o estereo a 16/32/44.1/48 kHz", a2dp_source_path);
+        a2dp_done = true;
+        return NULL;
+    }
+    ESP_LOGI(TAG, "Fuente A2DP: %s, %u Hz, %u canales", a2dp_source_path, wav.sample_rate, wav.channels);
+
+    memset(&param, 0, sizeof(param));
+    param.conn_stat.state = ESP_A2D_CONNECTION_STATE_CONNECTED;
+    memcpy(param.conn_stat.remote_bda, host_src_bda, sizeof(esp_bd_addr_t));
+    a2d_event(ESP_A2D_CONNECTION_STATE_EVT, &param);
+
+    memset(&param, 0, sizeof(param));
+    param.audio_cfg.mcc.type = ESP_A2D_MCT_SBC;
+    param.audio_cfg.mcc.cie.sbc[0] = sbc_rate_bits(wav.sample_rate);
+    memcpy(param.audio_cfg.remote_bda, host_src_bda, sizeof(esp_bd_addr_t));
+    a2d_event(ESP_A2D_AUDIO_CFG_EVT, &param);
+
+    memset(&param, 0, sizeof(param));
+    param.audio_stat.state = ESP_A2D_AUDIO_STATE_STARTED;
+    memcpy(param.audio_stat.remote_bda, host_src_bda, sizeof(esp_bd_addr_t));
+    a2d_event(ESP_A2D_AUDIO_STATE_EVT, &param);
+
+    size_t frame_in = wav.channels * 2u;
+    uint32_t left = wav.data_bytes;
+    int64_t next_us = host_time_us();
+    while (1) {
+        size_t want = sizeof(in) / 4 * frame_in;
+        size_t got = fread(in, 1, want < left ? want : left, wav.file) / frame_in;
+        left -= (uint32_t)(got * frame_in);
+        if (got == 0) {
+            if (!a2dp_source_loop) {
+                break;
+            }
+            host_wav_rewind(&wav);
+            left = wav.data_bytes;
+            continue;
+        }
+        const uint8_t *pcm = in;
+        if (wav.channels == 1) {
+            // El telefono siempre entrega estereo intercalado
+            for (size_t i = 0; i < got; i++) {
+                memcpy(&out[i * 4], &in[i * 2], 2);
+                memcpy(&out[i * 4 + 2], &in[i * 2], 2);
+            }
+            pcm = out;
+        }
+        pthread_mutex_lock(&btc_lock);
+        a2d_data_cb(pcm, (uint32_t)(got * 4));
+        pthread_mutex_unlock(&btc_lock);
+        next_us += (int64_t)got * 1000000 / wav.sample_rate;
+        host_sleep_until_us(next_us);
+    }
+
+    memset(&param, 0, sizeof(param));
+    param.audio_stat.state = ESP_A2D_AUDIO_STATE_STOPPED;
+    memcpy(param.audio_stat.remote_bda, host_src_bda, sizeof(esp_bd_addr_t));
+    a2d_event(ESP_A2D_AUDIO_STATE_EVT, &param);
+    host_wav_close(&wav, false);
+    ESP_LOGI(TAG, "Fin de la fuente A2DP");
+    a2dp_done = true;
+    return NULL;
+}
+
+esp_err_t esp_a2d_register_callback(esp_a2d_cb_t callback)
+{
+    a2d_cb = callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_a2d_sink_register_data_callback(esp_a2d_sink_data_cb_t callback)
+{
+    a2d_data_cb = callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_a2d_sink_init(void)
+{
+    if (a2d_cb == NULL || a2d_data_cb == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (a2dp_source_path != NULL) {
+        start_thread(a2dp_source_thread, "a2dp_source");
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_a2d_sink_connect(esp_bd_addr_t remote_bda)
+{
+    // Sin fuentes emparejadas el firmware no deberia pedir una conexion saliente
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+// ---------------------------------------------------------------------------------------------
+// SPP sobre pty
+
+static void spp_post(esp_spp_cb_event_t event, const esp_spp_cb_param_t *param, const uint8_t *data, size_t len)
+{
+    bt_event_t *ev = calloc(1, sizeof(*ev));
+    if (ev == NULL) {
+        return;
+    }
+    ev->event = event;
+    if (param != NULL) {
+        ev->param = *param;
+    }
+    if (data != NULL) {
+        memcpy(ev->data, data, len);
+        ev->param.data_ind.data = ev->data;
+        ev->param.data_ind.len = (uint16_t)len;
+    }
+    pthread_mutex_lock(&spp_queue_lock);
+    if (spp_queue_tail != NULL) {
+        spp_queue_tail->next = ev;
+    } else {
+        spp_queue_head = ev;
+    }
+    spp_queue_tail = ev;
+    pthread_cond_signal(&spp_queue_cond);
+    pthread_mutex_unlock(&spp_queue_lock);
+}
+
+// Hace de tarea BTC para los eventos SPP
+static void *spp_dispatch_thread(void *arg)
+{
+    while (1) {
+        pthread_mutex_lock(&spp_queue_lock);
+        while (spp_queue_head == NULL) {
+            pthread_cond_wait(&spp_queue_cond, &spp_queue_lock);
+        }
+        bt_event_t *ev = spp_queue_head;
+        spp_queue_head = ev->next;
+        if (spp_queue_head == NULL) {
+            spp_queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&spp_queue_lock);
+
+        if (ev->event == ESP_SPP_DATA_IND_EVT) {
+            ev->param.data_ind.data = ev->data;
+        }
+        pthread_mutex_lock(&btc_lock);
+        spp_cb(ev->event, &ev->param);
+        pthread_mutex_unlock(&btc_lock);
+        free(ev);
+    }
+    return NULL;
+}
+
+// La conexion se abre con los primeros datos del cliente y se cierra cuando suelta el pty
+static void *spp_pty_thread(void *arg)
+{
+    uint8_t buf[SPP_READ_BYTES];
+    esp_spp_cb_param_t param;
+    while (1) {
+        struct pollfd pfd = {.fd = spp_master, .events = POLLIN};
+        if (poll(&pfd, 1, SPP_POLL_MS) <= 0) {
+            continue;
+        }
+        ssize_t n = (pfd.revents & POLLIN) ? read(spp_master, buf, sizeof(buf)) : -1;
+        if (n > 0) {
+            if (!spp_connected) {
+                spp_connected = true;
+                memset(&param, 0, sizeof(param));
+                param.srv_open.status = ESP_SPP_SUCCESS;
+                param.srv_open.handle = SPP_HANDLE;
+                memcpy(param.srv_open.rem_bda, host_src_bda, sizeof(esp_bd_addr_t));
+                spp_post(ESP_SPP_SRV_OPEN_EVT, &param, NULL, 0);
+            }
+            memset(&param, 0, sizeof(param));
+            param.data_ind.status = ESP_SPP_SUCCESS;
+            param.data_ind.handle = SPP_HANDLE;
+            spp_post(ESP_SPP_DATA_IND_EVT, &param, buf, (size_t)n);
+            continue;
+        }
+        // Sin nadie del lado esclavo el maestro informa POLLHUP o EIO en cada intento
+        if (spp_connected) {
+            spp_connected = false;
+            memset(&param, 0, sizeof(param));
+            param.close.status = ESP_SPP_SUCCESS;
+            param.close.handle = SPP_HANDLE;
+            spp_post(ESP_SPP_CLOSE_EVT, &param, NULL, 0);
+        }
+        usleep(SPP_POLL_MS * 1000);
+    }
+    return NULL;
+}
+
+static esp_err_t open_pty(void)
+{
+    struct termios tio;
+    spp_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (spp_master < 0 || grantpt(spp_master) != 0 || unlockpt(spp_master) != 0) {
+        return ESP_FAIL;
+    }
+    // Modo crudo: los comandos y las tramas binarias pasan sin tocar
+    if (tcgetattr(spp_master, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(spp_master, TCSANOW, &tio);
+    }
+    const char *name = ptsname(spp_master);
+    if (spp_link != NULL) {
+        unlink(spp_link);
+        if (symlink(name, spp_link) != 0) {
+            ESP_LOGW(TAG, "No se pudo crear %s: %s", spp_link, strerror(errno));
+        }
+    }
+    ESP_LOGI(TAG, "Servidor SPP en %s%s%s", name, spp_link != NULL ? " -> " : "", spp_link != NULL ? spp_link : "");
+    return ESP_OK;
+}
+
+esp_err_t esp_spp_register_callback(esp_spp_cb_t callback)
+{
+    spp_cb = callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_spp_init(esp_spp_mode_t mode)
+{
+    esp_spp_cb_param_t param;
+    if (spp_cb == NULL || mode != ESP_SPP_MODE_CB) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    start_thread(spp_dispatch_thread, "btc_spp");
+    memset(&param, 0, sizeof(param));
+    spp_post(ESP_SPP_INIT_EVT, &param, NULL, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_spp_start_srv(esp_spp_sec_t sec_mask, esp_spp_role_t role, uint8_t local_scn, const char *name)
+{
+    esp_spp_cb_param_t param;
+    if (spp_master < 0) {
+        if (open_pty() != ESP_OK) {
+            ESP_LOGE(TAG, "No se pudo abrir el pty del servidor SPP");
+            return ESP_FAIL;
+        }
+        start_thread(spp_pty_thread, "spp_pty");
+    }
+    memset(&param, 0, sizeof(param));
+    spp_post(ESP_SPP_START_EVT, &param, NULL, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_spp_write(uint32_t handle, int len, uint8_t *p_data)
+{
+    esp_spp_cb_param_t param;
+    if (handle != SPP_HANDLE || !spp_connected) {
+        return ESP_FAIL;
+    }
+    // Bloquea si el cliente no lee, como la ventana de creditos de RFCOMM
+    int done = 0;
+    while (done < len) {
+        ssize_t n = write(spp_master, p_data + done, (size_t)(len - done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        done += (int)n;
+    }
+    memset(&param, 0, sizeof(param));
+    param.write.status = done == len ? ESP_SPP_SUCCESS : ESP_SPP_FAILURE;
+    param.write.handle = handle;
+    param.write.len = done;
+    spp_post(ESP_SPP_WRITE_EVT, &param, NULL, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_spp_disconnect(uint32_t handle)
+{
+    esp_spp_cb_param_t param;
+    if (handle != SPP_HANDLE || !spp_connected) {
+        return ESP_FAIL;
+    }
+    spp_connected = false;
+    memset(&param, 0, sizeof(param));
+    param.close.status = ESP_SPP_SUCCESS;
+    param.close.handle = handle;
+    spp_post(ESP_SPP_CLOSE_EVT, &param, NULL, 0);
+    return ESP_OK;
+}
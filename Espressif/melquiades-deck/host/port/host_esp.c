@@ -0,0 +1,309 @@
+// Servicios basicos de ESP-IDF en el host: reloj, log, errores, sistema y esp_timer
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "host_port.h"
+
+#define TAG "HOST_ESP"
+
+// Heap que se informa al firmware: el del ESP32 con Bluedroid y A2DP arriba, orientativo
+#define HOST_HEAP_FREE  120000
+#define LOG_TAG_OVERRIDES 16    // Tags con nivel propio
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t deadline_us;    // -1 si no esta armado
+    uint64_t period_us;     // 0 para un disparo
+    struct esp_timer *next;
+};
+
+static int64_t boot_ns = 0;
+static esp_log_level_t log_level = CONFIG_LOG_DEFAULT_LEVEL;
+static struct {
+    const char *tag;
+    esp_log_level_t level;
+} log_tags[LOG_TAG_OVERRIDES];
+static int log_tag_count = 0;
+static vprintf_like_t log_vprintf = vprintf;
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+static struct esp_timer *timers = NULL;
+
+static int64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// El arranque del proceso es el cero del reloj, como el boot del ESP32
+__attribute__((constructor)) static void init_boot_time(void)
+{
+    boot_ns = monotonic_ns();
+}
+
+int64_t host_time_us(void)
+{
+    return (monotonic_ns() - boot_ns) / 1000;
+}
+
+void host_sleep_until_us(int64_t t_us)
+{
+    int64_t ns = boot_ns + t_us * 1000;
+    struct timespec ts = {.tv_sec = ns / 1000000000LL, .tv_nsec = ns % 1000000000LL};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return host_time_us();
+}
+
+uint32_t esp_cpu_get_ccount(void)
+{
+    return (uint32_t)((monotonic_ns() - boot_ns) * CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ / 1000);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Log
+
+// Como en IDF los tags se comparan por contenido y "*" fija el nivel global
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    if (strcmp(tag, "*") == 0) {
+        log_level = level;
+        while (log_tag_count > 0) {
+            free((char *)log_tags[--log_tag_count].tag);
+        }
+        return;
+    }
+    for (int i = 0; i < log_tag_count; i++) {
+        if (strcmp(log_tags[i].tag, tag) == 0) {
+            log_tags[i].level = level;
+            return;
+        }
+    }
+    if (log_tag_count < LOG_TAG_OVERRIDES) {
+        log_tags[log_tag_count].tag = strdup(tag);
+        log_tags[log_tag_count].level = level;
+        log_tag_count++;
+    }
+}
+
+static esp_log_level_t tag_level(const char *tag)
+{
+    for (int i = 0; i < log_tag_count; i++) {
+        if (strcmp(log_tags[i].tag, tag) == 0) {
+            return log_tags[i].level;
+        }
+    }
+    return log_level;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(host_time_us() / 1000);
+}
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
+{
+    vprintf_like_t prev = log_vprintf;
+    log_vprintf = func;
+    return prev;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = "NEWIDV";
+    char line[512];
+    va_list args;
+    if (level > tag_level(tag)) {
+        return;
+    }
+    // Como en IDF el prefijo va dentro del formato, asi los hooks de vprintf reciben la linea completa
+    snprintf(line, sizeof(line), "%c (%u) %s: %s\n", letters[level], esp_log_timestamp(), tag, format);
+    va_start(args, format);
+    log_vprintf(line, args);
+    va_end(args);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Errores y sistema
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                        return "ESP_OK";
+    case ESP_FAIL:                      return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:                return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:           return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:         return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:          return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:             return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:         return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:               return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_FOUND:         return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_READ_ONLY:         return "ESP_ERR_NVS_READ_ONLY";
+    case ESP_ERR_NVS_INVALID_HANDLE:    return "ESP_ERR_NVS_INVALID_HANDLE";
+    case ESP_ERR_NVS_INVALID_LENGTH:    return "ESP_ERR_NVS_INVALID_LENGTH";
+    case ESP_ERR_NVS_NO_FREE_PAGES:     return "ESP_ERR_NVS_NO_FREE_PAGES";
+    case ESP_ERR_NVS_NEW_VERSION_FOUND: return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+    default:                            return "UNKNOWN ERROR";
+    }
+}
+
+void _esp_error_check_failed(esp_err_t rc, const char *file, int line, const char *function, const char *expression)
+{
+    fprintf(stderr, "ESP_ERROR_CHECK fallo: esp_err_t 0x%x (%s) en %s:%d (%s)\nexpresion: %s\n",
+            rc, esp_err_to_name(rc), file, line, function, expression);
+    abort();
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return HOST_HEAP_FREE;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return HOST_HEAP_FREE;
+}
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+// ---------------------------------------------------------------------------------------------
+// esp_timer: un hilo despacha todos los timers en orden de vencimiento
+
+static void *timer_thread(void *arg)
+{
+    pthread_mutex_lock(&timer_lock);
+    while (1) {
+        struct esp_timer *due = NULL;
+        for (struct esp_timer *t = timers; t != NULL; t = t->next) {
+            if (t->deadline_us >= 0 && (due == NULL || t->deadline_us < due->deadline_us)) {
+                due = t;
+            }
+        }
+        if (due == NULL) {
+            pthread_cond_wait(&timer_cond, &timer_lock);
+            continue;
+        }
+        int64_t now = host_time_us();
+        if (due->deadline_us > now) {
+            int64_t ns = boot_ns + due->deadline_us * 1000;
+            struct timespec ts = {.tv_sec = ns / 1000000000LL, .tv_nsec = ns % 1000000000LL};
+            pthread_cond_timedwait(&timer_cond, &timer_lock, &ts);
+            continue;
+        }
+        due->deadline_us = due->period_us > 0 ? due->deadline_us + (int64_t)due->period_us : -1;
+        esp_timer_cb_t cb = due->callback;
+        void *cb_arg = due->arg;
+        // El callback puede volver a armar o parar timers
+        pthread_mutex_unlock(&timer_lock);
+        cb(cb_arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+static void start_timer_thread(void)
+{
+    pthread_t thread;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_create(&thread, NULL, timer_thread, NULL);
+    pthread_setname_np(thread, "esp_timer");
+    pthread_detach(thread);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_once(&timer_once, start_timer_thread);
+    struct esp_timer *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    t->callback = create_args->callback;
+    t->arg = create_args->arg;
+    t->deadline_us = -1;
+    pthread_mutex_lock(&timer_lock);
+    t->next = timers;
+    timers = t;
+    pthread_mutex_unlock(&timer_lock);
+    *out_handle = t;
+    return ESP_OK;
+}
+
+static esp_err_t arm_timer(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us)
+{
+    esp_err_t ret = ESP_OK;
+    pthread_mutex_lock(&timer_lock);
+    if (timer->deadline_us >= 0) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        timer->deadline_us = host_time_us() + (int64_t)timeout_us;
+        timer->period_us = period_us;
+        pthread_cond_signal(&timer_cond);
+    }
+    pthread_mutex_unlock(&timer_lock);
+    return ret;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return arm_timer(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    return arm_timer(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t ret = ESP_OK;
+    pthread_mutex_lock(&timer_lock);
+    if (timer->deadline_us < 0) {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    timer->deadline_us = -1;
+    pthread_mutex_unlock(&timer_lock);
+    return ret;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    for (struct esp_timer **p = &timers; *p != NULL; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&timer_lock);
+    free(timer);
+    return ESP_OK;
+}
@@ -0,0 +1,610 @@
+// FreeRTOS sobre pthreads: tareas, notificaciones, colas, ring de bytes y secciones criticas.
+// Alcanza con lo que usa el firmware; no es un planificador de tiempo real.
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/ringbuf.h"
+#include "esp_log.h"
+#include "host_port.h"
+
+#define TAG "HOST_RTOS"
+
+struct tskTaskControlBlock {
+    pthread_t thread;
+    char name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t fn;
+    void *arg;
+    uint32_t stack;
+    UBaseType_t priority;
+    BaseType_t core;
+    UBaseType_t number;
+    clockid_t cpu_clock;
+    bool has_clock;
+    // Notificacion simple (contador), como xTaskNotifyGive/ulTaskNotifyTake
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    struct tskTaskControlBlock *next;
+};
+
+struct QueueDefinition {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t *storage;
+};
+
+struct RingbufferDef {
+    pthread_mutex_t lock;
+    pthread_cond_t data;
+    pthread_cond_t space;
+    size_t size;
+    size_t read;            // Inicio de los datos
+    size_t used;            // Bytes escritos, incluidos los prestados
+    size_t borrowed;        // Bytes entregados por ReceiveUpTo y aun no devueltos
+    uint8_t *buf;
+};
+
+static pthread_mutex_t tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct tskTaskControlBlock *tasks = NULL;
+static UBaseType_t task_count = 0;
+static UBaseType_t task_numbers = 0;
+static __thread struct tskTaskControlBlock *current_task = NULL;
+
+static pthread_mutex_t critical_lock;
+static pthread_once_t critical_once = PTHREAD_ONCE_INIT;
+
+// ---------------------------------------------------------------------------------------------
+// Tiempos de espera
+
+static void init_cond(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL + (uint64_t)ts.tv_nsec;
+    ts.tv_sec += (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+// Espera en cond hasta que pred() se cumpla o venza el plazo; devuelve pdTRUE si se cumplio
+#define WAIT_UNTIL(pred, cond, lock, ticks, deadline) ({                         \
+        BaseType_t __ok = pdTRUE;                                               \
+        while (!(pred)) {                                                       \
+            if ((ticks) == 0) {                                                 \
+                __ok = pdFALSE;                                                 \
+                break;                                                          \
+            }                                                                   \
+            if ((ticks) == portMAX_DELAY) {                                     \
+                pthread_cond_wait((cond), (lock));                              \
+            } else if (pthread_cond_timedwait((cond), (lock), (deadline)) == ETIMEDOUT && !(pred)) { \
+                __ok = pdFALSE;                                                 \
+                break;                                                          \
+            }                                                                   \
+        }                                                                       \
+        __ok;                                                                   \
+    })
+
+static void unlock_mutex(void *arg)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Tareas
+
+static void link_task(struct tskTaskControlBlock *t)
+{
+    pthread_mutex_lock(&tasks_lock);
+    t->number = ++task_numbers;
+    t->next = tasks;
+    tasks = t;
+    task_count++;
+    pthread_mutex_unlock(&tasks_lock);
+}
+
+static void unlink_task(struct tskTaskControlBlock *t)
+{
+    pthread_mutex_lock(&tasks_lock);
+    for (struct tskTaskControlBlock **p = &tasks; *p != NULL; p = &(*p)->next) {
+        if (*p == t) {
+            *p = t->next;
+            task_count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&tasks_lock);
+}
+
+static struct tskTaskControlBlock *new_task(const char *name, uint32_t stack, UBaseType_t prio, BaseType_t core)
+{
+    struct tskTaskControlBlock *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return NULL;
+    }
+    strncpy(t->name, name, sizeof(t->name) - 1);
+    t->stack = stack;
+    t->priority = prio;
+    t->core = core;
+    pthread_mutex_init(&t->lock, NULL);
+    init_cond(&t->cond);
+    return t;
+}
+
+static void *task_entry(void *arg)
+{
+    struct tskTaskControlBlock *t = arg;
+    current_task = t;
+    // Nombre visible en perf y gdb (el kernel acepta 15 caracteres)
+    char thread_name[16];
+    snprintf(thread_name, sizeof(thread_name), "%s", t->name);
+    pthread_setname_np(pthread_self(), thread_name);
+    t->has_clock = pthread_getcpuclockid(pthread_self(), &t->cpu_clock) == 0;
+    pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
+    t->fn(t->arg);
+    // Como en FreeRTOS, una tarea no debe volver de su funcion
+    ESP_LOGE(TAG, "La tarea %s retorno sin vTaskDelete", t->name);
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+void host_freertos_init(void)
+{
+    struct tskTaskControlBlock *t = new_task("main", 0, 1, 0);
+    t->thread = pthread_self();
+    t->has_clock = pthread_getcpuclockid(t->thread, &t->cpu_clock) == 0;
+    current_task = t;
+    link_task(t);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core)
+{
+    struct tskTaskControlBlock *t = new_task(name, stack, prio, core);
+    if (t == NULL) {
+        return pdFAIL;
+    }
+    t->fn = fn;
+    t->arg = arg;
+    link_task(t);
+    if (pthread_create(&t->thread, NULL, task_entry, t) != 0) {
+        unlink_task(t);
+        free(t);
+        return pdFAIL;
+    }
+    if (out != NULL) {
+        *out = t;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio,
+                       TaskHandle_t *out)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                           UBaseType_t prio, StackType_t *stack_buffer, StaticTask_t *tcb_buffer,
+                                           BaseType_t core)
+{
+    TaskHandle_t handle = NULL;
+    (void)stack_buffer;
+    (void)tcb_buffer;
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, &handle, core) == pdPASS ? handle : NULL;
+}
+
+void vTaskDelete(TaskHandle_t t)
+{
+    if (t == NULL || t == current_task) {
+        t = current_task;
+        if (t == NULL) {
+            pthread_exit(NULL);
+        }
+        unlink_task(t);
+        if (t->fn == NULL) {
+            // La tarea main vuelve a host_main, que sigue esperando el fin de la corrida
+            return;
+        }
+        pthread_detach(pthread_self());
+        free(t);
+        pthread_exit(NULL);
+    }
+    // Otra tarea: se cancela en su proxima espera y se espera a que salga antes de liberar
+    unlink_task(t);
+    pthread_cancel(t->thread);
+    pthread_join(t->thread, NULL);
+    free(t);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    struct timespec ts = deadline_after(ticks);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(host_time_us() / (1000 * portTICK_PERIOD_MS));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current_task;
+}
+
+BaseType_t xTaskGetAffinity(TaskHandle_t t)
+{
+    t = t != NULL ? t : current_task;
+    return t != NULL ? t->core : tskNO_AFFINITY;
+}
+
+char *pcTaskGetName(TaskHandle_t t)
+{
+    t = t != NULL ? t : current_task;
+    return t != NULL ? t->name : NULL;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return current_task != NULL && current_task->core != tskNO_AFFINITY ? current_task->core : 0;
+}
+
+BaseType_t xPortInIsrContext(void)
+{
+    // Los hilos que no son tareas (traza de sensores, timers, BT) hacen de contexto de interrupcion
+    return current_task == NULL;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    return task_count;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t t)
+{
+    // Sin stack propio que medir: se informa el tamano pedido, como en uxTaskGetSystemState
+    t = t != NULL ? t : current_task;
+    return t != NULL ? t->stack : 0;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *arr, UBaseType_t size, uint32_t *total_run_time)
+{
+    UBaseType_t n = 0;
+    pthread_mutex_lock(&tasks_lock);
+    for (struct tskTaskControlBlock *t = tasks; t != NULL && n < size; t = t->next, n++) {
+        struct timespec cpu = {0};
+        if (t->has_clock) {
+            clock_gettime(t->cpu_clock, &cpu);
+        }
+        arr[n] = (TaskStatus_t){
+            .xHandle = t,
+            .pcTaskName = t->name,
+            .xTaskNumber = t->number,
+            .eCurrentState = t == current_task ? eRunning : eBlocked,
+            .uxCurrentPriority = t->priority,
+            .uxBasePriority = t->priority,
+            .ulRunTimeCounter = (uint32_t)(cpu.tv_sec * 1000000LL + cpu.tv_nsec / 1000),
+            .pxStackBase = NULL,
+            .usStackHighWaterMark = t->stack,
+            .xCoreID = t->core,
+        };
+    }
+    pthread_mutex_unlock(&tasks_lock);
+    if (total_run_time != NULL) {
+        *total_run_time = (uint32_t)host_time_us();
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Notificaciones
+
+BaseType_t xTaskNotifyGive(TaskHandle_t t)
+{
+    pthread_mutex_lock(&t->lock);
+    t->notify++;
+    pthread_cond_signal(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t *woken)
+{
+    xTaskNotifyGive(t);
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    struct tskTaskControlBlock *t = current_task;
+    struct timespec deadline = deadline_after(wait == portMAX_DELAY ? 0 : wait);
+    uint32_t value = 0;
+    pthread_mutex_lock(&t->lock);
+    pthread_cleanup_push(unlock_mutex, &t->lock);
+    if (WAIT_UNTIL(t->notify != 0, &t->cond, &t->lock, wait, &deadline)) {
+        value = t->notify;
+        t->notify = clear ? 0 : t->notify - 1;
+    }
+    pthread_cleanup_pop(1);
+    return value;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Colas
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size)
+{
+    struct QueueDefinition *q = calloc(1, sizeof(*q));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->storage = malloc(len * item_size + 1);
+    if (q->storage == NULL) {
+        free(q);
+        return NULL;
+    }
+    q->length = len;
+    q->item_size = item_size;
+    pthread_mutex_init(&q->lock, NULL);
+    init_cond(&q->not_empty);
+    init_cond(&q->not_full);
+    return q;
+}
+
+static void queue_push(struct QueueDefinition *q, const void *item)
+{
+    memcpy(&q->storage[((q->head + q->count) % q->length) * q->item_size], item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void *item, TickType_t wait)
+{
+    struct timespec deadline = deadline_after(wait == portMAX_DELAY ? 0 : wait);
+    BaseType_t ok;
+    pthread_mutex_lock(&q->lock);
+    pthread_cleanup_push(unlock_mutex, &q->lock);
+    ok = WAIT_UNTIL(q->count < q->length, &q->not_full, &q->lock, wait, &deadline);
+    if (ok) {
+        queue_push(q, item);
+    }
+    pthread_cleanup_pop(1);
+    return ok ? pdPASS : errQUEUE_FULL;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t wait)
+{
+    return xQueueSendToBack(q, item, wait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken)
+{
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return xQueueSendToBack(q, item, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item)
+{
+    pthread_mutex_lock(&q->lock);
+    if (q->count == q->length) {
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+    }
+    queue_push(q, item);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+static BaseType_t queue_take(QueueHandle_t q, void *item, TickType_t wait, bool remove)
+{
+    struct timespec deadline = deadline_after(wait == portMAX_DELAY ? 0 : wait);
+    BaseType_t ok;
+    pthread_mutex_lock(&q->lock);
+    pthread_cleanup_push(unlock_mutex, &q->lock);
+    ok = WAIT_UNTIL(q->count > 0, &q->not_empty, &q->lock, wait, &deadline);
+    if (ok) {
+        memcpy(item, &q->storage[q->head * q->item_size], q->item_size);
+        if (remove) {
+            q->head = (q->head + 1) % q->length;
+            q->count--;
+            pthread_cond_signal(&q->not_full);
+        }
+    }
+    pthread_cleanup_pop(1);
+    return ok;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t wait)
+{
+    return queue_take(q, item, wait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t wait)
+{
+    return queue_take(q, item, wait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->length - q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->head = 0;
+    q->count = 0;
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->storage);
+    free(q);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Ring de bytes
+
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t type)
+{
+    if (type != RINGBUF_TYPE_BYTEBUF) {
+        ESP_LOGE(TAG, "Solo se soporta RINGBUF_TYPE_BYTEBUF");
+        return NULL;
+    }
+    struct RingbufferDef *rb = calloc(1, sizeof(*rb));
+    if (rb == NULL) {
+        return NULL;
+    }
+    rb->buf = malloc(size);
+    if (rb->buf == NULL) {
+        free(rb);
+        return NULL;
+    }
+    rb->size = size;
+    pthread_mutex_init(&rb->lock, NULL);
+    init_cond(&rb->data);
+    init_cond(&rb->space);
+    return rb;
+}
+
+BaseType_t xRingbufferSend(RingbufHandle_t rb, const void *item, size_t size, TickType_t wait)
+{
+    if (size > rb->size) {
+        return pdFALSE;
+    }
+    struct timespec deadline = deadline_after(wait == portMAX_DELAY ? 0 : wait);
+    BaseType_t ok;
+    pthread_mutex_lock(&rb->lock);
+    pthread_cleanup_push(unlock_mutex, &rb->lock);
+    ok = WAIT_UNTIL(rb->size - rb->used >= size, &rb->space, &rb->lock, wait, &deadline);
+    if (ok) {
+        const uint8_t *src = item;
+        size_t write = (rb->read + rb->used) % rb->size;
+        size_t first = size < rb->size - write ? size : rb->size - write;
+        memcpy(&rb->buf[write], src, first);
+        memcpy(rb->buf, src + first, size - first);
+        rb->used += size;
+        pthread_cond_signal(&rb->data);
+    }
+    pthread_cleanup_pop(1);
+    return ok;
+}
+
+void *xRingbufferReceiveUpTo(RingbufHandle_t rb, size_t *size, TickType_t wait, size_t max)
+{
+    struct timespec deadline = deadline_after(wait == portMAX_DELAY ? 0 : wait);
+    void *item = NULL;
+    pthread_mutex_lock(&rb->lock);
+    pthread_cleanup_push(unlock_mutex, &rb->lock);
+    // Como en ESP-IDF, solo se presta un tramo a la vez y nunca cruza el final del buffer
+    if (WAIT_UNTIL(rb->borrowed == 0 && rb->used > 0, &rb->data, &rb->lock, wait, &deadline)) {
+        size_t len = rb->size - rb->read;
+        len = len < rb->used ? len : rb->used;
+        len = len < max ? len : max;
+        rb->borrowed = len;
+        *size = len;
+        item = &rb->buf[rb->read];
+    }
+    pthread_cleanup_pop(1);
+    return item;
+}
+
+void vRingbufferReturnItem(RingbufHandle_t rb, void *item)
+{
+    pthread_mutex_lock(&rb->lock);
+    rb->read = (rb->read + rb->borrowed) % rb->size;
+    rb->used -= rb->borrowed;
+    rb->borrowed = 0;
+    pthread_cond_broadcast(&rb->space);
+    pthread_cond_signal(&rb->data);
+    pthread_mutex_unlock(&rb->lock);
+}
+
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t rb)
+{
+    pthread_mutex_lock(&rb->lock);
+    size_t free_bytes = rb->size - rb->used;
+    pthread_mutex_unlock(&rb->lock);
+    return free_bytes;
+}
+
+void vRingbufferDelete(RingbufHandle_t rb)
+{
+    pthread_mutex_destroy(&rb->lock);
+    pthread_cond_destroy(&rb->data);
+    pthread_cond_destroy(&rb->space);
+    free(rb->buf);
+    free(rb);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Secciones criticas
+
+static void init_critical(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+    pthread_once(&critical_once, init_critical);
+    pthread_mutex_lock(&critical_lock);
+    mux->count++;
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+    mux->count--;
+    pthread_mutex_unlock(&critical_lock);
+}
@@ -0,0 +1,194 @@
+// I2S del host: las escrituras se consumen al ritmo de la frecuencia configurada, con la
+// profundidad de DMA del driver, y van a un WAV o se descartan
+#include <pthread.h>
+#include <string.h>
+#include "driver/i2s.h"
+#include "esp_log.h"
+#include "host_port.h"
+#include "host_wav.h"
+
+#define TAG "HOST_I2S"
+
+#define I2S_FRAME_BYTES 4   // 16 bits estereo, el unico formato que usa el firmware
+
+typedef struct {
+    bool installed;
+    bool running;
+    uint32_t sample_rate;
+    uint32_t dma_frames;    // Frames que caben en los buffers DMA
+    uint32_t dma_buf_frames;
+    QueueHandle_t events;   // Cola de eventos pedida en i2s_driver_install, NULL sin cola
+    uint64_t done_bufs;     // Buffers DMA ya avisados con I2S_EVENT_TX_DONE
+    int64_t play_start_us;  // Instante en que se empezo a reproducir el frame 0
+    uint64_t frames;        // Frames escritos desde play_start_us
+} host_i2s_port_t;
+
+static host_i2s_port_t ports[I2S_NUM_MAX];
+static pthread_mutex_t sink_lock = PTHREAD_MUTEX_INITIALIZER;
+static const char *sink_path = NULL;
+static host_wav_t sink;
+static bool sink_open = false;
+
+void host_i2s_set_sink(const char *path)
+{
+    sink_path = path;
+}
+
+void host_i2s_close(void)
+{
+    pthread_mutex_lock(&sink_lock);
+    if (sink_open) {
+        ESP_LOGI(TAG, "%s: %u bytes a %u Hz", sink_path, sink.data_bytes, sink.sample_rate);
+        host_wav_close(&sink, true);
+        sink_open = false;
+    }
+    pthread_mutex_unlock(&sink_lock);
+}
+
+esp_err_t i2s_driver_install(i2s_port_t i2s_num, const i2s_config_t *i2s_config, int queue_size, void *i2s_queue)
+{
+    if (i2s_num >= I2S_NUM_MAX || i2s_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (i2s_config->bits_per_sample != I2S_BITS_PER_SAMPLE_16BIT) {
+        ESP_LOGE(TAG, "Solo se emulan 16 bits por muestra");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    host_i2s_port_t *p = &ports[i2s_num];
+    memset(p, 0, sizeof(*p));
+    p->installed = true;
+    p->sample_rate = i2s_config->sample_rate;
+    p->dma_frames = (uint32_t)(i2s_config->dma_buf_count * i2s_config->dma_buf_len);
+    p->dma_buf_frames = (uint32_t)i2s_config->dma_buf_len;
+    if (queue_size > 0 && i2s_queue != NULL) {
+        p->events = xQueueCreate((UBaseType_t)queue_size, sizeof(i2s_event_t));
+        *(QueueHandle_t *)i2s_queue = p->events;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t i2s_num)
+{
+    if (i2s_num >= I2S_NUM_MAX || !ports[i2s_num].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ports[i2s_num].installed = false;
+    ports[i2s_num].running = false;
+    if (ports[i2s_num].events != NULL) {
+        vQueueDelete(ports[i2s_num].events);
+        ports[i2s_num].events = NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_pin(i2s_port_t i2s_num, const i2s_pin_config_t *pin)
+{
+    return i2s_num < I2S_NUM_MAX && ports[i2s_num].installed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t i2s_set_sample_rates(i2s_port_t i2s_num, uint32_t rate)
+{
+    if (i2s_num >= I2S_NUM_MAX || !ports[i2s_num].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Cambiar el reloj vacia el DMA, el ritmo se vuelve a medir desde cero
+    ports[i2s_num].sample_rate = rate;
+    ports[i2s_num].frames = 0;
+    ports[i2s_num].done_bufs = 0;
+    ports[i2s_num].play_start_us = host_time_us();
+    pthread_mutex_lock(&sink_lock);
+    if (sink_open && sink.sample_rate != rate) {
+        ESP_LOGW(TAG, "Cambio de frecuencia a %u Hz, el WAV de salida sigue marcado en %u Hz", rate, sink.sample_rate);
+    }
+    pthread_mutex_unlock(&sink_lock);
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_clk(i2s_port_t i2s_num, uint32_t rate, uint32_t bits_cfg, i2s_channel_t ch)
+{
+    if (bits_cfg != I2S_BITS_PER_SAMPLE_16BIT || ch != I2S_CHANNEL_STEREO) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return i2s_set_sample_rates(i2s_num, rate);
+}
+
+esp_err_t i2s_start(i2s_port_t i2s_num)
+{
+    if (i2s_num >= I2S_NUM_MAX || !ports[i2s_num].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ports[i2s_num].running = true;
+    ports[i2s_num].frames = 0;
+    ports[i2s_num].done_bufs = 0;
+    ports[i2s_num].play_start_us = host_time_us();
+    return ESP_OK;
+}
+
+esp_err_t i2s_stop(i2s_port_t i2s_num)
+{
+    if (i2s_num >= I2S_NUM_MAX || !ports[i2s_num].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ports[i2s_num].running = false;
+    return ESP_OK;
+}
+
+static void write_sink(uint32_t sample_rate, const void *src, size_t size)
+{
+    pthread_mutex_lock(&sink_lock);
+    if (!sink_open && sink_path != NULL) {
+        sink_open = host_wav_open_write(&sink, sink_path, sample_rate, 2);
+        if (!sink_open) {
+            ESP_LOGE(TAG, "No se pudo crear %s, la salida se descarta", sink_path);
+            sink_path = NULL;
+        }
+    }
+    if (sink_open) {
+        host_wav_write(&sink, src, size);
+    }
+    pthread_mutex_unlock(&sink_lock);
+}
+
+// Avisa como el ISR del driver los buffers DMA que terminaron de sonar desde la ultima escritura
+static void post_events(host_i2s_port_t *p, int64_t now, bool underflow)
+{
+    i2s_event_t event = {.size = p->dma_buf_frames * I2S_FRAME_BYTES};
+    if (p->events == NULL || p->dma_buf_frames == 0) {
+        return;
+    }
+    uint64_t played = (uint64_t)(now - p->play_start_us) * p->sample_rate / 1000000;
+    uint64_t bufs = (played < p->frames ? played : p->frames) / p->dma_buf_frames;
+    event.type = I2S_EVENT_TX_DONE;
+    for (; p->done_bufs < bufs; p->done_bufs++) {
+        xQueueSendFromISR(p->events, &event, NULL);
+    }
+    if (underflow) {
+        event.type = I2S_EVENT_TX_Q_OVF;
+        xQueueSendFromISR(p->events, &event, NULL);
+    }
+}
+
+esp_err_t i2s_write(i2s_port_t i2s_num, const void *src, size_t size, size_t *bytes_written, TickType_t ticks_to_wait)
+{
+    if (i2s_num >= I2S_NUM_MAX || !ports[i2s_num].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    host_i2s_port_t *p = &ports[i2s_num];
+    int64_t now = host_time_us();
+    int64_t played_us = (int64_t)(p->frames * 1000000ULL / p->sample_rate);
+    bool underflow = p->play_start_us + played_us < now;
+    post_events(p, now, underflow);
+    if (underflow) {
+        // El DMA se quedo sin datos y repitio silencio (tx_desc_auto_clear): el reloj sigue desde ahora
+        p->play_start_us = now - played_us;
+    }
+    p->frames += size / I2S_FRAME_BYTES;
+    // Bloquea hasta que lo pendiente vuelve a caber en los buffers DMA
+    if (p->running && p->frames > p->dma_frames) {
+        int64_t ready_us = p->play_start_us + (int64_t)((p->frames - p->dma_frames) * 1000000ULL / p->sample_rate);
+        host_sleep_until_us(ready_us);
+    }
+    write_sink(p->sample_rate, src, size);
+    *bytes_written = size;
+    return ESP_OK;
+}
@@ -0,0 +1,423 @@
+// GPIO y ADC del host: los niveles y lecturas salen de una traza reproducida en un hilo que
+// hace de hardware. Los flancos llaman a los handlers de ISR y el ADC continuo entrega
+// bloques al ritmo configurado, desbordando el buffer del driver si nadie lo vacia a tiempo.
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driver/gpio.h"
+#include "driver/adc.h"
+#include "esp_adc_cal.h"
+#include "esp_log.h"
+#include "sensor_board.h"
+#include "host_port.h"
+
+#define TAG "HOST_IO"
+
+#define ADC_RAW_MAX     4095
+#define ADC_FULL_MV     3300    // Recta ideal a 11 dB con Vref de 1100 mV
+#define MUX_INPUTS      8
+
+typedef struct {
+    uint32_t t_ms;
+    char kind[8];
+    int index;
+    int value;
+} trace_line_t;
+
+static pthread_mutex_t io_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// GPIO
+static uint8_t levels[GPIO_NUM_MAX];
+static gpio_int_type_t intr_types[GPIO_NUM_MAX];
+static gpio_isr_t isr_handlers[GPIO_NUM_MAX];
+static void *isr_args[GPIO_NUM_MAX];
+static bool isr_service = false;
+
+// ADC
+static uint16_t adc1_values[ADC1_CHANNEL_MAX];
+static uint16_t adc2_values[ADC2_CHANNEL_MAX];
+static uint16_t mux_values[MUX_INPUTS];
+static bool digi_initialized = false;
+static bool digi_running = false;
+static uint8_t digi_channels[ADC1_CHANNEL_MAX];
+static uint32_t digi_channel_count = 0;
+static uint32_t digi_next = 0;          // Proximo canal del patron
+static uint32_t digi_hz = 0;
+static uint32_t digi_frame_bytes = 0;
+static uint32_t digi_store_bytes = 0;
+static int64_t digi_start_us = 0;
+static uint64_t digi_emitted = 0;       // Conversiones entregadas o descartadas desde digi_start_us
+
+// Traza
+static trace_line_t *trace = NULL;
+static size_t trace_len = 0;
+static bool trace_loop = false;
+static volatile bool trace_done = true;
+
+bool host_io_done(void)
+{
+    return trace_done;
+}
+
+// ---------------------------------------------------------------------------------------------
+// GPIO
+
+static bool is_valid_pin(gpio_num_t pin)
+{
+    return pin >= 0 && pin < GPIO_NUM_MAX;
+}
+
+esp_err_t gpio_config(const gpio_config_t *cfg)
+{
+    pthread_mutex_lock(&io_lock);
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (!(cfg->pin_bit_mask & (1ULL << pin))) {
+            continue;
+        }
+        intr_types[pin] = cfg->intr_type;
+        // Sin traza una entrada queda en el nivel de su pull interno
+        if (cfg->pull_up_en == GPIO_PULLUP_ENABLE) {
+            levels[pin] = 1;
+        } else if (cfg->pull_down_en == GPIO_PULLDOWN_ENABLE) {
+            levels[pin] = 0;
+        }
+    }
+    pthread_mutex_unlock(&io_lock);
+    return ESP_OK;
+}
+
+void gpio_pad_select_gpio(uint8_t gpio_num)
+{
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    return is_valid_pin(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (!is_valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    levels[gpio_num] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    return is_valid_pin(gpio_num) ? levels[gpio_num] : 0;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    if (isr_service) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    isr_service = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    if (!isr_service) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!is_valid_pin(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&io_lock);
+    isr_handlers[gpio_num] = isr_handler;
+    isr_args[gpio_num] = args;
+    pthread_mutex_unlock(&io_lock);
+    return ESP_OK;
+}
+
+static bool edge_fires(gpio_int_type_t type, uint8_t before, uint8_t after)
+{
+    switch (type) {
+    case GPIO_INTR_POSEDGE:    return !before && after;
+    case GPIO_INTR_NEGEDGE:    return before && !after;
+    case GPIO_INTR_ANYEDGE:    return before != after;
+    case GPIO_INTR_LOW_LEVEL:  return !after;
+    case GPIO_INTR_HIGH_LEVEL: return after;
+    default:                   return false;
+    }
+}
+
+// Cambia una entrada desde la traza y corre la "ISR" en este hilo si corresponde
+static void drive_pin(int pin, int value)
+{
+    if (pin < 0 || pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    pthread_mutex_lock(&io_lock);
+    uint8_t before = levels[pin];
+    levels[pin] = value ? 1 : 0;
+    gpio_isr_t handler = edge_fires(intr_types[pin], before, levels[pin]) ? isr_handlers[pin] : NULL;
+    void *arg = isr_args[pin];
+    pthread_mutex_unlock(&io_lock);
+    if (handler != NULL) {
+        handler(arg);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// ADC
+
+static uint16_t clamp_raw(int value)
+{
+    return (uint16_t)(value < 0 ? 0 : value > ADC_RAW_MAX ? ADC_RAW_MAX : value);
+}
+
+esp_err_t adc2_config_channel_atten(adc2_channel_t channel, adc_atten_t atten)
+{
+    return channel < ADC2_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t adc2_get_raw(adc2_channel_t channel, adc_bits_width_t width_bit, int *raw_out)
+{
+    // Sin radio real ADC2 nunca queda bloqueado por Wi-Fi/BT
+    if (channel >= ADC2_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *raw_out = adc2_values[channel];
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_initialize(const adc_digi_init_config_t *init_config)
+{
+    if (digi_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (init_config->conv_num_each_intr == 0 || init_config->max_store_buf_size < init_config->conv_num_each_intr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    digi_frame_bytes = init_config->conv_num_each_intr;
+    digi_store_bytes = init_config->max_store_buf_size;
+    digi_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_controller_configure(const adc_digi_configuration_t *config)
+{
+    if (!digi_initialized || config->pattern_num == 0 || config->pattern_num > ADC1_CHANNEL_MAX ||
+        config->sample_freq_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&io_lock);
+    for (uint32_t i = 0; i < config->pattern_num; i++) {
+        digi_channels[i] = config->adc_pattern[i].channel;
+    }
+    digi_channel_count = config->pattern_num;
+    digi_hz = config->sample_freq_hz;
+    digi_next = 0;
+    pthread_mutex_unlock(&io_lock);
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_start(void)
+{
+    if (!digi_initialized || digi_channel_count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&io_lock);
+    digi_start_us = host_time_us();
+    digi_emitted = 0;
+    digi_running = true;
+    pthread_mutex_unlock(&io_lock);
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_stop(void)
+{
+    digi_running = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_deinitialize(void)
+{
+    digi_running = false;
+    digi_initialized = false;
+    digi_channel_count = 0;
+    return ESP_OK;
+}
+
+static uint16_t read_channel(uint8_t channel)
+{
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+    static const gpio_num_t mux_sel[] = SENSOR_BOARD_MUX_SEL;
+    if (channel == SENSOR_BOARD_MUX_CHANNEL) {
+        int input = 0;
+        for (int b = 0; b < sizeof(mux_sel) / sizeof(mux_sel[0]); b++) {
+            input |= levels[mux_sel[b]] << b;
+        }
+        return mux_values[input];
+    }
+#endif
+    return channel < ADC1_CHANNEL_MAX ? adc1_values[channel] : 0;
+}
+
+esp_err_t adc_digi_read_bytes(uint8_t *buf, uint32_t length_max, uint32_t *out_length, uint32_t timeout_ms)
+{
+    esp_err_t ret = ESP_OK;
+    if (!digi_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint32_t frame_conv = digi_frame_bytes / SOC_ADC_DIGI_RESULT_BYTES;
+    uint32_t store_conv = digi_store_bytes / SOC_ADC_DIGI_RESULT_BYTES;
+    if (length_max < digi_frame_bytes) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    int64_t deadline_us = host_time_us() + (int64_t)timeout_ms * 1000;
+
+    pthread_mutex_lock(&io_lock);
+    while (1) {
+        uint64_t due = (uint64_t)(host_time_us() - digi_start_us) * digi_hz / 1000000;
+        uint64_t avail = due - digi_emitted;
+        if (avail > store_conv) {
+            // El buffer del driver se lleno: se pierden los bloques viejos, como en IDF
+            digi_emitted = due - store_conv;
+            ret = ESP_ERR_INVALID_STATE;
+            avail = store_conv;
+        }
+        if (avail >= frame_conv) {
+            break;
+        }
+        int64_t ready_us = digi_start_us + (int64_t)((digi_emitted + frame_conv) * 1000000 / digi_hz);
+        if (ready_us > deadline_us) {
+            pthread_mutex_unlock(&io_lock);
+            *out_length = 0;
+            return ESP_ERR_TIMEOUT;
+        }
+        pthread_mutex_unlock(&io_lock);
+        host_sleep_until_us(ready_us);
+        pthread_mutex_lock(&io_lock);
+    }
+    for (uint32_t i = 0; i < frame_conv; i++) {
+        adc_digi_output_data_t *out = (adc_digi_output_data_t *)&buf[i * SOC_ADC_DIGI_RESULT_BYTES];
+        uint8_t channel = digi_channels[digi_next];
+        out->val = 0;
+        out->type1.channel = channel;
+        out->type1.data = read_channel(channel);
+        digi_next = (digi_next + 1) % digi_channel_count;
+    }
+    digi_emitted += frame_conv;
+    pthread_mutex_unlock(&io_lock);
+    *out_length = digi_frame_bytes;
+    return ret;
+}
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t adc_num, adc_atten_t atten, adc_bits_width_t bit_width,
+                                             uint32_t default_vref, esp_adc_cal_characteristics_t *chars)
+{
+    memset(chars, 0, sizeof(*chars));
+    chars->adc_num = adc_num;
+    chars->atten = atten;
+    chars->bit_width = bit_width;
+    chars->vref = default_vref;
+    return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t adc_reading, const esp_adc_cal_characteristics_t *chars)
+{
+    return adc_reading * ADC_FULL_MV / ADC_RAW_MAX * chars->vref / 1100;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Traza
+
+static bool parse_line(const char *line, trace_line_t *out)
+{
+    while (isspace((unsigned char)*line)) {
+        line++;
+    }
+    if (*line == '\0' || *line == '#') {
+        return false;
+    }
+    if (sscanf(line, "%u %7s %d %d", &out->t_ms, out->kind, &out->index, &out->value) != 4) {
+        ESP_LOGW(TAG, "Linea de traza invalida: %s", line);
+        return false;
+    }
+    return true;
+}
+
+static void apply_line(const trace_line_t *l)
+{
+    if (strcmp(l->kind, "gpio") == 0) {
+        drive_pin(l->index, l->value);
+        return;
+    }
+    pthread_mutex_lock(&io_lock);
+    if (strcmp(l->kind, "adc1") == 0 && l->index >= 0 && l->index < ADC1_CHANNEL_MAX) {
+        adc1_values[l->index] = clamp_raw(l->value);
+    } else if (strcmp(l->kind, "adc2") == 0 && l->index >= 0 && l->index < ADC2_CHANNEL_MAX) {
+        adc2_values[l->index] = clamp_raw(l->value);
+    } else if (strcmp(l->kind, "mux") == 0 && l->index >= 0 && l->index < MUX_INPUTS) {
+        mux_values[l->index] = clamp_raw(l->value);
+    } else {
+        ESP_LOGW(TAG, "Entrada de traza desconocida: %s %d", l->kind, l->index);
+    }
+    pthread_mutex_unlock(&io_lock);
+}
+
+static void *trace_thread(void *arg)
+{
+    int64_t offset_us = 0;
+    do {
+        for (size_t i = 0; i < trace_len; i++) {
+            host_sleep_until_us(offset_us + (int64_t)trace[i].t_ms * 1000);
+            apply_line(&trace[i]);
+        }
+        offset_us += (int64_t)trace[trace_len - 1].t_ms * 1000;
+    } while (trace_loop);
+    ESP_LOGI(TAG, "Fin de la traza de sensores");
+    trace_done = true;
+    return NULL;
+}
+
+void host_io_set_trace(const char *path, bool loop)
+{
+    char line[128];
+    size_t cap = 0;
+    FILE *f = path != NULL ? fopen(path, "r") : NULL;
+    if (f == NULL) {
+        if (path != NULL) {
+            ESP_LOGE(TAG, "No se pudo abrir la traza %s: %s", path, strerror(errno));
+        }
+        return;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        trace_line_t l;
+        if (!parse_line(line, &l)) {
+            continue;
+        }
+        if (trace_len > 0 && l.t_ms < trace[trace_len - 1].t_ms) {
+            ESP_LOGW(TAG, "Traza fuera de orden en %u ms, se ignora la linea", l.t_ms);
+            continue;
+        }
+        if (trace_len == cap) {
+            cap = cap ? cap * 2 : 64;
+            trace_line_t *grown = realloc(trace, cap * sizeof(*trace));
+            if (grown == NULL) {
+                break;
+            }
+            trace = grown;
+        }
+        trace[trace_len++] = l;
+    }
+    fclose(f);
+    if (trace_len == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "Traza %s: %u cambios en %u ms", path, (uint32_t)trace_len, trace[trace_len - 1].t_ms);
+    trace_loop = loop && trace[trace_len - 1].t_ms > 0;
+    trace_done = false;
+    pthread_t thread;
+    pthread_create(&thread, NULL, trace_thread, NULL);
+    pthread_setname_np(thread, "sensor_trace");
+    pthread_detach(thread);
+}
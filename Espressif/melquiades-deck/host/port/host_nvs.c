@@ -0,0 +1,279 @@
+// NVS del host: blobs por namespace en memoria, con un archivo opcional que se reescribe
+// completo en cada nvs_commit para conservar slots, asociaciones y calibraciones entre corridas
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include "host_port.h"
+
+#define TAG "HOST_NVS"
+
+#define NVS_NAME_MAX        16      // 15 caracteres y el terminador, como en IDF
+#define NVS_MAX_HANDLES     8
+#define NVS_FILE_MAGIC      "MQNVS1\n"
+
+typedef struct nvs_entry {
+    char ns[NVS_NAME_MAX];
+    char key[NVS_NAME_MAX];
+    size_t len;
+    uint8_t *data;
+    struct nvs_entry *next;
+} nvs_entry_t;
+
+typedef struct {
+    bool used;
+    bool writable;
+    char ns[NVS_NAME_MAX];
+} nvs_slot_t;
+
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static nvs_entry_t *entries = NULL;
+static nvs_slot_t handles[NVS_MAX_HANDLES];
+static const char *nvs_file = NULL;
+
+void host_nvs_set_file(const char *path)
+{
+    nvs_file = path;
+}
+
+static nvs_entry_t *find_entry(const char *ns, const char *key)
+{
+    for (nvs_entry_t *e = entries; e != NULL; e = e->next) {
+        if (strcmp(e->ns, ns) == 0 && (key == NULL || strcmp(e->key, key) == 0)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t put_entry(const char *ns, const char *key, const void *value, size_t len)
+{
+    nvs_entry_t *e = find_entry(ns, key);
+    uint8_t *data = malloc(len > 0 ? len : 1);
+    if (data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(data, value, len);
+    if (e == NULL) {
+        e = calloc(1, sizeof(*e));
+        if (e == NULL) {
+            free(data);
+            return ESP_ERR_NO_MEM;
+        }
+        snprintf(e->ns, sizeof(e->ns), "%s", ns);
+        snprintf(e->key, sizeof(e->key), "%s", key);
+        e->next = entries;
+        entries = e;
+    } else {
+        free(e->data);
+    }
+    e->data = data;
+    e->len = len;
+    return ESP_OK;
+}
+
+static void clear_entries(void)
+{
+    while (entries != NULL) {
+        nvs_entry_t *e = entries;
+        entries = e->next;
+        free(e->data);
+        free(e);
+    }
+}
+
+// Formato: magic y por entrada "ns\0key\0" seguido del largo (uint32) y los datos
+static void load_file(void)
+{
+    FILE *f = fopen(nvs_file, "rb");
+    char magic[sizeof(NVS_FILE_MAGIC) - 1];
+    if (f == NULL) {
+        return;
+    }
+    if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) || memcmp(magic, NVS_FILE_MAGIC, sizeof(magic)) != 0) {
+        ESP_LOGW(TAG, "%s no es un archivo de NVS, se ignora", nvs_file);
+        fclose(f);
+        return;
+    }
+    char ns[NVS_NAME_MAX];
+    char key[NVS_NAME_MAX];
+    uint32_t len;
+    int count = 0;
+    while (fread(ns, 1, sizeof(ns), f) == sizeof(ns) && fread(key, 1, sizeof(key), f) == sizeof(key) &&
+           fread(&len, sizeof(len), 1, f) == 1) {
+        uint8_t *data = malloc(len > 0 ? len : 1);
+        if (data == NULL || fread(data, 1, len, f) != len) {
+            free(data);
+            break;
+        }
+        ns[NVS_NAME_MAX - 1] = '\0';
+        key[NVS_NAME_MAX - 1] = '\0';
+        put_entry(ns, key, data, len);
+        free(data);
+        count++;
+    }
+    fclose(f);
+    ESP_LOGI(TAG, "%d entradas cargadas de %s", count, nvs_file);
+}
+
+static esp_err_t save_file(void)
+{
+    if (nvs_file == NULL) {
+        return ESP_OK;
+    }
+    FILE *f = fopen(nvs_file, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "No se pudo escribir %s", nvs_file);
+        return ESP_FAIL;
+    }
+    fwrite(NVS_FILE_MAGIC, 1, sizeof(NVS_FILE_MAGIC) - 1, f);
+    for (nvs_entry_t *e = entries; e != NULL; e = e->next) {
+        uint32_t len = (uint32_t)e->len;
+        fwrite(e->ns, 1, sizeof(e->ns), f);
+        fwrite(e->key, 1, sizeof(e->key), f);
+        fwrite(&len, sizeof(len), 1, f);
+        fwrite(e->data, 1, e->len, f);
+    }
+    fclose(f);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    clear_entries();
+    if (nvs_file != NULL) {
+        load_file();
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    clear_entries();
+    esp_err_t ret = save_file();
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    esp_err_t ret = ESP_ERR_NVS_NOT_FOUND;
+    if (strlen(name) >= NVS_NAME_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&nvs_lock);
+    // Como en IDF, abrir en solo lectura un namespace que nunca se escribio falla
+    if (open_mode == NVS_READWRITE || find_entry(name, NULL) != NULL) {
+        ret = ESP_ERR_NO_MEM;
+        for (int i = 0; i < NVS_MAX_HANDLES; i++) {
+            if (!handles[i].used) {
+                handles[i].used = true;
+                handles[i].writable = open_mode == NVS_READWRITE;
+                snprintf(handles[i].ns, sizeof(handles[i].ns), "%s", name);
+                *out_handle = (nvs_handle_t)(i + 1);
+                ret = ESP_OK;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
+
+static nvs_slot_t *get_slot(nvs_handle_t handle)
+{
+    if (handle == 0 || handle > NVS_MAX_HANDLES || !handles[handle - 1].used) {
+        return NULL;
+    }
+    return &handles[handle - 1];
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = get_slot(handle);
+    if (slot != NULL) {
+        slot->used = false;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t ret = get_slot(handle) != NULL ? save_file() : ESP_ERR_NVS_INVALID_HANDLE;
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    esp_err_t ret;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = get_slot(handle);
+    if (slot == NULL) {
+        ret = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (!slot->writable) {
+        ret = ESP_ERR_NVS_READ_ONLY;
+    } else if (strlen(key) >= NVS_NAME_MAX) {
+        ret = ESP_ERR_INVALID_ARG;
+    } else {
+        ret = put_entry(slot->ns, key, value, length);
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    esp_err_t ret = ESP_OK;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = get_slot(handle);
+    nvs_entry_t *e = slot != NULL ? find_entry(slot->ns, key) : NULL;
+    if (slot == NULL) {
+        ret = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (e == NULL) {
+        ret = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out_value == NULL) {
+        *length = e->len;
+    } else if (*length < e->len) {
+        *length = e->len;
+        ret = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out_value, e->data, e->len);
+        *length = e->len;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    esp_err_t ret = ESP_ERR_NVS_NOT_FOUND;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = get_slot(handle);
+    if (slot == NULL) {
+        ret = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (!slot->writable) {
+        ret = ESP_ERR_NVS_READ_ONLY;
+    } else {
+        for (nvs_entry_t **p = &entries; *p != NULL; p = &(*p)->next) {
+            if (strcmp((*p)->ns, slot->ns) == 0 && strcmp((*p)->key, key) == 0) {
+                nvs_entry_t *e = *p;
+                *p = e->next;
+                free(e->data);
+                free(e);
+                ret = ESP_OK;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
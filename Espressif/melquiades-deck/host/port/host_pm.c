@@ -0,0 +1,79 @@
+// Gestion de energia en el host: configuracion y locks con contador, sin efecto sobre el reloj
+#include <pthread.h>
+#include <stdlib.h>
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_log.h"
+
+#define TAG "HOST_PM"
+
+struct esp_pm_lock {
+    esp_pm_lock_type_t type;
+    const char *name;
+    int count;
+};
+
+static pthread_mutex_t pm_lock = PTHREAD_MUTEX_INITIALIZER;
+
+esp_err_t esp_pm_configure(const void *config)
+{
+    const esp_pm_config_esp32_t *cfg = config;
+    if (cfg == NULL || cfg->min_freq_mhz > cfg->max_freq_mhz) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep %s", cfg->min_freq_mhz, cfg->max_freq_mhz,
+             cfg->light_sleep_enable ? "si" : "no");
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char *name, esp_pm_lock_handle_t *out_handle)
+{
+    if (out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_pm_lock *lock = calloc(1, sizeof(*lock));
+    if (lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    lock->type = lock_type;
+    lock->name = name;
+    *out_handle = lock;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&pm_lock);
+    handle->count++;
+    pthread_mutex_unlock(&pm_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&pm_lock);
+    if (handle->count == 0) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        handle->count--;
+    }
+    pthread_mutex_unlock(&pm_lock);
+    return ret;
+}
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,74 @@
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Puntos de configuracion de los drivers falsos del build de host. host_main.c los fija
+// antes de llamar a app_main(); el firmware no los conoce.
+
+/**
+ * @brief Microsegundos desde el arranque del proceso (base de esp_timer_get_time y los ticks)
+ */
+int64_t host_time_us(void);
+
+/**
+ * @brief Duerme hasta el instante dado en la base de host_time_us
+ */
+void host_sleep_until_us(int64_t t_us);
+
+/**
+ * @brief Registra el hilo principal como la tarea "main" para que app_main pueda usar la API de tareas
+ */
+void host_freertos_init(void);
+
+/**
+ * @brief Archivo donde se carga y se guarda la NVS, NULL para una NVS solo en memoria
+ */
+void host_nvs_set_file(const char *path);
+
+/**
+ * @brief Archivo WAV de salida del I2S, NULL para descartar las muestras
+ */
+void host_i2s_set_sink(const char *path);
+
+/**
+ * @brief Completa la cabecera del WAV de salida con el largo final
+ */
+void host_i2s_close(void);
+
+/**
+ * @brief WAV PCM de 16 bits estereo que hace de telefono A2DP, NULL sin fuente
+ *
+ * @param loop Vuelve al principio al terminar el archivo
+ */
+void host_a2dp_set_source(const char *path, bool loop);
+
+/**
+ * @brief Enlace simbolico hacia el pty del servidor SPP, NULL para solo anunciarlo en el log
+ */
+void host_spp_set_link(const char *path);
+
+/**
+ * @brief Traza de sensores a reproducir, NULL para dejar entradas fijas
+ *
+ * Una linea por cambio, con el tiempo en ms desde el arranque:
+ *   <ms> gpio <pin> <nivel>
+ *   <ms> adc1 <canal> <lectura 0-4095>
+ *   <ms> adc2 <canal> <lectura 0-4095>
+ *   <ms> mux <entrada> <lectura 0-4095>
+ * Las lineas vacias y las que empiezan con '#' se ignoran.
+ */
+void host_io_set_trace(const char *path, bool loop);
+
+/**
+ * @brief Indica si la fuente A2DP termino su archivo (o si no hay fuente)
+ */
+bool host_a2dp_done(void);
+
+/**
+ * @brief Indica si la traza de sensores llego al final (o si no hay traza)
+ */
+bool host_io_done(void);
+
+#endif // HOST_PORT_H
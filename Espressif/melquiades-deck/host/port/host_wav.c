@@ -0,0 +1,129 @@
+#include "host_wav.h"
+#include <string.h>
+
+#define WAV_HEADER_BYTES    44
+
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+bool host_wav_open_read(host_wav_t *wav, const char *path)
+{
+    uint8_t hdr[12];
+    bool have_fmt = false;
+    memset(wav, 0, sizeof(*wav));
+    wav->file = fopen(path, "rb");
+    if (wav->file == NULL) {
+        return false;
+    }
+    if (fread(hdr, 1, 12, wav->file) != 12 || memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+        goto fail;
+    }
+    // Recorre los chunks hasta "data"; "fmt " tiene que venir antes
+    uint8_t chunk[8];
+    while (fread(chunk, 1, 8, wav->file) == 8) {
+        uint32_t size = read_le32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, wav->file) != 16) {
+                goto fail;
+            }
+            if (read_le16(fmt) != 1 || read_le16(fmt + 14) != 16) {
+                goto fail;
+            }
+            wav->channels = read_le16(fmt + 2);
+            wav->sample_rate = read_le32(fmt + 4);
+            have_fmt = true;
+            fseek(wav->file, (long)((size - 16) + (size & 1)), SEEK_CUR);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) {
+                goto fail;
+            }
+            wav->data_offset = (uint32_t)ftell(wav->file);
+            wav->data_bytes = size;
+            return true;
+        } else {
+            fseek(wav->file, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+fail:
+    fclose(wav->file);
+    wav->file = NULL;
+    return false;
+}
+
+static void write_header(host_wav_t *wav)
+{
+    uint8_t hdr[WAV_HEADER_BYTES];
+    uint16_t block = (uint16_t)(wav->channels * 2);
+    memcpy(hdr, "RIFF", 4);
+    put_le32(hdr + 4, 36 + wav->data_bytes);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    put_le32(hdr + 16, 16);
+    put_le16(hdr + 20, 1);
+    put_le16(hdr + 22, wav->channels);
+    put_le32(hdr + 24, wav->sample_rate);
+    put_le32(hdr + 28, wav->sample_rate * block);
+    put_le16(hdr + 32, block);
+    put_le16(hdr + 34, 16);
+    memcpy(hdr + 36, "data", 4);
+    put_le32(hdr + 40, wav->data_bytes);
+    fseek(wav->file, 0, SEEK_SET);
+    fwrite(hdr, 1, sizeof(hdr), wav->file);
+}
+
+bool host_wav_open_write(host_wav_t *wav, const char *path, uint32_t sample_rate, uint16_t channels)
+{
+    memset(wav, 0, sizeof(*wav));
+    wav->file = fopen(path, "wb");
+    if (wav->file == NULL) {
+        return false;
+    }
+    wav->sample_rate = sample_rate;
+    wav->channels = channels;
+    wav->data_offset = WAV_HEADER_BYTES;
+    write_header(wav);
+    return true;
+}
+
+void host_wav_write(host_wav_t *wav, const void *data, size_t len)
+{
+    wav->data_bytes += (uint32_t)fwrite(data, 1, len, wav->file);
+}
+
+void host_wav_rewind(host_wav_t *wav)
+{
+    fseek(wav->file, (long)wav->data_offset, SEEK_SET);
+}
+
+void host_wav_close(host_wav_t *wav, bool writing)
+{
+    if (wav->file == NULL) {
+        return;
+    }
+    if (writing) {
+        write_header(wav);
+    }
+    fclose(wav->file);
+    wav->file = NULL;
+}
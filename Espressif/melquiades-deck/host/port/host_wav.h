@@ -0,0 +1,43 @@
+#ifndef HOST_WAV_H
+#define HOST_WAV_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Lectura y escritura minima de WAV PCM de 16 bits, lo unico que maneja el camino de audio
+
+typedef struct {
+    FILE *file;
+    uint32_t sample_rate;
+    uint16_t channels;
+    uint32_t data_offset;   // Inicio de las muestras en el archivo
+    uint32_t data_bytes;    // Bytes de muestras (lectura) o escritos hasta ahora (escritura)
+} host_wav_t;
+
+/**
+ * @brief Abre un WAV PCM de 16 bits y deja el archivo al inicio de las muestras
+ */
+bool host_wav_open_read(host_wav_t *wav, const char *path);
+
+/**
+ * @brief Crea un WAV de 16 bits con la cabecera a completar al cerrar
+ */
+bool host_wav_open_write(host_wav_t *wav, const char *path, uint32_t sample_rate, uint16_t channels);
+
+/**
+ * @brief Agrega muestras al WAV de salida
+ */
+void host_wav_write(host_wav_t *wav, const void *data, size_t len);
+
+/**
+ * @brief Vuelve al inicio de las muestras de un WAV de entrada
+ */
+void host_wav_rewind(host_wav_t *wav);
+
+/**
+ * @brief Cierra el archivo; en escritura completa los largos de la cabecera
+ */
+void host_wav_close(host_wav_t *wav, bool writing);
+
+#endif // HOST_WAV_H
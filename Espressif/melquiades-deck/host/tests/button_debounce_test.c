@@ -0,0 +1,166 @@
+// Antirrebote de botones con trazas sinteticas de flancos: rebotes de contacto, pulsos
+// espurios, rafagas largas y la cola de flancos de la ISR. Se evalua el boton en cada
+// vencimiento, como hace la tarea de botones en el equipo.
+#include <stdint.h>
+#include <string.h>
+#include "button_debounce.h"
+#include "test_check.h"
+
+#define MAX_EVENTS 16
+
+// Flanco crudo con el nivel que queda en el pin
+typedef struct {
+    int64_t t_us;
+    bool level;
+} edge_step_t;
+
+typedef struct {
+    btn_event_t events[MAX_EVENTS];
+    int count;
+} event_log_t;
+
+static void poll_until(btn_debounce_t *d, bool level, int64_t until_us, event_log_t *log)
+{
+    int64_t deadline = btn_debounce_deadline(d);
+    while (deadline >= 0 && deadline <= until_us) {
+        btn_event_t ev;
+        if (btn_debounce_poll(d, level, deadline, &ev) && log->count < MAX_EVENTS) {
+            log->events[log->count++] = ev;
+        }
+        deadline = btn_debounce_deadline(d);
+    }
+}
+
+// Corre la traza desde el nivel inicial y evalua hasta que el boton queda estable
+static void run_trace(btn_debounce_t *d, bool initial, const edge_step_t *steps, int count, event_log_t *log)
+{
+    bool level = initial;
+    memset(log, 0, sizeof(*log));
+    btn_debounce_init(d, initial);
+    for (int i = 0; i < count; i++) {
+        poll_until(d, level, steps[i].t_us, log);
+        level = steps[i].level;
+        btn_debounce_edge(d, steps[i].t_us);
+    }
+    poll_until(d, level, INT64_MAX, log);
+}
+
+static void check_event(const event_log_t *log, int i, btn_event_type_t type, int64_t t_us)
+{
+    CHECK(i < log->count);
+    if (i < log->count) {
+        CHECK_INT(log->events[i].type, type);
+        CHECK_INT(log->events[i].t_us, t_us);
+    }
+}
+
+static void test_contact_bounce(void)
+{
+    // Pulsacion y soltada con rebotes de menos de BTN_DEBOUNCE_US entre flancos
+    static const edge_step_t steps[] = {
+        {0, true}, {300, false}, {700, true}, {1200, false}, {1900, true},
+        {100000, false}, {100400, true}, {101000, false},
+    };
+    btn_debounce_t d;
+    event_log_t log;
+    run_trace(&d, false, steps, sizeof(steps) / sizeof(steps[0]), &log);
+    CHECK_INT(log.count, 2);
+    // El evento lleva el primer flanco de la rafaga, no el instante en que se confirmo
+    check_event(&log, 0, BTN_EVENT_PRESS, 0);
+    check_event(&log, 1, BTN_EVENT_RELEASE, 100000);
+    CHECK_INT(d.edges, 8);
+    CHECK_INT(d.bounces, 6);
+    CHECK(!d.pressed);
+    CHECK_INT(btn_debounce_deadline(&d), -1);
+}
+
+static void test_glitch(void)
+{
+    // Pulso espurio: el pin vuelve al nivel original antes de estabilizarse
+    static const edge_step_t steps[] = {{0, true}, {2000, false}};
+    btn_debounce_t d;
+    event_log_t log;
+    run_trace(&d, false, steps, 2, &log);
+    CHECK_INT(log.count, 0);
+    CHECK_INT(d.bounces, 2);
+    CHECK(!d.pressed);
+
+    // Pulso espurio con un rebote mas, terminando en el mismo nivel de partida
+    static const edge_step_t odd[] = {{0, false}, {100, true}, {4000, false}, {4100, true}};
+    run_trace(&d, true, odd, 4, &log);
+    CHECK_INT(log.count, 0);
+    CHECK(d.pressed);
+}
+
+static void test_bounce_gap(void)
+{
+    // Un rebote que llega justo despues de la ventana se toma como soltada
+    static const edge_step_t steps[] = {{0, true}, {BTN_DEBOUNCE_US + 1, false}};
+    btn_debounce_t d;
+    event_log_t log;
+    run_trace(&d, false, steps, 2, &log);
+    CHECK_INT(log.count, 2);
+    check_event(&log, 0, BTN_EVENT_PRESS, 0);
+    check_event(&log, 1, BTN_EVENT_RELEASE, BTN_DEBOUNCE_US + 1);
+
+    // Justo en el limite todavia es rebote: la rafaga se extiende y termina en reposo
+    static const edge_step_t edge[] = {{0, true}, {BTN_DEBOUNCE_US - 1, false}};
+    run_trace(&d, false, edge, 2, &log);
+    CHECK_INT(log.count, 0);
+}
+
+static void test_poll_timing(void)
+{
+    btn_debounce_t d;
+    btn_event_t ev;
+    btn_debounce_init(&d, false);
+    CHECK_INT(btn_debounce_edge(&d, 1000), 1000 + BTN_DEBOUNCE_US);
+    // Antes del vencimiento no hay evento aunque el nivel ya cambio
+    CHECK(!btn_debounce_poll(&d, true, 1000 + BTN_DEBOUNCE_US - 1, &ev));
+    CHECK(btn_debounce_poll(&d, true, 1000 + BTN_DEBOUNCE_US, &ev));
+    CHECK_INT(ev.type, BTN_EVENT_PRESS);
+    CHECK_INT(ev.t_us, 1000);
+    // Sin flancos nuevos no se vuelve a reportar
+    CHECK(!btn_debounce_poll(&d, true, 1000000, &ev));
+}
+
+static void test_edge_queue(void)
+{
+    static btn_edge_queue_t q;
+    btn_edge_t e;
+    memset(&q, 0, sizeof(q));
+    for (int i = 0; i < BTN_EDGE_QUEUE_LEN; i++) {
+        CHECK(btn_edge_queue_push(&q, (uint8_t)(i % 4), i));
+    }
+    CHECK(!btn_edge_queue_push(&q, 0, 999));
+    CHECK_INT(q.overflows, 1);
+    for (int i = 0; i < BTN_EDGE_QUEUE_LEN; i++) {
+        CHECK(btn_edge_queue_pop(&q, &e));
+        CHECK_INT(e.button, i % 4);
+        CHECK_INT(e.t_us, i);
+    }
+    CHECK(!btn_edge_queue_pop(&q, &e));
+
+    // Los indices libres cruzan el desborde de 32 bits sin perder ni duplicar flancos
+    memset(&q, 0, sizeof(q));
+    q.head = q.tail = UINT32_MAX - 2;
+    for (int i = 0; i < 6; i++) {
+        CHECK(btn_edge_queue_push(&q, 1, 100 + i));
+    }
+    for (int i = 0; i < 6; i++) {
+        CHECK(btn_edge_queue_pop(&q, &e));
+        CHECK_INT(e.t_us, 100 + i);
+    }
+    CHECK(!btn_edge_queue_pop(&q, &e));
+    CHECK_INT(q.overflows, 0);
+}
+
+int main(void)
+{
+    test_contact_bounce();
+    test_glitch();
+    test_bounce_gap();
+    test_poll_timing();
+    test_edge_queue();
+    return test_result("button_debounce");
+}
@@ -0,0 +1,236 @@
+// Reconocedor de gestos con secuencias sinteticas de eventos limpios: tap, doble toque,
+// long-press con repeticion, acordes y ventanas vencidas. Se llama a btn_gesture_tick en
+// cada vencimiento, como hace la tarea de botones en el equipo.
+#include <stdint.h>
+#include <string.h>
+#include "button_gestures.h"
+#include "test_check.h"
+
+#define MS(x)       ((int64_t)(x) * 1000)
+#define MAX_LOG     32
+
+enum {
+    ACT_TAP_1 = 1,
+    ACT_DOUBLE_1,
+    ACT_LONG_1,
+    ACT_REPEAT_1,
+    ACT_TAP_2,
+    ACT_CHORD_13,
+    ACT_TAP_3,
+};
+
+// Boton 1 con todos los gestos, boton 2 solo tap (sin espera de doble toque), 1+3 en acorde
+static const btn_gesture_rule_t rules[] = {
+    {0x01, BTN_GESTURE_TAP, ACT_TAP_1},
+    {0x01, BTN_GESTURE_DOUBLE_TAP, ACT_DOUBLE_1},
+    {0x01, BTN_GESTURE_LONG_PRESS, ACT_LONG_1},
+    {0x01, BTN_GESTURE_HOLD_REPEAT, ACT_REPEAT_1},
+    {0x02, BTN_GESTURE_TAP, ACT_TAP_2},
+    {0x05, BTN_GESTURE_CHORD, ACT_CHORD_13},
+    {0x04, BTN_GESTURE_TAP, ACT_TAP_3},
+};
+
+typedef struct {
+    int64_t t_ms;
+    uint8_t button;
+    bool press;
+} press_step_t;
+
+typedef struct {
+    btn_gesture_t gestures[MAX_LOG];
+    int64_t emitted_us[MAX_LOG];    // Cuando salio el gesto, no el instante que lleva
+    int count;
+} gesture_log_t;
+
+static void record(gesture_log_t *log, const btn_gesture_t *out, int n, int64_t now_us)
+{
+    CHECK(n >= 0 && n <= BTN_GESTURE_MAX_OUT);
+    for (int i = 0; i < n && log->count < MAX_LOG; i++) {
+        log->gestures[log->count] = out[i];
+        log->emitted_us[log->count] = now_us;
+        log->count++;
+    }
+}
+
+static void tick_until(btn_gesture_engine_t *eng, int64_t until_us, gesture_log_t *log)
+{
+    btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+    int64_t deadline = btn_gesture_deadline(eng);
+    while (deadline >= 0 && deadline <= until_us) {
+        record(log, out, btn_gesture_tick(eng, deadline, out), deadline);
+        deadline = btn_gesture_deadline(eng);
+    }
+}
+
+static void run(btn_gesture_engine_t *eng, const press_step_t *steps, int count, int64_t end_ms, gesture_log_t *log)
+{
+    btn_gesture_timing_t timing;
+    btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+    btn_gesture_default_timing(&timing);
+    btn_gesture_init(eng, &timing, rules, sizeof(rules) / sizeof(rules[0]));
+    memset(log, 0, sizeof(*log));
+    for (int i = 0; i < count; i++) {
+        btn_event_t ev = {
+            .button = steps[i].button,
+            .type = steps[i].press ? BTN_EVENT_PRESS : BTN_EVENT_RELEASE,
+            .t_us = MS(steps[i].t_ms),
+        };
+        tick_until(eng, ev.t_us, log);
+        record(log, out, btn_gesture_feed(eng, &ev, out), ev.t_us);
+    }
+    tick_until(eng, MS(end_ms), log);
+}
+
+static void check_gesture(const gesture_log_t *log, int i, btn_gesture_type_t type, uint8_t action,
+                          int64_t t_us, int64_t emitted_us)
+{
+    CHECK(i < log->count);
+    if (i < log->count) {
+        CHECK_INT(log->gestures[i].type, type);
+        CHECK_INT(log->gestures[i].action, action);
+        CHECK_INT(log->gestures[i].t_us, t_us);
+        CHECK_INT(log->emitted_us[i], emitted_us);
+    }
+}
+
+static void test_tap(void)
+{
+    btn_gesture_engine_t eng;
+    gesture_log_t log;
+    // Con doble toque en la tabla el tap sale al cerrarse la ventana, con el instante de la presion
+    static const press_step_t one[] = {{0, 1, true}, {80, 1, false}};
+    run(&eng, one, 2, 2000, &log);
+    CHECK_INT(log.count, 1);
+    check_gesture(&log, 0, BTN_GESTURE_TAP, ACT_TAP_1, 0, MS(80 + 250));
+    CHECK_INT(btn_gesture_deadline(&eng), -1);
+
+    // Sin doble toque en la tabla sale al soltar
+    static const press_step_t two[] = {{100, 2, true}, {150, 2, false}};
+    run(&eng, two, 2, 2000, &log);
+    CHECK_INT(log.count, 1);
+    check_gesture(&log, 0, BTN_GESTURE_TAP, ACT_TAP_2, MS(100), MS(150));
+}
+
+static void test_double_tap(void)
+{
+    btn_gesture_engine_t eng;
+    gesture_log_t log;
+    static const press_step_t quick[] = {{0, 1, true}, {70, 1, false}, {180, 1, true}, {250, 1, false}};
+    run(&eng, quick, 4, 2000, &log);
+    CHECK_INT(log.count, 1);
+    check_gesture(&log, 0, BTN_GESTURE_DOUBLE_TAP, ACT_DOUBLE_1, MS(180), MS(180));
+
+    // El segundo toque despues de la ventana da dos taps
+    static const press_step_t slow[] = {{0, 1, true}, {70, 1, false}, {400, 1, true}, {450, 1, false}};
+    run(&eng, slow, 4, 2000, &log);
+    CHECK_INT(log.count, 2);
+    check_gesture(&log, 0, BTN_GESTURE_TAP, ACT_TAP_1, 0, MS(320));
+    check_gesture(&log, 1, BTN_GESTURE_TAP, ACT_TAP_1, MS(400), MS(700));
+}
+
+static void test_missed_window(void)
+{
+    // Sin tick en el medio, la presion que llega tarde cierra primero la ventana vencida
+    btn_gesture_timing_t timing;
+    btn_gesture_engine_t eng;
+    btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+    btn_gesture_default_timing(&timing);
+    btn_gesture_init(&eng, &timing, rules, sizeof(rules) / sizeof(rules[0]));
+    btn_event_t ev = {.button = 1, .type = BTN_EVENT_PRESS, .t_us = 0};
+    CHECK_INT(btn_gesture_feed(&eng, &ev, out), 0);
+    ev.type = BTN_EVENT_RELEASE;
+    ev.t_us = MS(60);
+    CHECK_INT(btn_gesture_feed(&eng, &ev, out), 0);
+    ev.type = BTN_EVENT_PRESS;
+    ev.t_us = MS(500);
+    CHECK_INT(btn_gesture_feed(&eng, &ev, out), 1);
+    CHECK_INT(out[0].type, BTN_GESTURE_TAP);
+    CHECK_INT(out[0].t_us, 0);
+}
+
+static void test_long_press(void)
+{
+    btn_gesture_engine_t eng;
+    gesture_log_t log;
+    static const press_step_t hold[] = {{0, 1, true}, {1000, 1, false}};
+    run(&eng, hold, 2, 3000, &log);
+    CHECK_INT(log.count, 3);
+    check_gesture(&log, 0, BTN_GESTURE_LONG_PRESS, ACT_LONG_1, MS(600), MS(600));
+    check_gesture(&log, 1, BTN_GESTURE_HOLD_REPEAT, ACT_REPEAT_1, MS(750), MS(750));
+    check_gesture(&log, 2, BTN_GESTURE_HOLD_REPEAT, ACT_REPEAT_1, MS(900), MS(900));
+    CHECK_INT(btn_gesture_deadline(&eng), -1);
+
+    // Un boton sin gestos largos no agenda timeouts: una presion larga no genera nada
+    static const press_step_t two[] = {{0, 2, true}};
+    run(&eng, two, 1, 3000, &log);
+    CHECK_INT(btn_gesture_deadline(&eng), -1);
+    CHECK_INT(log.count, 0);
+}
+
+static void test_late_tick(void)
+{
+    // Con la tarea atrasada sale una sola repeticion y la siguiente se agenda desde ahora
+    btn_gesture_timing_t timing;
+    btn_gesture_engine_t eng;
+    btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+    btn_gesture_default_timing(&timing);
+    btn_gesture_init(&eng, &timing, rules, sizeof(rules) / sizeof(rules[0]));
+    btn_event_t ev = {.button = 1, .type = BTN_EVENT_PRESS, .t_us = 0};
+    btn_gesture_feed(&eng, &ev, out);
+    CHECK_INT(btn_gesture_tick(&eng, MS(600), out), 1);
+    CHECK_INT(out[0].type, BTN_GESTURE_LONG_PRESS);
+    CHECK_INT(btn_gesture_tick(&eng, MS(2000), out), 1);
+    CHECK_INT(out[0].type, BTN_GESTURE_HOLD_REPEAT);
+    CHECK_INT(btn_gesture_deadline(&eng), MS(2000 + 150));
+}
+
+static void test_chord(void)
+{
+    btn_gesture_engine_t eng;
+    gesture_log_t log;
+    static const press_step_t chord[] = {{0, 1, true}, {40, 3, true}, {1500, 3, false}, {1520, 1, false}};
+    run(&eng, chord, 4, 3000, &log);
+    // Los botones del acorde quedan consumidos: ni long-press ni tap al soltar
+    CHECK_INT(log.count, 1);
+    check_gesture(&log, 0, BTN_GESTURE_CHORD, ACT_CHORD_13, MS(40), MS(40));
+    if (log.count > 0) {
+        CHECK_INT(log.gestures[0].button, 1);
+        CHECK_INT(log.gestures[0].button2, 3);
+    }
+
+    // Separadas mas que la ventana de acorde, cada presion es su propio gesto
+    static const press_step_t apart[] = {{0, 1, true}, {100, 3, true}, {150, 3, false}, {200, 1, false}};
+    run(&eng, apart, 4, 3000, &log);
+    CHECK_INT(log.count, 2);
+    check_gesture(&log, 0, BTN_GESTURE_TAP, ACT_TAP_3, MS(100), MS(150));
+    check_gesture(&log, 1, BTN_GESTURE_TAP, ACT_TAP_1, 0, MS(450));
+}
+
+static void test_unmapped(void)
+{
+    btn_gesture_engine_t eng;
+    gesture_log_t log;
+    btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+    // Boton 4 sin reglas y botones fuera de rango: no sale nada
+    static const press_step_t none[] = {{0, 4, true}, {50, 4, false}, {100, 4, true}, {900, 4, false}};
+    run(&eng, none, 4, 3000, &log);
+    CHECK_INT(log.count, 0);
+    btn_event_t ev = {.button = 0, .type = BTN_EVENT_PRESS, .t_us = 0};
+    CHECK_INT(btn_gesture_feed(&eng, &ev, out), 0);
+    ev.button = BTN_GESTURE_MAX_BUTTONS + 1;
+    CHECK_INT(btn_gesture_feed(&eng, &ev, out), 0);
+    CHECK(strcmp(btn_gesture_name(BTN_GESTURE_DOUBLE_TAP), "double_tap") == 0);
+    CHECK(strcmp(btn_gesture_name(BTN_GESTURE_TYPE_COUNT), "?") == 0);
+}
+
+int main(void)
+{
+    test_tap();
+    test_double_tap();
+    test_missed_window();
+    test_long_press();
+    test_late_tick();
+    test_chord();
+    test_unmapped();
+    return test_result("button_gestures");
+}
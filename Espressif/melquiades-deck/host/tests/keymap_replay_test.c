@@ -0,0 +1,268 @@
+// Reproduce trazas de sensores de host/traces por la misma cadena que la tarea de botones:
+// antirrebote, reconocedor de gestos con la tabla del equipo y keymap. Con un reloj simulado
+// se verifica cada reporte serializado, el instante en que sale y su latencia.
+//
+// Latencia: desde el primer flanco de la rafaga que decide el gesto (o el vencimiento del
+// timeout que lo decide) hasta el reporte. Las ventanas de gestos son parte del diseno y no
+// cuentan; lo que suma el equipo es el antirrebote.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "buttons.h"
+#include "keymap.h"
+#include "test_check.h"
+
+#define MS(x)               ((int64_t)(x) * 1000)
+#define MAX_EDGES           256
+#define MAX_OUTPUTS         64
+#define MAX_BURST_US        MS(5)   // Rebote mas largo de las trazas
+#define REPLAY_TAIL_US      MS(10000)
+
+static const gpio_num_t pins[BTN_DEFAULT_COUNT] = {BTN1, BTN2, BTN3, BTN4, BTN5, BTN6};
+
+typedef struct {
+    int64_t t_us;
+    uint8_t button;     // 0..BTN_DEFAULT_COUNT-1
+    bool level;
+} replay_edge_t;
+
+// Un gesto resuelto y sus reportes serializados
+typedef struct {
+    int64_t emit_us;
+    int64_t latency_us;
+    uint8_t action;
+    int count;
+    uint8_t bytes[KEYMAP_MAX_REPORTS * KEYMAP_REPORT_BYTES];
+} replay_output_t;
+
+typedef struct {
+    const keymap_t *map;
+    btn_debounce_t debouncers[BTN_DEFAULT_COUNT];
+    bool levels[BTN_DEFAULT_COUNT];
+    btn_gesture_engine_t gestures;
+    uint8_t seq;
+    replay_output_t outputs[MAX_OUTPUTS];
+    int count;
+} replay_t;
+
+// Reporte esperado sin el byte de secuencia: [id][dato][dato]
+typedef struct {
+    int64_t emit_ms;
+    uint8_t action;
+    int count;
+    uint8_t reports[KEYMAP_MAX_REPORTS][KEYMAP_REPORT_BYTES - 1];
+} replay_expect_t;
+
+static replay_edge_t edges[MAX_EDGES];
+
+// Mismo formato que el port de host: "<ms> gpio <pin> <nivel>", el resto de las lineas no son botones
+static int load_trace(const char *dir, const char *name)
+{
+    char path[512];
+    char line[128];
+    int count = 0;
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "r");
+    CHECK(f != NULL);
+    if (f == NULL) {
+        fprintf(stderr, "No se pudo abrir %s\n", path);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), f) != NULL && count < MAX_EDGES) {
+        unsigned t_ms;
+        char kind[8];
+        int pin, value;
+        if (line[0] == '#' || sscanf(line, "%u %7s %d %d", &t_ms, kind, &pin, &value) != 4 ||
+            strcmp(kind, "gpio") != 0) {
+            continue;
+        }
+        for (int b = 0; b < BTN_DEFAULT_COUNT; b++) {
+            if (pins[b] == pin) {
+                edges[count].t_us = MS(t_ms);
+                edges[count].button = (uint8_t)b;
+                edges[count].level = value != 0;
+                count++;
+            }
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+static void emit(replay_t *r, const btn_gesture_t *out, int n, int64_t now_us, int64_t decided_us)
+{
+    keymap_report_t reports[KEYMAP_MAX_REPORTS];
+    for (int i = 0; i < n && r->count < MAX_OUTPUTS; i++) {
+        replay_output_t *o = &r->outputs[r->count++];
+        o->emit_us = now_us;
+        o->latency_us = now_us - decided_us;
+        o->action = out[i].action;
+        o->count = keymap_process(r->map, &out[i], reports);
+        for (int k = 0; k < o->count; k++) {
+            keymap_report_encode(&reports[k], r->seq++, &o->bytes[k * KEYMAP_REPORT_BYTES]);
+        }
+    }
+}
+
+// Lo que hace la tarea de botones al despertar: evaluar cada antirrebote y los timeouts de gestos
+static void service(replay_t *r, int64_t now_us)
+{
+    btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+    for (int b = 0; b < BTN_DEFAULT_COUNT; b++) {
+        btn_event_t ev;
+        if (btn_debounce_poll(&r->debouncers[b], r->levels[b], now_us, &ev)) {
+            ev.button = (uint8_t)(b + 1);
+            emit(r, out, btn_gesture_feed(&r->gestures, &ev, out), now_us, ev.t_us);
+        }
+    }
+    int64_t deadline = btn_gesture_deadline(&r->gestures);
+    if (deadline >= 0 && deadline <= now_us) {
+        emit(r, out, btn_gesture_tick(&r->gestures, now_us, out), now_us, deadline);
+    }
+}
+
+static int64_t next_deadline(const replay_t *r)
+{
+    int64_t next = btn_gesture_deadline(&r->gestures);
+    for (int b = 0; b < BTN_DEFAULT_COUNT; b++) {
+        int64_t d = btn_debounce_deadline(&r->debouncers[b]);
+        if (d >= 0 && (next < 0 || d < next)) {
+            next = d;
+        }
+    }
+    return next;
+}
+
+static void replay(replay_t *r, const keymap_t *map, int edge_count)
+{
+    btn_gesture_timing_t timing;
+    uint8_t rule_count;
+    const btn_gesture_rule_t *rules = pulsadores_gesture_rules(&rule_count);
+    memset(r, 0, sizeof(*r));
+    r->map = map;
+    for (int b = 0; b < BTN_DEFAULT_COUNT; b++) {
+        btn_debounce_init(&r->debouncers[b], false);
+    }
+    btn_gesture_default_timing(&timing);
+    btn_gesture_init(&r->gestures, &timing, rules, rule_count);
+
+    int64_t end_us = edge_count > 0 ? edges[edge_count - 1].t_us + REPLAY_TAIL_US : 0;
+    int i = 0;
+    while (1) {
+        int64_t deadline = next_deadline(r);
+        bool have_edge = i < edge_count;
+        if (deadline >= 0 && deadline <= end_us && (!have_edge || deadline <= edges[i].t_us)) {
+            service(r, deadline);
+        } else if (have_edge) {
+            // La ISR solo sella el flanco; el antirrebote decide al vencer su ventana
+            r->levels[edges[i].button] = edges[i].level;
+            btn_debounce_edge(&r->debouncers[edges[i].button], edges[i].t_us);
+            i++;
+        } else {
+            break;
+        }
+    }
+}
+
+static void check_outputs(const char *trace, const replay_t *r, const replay_expect_t *expect, int expect_count)
+{
+    int matched = 0;
+    int64_t worst_us = 0;
+    uint8_t seq = 0;
+    for (int i = 0; i < r->count; i++) {
+        const replay_output_t *o = &r->outputs[i];
+        CHECK(o->latency_us >= 0 && o->latency_us <= BTN_DEBOUNCE_US + MAX_BURST_US);
+        if (o->latency_us > worst_us) {
+            worst_us = o->latency_us;
+        }
+        if (o->count == 0) {
+            // Gesto sin atajo asignado: no sale nada hacia el escritorio
+            continue;
+        }
+        CHECK(matched < expect_count);
+        if (matched >= expect_count) {
+            fprintf(stderr, "%s: reporte de mas, accion %u en %lld ms\n", trace, o->action,
+                    (long long)(o->emit_us / 1000));
+            continue;
+        }
+        const replay_expect_t *e = &expect[matched++];
+        CHECK_INT(o->action, e->action);
+        CHECK_INT(o->emit_us, MS(e->emit_ms));
+        CHECK_INT(o->count, e->count);
+        for (int k = 0; k < o->count && k < e->count; k++) {
+            const uint8_t *bytes = &o->bytes[k * KEYMAP_REPORT_BYTES];
+            // La secuencia cuenta reportes, no gestos: el escritorio detecta perdidas con ella
+            CHECK_INT(bytes[0], seq++);
+            CHECK(memcmp(&bytes[1], e->reports[k], KEYMAP_REPORT_BYTES - 1) == 0);
+        }
+    }
+    CHECK_INT(matched, expect_count);
+    printf("%s: %d gestos, %d con reportes, latencia maxima %lld.%03lld ms\n", trace, r->count, matched,
+           (long long)(worst_us / 1000), (long long)(worst_us % 1000));
+}
+
+static void test_example_trace(const char *dir)
+{
+    // Tabla por defecto: solo los taps tienen atajo, el largo y la repeticion del boton 4 no
+    static const replay_expect_t expect[] = {
+        {1085, 1, 2, {{KEYMAP_REPORT_CONSUMER, 0xCD, 0x00}, {KEYMAP_REPORT_CONSUMER, 0x00, 0x00}}},
+        // El boton 2 no tiene doble tap en la tabla: dos taps sin esperar ventana
+        {2075, 2, 2, {{KEYMAP_REPORT_CONSUMER, 0xB6, 0x00}, {KEYMAP_REPORT_CONSUMER, 0x00, 0x00}}},
+        {2255, 2, 2, {{KEYMAP_REPORT_CONSUMER, 0xB6, 0x00}, {KEYMAP_REPORT_CONSUMER, 0x00, 0x00}}},
+    };
+    keymap_t map;
+    static replay_t r;
+    keymap_default(&map);
+    int n = load_trace(dir, "example.trace");
+    CHECK_INT(n, 8);
+    replay(&r, &map, n);
+    check_outputs("example.trace", &r, expect, sizeof(expect) / sizeof(expect[0]));
+    // Pulsacion larga (accion 10) y dos repeticiones (accion 16) del boton 4, sin atajo
+    int long_press = 0;
+    for (int i = 0; i < r.count; i++) {
+        long_press += r.outputs[i].action == 10 || r.outputs[i].action == 16;
+    }
+    CHECK_INT(long_press, 3);
+}
+
+static void test_keys_trace(const char *dir)
+{
+    static const replay_expect_t expect[] = {
+        // Tap del boton 1: sale al confirmar la suelta (ultimo rebote 1093 ms + 5 ms)
+        {1098, 1, 2, {{KEYMAP_REPORT_CONSUMER, 0xCD, 0x00}, {KEYMAP_REPORT_CONSUMER, 0x00, 0x00}}},
+        // Doble tap del boton 5 -> Enter
+        {2157, 13, 2, {{KEYMAP_REPORT_KEYBOARD, 0x00, 0x28}, {KEYMAP_REPORT_KEYBOARD, 0x00, 0x00}}},
+        // Pulsacion larga del boton 1 -> ctrl+c, justo al cumplirse 600 ms de la primera presion
+        {3600, 7, 2, {{KEYMAP_REPORT_KEYBOARD, KEYMAP_MOD_CTRL, 0x06}, {KEYMAP_REPORT_KEYBOARD, 0x00, 0x00}}},
+        // Acorde 1+2 -> macro ctrl+z, ctrl+y; las sueltas no agregan nada
+        {4035, 17, 4, {{KEYMAP_REPORT_KEYBOARD, KEYMAP_MOD_CTRL, 0x1D}, {KEYMAP_REPORT_KEYBOARD, 0x00, 0x00},
+                       {KEYMAP_REPORT_KEYBOARD, KEYMAP_MOD_CTRL, 0x1C}, {KEYMAP_REPORT_KEYBOARD, 0x00, 0x00}}},
+        // Tap del boton 6: espera la ventana de doble tap (5050 + 250 ms)
+        {5300, 6, 2, {{KEYMAP_REPORT_CONSUMER, 0xE2, 0x00}, {KEYMAP_REPORT_CONSUMER, 0x00, 0x00}}},
+    };
+    keymap_t map;
+    static replay_t r;
+    keymap_default(&map);
+    map.entries[7 - 1] = (keymap_entry_t){KEYMAP_ACTION_KEY, KEYMAP_MOD_CTRL, 0x06};
+    map.entries[13 - 1] = (keymap_entry_t){KEYMAP_ACTION_KEY, 0, 0x28};
+    map.entries[17 - 1] = (keymap_entry_t){KEYMAP_ACTION_MACRO, 0, 0};
+    map.macros[0][0] = (keymap_step_t){KEYMAP_MOD_CTRL, 0x1D};
+    map.macros[0][1] = (keymap_step_t){KEYMAP_MOD_CTRL, 0x1C};
+    CHECK(keymap_validate(&map));
+    int n = load_trace(dir, "keys.trace");
+    CHECK_INT(n, 24);
+    replay(&r, &map, n);
+    check_outputs("keys.trace", &r, expect, sizeof(expect) / sizeof(expect[0]));
+    // El pulso espurio del boton 2 no llega al reconocedor
+    CHECK_INT(r.debouncers[1].edges, 4);
+    CHECK_INT(r.debouncers[1].bounces, 2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = argc > 1 ? argv[1] : "traces";
+    test_example_trace(dir);
+    test_keys_trace(dir);
+    return test_result("keymap_replay");
+}
@@ -0,0 +1,188 @@
+// Asociaciones pot -> DSP: curvas lineal, logaritmica y con reten, estado inicial sin entregar
+// (NAN), la primera lectura que solo fija el punto de partida, el suavizado por pasos y la
+// cuantizacion a la resolucion de cada parametro.
+#include <math.h>
+#include <stdint.h>
+#include "knob_binding.h"
+#include "test_check.h"
+
+static knob_binding_t binding(knob_target_t target, uint8_t shift)
+{
+    knob_binding_t b;
+    knob_binding_default(&b, target);
+    b.smooth_shift = shift;
+    return b;
+}
+
+static void test_linear_curve(void)
+{
+    knob_binding_t b = binding(KNOB_TARGET_VOLUME, 0);
+    CHECK_NEAR(knob_binding_map(&b, 0), 0.0, 1e-6);
+    CHECK_NEAR(knob_binding_map(&b, 4095), 100.0, 1e-4);
+    CHECK_NEAR(knob_binding_map(&b, 1024), 100.0 * 1024 / 4095, 1e-4);
+    // Lecturas fuera de 12 bits se saturan al maximo
+    CHECK_NEAR(knob_binding_map(&b, 5000), 100.0, 1e-4);
+}
+
+static void test_log_curve(void)
+{
+    knob_binding_t b = binding(KNOB_TARGET_VOLUME, 0);
+    b.curve = KNOB_CURVE_LOG;
+    CHECK_NEAR(knob_binding_map(&b, 0), 0.0, 1e-4);
+    CHECK_NEAR(knob_binding_map(&b, 4095), 100.0, 1e-3);
+    // La mitad del recorrido cae cerca del 9 %
+    CHECK_NEAR(knob_binding_map(&b, 2048), 100.0 * (pow(10.0, 2.0 * 2048 / 4095) - 1.0) / 99.0, 1e-3);
+    float prev = -1.0f;
+    for (int raw = 0; raw <= 4095; raw += 15) {
+        float v = knob_binding_map(&b, (uint16_t)raw);
+        CHECK(v > prev);
+        prev = v;
+    }
+}
+
+static void test_detent_curve(void)
+{
+    // Balance: reten del 8 %, la zona 0.46..0.54 del recorrido queda en el centro
+    knob_binding_t b = binding(KNOB_TARGET_BALANCE, 0);
+    CHECK_INT(b.curve, KNOB_CURVE_DETENT);
+    CHECK_NEAR(knob_binding_map(&b, 0), -1.0, 1e-6);
+    CHECK_NEAR(knob_binding_map(&b, 4095), 1.0, 1e-4);
+    CHECK_NEAR(knob_binding_map(&b, 1900), 0.0, 1e-6);
+    CHECK_NEAR(knob_binding_map(&b, 2048), 0.0, 1e-6);
+    CHECK_NEAR(knob_binding_map(&b, 2190), 0.0, 1e-6);
+    CHECK_NEAR(knob_binding_map(&b, 1024), -1.0 + 2.0 * 0.5 * (1024.0 / 4095) / 0.46, 1e-4);
+    // Fuera del reten la curva sale del centro sin salto
+    CHECK_NEAR(knob_binding_map(&b, 1880), 0.0, 0.01);
+    CHECK_NEAR(knob_binding_map(&b, 2215), 0.0, 0.01);
+}
+
+static void test_initial_state(void)
+{
+    knob_binding_t b = binding(KNOB_TARGET_VOLUME, 0);
+    knob_binding_state_t st;
+    knob_binding_reset_state(&st);
+    CHECK(isnan(st.applied));
+    CHECK(!st.seeded);
+    CHECK_INT(st.updates, 0);
+    CHECK_INT(st.applies, 0);
+    // Sin lectura no hay nada que entregar
+    CHECK(!knob_binding_step(&b, &st));
+    CHECK(isnan(st.applied));
+}
+
+static void test_seed(void)
+{
+    knob_binding_t b = binding(KNOB_TARGET_VOLUME, 1);
+    knob_binding_state_t st;
+    knob_binding_reset_state(&st);
+    // La primera lectura fija el punto de partida sin tocar el DSP
+    CHECK(!knob_binding_update(&b, &st, 3000));
+    CHECK(st.seeded);
+    CHECK(st.settled);
+    CHECK_NEAR(st.current, knob_binding_map(&b, 3000), 1e-6);
+    CHECK_INT(st.updates, 0);
+    CHECK(!knob_binding_step(&b, &st));
+    CHECK(isnan(st.applied));
+    // La misma lectura tampoco cuenta como movimiento
+    CHECK(!knob_binding_update(&b, &st, 3000));
+    CHECK(!knob_binding_step(&b, &st));
+    // Al moverse se entrega el valor, partiendo de la posicion sembrada y no de 0
+    CHECK(knob_binding_update(&b, &st, 3100));
+    CHECK_INT(st.updates, 1);
+    CHECK(knob_binding_step(&b, &st));
+    CHECK(st.applied > 70.0f);
+    // Reiniciar el estado obliga a sembrar de nuevo
+    knob_binding_reset_state(&st);
+    CHECK(!knob_binding_update(&b, &st, 100));
+    CHECK(isnan(st.applied));
+}
+
+static void test_nan_forces_first_delivery(void)
+{
+    // Un movimiento que redondea al mismo volumen que el inicial igual se entrega una vez
+    knob_binding_t b = binding(KNOB_TARGET_VOLUME, 0);
+    knob_binding_state_t st;
+    knob_binding_reset_state(&st);
+    knob_binding_update(&b, &st, 2048);
+    CHECK(knob_binding_update(&b, &st, 2049));
+    CHECK(knob_binding_step(&b, &st));
+    CHECK_NEAR(st.applied, 50.0, 1e-6);
+    CHECK_INT(st.applies, 1);
+}
+
+static void test_quantization(void)
+{
+    knob_binding_t b = binding(KNOB_TARGET_VOLUME, 0);
+    knob_binding_state_t st;
+    knob_binding_reset_state(&st);
+    knob_binding_update(&b, &st, 0);
+    CHECK(knob_binding_update(&b, &st, 2048));
+    CHECK(knob_binding_step(&b, &st));
+    CHECK_NEAR(st.applied, 50.0, 1e-6);
+    // 2049 y 2060 siguen en 50 %: la lectura cambia pero el DSP no recibe nada
+    CHECK(knob_binding_update(&b, &st, 2049));
+    CHECK(!knob_binding_step(&b, &st));
+    CHECK(knob_binding_update(&b, &st, 2060));
+    CHECK(!knob_binding_step(&b, &st));
+    CHECK_INT(st.applies, 1);
+    CHECK(knob_binding_update(&b, &st, 2100));
+    CHECK(knob_binding_step(&b, &st));
+    CHECK_NEAR(st.applied, 51.0, 1e-6);
+
+    // Balance en centesimas y EQ en decimas de dB
+    knob_binding_t bal = binding(KNOB_TARGET_BALANCE, 0);
+    knob_binding_t eq = binding(KNOB_TARGET_BASS, 0);
+    knob_binding_state_t st_bal, st_eq;
+    knob_binding_reset_state(&st_bal);
+    knob_binding_reset_state(&st_eq);
+    knob_binding_update(&bal, &st_bal, 0);
+    knob_binding_update(&eq, &st_eq, 0);
+    for (int raw = 37; raw <= 4095; raw += 97) {
+        knob_binding_update(&bal, &st_bal, (uint16_t)raw);
+        knob_binding_update(&eq, &st_eq, (uint16_t)raw);
+        knob_binding_step(&bal, &st_bal);
+        knob_binding_step(&eq, &st_eq);
+        CHECK_NEAR(st_bal.applied * 100.0f, roundf(st_bal.applied * 100.0f), 1e-3);
+        CHECK_NEAR(st_eq.applied * 10.0f, roundf(st_eq.applied * 10.0f), 1e-3);
+    }
+}
+
+static void test_smoothing_steps(void)
+{
+    // Suavizado 1/2: de 0 a 100 % en pasos decrecientes, cada uno en la resolucion del volumen
+    knob_binding_t b = binding(KNOB_TARGET_VOLUME, 1);
+    knob_binding_state_t st;
+    knob_binding_reset_state(&st);
+    knob_binding_update(&b, &st, 0);
+    CHECK(knob_binding_update(&b, &st, 4095));
+    float prev = 0.0f;
+    int steps = 0;
+    while (knob_binding_step(&b, &st) && steps < 50) {
+        CHECK(st.applied > prev);
+        CHECK_NEAR(st.applied, roundf(st.applied), 1e-6);
+        prev = st.applied;
+        steps++;
+    }
+    CHECK_NEAR(st.applied, 100.0, 1e-6);
+    CHECK(steps > 1 && steps <= 12);
+    CHECK_INT(st.applies, steps);
+    // La cola del suavizado termina sin entregas: ya redondea al mismo valor
+    for (int i = 0; i < 20 && !st.settled; i++) {
+        CHECK(!knob_binding_step(&b, &st));
+    }
+    CHECK(st.settled);
+    CHECK_INT(st.applies, steps);
+}
+
+int main(void)
+{
+    test_linear_curve();
+    test_log_curve();
+    test_detent_curve();
+    test_initial_state();
+    test_seed();
+    test_nan_forces_first_delivery();
+    test_quantization();
+    test_smoothing_steps();
+    return test_result("knob_binding");
+}
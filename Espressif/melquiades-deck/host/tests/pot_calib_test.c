@@ -0,0 +1,153 @@
+// Linealizacion de pots con curvas sinteticas de eFuse y puntos manuales: validacion de los
+// puntos, respuesta ideal, una curva comprimida arriba como la del ADC del ESP32, tramos
+// min/centro/max con saturacion, y la tabla aplicada dentro de pot_filter.
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "pot_calib.h"
+#include "pot_filter.h"
+#include "test_check.h"
+
+#define Q4(x) ((x) << POT_FILTER_FRAC_BITS)
+
+static uint16_t lut[POT_CALIB_LUT_SIZE];
+static uint16_t grid[POT_CALIB_LUT_SIZE];
+
+// Curva tipo ADC1 a 11 dB: offset de 140 mV y compresion en el ultimo cuarto
+static double synthetic_mv(double raw)
+{
+    return 140.0 + 0.75 * raw - (raw > 3000.0 ? 0.00012 * (raw - 3000.0) * (raw - 3000.0) : 0.0);
+}
+
+static void build_grid(void)
+{
+    for (int i = 0; i < POT_CALIB_LUT_SIZE; i++) {
+        int raw = i * 16 > 4095 ? 4095 : i * 16;
+        grid[i] = (uint16_t)lround(synthetic_mv(raw));
+    }
+}
+
+static void test_points_valid(void)
+{
+    pot_calib_points_t pts = {.min = 100, .centre = 0, .max = 4000};
+    CHECK(pot_calib_points_valid(&pts));
+    pts.centre = 2000;
+    CHECK(pot_calib_points_valid(&pts));
+    pts.centre = 100;
+    CHECK(!pot_calib_points_valid(&pts));
+    pts.centre = 4000;
+    CHECK(!pot_calib_points_valid(&pts));
+    pts.centre = 0;
+    pts.max = 0;
+    CHECK(!pot_calib_points_valid(&pts));
+    pts.max = 4096;
+    CHECK(!pot_calib_points_valid(&pts));
+    // Recorrido menor que POT_CALIB_MIN_SPAN: demasiado corto para calibrar
+    pts.min = 1000;
+    pts.max = 1000 + POT_CALIB_MIN_SPAN - 1;
+    CHECK(!pot_calib_points_valid(&pts));
+    pts.max = 1000 + POT_CALIB_MIN_SPAN;
+    CHECK(pot_calib_points_valid(&pts));
+    CHECK(!pot_calib_points_valid(NULL));
+}
+
+static void test_identity(void)
+{
+    // Sin curva ni puntos la tabla deja pasar el valor sin cambios
+    pot_calib_build(lut, NULL, NULL);
+    CHECK_INT(lut[0], 0);
+    CHECK_INT(lut[POT_CALIB_LUT_SIZE - 1], POT_FILTER_MAX);
+    for (int raw = 0; raw <= 4095; raw += 7) {
+        CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(raw)), Q4(raw));
+    }
+    // La celda corta del final tambien es exacta: el pot llega a la escala completa
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(4088)), Q4(4088));
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(4095)), POT_FILTER_MAX);
+    CHECK_INT(pot_calib_mv(NULL, 1234), 1234);
+}
+
+static void test_efuse_curve(void)
+{
+    build_grid();
+    CHECK_INT(pot_calib_mv(grid, 0), grid[0]);
+    CHECK_INT(pot_calib_mv(grid, 4095), grid[POT_CALIB_LUT_SIZE - 1]);
+    CHECK_INT(pot_calib_mv(grid, 5000), grid[POT_CALIB_LUT_SIZE - 1]);
+    CHECK_NEAR(pot_calib_mv(grid, 1000), synthetic_mv(1000), 1);
+
+    pot_calib_build(lut, grid, NULL);
+    double lo = synthetic_mv(0), hi = synthetic_mv(4095);
+    uint16_t last = 0;
+    for (int raw = 0; raw <= 4095; raw += 5) {
+        uint16_t y = pot_calib_apply(lut, (uint16_t)Q4(raw));
+        // La salida sigue los mV normalizados: proporcional a la tension y no a la lectura
+        double expected = (synthetic_mv(raw) - lo) / (hi - lo) * POT_FILTER_MAX;
+        CHECK_NEAR(y, expected, Q4(3));
+        CHECK(y >= last);
+        last = y;
+    }
+    CHECK_INT(pot_calib_apply(lut, 0), 0);
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(4095)), POT_FILTER_MAX);
+}
+
+static void test_manual_points(void)
+{
+    pot_calib_points_t pts = {.min = 200, .centre = 1900, .max = 3900};
+    pot_calib_build(lut, NULL, &pts);
+    // Los extremos mecanicos saturan y el reten cae en la mitad de la escala. Un punto que no cae
+    // en la grilla de 16 LSB se redondea por la interpolacion entre celdas: hasta media celda
+    CHECK_INT(pot_calib_apply(lut, 0), 0);
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(200)), 0, Q4(8));
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(192)), 0);
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(1900)), Q4(2048), Q4(8));
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(3900)), POT_FILTER_MAX, Q4(8));
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(3904)), POT_FILTER_MAX);
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(4095)), POT_FILTER_MAX);
+    // Cada mitad es lineal entre sus puntos
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(1050)), Q4(1024), Q4(2));
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(2900)), Q4(2048) + (POT_FILTER_MAX - Q4(2048)) / 2, Q4(2));
+
+    // Puntos invalidos: se usa solo la curva
+    pts.min = 3000;
+    pot_calib_build(lut, NULL, &pts);
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(1000)), Q4(1000), 16);
+
+    // Sin centro el tramo min..max es uno solo, con la curva de eFuse debajo
+    build_grid();
+    pts.min = 300;
+    pts.centre = 0;
+    pts.max = 3800;
+    pot_calib_build(lut, grid, &pts);
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(300)), 0, Q4(8));
+    CHECK_NEAR(pot_calib_apply(lut, (uint16_t)Q4(3800)), POT_FILTER_MAX, Q4(8));
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(288)), 0);
+    CHECK_INT(pot_calib_apply(lut, (uint16_t)Q4(3808)), POT_FILTER_MAX);
+}
+
+static void test_filter_with_lut(void)
+{
+    pot_calib_points_t pts = {.min = 200, .centre = 0, .max = 3900};
+    pot_filter_config_t cfg = {.decimation = 16, .smooth_shift = 0, .deadband = Q4(1), .lut = lut};
+    pot_filter_t f;
+    pot_calib_build(lut, NULL, &pts);
+    pot_filter_init(&f);
+    for (int i = 0; i < 16; i++) {
+        pot_filter_push(&f, &cfg, 190);
+    }
+    // El promedio crudo queda para capturar puntos y el reportado ya pasa por la tabla
+    CHECK_INT(f.raw_avg, Q4(190));
+    CHECK_INT(pot_filter_reported_12bit(&f), 0);
+    for (int i = 0; i < 16; i++) {
+        pot_filter_push(&f, &cfg, 3950);
+    }
+    CHECK_INT(pot_filter_reported_12bit(&f), 4095);
+}
+
+int main(void)
+{
+    test_points_valid();
+    test_identity();
+    test_efuse_curve();
+    test_manual_points();
+    test_filter_with_lut();
+    return test_result("pot_calib");
+}
@@ -0,0 +1,146 @@
+// Filtro de pots con senales sinteticas: diezmado, ruido de ADC bajo la banda muerta,
+// escalones, suavizado desactivado y extremos de la escala. Sin tabla de calibracion,
+// la linealizacion se prueba en pot_calib_test.
+#include <stdint.h>
+#include <stdlib.h>
+#include "pot_filter.h"
+#include "test_check.h"
+
+#define Q4(x) ((x) << POT_FILTER_FRAC_BITS)
+
+static uint32_t noise_state = 12345;
+
+// Ruido uniforme en [-amp, amp], determinista para que la prueba no dependa de la corrida
+static int noise(int amp)
+{
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return (int)((noise_state >> 8) % (uint32_t)(2 * amp + 1)) - amp;
+}
+
+// Empuja muestras hasta la proxima salida diezmada; devuelve si cambio el valor reportado
+static bool push_output(pot_filter_t *f, const pot_filter_config_t *cfg, int level, int amp)
+{
+    bool changed = false;
+    for (int i = 0; i < cfg->decimation; i++) {
+        int raw = level + (amp > 0 ? noise(amp) : 0);
+        raw = raw < 0 ? 0 : raw > 4095 ? 4095 : raw;
+        changed = pot_filter_push(f, cfg, (uint16_t)raw);
+    }
+    return changed;
+}
+
+static void test_decimation(void)
+{
+    pot_filter_config_t cfg = {.decimation = 8, .smooth_shift = 2, .deadband = Q4(2)};
+    pot_filter_t f;
+    pot_filter_init(&f);
+    // 1000 y 1001 alternados: el promedio gana medio LSB que queda en la fraccion Q4
+    for (int i = 0; i < 7; i++) {
+        CHECK(!pot_filter_push(&f, &cfg, (uint16_t)(1000 + (i & 1))));
+    }
+    CHECK_INT(f.outputs, 0);
+    CHECK(pot_filter_push(&f, &cfg, 1001));
+    CHECK_INT(f.outputs, 1);
+    CHECK(f.primed);
+    CHECK_INT(f.raw_avg, Q4(1000) + 8);
+    // La primera salida se reporta sin suavizar
+    CHECK_INT(f.reported, Q4(1000) + 8);
+    CHECK_INT(pot_filter_reported_12bit(&f), 1001);
+    CHECK_INT(f.count, 0);
+    CHECK_INT(f.acc, 0);
+
+    // Los bits altos de la palabra del DMA no entran en el promedio
+    pot_filter_init(&f);
+    for (int i = 0; i < 8; i++) {
+        pot_filter_push(&f, &cfg, (uint16_t)(0xF000 | 2048));
+    }
+    CHECK_INT(pot_filter_reported_12bit(&f), 2048);
+
+    // Diezmado 0 se toma como 1
+    pot_filter_config_t single = {.decimation = 0, .smooth_shift = 0, .deadband = 0};
+    pot_filter_init(&f);
+    CHECK(pot_filter_push(&f, &single, 300));
+    CHECK_INT(f.outputs, 1);
+}
+
+static void test_noise_inside_deadband(void)
+{
+    pot_filter_config_t cfg = {.decimation = 64, .smooth_shift = 2, .deadband = Q4(3)};
+    pot_filter_t f;
+    pot_filter_init(&f);
+    push_output(&f, &cfg, 2048, 0);
+    CHECK_INT(f.changes, 1);
+    // +-24 LSB de ruido crudo: el promedio y el suavizado lo dejan muy por debajo de 3 LSB
+    int changes = 0;
+    for (int i = 0; i < 2000; i++) {
+        changes += push_output(&f, &cfg, 2048, 24) ? 1 : 0;
+    }
+    CHECK_INT(changes, 0);
+    CHECK_INT(pot_filter_reported_12bit(&f), 2048);
+    CHECK(abs((int)f.value - Q4(2048)) <= Q4(3));
+}
+
+static void test_step(void)
+{
+    pot_filter_config_t cfg = {.decimation = 16, .smooth_shift = 2, .deadband = Q4(2)};
+    pot_filter_t f;
+    pot_filter_init(&f);
+    push_output(&f, &cfg, 1000, 0);
+    uint16_t last = f.reported;
+    int outputs = 0;
+    // Un escalon de 2000 LSB llega en pocas salidas y el reportado solo sube
+    while (abs((int)pot_filter_reported_12bit(&f) - 3000) > 2 && outputs < 100) {
+        push_output(&f, &cfg, 3000, 0);
+        CHECK(f.reported >= last);
+        last = f.reported;
+        outputs++;
+    }
+    CHECK(outputs <= 40);
+    CHECK(abs((int)pot_filter_reported_12bit(&f) - 3000) <= 2);
+    // Un cambio menor que la banda muerta no se reporta
+    uint32_t changes = f.changes;
+    for (int i = 0; i < 50; i++) {
+        push_output(&f, &cfg, pot_filter_reported_12bit(&f) + 1, 0);
+    }
+    CHECK_INT(f.changes, changes);
+}
+
+static void test_no_smoothing(void)
+{
+    pot_filter_config_t cfg = {.decimation = 4, .smooth_shift = 0, .deadband = 0};
+    pot_filter_t f;
+    pot_filter_init(&f);
+    push_output(&f, &cfg, 100, 0);
+    // Sin suavizado ni banda muerta cada salida distinta se reporta tal cual
+    CHECK(push_output(&f, &cfg, 3900, 0));
+    CHECK_INT(f.value, Q4(3900));
+    CHECK_INT(pot_filter_reported_12bit(&f), 3900);
+    CHECK(!push_output(&f, &cfg, 3900, 0));
+}
+
+static void test_full_scale(void)
+{
+    pot_filter_config_t cfg = {.decimation = 256, .smooth_shift = 6, .deadband = Q4(1)};
+    pot_filter_t f;
+    pot_filter_init(&f);
+    push_output(&f, &cfg, 4095, 0);
+    CHECK_INT(f.reported, POT_FILTER_MAX);
+    CHECK_INT(pot_filter_reported_12bit(&f), 4095);
+    // Con 1/64 por salida la cola de un recorrido completo tarda ~17 constantes de tiempo
+    for (int i = 0; i < 1200; i++) {
+        push_output(&f, &cfg, 0, 0);
+    }
+    // El suavizado llega a 0 y el reportado queda dentro de la banda muerta
+    CHECK_INT(f.value, 0);
+    CHECK(f.reported <= Q4(1));
+}
+
+int main(void)
+{
+    test_decimation();
+    test_noise_inside_deadband();
+    test_step();
+    test_no_smoothing();
+    test_full_scale();
+    return test_result("pot_filter");
+}
@@ -0,0 +1,163 @@
+// Politica de energia con secuencias sinteticas de entradas: tiempos de espera de AUDIO y
+// ACTIVE, la espera que corre desde el paso en que se ve parar el stream, el desborde de los
+// ms de 32 bits, power_policy_next_change_ms y el tiempo acumulado en cada modo.
+#include <stdint.h>
+#include <string.h>
+#include "power_policy.h"
+#include "test_check.h"
+
+#define AUDIO_HOLD_MS   10000
+#define ACTIVE_HOLD_MS  5000
+
+static const power_inputs_t none = {false, false, false};
+static const power_inputs_t audio = {true, false, false};
+static const power_inputs_t activity = {false, false, true};
+static const power_inputs_t sensors = {false, true, false};
+
+static void init(power_policy_t *p, uint32_t now_ms)
+{
+    power_policy_config_t cfg = {.audio_hold_ms = AUDIO_HOLD_MS, .active_hold_ms = ACTIVE_HOLD_MS};
+    power_policy_init(p, &cfg, now_ms);
+}
+
+static void test_boot_and_active_hold(void)
+{
+    power_policy_t p;
+    init(&p, 1000);
+    // El arranque cuenta como actividad
+    CHECK_INT(p.mode, POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_next_change_ms(&p, 1000), ACTIVE_HOLD_MS);
+    CHECK_INT(power_policy_step(&p, &none, 5999), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_next_change_ms(&p, 5999), 1);
+    CHECK_INT(power_policy_step(&p, &none, 6000), POWER_MODE_IDLE);
+    CHECK_INT(power_policy_next_change_ms(&p, 6000), UINT32_MAX);
+
+    // Cada gesto corre la espera desde ese paso
+    CHECK_INT(power_policy_step(&p, &activity, 7000), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_step(&p, &activity, 9000), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_step(&p, &none, 13999), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_step(&p, &none, 14000), POWER_MODE_IDLE);
+    CHECK_INT(p.entries[POWER_MODE_ACTIVE], 2);
+    CHECK_INT(p.entries[POWER_MODE_IDLE], 2);
+}
+
+static void test_sensor_stream_edge(void)
+{
+    power_policy_t p;
+    init(&p, 0);
+    // Con sensores en continuo no se baja a reposo aunque no haya gestos
+    CHECK_INT(power_policy_step(&p, &sensors, 1000), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_step(&p, &sensors, 60000), POWER_MODE_ACTIVE);
+    // Al cortarse, la espera cuenta desde el paso que lo vio y no desde el ultimo con stream
+    CHECK_INT(power_policy_step(&p, &none, 90000), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_next_change_ms(&p, 90000), ACTIVE_HOLD_MS);
+    CHECK_INT(power_policy_step(&p, &none, 90000 + ACTIVE_HOLD_MS), POWER_MODE_IDLE);
+}
+
+static void test_audio_hold(void)
+{
+    power_policy_t p;
+    init(&p, 0);
+    CHECK_INT(power_policy_step(&p, &audio, 100), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_step(&p, &audio, 20000), POWER_MODE_AUDIO);
+    // Pausa entre temas: sigue en AUDIO durante la espera
+    CHECK_INT(power_policy_step(&p, &none, 21000), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_next_change_ms(&p, 21000), AUDIO_HOLD_MS);
+    CHECK_INT(power_policy_step(&p, &audio, 25000), POWER_MODE_AUDIO);
+    CHECK_INT(p.entries[POWER_MODE_AUDIO], 1);
+    // Stream parado de verdad: AUDIO hasta vencer la espera y luego directo a reposo
+    CHECK_INT(power_policy_step(&p, &none, 30000), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_step(&p, &none, 30000 + AUDIO_HOLD_MS - 1), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_step(&p, &none, 30000 + AUDIO_HOLD_MS), POWER_MODE_IDLE);
+}
+
+static void test_stream_stop_latch(void)
+{
+    power_policy_t p;
+    init(&p, 0);
+    CHECK_INT(power_policy_step(&p, &audio, 1000), POWER_MODE_AUDIO);
+    // El paso siguiente llega tarde, mas alla de la espera desde el ultimo paso con stream:
+    // la espera se cuenta desde este paso, sin pasar por reposo con el stream recien cortado
+    CHECK_INT(power_policy_step(&p, &none, 1000 + AUDIO_HOLD_MS + 5000), POWER_MODE_AUDIO);
+    CHECK(!p.audio_streaming);
+    CHECK_INT(power_policy_next_change_ms(&p, 1000 + AUDIO_HOLD_MS + 5000), AUDIO_HOLD_MS);
+    // El latch se consume en ese paso: el siguiente ya no corre la espera
+    CHECK_INT(power_policy_step(&p, &none, 1000 + AUDIO_HOLD_MS + 6000), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_next_change_ms(&p, 1000 + AUDIO_HOLD_MS + 6000), AUDIO_HOLD_MS - 1000);
+    // Gestos durante el audio: al vencer la espera de AUDIO queda la de ACTIVE
+    CHECK_INT(power_policy_step(&p, &activity, 1000 + 2 * AUDIO_HOLD_MS + 1000), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_step(&p, &none, 1000 + 2 * AUDIO_HOLD_MS + 5000), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_next_change_ms(&p, 1000 + 2 * AUDIO_HOLD_MS + 5000), 1000);
+    CHECK_INT(power_policy_step(&p, &none, 1000 + 2 * AUDIO_HOLD_MS + 6000), POWER_MODE_IDLE);
+}
+
+static void test_zero_hold(void)
+{
+    power_policy_t p;
+    power_policy_config_t cfg = {.audio_hold_ms = 0, .active_hold_ms = 0};
+    power_policy_init(&p, &cfg, 500);
+    CHECK_INT(power_policy_next_change_ms(&p, 500), 0);
+    CHECK_INT(power_policy_step(&p, &audio, 600), POWER_MODE_AUDIO);
+    // Sin espera el modo sigue a las entradas en el mismo paso
+    CHECK_INT(power_policy_step(&p, &none, 700), POWER_MODE_IDLE);
+    CHECK_INT(power_policy_step(&p, &activity, 800), POWER_MODE_IDLE);
+}
+
+static void test_wrap(void)
+{
+    power_policy_t p;
+    uint32_t start = UINT32_MAX - 1000;
+    init(&p, start);
+    // La espera de ACTIVE cruza el desborde: vence en 3999 del ciclo siguiente
+    CHECK_INT(power_policy_next_change_ms(&p, UINT32_MAX - 500), ACTIVE_HOLD_MS - 500);
+    CHECK_INT(power_policy_step(&p, &none, UINT32_MAX), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_step(&p, &none, 0), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_step(&p, &none, 3998), POWER_MODE_ACTIVE);
+    CHECK_INT(power_policy_next_change_ms(&p, 3998), 1);
+    CHECK_INT(power_policy_step(&p, &none, 3999), POWER_MODE_IDLE);
+
+    // Stream que para justo antes del desborde
+    init(&p, UINT32_MAX - 20000);
+    CHECK_INT(power_policy_step(&p, &audio, UINT32_MAX - 3000), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_step(&p, &none, UINT32_MAX - 2000), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_next_change_ms(&p, 1000), AUDIO_HOLD_MS - 3001);
+    CHECK_INT(power_policy_step(&p, &none, AUDIO_HOLD_MS - 2002), POWER_MODE_AUDIO);
+    CHECK_INT(power_policy_step(&p, &none, AUDIO_HOLD_MS - 2001), POWER_MODE_IDLE);
+
+    // El tiempo por modo se acumula bien a traves del desborde
+    uint64_t residency[POWER_MODE_COUNT];
+    power_policy_residency(&p, AUDIO_HOLD_MS, residency);
+    CHECK_INT(residency[POWER_MODE_ACTIVE], 17000);
+    CHECK_INT(residency[POWER_MODE_AUDIO], AUDIO_HOLD_MS - 2001 + 3001);
+    CHECK_INT(residency[POWER_MODE_IDLE], 2001);
+}
+
+static void test_residency(void)
+{
+    power_policy_t p;
+    uint64_t residency[POWER_MODE_COUNT];
+    init(&p, 0);
+    power_policy_step(&p, &audio, 2000);
+    power_policy_step(&p, &none, 3000);
+    power_policy_step(&p, &none, 13000);
+    // El tramo en curso se suma hasta now sin modificar la politica
+    power_policy_residency(&p, 20000, residency);
+    CHECK_INT(residency[POWER_MODE_ACTIVE], 2000);
+    CHECK_INT(residency[POWER_MODE_AUDIO], 11000);
+    CHECK_INT(residency[POWER_MODE_IDLE], 7000);
+    CHECK_INT(p.residency_ms[POWER_MODE_IDLE], 0);
+    CHECK(strcmp(power_mode_name(POWER_MODE_IDLE), "reposo") == 0);
+    CHECK(strcmp(power_mode_name(POWER_MODE_COUNT), "?") == 0);
+}
+
+int main(void)
+{
+    test_boot_and_active_hold();
+    test_sensor_stream_edge();
+    test_audio_hold();
+    test_stream_stop_latch();
+    test_zero_hold();
+    test_wrap();
+    test_residency();
+    return test_result("power_policy");
+}
@@ -0,0 +1,168 @@
+// Reporte por cambios de los slots con secuencias sinteticas: formato de la linea, intervalo
+// minimo con cambios agrupados, latidos, el instante del cambio mas antiguo, lineas cortadas
+// por falta de espacio y los contadores por modo.
+#include <stdint.h>
+#include <string.h>
+#include "sensor_report.h"
+#include "test_check.h"
+
+#define LINE_SIZE 128
+
+static sensor_registry_t reg;
+static uint16_t values[SENSOR_SLOT_COUNT];
+
+// Slots 1 y 2 pots con latido, 3 boton, 4 pot sin latido
+static void setup_registry(void)
+{
+    memset(&reg, 0, sizeof(reg));
+    memset(values, 0, sizeof(values));
+    reg.version = SENSOR_REGISTRY_VERSION;
+    for (int i = 0; i < 4; i++) {
+        sensor_slot_config_t *s = &reg.slots[i];
+        s->type = i == 2 ? SENSOR_TYPE_BUTTON : SENSOR_TYPE_POT;
+        s->min_interval_ms = 50;
+        s->heartbeat_ms = i == 3 ? 0 : 1000;
+    }
+}
+
+static size_t build(sensor_report_t *r, uint32_t now_ms, char *line, size_t size)
+{
+    memset(line, 0, size);
+    return sensor_report_build(r, &reg, values, SENSOR_REPORT_ACTIVE, now_ms, line, size);
+}
+
+static void test_single_change(void)
+{
+    sensor_report_t r;
+    char line[LINE_SIZE];
+    setup_registry();
+    sensor_report_init(&r, 0);
+    CHECK_INT(build(&r, 10, line, sizeof(line)), 0);
+    sensor_report_change(&r, 0, 2048, 60500);
+    size_t len = build(&r, 70, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 1=2048 t=60.500 ms\r\n") == 0);
+    CHECK_INT(len, strlen(line));
+    // Ya reportado: no se repite hasta otro cambio o el latido
+    CHECK_INT(build(&r, 80, line, sizeof(line)), 0);
+    CHECK_INT(r.slots[0].value, 2048);
+}
+
+static void test_min_interval(void)
+{
+    sensor_report_t r;
+    char line[LINE_SIZE];
+    setup_registry();
+    sensor_report_init(&r, 0);
+    sensor_report_change(&r, 0, 100, 100000);
+    build(&r, 100, line, sizeof(line));
+    // Dos cambios dentro del intervalo minimo: sale el ultimo valor con el instante del primero
+    sensor_report_change(&r, 0, 200, 120000);
+    CHECK_INT(build(&r, 130, line, sizeof(line)), 0);
+    sensor_report_change(&r, 0, 300, 140000);
+    CHECK_INT(build(&r, 149, line, sizeof(line)), 0);
+    CHECK_INT(r.modes[SENSOR_REPORT_ACTIVE].deferred, 2);
+    build(&r, 150, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 1=300 t=120.000 ms\r\n") == 0);
+}
+
+static void test_heartbeat(void)
+{
+    sensor_report_t r;
+    char line[LINE_SIZE];
+    setup_registry();
+    sensor_report_init(&r, 0);
+    values[0] = 11;
+    values[1] = 22;
+    values[3] = 44;
+    CHECK_INT(build(&r, 999, line, sizeof(line)), 0);
+    // Vencen los latidos de 1 y 2; el 4 no tiene latido y el 3 es un boton
+    build(&r, 1000, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 1=11 2=22 t=1000.000 ms\r\n") == 0);
+    CHECK_INT(r.modes[SENSOR_REPORT_ACTIVE].heartbeats, 2);
+    // Un cambio reinicia el latido de su slot
+    sensor_report_change(&r, 1, 23, 1500000);
+    build(&r, 1500, line, sizeof(line));
+    values[1] = 23;
+    build(&r, 2000, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 1=11 t=2000.000 ms\r\n") == 0);
+    // Los cambios de un boton no entran en la linea de pots
+    sensor_report_change(&r, 2, 1, 2100000);
+    CHECK_INT(build(&r, 2200, line, sizeof(line)), 0);
+    // Slot fuera de rango: se ignora
+    sensor_report_change(&r, SENSOR_SLOT_COUNT, 1, 0);
+    sensor_report_change(&r, -1, 1, 0);
+}
+
+static void test_oldest_stamp(void)
+{
+    sensor_report_t r;
+    char line[LINE_SIZE];
+    setup_registry();
+    sensor_report_init(&r, 0);
+    sensor_report_change(&r, 3, 4000, 90250);
+    sensor_report_change(&r, 0, 1000, 95000);
+    build(&r, 100, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 1=1000 4=4000 t=90.250 ms\r\n") == 0);
+    CHECK_INT(r.modes[SENSOR_REPORT_ACTIVE].entries, 2);
+}
+
+static void test_truncated_line(void)
+{
+    sensor_report_t r;
+    // Entra "Sensores:" y un slot con su terminador, el segundo queda pendiente para la linea siguiente
+    char line[SENSOR_REPORT_STAMP_BYTES + 17];
+    setup_registry();
+    sensor_report_init(&r, 0);
+    sensor_report_change(&r, 0, 4095, 100000);
+    sensor_report_change(&r, 1, 4095, 100000);
+    size_t len = build(&r, 100, line, sizeof(line));
+    CHECK(len < sizeof(line));
+    CHECK(strcmp(line, "Sensores: 1=4095 t=100.000 ms\r\n") == 0);
+    CHECK(r.slots[1].has_pending);
+    build(&r, 200, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 2=4095 t=100.000 ms\r\n") == 0);
+
+    // Un latido que no entra pasa a pendiente con el instante de la linea que lo corto
+    setup_registry();
+    sensor_report_init(&r, 0);
+    values[0] = 4095;
+    values[1] = 4095;
+    build(&r, 1000, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 1=4095 t=1000.000 ms\r\n") == 0);
+    build(&r, 1001, line, sizeof(line));
+    CHECK(strcmp(line, "Sensores: 2=4095 t=1000.000 ms\r\n") == 0);
+}
+
+static void test_mode_stats(void)
+{
+    sensor_report_t r;
+    char line[LINE_SIZE];
+    char text[512];
+    setup_registry();
+    sensor_report_init(&r, 0);
+    sensor_report_account(&r, SENSOR_REPORT_IDLE, 1000);
+    sensor_report_change(&r, 0, 5, 1000000);
+    size_t len = build(&r, 1000, line, sizeof(line));
+    sensor_report_count(&r, SENSOR_REPORT_ACTIVE, 30);
+    sensor_report_account(&r, SENSOR_REPORT_ACTIVE, 3000);
+    CHECK_INT(r.modes[SENSOR_REPORT_IDLE].time_ms, 1000);
+    CHECK_INT(r.modes[SENSOR_REPORT_ACTIVE].time_ms, 2000);
+    CHECK_INT(r.modes[SENSOR_REPORT_ACTIVE].frames, 2);
+    CHECK_INT(r.modes[SENSOR_REPORT_ACTIVE].bytes, len + 30);
+    size_t n = sensor_report_format(&r, 100, text, sizeof(text));
+    CHECK_INT(n, strlen(text));
+    CHECK(strstr(text, "2 tramas/s, 200 B/s") != NULL);
+    CHECK(strstr(text, "activo: 2.00 s, 1.00 tramas/s") != NULL);
+    CHECK_INT(sensor_report_format(&r, 100, text, 0), 0);
+}
+
+int main(void)
+{
+    test_single_change();
+    test_min_interval();
+    test_heartbeat();
+    test_oldest_stamp();
+    test_truncated_line();
+    test_mode_stats();
+    return test_result("sensor_report");
+}
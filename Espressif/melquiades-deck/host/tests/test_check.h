@@ -0,0 +1,44 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <stdio.h>
+
+// Verificaciones minimas para las pruebas de host: cada falla se informa con su linea y la
+// prueba sigue, main devuelve test_result() para que ctest la marque como fallida.
+
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: fallo: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_INT(actual, expected) do { \
+        long long check_a = (long long)(actual), check_e = (long long)(expected); \
+        if (check_a != check_e) { \
+            fprintf(stderr, "%s:%d: fallo: %s = %lld, se esperaba %lld\n", __FILE__, __LINE__, #actual, check_a, check_e); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tol) do { \
+        double check_a = (double)(actual), check_e = (double)(expected); \
+        if (!(check_a >= check_e - (tol) && check_a <= check_e + (tol))) { \
+            fprintf(stderr, "%s:%d: fallo: %s = %g, se esperaba %g\n", __FILE__, __LINE__, #actual, check_a, check_e); \
+            test_failures++; \
+        } \
+    } while (0)
+
+static inline int test_result(const char *name)
+{
+    if (test_failures == 0) {
+        printf("%s: ok\n", name);
+        return 0;
+    }
+    printf("%s: %d fallas\n", name, test_failures);
+    return 1;
+}
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,266 @@
+// Procesa un WAV fuera de linea con el mismo audio_dsp_process del equipo, para escuchar y
+// comparar presets, limitador y ajustes por oido sobre grabaciones reales sin flashear la
+// placa. La entrada se mapea en memoria y se recorre en bloques del tamano que usa la tarea
+// I2S; la salida es siempre estereo, como la que llega al PCM5102.
+#include <ctype.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "dsp_bench.h"
+#include "host_wav.h"
+
+#define TAG "DSP_WAV"
+
+#define WAV_DEFAULT_BLOCK   2048    // Bloque de la tarea I2S
+#define WAV_MAX_BLOCK       65536
+
+// Pico y energia de la salida por canal
+typedef struct {
+    int32_t peak[2];
+    double sum_sq[2];
+    uint64_t frames;
+} wav_levels_t;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Uso: %s -i entrada.wav -o salida.wav [-e preset] [-g dB] [-B dB] [-M dB] [-T dB]\n"
+            "       [-L dB] [-R dB] [-l dBFS] [-k bytes] [-q]\n"
+            "  -i  WAV PCM de 16 bits, mono o estereo, a cualquier frecuencia\n"
+            "  -o  WAV estereo de 16 bits con la salida del DSP\n"
+            "  -e  Preset de EQ por numero (0-%d) o nombre (por defecto Plano)\n"
+            "  -g  Ganancia general en dB (por defecto 6, la de la salida de audio)\n"
+            "  -B, -M, -T  Bajos, medios y agudos en dB; reemplazan los del preset\n"
+            "  -L, -R  Ganancia por oido en dB; activa el procesamiento por canal\n"
+            "  -l  Umbral del limitador en dBFS (-20 a 0, por defecto apagado)\n"
+            "  -k  Bytes por llamada a audio_dsp_process (por defecto %d)\n"
+            "  -q  Sin informe de niveles\n",
+            prog, EQ_MAX_PRESETS - 1, WAV_DEFAULT_BLOCK);
+}
+
+static bool parse_preset(const char *arg, eq_preset_t *preset)
+{
+    float bass, mid, treble;
+    if (isdigit((unsigned char)arg[0])) {
+        int idx = atoi(arg);
+        if (idx < 0 || idx >= EQ_MAX_PRESETS) {
+            return false;
+        }
+        *preset = idx;
+        return true;
+    }
+    for (eq_preset_t p = 0; p < EQ_MAX_PRESETS; p++) {
+        if (strcasecmp(get_eq_preset_bands(p, &bass, &mid, &treble), arg) == 0) {
+            *preset = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void measure(const int16_t *pcm, uint32_t frames, wav_levels_t *levels)
+{
+    for (uint32_t i = 0; i < frames; i++) {
+        for (int ch = 0; ch < 2; ch++) {
+            int32_t s = pcm[2 * i + ch];
+            int32_t mag = s < 0 ? -s : s;
+            if (mag > levels->peak[ch]) {
+                levels->peak[ch] = mag;
+            }
+            levels->sum_sq[ch] += (double)s * s;
+        }
+    }
+    levels->frames += frames;
+}
+
+static double to_dbfs(double value)
+{
+    return value > 0.0 ? 20.0 * log10(value / 32768.0) : -INFINITY;
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL;
+    const char *output = NULL;
+    eq_preset_t preset = EQ_FLAT;
+    float gain_db = NAN, bass_db = NAN, mid_db = NAN, treble_db = NAN;
+    float left_db = NAN, right_db = NAN, limiter_db = NAN;
+    size_t block_bytes = WAV_DEFAULT_BLOCK;
+    bool quiet = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:o:e:g:B:M:T:L:R:l:k:qh")) != -1) {
+        switch (opt) {
+        case 'i': input = optarg; break;
+        case 'o': output = optarg; break;
+        case 'e':
+            if (!parse_preset(optarg, &preset)) {
+                fprintf(stderr, "Preset desconocido: %s\n", optarg);
+                return 2;
+            }
+            break;
+        case 'g': gain_db = strtof(optarg, NULL); break;
+        case 'B': bass_db = strtof(optarg, NULL); break;
+        case 'M': mid_db = strtof(optarg, NULL); break;
+        case 'T': treble_db = strtof(optarg, NULL); break;
+        case 'L': left_db = strtof(optarg, NULL); break;
+        case 'R': right_db = strtof(optarg, NULL); break;
+        case 'l': limiter_db = strtof(optarg, NULL); break;
+        case 'k': block_bytes = strtoul(optarg, NULL, 0); break;
+        case 'q': quiet = true; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (input == NULL || output == NULL) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (block_bytes < DSP_BENCH_FRAME_BYTES || block_bytes > WAV_MAX_BLOCK) {
+        fprintf(stderr, "El bloque va de %d a %d bytes\n", DSP_BENCH_FRAME_BYTES, WAV_MAX_BLOCK);
+        return 2;
+    }
+    block_bytes -= block_bytes % DSP_BENCH_FRAME_BYTES;
+
+    // Misma configuracion que arma la salida de audio, con lo que se pida encima
+    dsp_config_t config;
+    const char *preset_name = dsp_bench_preset_config(preset, &config);
+    if (!isnan(gain_db)) config.gain_db = gain_db;
+    if (!isnan(bass_db)) config.bass_gain_db = bass_db;
+    if (!isnan(mid_db)) config.mid_gain_db = mid_db;
+    if (!isnan(treble_db)) config.treble_gain_db = treble_db;
+    if (!isnan(left_db) || !isnan(right_db)) {
+        config.separate_channels = true;
+        config.left_gain_db = isnan(left_db) ? 0.0f : left_db;
+        config.right_gain_db = isnan(right_db) ? 0.0f : right_db;
+    }
+    if (!isnan(limiter_db)) config.limiter_threshold_db = limiter_db;
+
+    // La cabecera se lee con el lector del port; las muestras se toman del mapa
+    host_wav_t in_wav;
+    if (!host_wav_open_read(&in_wav, input) || (in_wav.channels != 1 && in_wav.channels != 2)) {
+        ESP_LOGE(TAG, "%s no es un WAV PCM de 16 bits mono o estereo", input);
+        return 1;
+    }
+    uint32_t rate = in_wav.sample_rate;
+    uint16_t channels = in_wav.channels;
+    size_t data_offset = in_wav.data_offset;
+    size_t data_bytes = in_wav.data_bytes;
+    host_wav_close(&in_wav, false);
+
+    int fd = open(input, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        ESP_LOGE(TAG, "No se pudo abrir %s", input);
+        return 1;
+    }
+    // Un WAV cortado declara mas datos de los que tiene
+    if (data_offset + data_bytes > (size_t)st.st_size) {
+        data_bytes = (size_t)st.st_size - data_offset;
+    }
+    uint32_t frames = data_bytes / (2 * channels);
+    const uint8_t *map = NULL;
+    if (st.st_size > 0) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED || map == NULL) {
+        ESP_LOGE(TAG, "No se pudo mapear %s", input);
+        return 1;
+    }
+    madvise((void *)map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    const int16_t *pcm = (const int16_t *)(map + data_offset);
+
+    host_wav_t out_wav;
+    if (!host_wav_open_write(&out_wav, output, rate, 2)) {
+        ESP_LOGE(TAG, "No se pudo crear %s", output);
+        munmap((void *)map, (size_t)st.st_size);
+        return 1;
+    }
+
+    esp_log_level_set("AUDIO_DSP", ESP_LOG_WARN);
+    if (audio_dsp_init(rate) != ESP_OK) {
+        host_wav_close(&out_wav, true);
+        munmap((void *)map, (size_t)st.st_size);
+        return 1;
+    }
+
+    // Mono se duplica a los dos canales en stage, como lo hace el telefono al mandar SBC
+    uint32_t block_frames = block_bytes / DSP_BENCH_FRAME_BYTES;
+    int16_t *stage = malloc(block_bytes);
+    int16_t *out = malloc(block_bytes);
+    wav_levels_t levels = {0};
+    double dsp_s = 0.0;
+    double start = now_s();
+    esp_err_t ret = (stage != NULL && out != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+    for (uint32_t f = 0; f < frames && ret == ESP_OK; f += block_frames) {
+        uint32_t n = frames - f < block_frames ? frames - f : block_frames;
+        const int16_t *src = &pcm[(size_t)f * channels];
+        if (channels == 1) {
+            for (uint32_t i = 0; i < n; i++) {
+                stage[2 * i] = src[i];
+                stage[2 * i + 1] = src[i];
+            }
+            src = stage;
+        }
+        double t = now_s();
+        ret = audio_dsp_process((const uint8_t *)src, (uint8_t *)out, n * DSP_BENCH_FRAME_BYTES, &config);
+        dsp_s += now_s() - t;
+        if (!quiet) {
+            measure(out, n, &levels);
+        }
+        host_wav_write(&out_wav, out, n * DSP_BENCH_FRAME_BYTES);
+    }
+    host_wav_close(&out_wav, true);
+    double total_s = now_s() - start;
+
+    free(stage);
+    free(out);
+    audio_dsp_deinit();
+    munmap((void *)map, (size_t)st.st_size);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "audio_dsp_process fallo: %s", esp_err_to_name(ret));
+        return 1;
+    }
+
+    double audio_s = (double)frames / rate;
+    printf("%s: %u frames a %u Hz (%s), %.1f s de audio\n", input, frames, rate,
+           channels == 1 ? "mono" : "estereo", audio_s);
+    printf("DSP: preset %s, ganancia %.1f dB, bandas %.1f/%.1f/%.1f dB", preset_name, config.gain_db,
+           config.bass_gain_db, config.mid_gain_db, config.treble_gain_db);
+    if (config.separate_channels) {
+        printf(", oidos %.1f/%.1f dB", config.left_gain_db, config.right_gain_db);
+    }
+    if (config.limiter_threshold_db < 0.0f) {
+        printf(", limitador %.1f dBFS", config.limiter_threshold_db);
+    }
+    printf(", bloque %u B\n", (unsigned)block_bytes);
+    printf("Velocidad: DSP x%.0f tiempo real, total x%.0f (%.3f s)\n",
+           dsp_s > 0.0 ? audio_s / dsp_s : 0.0, total_s > 0.0 ? audio_s / total_s : 0.0, total_s);
+    if (!quiet && levels.frames > 0) {
+        static const char *names[2] = {"izquierdo", "derecho"};
+        for (int ch = 0; ch < 2; ch++) {
+            double rms = sqrt(levels.sum_sq[ch] / levels.frames);
+            printf("Canal %-9s pico %6.1f dBFS%s, RMS %6.1f dBFS\n", names[ch], to_dbfs(levels.peak[ch]),
+                   levels.peak[ch] >= 32767 ? " (recorta)" : "", to_dbfs(rms));
+        }
+    }
+    printf("Salida en %s\n", output);
+    return 0;
+}
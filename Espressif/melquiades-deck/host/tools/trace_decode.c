@@ -0,0 +1,153 @@
+// Decodifica volcados de "trace bin" capturados por UART o SPP. Los bytes pueden venir
+// mezclados con texto del shell: solo se toman las tramas BIN_FRAME_TRACE con CRC valido.
+// Los formatos viajan en el mismo volcado, no hace falta el ELF del firmware.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bin_protocol.h"
+#include "trace_log.h"
+
+#define DECODE_MAX_STRINGS  512
+#define DECODE_MAX_PAYLOAD  (5 + 255)
+
+typedef struct {
+    uint32_t id;
+    char *text;
+} decode_string_t;
+
+static decode_string_t strings[DECODE_MAX_STRINGS];
+static int string_count = 0;
+static const char level_chars[] = "NEWIDV";
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Los ids son direcciones del firmware: son estables mientras no se flashee otra imagen
+static void define_string(uint32_t id, const uint8_t *text, size_t len)
+{
+    decode_string_t *slot = NULL;
+    for (int i = 0; i < string_count; i++) {
+        if (strings[i].id == id) {
+            slot = &strings[i];
+            free(slot->text);
+            break;
+        }
+    }
+    if (slot == NULL) {
+        if (string_count == DECODE_MAX_STRINGS) {
+            return;
+        }
+        slot = &strings[string_count++];
+        slot->id = id;
+    }
+    slot->text = strndup((const char *)text, len);
+}
+
+static const char *lookup(uint32_t id)
+{
+    for (int i = 0; i < string_count; i++) {
+        if (strings[i].id == id) {
+            return strings[i].text;
+        }
+    }
+    return NULL;
+}
+
+static void handle_payload(const uint8_t *p, size_t len)
+{
+    if (len == 0) {
+        return;
+    }
+    if (p[0] == TRACE_BIN_STRING && len >= 5) {
+        define_string(get_u32(p + 1), p + 5, len - 5);
+    } else if (p[0] == TRACE_BIN_RECORD && len >= 16) {
+        uint32_t stamp = get_u32(p + 1);
+        const char *tag = lookup(get_u32(p + 5));
+        const char *fmt = lookup(get_u32(p + 9));
+        uint8_t level = p[13];
+        uint8_t core = p[14];
+        uint8_t argc = p[15];
+        uint32_t args[TRACE_MAX_ARGS] = {0};
+        for (int i = 0; i < argc && i < TRACE_MAX_ARGS && 16 + 4 * (size_t)(i + 1) <= len; i++) {
+            args[i] = get_u32(p + 16 + 4 * i);
+        }
+        char msg[256];
+        if (fmt != NULL) {
+            trace_log_format_message(fmt, args, argc, msg, sizeof(msg));
+        } else {
+            snprintf(msg, sizeof(msg), "<formato 0x%08x desconocido>", get_u32(p + 9));
+        }
+        printf("%c (%u.%03u) c%u %s: %s\n", level < sizeof(level_chars) - 1 ? level_chars[level] : '?',
+               stamp / 1000, stamp % 1000, core, tag != NULL ? tag : "?", msg);
+    } else if (p[0] == TRACE_BIN_END && len >= 7) {
+        if (p[1] != TRACE_BIN_VERSION) {
+            fprintf(stderr, "Version de traza %u, se esperaba %u\n", p[1], TRACE_BIN_VERSION);
+        }
+        uint32_t lost = get_u32(p + 2);
+        if (lost > 0) {
+            fprintf(stderr, "%u registros pisados antes del volcado\n", lost);
+        }
+        if (p[6]) {
+            fprintf(stderr, "Quedan registros: repetir trace bin\n");
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "-h") == 0)) {
+        fprintf(stderr, "Uso: %s [captura.bin]  (sin archivo lee de la entrada estandar)\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && (in = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    // Maquina de estados propia: el parser del firmware limita el payload recibido a 48 bytes
+    uint8_t frame[BIN_HEADER_SIZE + DECODE_MAX_PAYLOAD + BIN_TRAILER_SIZE];
+    size_t have = 0;
+    size_t need = BIN_HEADER_SIZE;
+    uint32_t bad_crc = 0;
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        uint8_t byte = (uint8_t)c;
+        if (have == 0 && byte != BIN_SYNC_0) {
+            continue;
+        }
+        if (have == 1 && byte != BIN_SYNC_1) {
+            have = byte == BIN_SYNC_0 ? 1 : 0;
+            continue;
+        }
+        frame[have++] = byte;
+        if (have == BIN_HEADER_SIZE) {
+            size_t payload = frame[3] | ((size_t)frame[4] << 8);
+            if (payload > DECODE_MAX_PAYLOAD) {
+                have = 0;
+                continue;
+            }
+            need = BIN_HEADER_SIZE + payload + BIN_TRAILER_SIZE;
+        }
+        if (have >= BIN_HEADER_SIZE && have == need) {
+            size_t payload = need - BIN_OVERHEAD;
+            // El CRC cubre tipo, largo y payload
+            if (bin_crc8(frame + 2, 3 + payload) != frame[need - 1]) {
+                bad_crc++;
+            } else if (frame[2] == BIN_FRAME_TRACE) {
+                handle_payload(frame + BIN_HEADER_SIZE, payload);
+            }
+            have = 0;
+            need = BIN_HEADER_SIZE;
+        }
+    }
+    if (bad_crc > 0) {
+        fprintf(stderr, "%u tramas con CRC invalido\n", bad_crc);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}
@@ -10,6 +10,8 @@
 #define DB_TO_LINEAR(x) powf(10.0f, (x) / 20.0f)
 #define MAX_GAIN_DB 20.0f        // Ganancia máxima permitida en dB
 #define MIN_GAIN_DB -20.0f       // Atenuación máxima permitida en dB
+#define LIMITER_MIN_DB -20.0f    // Umbral mas bajo del limitador
+#define LIMITER_RELEASE_S 0.05f  // Tiempo de recuperacion del limitador
 
 // Coeficientes para filtros IIR simplificados (biquad)
 typedef struct {
@@ -34,9 +36,9 @@ static biquad_filter_t treble_filter_right;
 // Frecuencia de muestreo actual
 static uint32_t current_sample_rate = 44100;
 
-// Buffer temporal para procesar audio
-static uint8_t* temp_buffer = NULL;
-static size_t temp_buffer_size = 0;
+// Limitador de pico enlazado entre canales: ataque instantaneo y recuperacion exponencial
+static float limiter_gain = 1.0f;
+static float limiter_release = 0.0f;
 
 /**
  * @brief Diseña un filtro biquad para un tipo específico
@@ -133,22 +135,18 @@ static void configure_filters(void) {
     // Filtros para agudos (High-pass con corte en 4kHz)
     design_biquad(&treble_filter_left, 2, 4000.0f, 0.707f, 0.0f, current_sample_rate);
     design_biquad(&treble_filter_right, 2, 4000.0f, 0.707f, 0.0f, current_sample_rate);
+
+    limiter_gain = 1.0f;
+    limiter_release = 1.0f - expf(-1.0f / (LIMITER_RELEASE_S * current_sample_rate));
 }
 
 esp_err_t audio_dsp_init(uint32_t sample_rate) {
     ESP_LOGI(TAG, "Inicializando módulo DSP con frecuencia de muestreo: %d Hz", sample_rate);
     
+    // Se procesa en el buffer de salida, sin memoria propia: se puede llamar en cada cambio de frecuencia
     current_sample_rate = sample_rate;
     configure_filters();
     
-    // Inicializar buffer temporal
-    temp_buffer_size = 2048;  // Tamaño arbitrario, ajustar según necesidad
-    temp_buffer = malloc(temp_buffer_size);
-    if (temp_buffer == NULL) {
-        ESP_LOGE(TAG, "No se pudo asignar memoria para el buffer temporal DSP");
-        return ESP_ERR_NO_MEM;
-    }
-    
     return ESP_OK;
 }
 
@@ -161,6 +159,7 @@ void audio_dsp_default_config(dsp_config_t* config) {
         config->separate_channels = false;
         config->left_gain_db = 0.0f;
         config->right_gain_db = 0.0f;
+        config->limiter_threshold_db = 0.0f;  // Sin limitador, solo el recorte a fondo de escala
     }
 }
 
@@ -169,17 +168,6 @@ esp_err_t audio_dsp_process(const uint8_t* input_buffer, uint8_t* output_buffer,
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Asegurar que tenemos suficiente espacio en el buffer temporal
-    if (length > temp_buffer_size) {
-        free(temp_buffer);
-        temp_buffer_size = length;
-        temp_buffer = malloc(temp_buffer_size);
-        if (temp_buffer == NULL) {
-            ESP_LOGE(TAG, "No se pudo redimensionar el buffer temporal DSP");
-            return ESP_ERR_NO_MEM;
-        }
-    }
-    
     // Copiamos el buffer de entrada primero
     memcpy(output_buffer, input_buffer, length);
     
@@ -204,8 +192,18 @@ esp_err_t audio_dsp_process(const uint8_t* input_buffer, uint8_t* output_buffer,
         right_gain = DB_TO_LINEAR(fminf(fmaxf(config->right_gain_db, MIN_GAIN_DB), MAX_GAIN_DB));
     }
     
+    // Umbral del limitador en escala lineal, 0 dB o mas lo desactiva
+    bool limiter_on = config->limiter_threshold_db < 0.0f;
+    float limiter_threshold = DB_TO_LINEAR(fmaxf(config->limiter_threshold_db, LIMITER_MIN_DB));
+    if (!limiter_on) {
+        limiter_gain = 1.0f;
+    }
+    
     // Procesamiento de cada muestra
     for (int i = 0; i < num_samples; i += 2) {
+        float out_left = 0.0f;
+        float out_right = 0.0f;
+        
         // Procesar canal izquierdo (índice par)
         if (i < num_samples) {
             // Convertir de int16 a float para procesamiento
@@ -217,14 +215,7 @@ esp_err_t audio_dsp_process(const uint8_t* input_buffer, uint8_t* output_buffer,
             float treble_out = apply_biquad(&treble_filter_left, sample_left) * treble_gain;
             
             // Sumar las tres bandas
-            float out_left = (bass_out + mid_out + treble_out) * gain * left_gain;
-            
-            // Limitar a [-1.0, 1.0]
-            if (out_left > 1.0f) out_left = 1.0f;
-            if (out_left < -1.0f) out_left = -1.0f;
-            
-            // Convertir de vuelta a int16
-            samples[i] = (int16_t)(out_left * 32767.0f);
+            out_left = (bass_out + mid_out + treble_out) * gain * left_gain;
         }
         
         // Procesar canal derecho (índice impar)
@@ -238,13 +229,31 @@ esp_err_t audio_dsp_process(const uint8_t* input_buffer, uint8_t* output_buffer,
             float treble_out = apply_biquad(&treble_filter_right, sample_right) * treble_gain;
             
             // Sumar las tres bandas
-            float out_right = (bass_out + mid_out + treble_out) * gain * right_gain;
-            
-            // Limitar a [-1.0, 1.0]
+            out_right = (bass_out + mid_out + treble_out) * gain * right_gain;
+        }
+        
+        // Limitador: la misma ganancia en ambos canales para no mover la imagen estereo
+        if (limiter_on) {
+            float peak = fmaxf(fabsf(out_left), fabsf(out_right));
+            float target = peak > limiter_threshold ? limiter_threshold / peak : 1.0f;
+            if (target < limiter_gain) {
+                limiter_gain = target;
+            } else {
+                limiter_gain += (target - limiter_gain) * limiter_release;
+            }
+            out_left *= limiter_gain;
+            out_right *= limiter_gain;
+        }
+        
+        // Limitar a [-1.0, 1.0] y convertir de vuelta a int16
+        if (i < num_samples) {
+            if (out_left > 1.0f) out_left = 1.0f;
+            if (out_left < -1.0f) out_left = -1.0f;
+            samples[i] = (int16_t)(out_left * 32767.0f);
+        }
+        if (i + 1 < num_samples) {
             if (out_right > 1.0f) out_right = 1.0f;
             if (out_right < -1.0f) out_right = -1.0f;
-            
-            // Convertir de vuelta a int16
             samples[i + 1] = (int16_t)(out_right * 32767.0f);
         }
     }
@@ -253,11 +262,6 @@ esp_err_t audio_dsp_process(const uint8_t* input_buffer, uint8_t* output_buffer,
 }
 
 esp_err_t audio_dsp_deinit(void) {
-    if (temp_buffer != NULL) {
-        free(temp_buffer);
-        temp_buffer = NULL;
-        temp_buffer_size = 0;
-    }
-    
+    // Sin memoria dinamica que liberar; se conserva por simetria con audio_dsp_init
     return ESP_OK;
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ typedef struct {
     bool separate_channels;   // Procesar canales independientemente
     float left_gain_db;       // Ganancia específica canal izquierdo
     float right_gain_db;      // Ganancia específica canal derecho
+    float limiter_threshold_db;   // Umbral del limitador en dBFS (-20 a 0), 0 lo desactiva
 } dsp_config_t;
 
 /**
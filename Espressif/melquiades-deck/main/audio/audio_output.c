@@ -1,7 +1,19 @@
 #include "audio_output.h"
 #include "audio_dsp.h"
+#include "audio_probe.h"
 #include "driver/i2s.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/ringbuf.h"
+#include "../boot/boot_profile.h"
+#include "../telemetry/trace_log.h"
+#include "../system/task_table.h"
+#include "../system/event_bus.h"
+#include "../system/mem_track.h"
 
 #define TAG "AUDIO_OUTPUT"
 
@@ -11,13 +23,24 @@
 #define I2S_LRC  5   // Word/LR clock
 
 // Configuración I2S
-#define I2S_NUM           I2S_NUM_0
+#define I2S_NUM           I2S_NUM_1  // I2S0 queda para el DMA del ADC continuo
 #define I2S_SAMPLE_RATE   44100
 #define I2S_BITS_PER_SAMPLE I2S_BITS_PER_SAMPLE_16BIT
 #define I2S_CHANNEL_FORMAT I2S_CHANNEL_FMT_RIGHT_LEFT
 #define I2S_COMM_FORMAT   I2S_COMM_FORMAT_STAND_I2S
 #define DMA_BUF_COUNT     8
 #define DMA_BUF_LEN       64
+#define I2S_EVENT_QUEUE_LEN 16  // Eventos del DMA entre dos bloques (2048 B son 8 buffers)
+
+// Si entre dos bloques pasa mas que esto se considera un nuevo stream, no un underrun
+#define AUDIO_STREAM_GAP_US 500000
+
+// Ring entre el callback A2DP y la tarea I2S (~90 ms a 44.1 kHz estereo 16 bits)
+#define AUDIO_RING_SIZE       (16 * 1024)
+#define AUDIO_CHUNK_BYTES     2048      // Bytes que la tarea I2S toma por bloque
+#define AUDIO_RING_SEND_WAIT_MS 20      // Espera maxima del callback A2DP si el ring esta lleno
+#define AUDIO_IDLE_POLL_MS    100       // Sin datos la tarea I2S revisa cada tanto si la pausaron
+#define AUDIO_STOP_WAIT_MS    500       // Espera de deinit hasta que la tarea I2S suelte el ring
 
 // Buffer para procesamiento DSP
 static uint8_t* dsp_buffer = NULL;
@@ -25,6 +48,24 @@ static size_t dsp_buffer_size = 0;
 static dsp_config_t dsp_config;
 static bool dsp_enabled = true;  // Activar DSP por defecto
 
+// Los contadores de diagnostico viven en audio_probe
+static uint32_t current_sample_rate = I2S_SAMPLE_RATE;
+static int64_t last_write_end_us = 0;
+static QueueHandle_t i2s_event_queue = NULL;
+
+static RingbufHandle_t audio_ring = NULL;
+// Ultimo estado completo de los controles del DSP: cada entrega reemplaza a la anterior y la tarea
+// I2S aplica el que haya entre dos bloques. No hay cola, asi que el ultimo cambio nunca se pierde.
+static audio_output_controls_t pending_controls;
+static bool controls_dirty = false;
+static portMUX_TYPE controls_lock = portMUX_INITIALIZER_UNLOCKED;
+// El ring acepta datos solo entre init y deinit; deinit espera a que salgan los escritores en curso
+static volatile bool audio_accepting = false;
+static uint32_t audio_writers = 0;
+// Frecuencia pedida por A2DP, la aplica la tarea I2S entre bloques (0 = sin cambio pendiente)
+static uint32_t pending_sample_rate = 0;
+static void audio_output_task(void *pvParameters);
+
 static i2s_config_t i2s_config = {
     .mode = I2S_MODE_MASTER | I2S_MODE_TX,
     .sample_rate = I2S_SAMPLE_RATE,
@@ -51,7 +92,8 @@ esp_err_t audio_output_init(void)
     esp_err_t ret;
     
     // Instalar el driver I2S
-    ret = i2s_driver_install(I2S_NUM, &i2s_config, 0, NULL);
+    // Con cola de eventos el driver avisa cada buffer DMA enviado y cada vez que se quedo sin datos
+    ret = i2s_driver_install(I2S_NUM, &i2s_config, I2S_EVENT_QUEUE_LEN, &i2s_event_queue);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install I2S driver: %d", ret);
         return ret;
@@ -89,11 +131,26 @@ esp_err_t audio_output_init(void)
     
     // Inicializar buffer DSP
     dsp_buffer_size = 4096;  // Tamaño inicial, se redimensionará si es necesario
-    dsp_buffer = malloc(dsp_buffer_size);
+    dsp_buffer = MEM_MALLOC(MEM_MOD_AUDIO, dsp_buffer_size);
     if (dsp_buffer == NULL) {
         ESP_LOGE(TAG, "Failed to allocate DSP buffer");
         return ESP_ERR_NO_MEM;
     }
+
+    // Ring de desacople: el callback A2DP solo copia, la tarea I2S procesa y escribe
+    audio_ring = xRingbufferCreate(AUDIO_RING_SIZE, RINGBUF_TYPE_BYTEBUF);
+    if (audio_ring == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate audio ring");
+        return ESP_ERR_NO_MEM;
+    }
+    __atomic_store_n(&audio_accepting, true, __ATOMIC_SEQ_CST);
+
+    // La tarea I2S es estatica y se crea una vez; tras un deinit solo se reanuda
+    if (task_table_create(TASK_AUDIO_I2S, audio_output_task, NULL) == NULL) {
+        ESP_LOGE(TAG, "Failed to create audio task");
+        return ESP_ERR_NO_MEM;
+    }
+    task_table_run(TASK_AUDIO_I2S);
     
     ESP_LOGI(TAG, "I2S initialized successfully with DSP processing");
     ESP_LOGI(TAG, "PCM5102A DAC connected on pins - DOUT: %d, BCLK: %d, LRC: %d", 
@@ -106,6 +163,27 @@ esp_err_t audio_output_init(void)
 esp_err_t audio_output_deinit(void)
 {
     esp_err_t ret;
+
+    // Pausar la tarea I2S antes de liberar el ring: termina el bloque en curso y se estaciona
+    if (!task_table_stop(TASK_AUDIO_I2S, pdMS_TO_TICKS(AUDIO_STOP_WAIT_MS))) {
+        ESP_LOGE(TAG, "Audio task did not stop");
+        return ESP_ERR_TIMEOUT;
+    }
+    // Cerrar la entrada antes de borrar el ring: el callback A2DP puede estar dentro de un envio
+    __atomic_store_n(&audio_accepting, false, __ATOMIC_SEQ_CST);
+    int wait_ms = 0;
+    while (__atomic_load_n(&audio_writers, __ATOMIC_SEQ_CST) > 0 && wait_ms < AUDIO_STOP_WAIT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(AUDIO_RING_SEND_WAIT_MS));
+        wait_ms += AUDIO_RING_SEND_WAIT_MS;
+    }
+    if (__atomic_load_n(&audio_writers, __ATOMIC_SEQ_CST) > 0) {
+        ESP_LOGE(TAG, "Audio writers did not leave the ring");
+        return ESP_ERR_TIMEOUT;
+    }
+    if (audio_ring != NULL) {
+        vRingbufferDelete(audio_ring);
+        audio_ring = NULL;
+    }
     
     // Detener I2S
     ret = i2s_stop(I2S_NUM);
@@ -126,7 +204,7 @@ esp_err_t audio_output_deinit(void)
     
     // Liberar buffer DSP
     if (dsp_buffer != NULL) {
-        free(dsp_buffer);
+        MEM_FREE(dsp_buffer);
         dsp_buffer = NULL;
     }
     
@@ -134,18 +212,52 @@ esp_err_t audio_output_deinit(void)
     return ESP_OK;
 }
 
-esp_err_t audio_output_write(uint8_t* data, size_t length)
+// Vacia la cola de eventos del DMA sin bloquear; al empezar un stream se descartan los de la pausa
+static void audio_output_drain_dma_events(bool discard)
+{
+    i2s_event_t event;
+    if (i2s_event_queue == NULL) {
+        return;
+    }
+    while (xQueueReceive(i2s_event_queue, &event, 0) == pdTRUE) {
+        if (discard) {
+            continue;
+        }
+        if (event.type == I2S_EVENT_TX_DONE) {
+            audio_probe_dma_event(false);
+        } else if (event.type == I2S_EVENT_TX_Q_OVF) {
+            audio_probe_dma_event(true);
+        }
+    }
+}
+
+// Procesa un bloque con DSP y lo escribe al I2S, solo desde la tarea de audio
+static esp_err_t audio_output_write_i2s(uint8_t* data, size_t length)
 {
     size_t bytes_written = 0;
     esp_err_t ret = ESP_OK;
+    uint32_t cycles = 0;
+    bool underrun = false;
+
+    // Si el hueco desde el bloque anterior supera lo que cabe en el DMA, este se vacio (underrun)
+    int64_t now_us = audio_probe_block_start(length);
+    int64_t gap_us = last_write_end_us > 0 ? now_us - last_write_end_us : AUDIO_STREAM_GAP_US;
+    if (gap_us < AUDIO_STREAM_GAP_US) {
+        int64_t dma_us = (int64_t)DMA_BUF_COUNT * DMA_BUF_LEN * 1000000 / current_sample_rate;
+        underrun = gap_us > dma_us;
+        if (underrun) {
+            event_bus_publish_u32(BUS_TOPIC_TELEMETRY, BUS_TELEMETRY_UNDERRUN, (uint32_t)gap_us);
+        }
+    }
+    audio_output_drain_dma_events(gap_us >= AUDIO_STREAM_GAP_US);
     
     // Aplicar DSP si está habilitado
     if (dsp_enabled && data != NULL && length > 0) {
         // Asegurar que tenemos suficiente espacio en el buffer DSP
         if (length > dsp_buffer_size) {
-            free(dsp_buffer);
+            MEM_FREE(dsp_buffer);
             dsp_buffer_size = length;
-            dsp_buffer = malloc(dsp_buffer_size);
+            dsp_buffer = MEM_MALLOC(MEM_MOD_AUDIO, dsp_buffer_size);
             if (dsp_buffer == NULL) {
                 ESP_LOGE(TAG, "Failed to resize DSP buffer");
                 return ESP_ERR_NO_MEM;
@@ -153,47 +265,147 @@ esp_err_t audio_output_write(uint8_t* data, size_t length)
         }
         
         // Procesar audio con DSP
+        uint32_t start_cycles = esp_cpu_get_ccount();
         ret = audio_dsp_process(data, dsp_buffer, length, &dsp_config);
+        cycles = esp_cpu_get_ccount() - start_cycles;
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to process audio with DSP: %d", ret);
             return ret;
         }
         
         // Escribir datos procesados al I2S
+        now_us = esp_timer_get_time();
         ret = i2s_write(I2S_NUM, dsp_buffer, length, &bytes_written, portMAX_DELAY);
     } else {
         // Bypass DSP y escribir directamente al I2S
+        now_us = esp_timer_get_time();
         ret = i2s_write(I2S_NUM, data, length, &bytes_written, portMAX_DELAY);
     }
+    last_write_end_us = esp_timer_get_time();
+    audio_probe_block_done(cycles, now_us, last_write_end_us, ret == ESP_OK && bytes_written != length, underrun);
     
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write to I2S: %d", ret);
         return ret;
     }
     
-    if (bytes_written != length) {
-        ESP_LOGW(TAG, "Bytes written (%d) differs from length specified (%d)", bytes_written, length);
+    if (bytes_written > 0 && boot_profile_mark(BOOT_PHASE_FIRST_SAMPLE)) {
+        ESP_LOGI(TAG, "Primer sample audible a %u ms del arranque",
+                 (uint32_t)(boot_profile_get(BOOT_PHASE_FIRST_SAMPLE) / 1000));
     }
     
     return ESP_OK;
 }
 
-esp_err_t audio_output_set_sample_rate(uint32_t sample_rate)
+esp_err_t audio_output_write(uint8_t* data, size_t length)
 {
+    esp_err_t ret = ESP_OK;
+    if (data == NULL || length == 0) {
+        return ESP_OK;
+    }
+    // Sin ring (antes de init o tras deinit) el paquete se descarta: el I2S y el buffer DSP no existen
+    __atomic_add_fetch(&audio_writers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&audio_accepting, __ATOMIC_SEQ_CST)) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (xRingbufferSend(audio_ring, data, length, pdMS_TO_TICKS(AUDIO_RING_SEND_WAIT_MS)) != pdTRUE) {
+        // Si la tarea I2S no consume a tiempo se descarta el paquete en vez de frenar al stack BT
+        audio_probe_ring_drop();
+        event_bus_publish_u32(BUS_TOPIC_TELEMETRY, BUS_TELEMETRY_RING_DROP, length);
+        ret = ESP_ERR_TIMEOUT;
+    } else {
+        audio_probe_enqueued(length);
+    }
+    __atomic_sub_fetch(&audio_writers, 1, __ATOMIC_SEQ_CST);
+    return ret;
+}
+
+// Cambia la frecuencia del I2S y recalcula los filtros; solo desde la tarea I2S, entre bloques
+static void apply_sample_rate(void)
+{
+    uint32_t sample_rate = __atomic_exchange_n(&pending_sample_rate, 0, __ATOMIC_ACQ_REL);
+    if (sample_rate == 0 || sample_rate == current_sample_rate) {
+        return;
+    }
     esp_err_t ret = i2s_set_sample_rates(I2S_NUM, sample_rate);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set sample rate %d: %d", sample_rate, ret);
-        return ret;
+        return;
     }
-    
-    // Actualizar la frecuencia de muestreo en el DSP
+    current_sample_rate = sample_rate;
     ret = audio_dsp_init(sample_rate);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to update DSP sample rate: %d", ret);
-        return ret;
+        return;
     }
-    
     ESP_LOGI(TAG, "Sample rate set to %d Hz", sample_rate);
+}
+
+void audio_output_post_controls(const audio_output_controls_t *controls)
+{
+    portENTER_CRITICAL(&controls_lock);
+    pending_controls = *controls;
+    __atomic_store_n(&controls_dirty, true, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&controls_lock);
+    // Solo para los contadores del comando bus; el estado no viaja en el evento
+    event_bus_publish_u32(BUS_TOPIC_CONTROL, BUS_CONTROL_DSP, controls->volume);
+}
+
+// Aplica la ultima entrega de controles; solo desde la tarea I2S, antes de procesar un bloque
+static void apply_controls(void)
+{
+    audio_output_controls_t controls;
+    if (!__atomic_load_n(&controls_dirty, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    portENTER_CRITICAL(&controls_lock);
+    controls = pending_controls;
+    controls_dirty = false;
+    portEXIT_CRITICAL(&controls_lock);
+
+    audio_output_enable_dsp(controls.dsp_enabled);
+    audio_output_set_eq(controls.bass_db, controls.mid_db, controls.treble_db);
+    audio_output_set_volume(controls.volume);
+    audio_output_set_channel_balance(controls.left_gain_db, controls.right_gain_db);
+    audio_output_set_limiter(controls.limiter_db);
+}
+
+static void audio_output_task(void *pvParameters)
+{
+    while (1) {
+        task_table_wait_run(TASK_AUDIO_I2S);
+        size_t len = 0;
+        uint8_t *data = xRingbufferReceiveUpTo(audio_ring, &len, pdMS_TO_TICKS(AUDIO_IDLE_POLL_MS),
+                                               AUDIO_CHUNK_BYTES);
+        // Los cambios que llegaron mientras se esperaba valen ya para este bloque
+        apply_sample_rate();
+        apply_controls();
+        if (data == NULL) {
+            continue;
+        }
+        audio_output_write_i2s(data, len);
+        vRingbufferReturnItem(audio_ring, data);
+    }
+}
+
+uint8_t audio_output_get_ring_fill(void)
+{
+    if (audio_ring == NULL) {
+        return 0;
+    }
+    size_t free_bytes = xRingbufferGetCurFreeSize(audio_ring);
+    if (free_bytes >= AUDIO_RING_SIZE) {
+        return 0;
+    }
+    return (uint8_t)((AUDIO_RING_SIZE - free_bytes) * 100 / AUDIO_RING_SIZE);
+}
+
+esp_err_t audio_output_set_sample_rate(uint32_t sample_rate)
+{
+    if (sample_rate == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Se llama desde el callback A2DP: el I2S y los filtros del DSP los cambia la tarea de audio
+    __atomic_store_n(&pending_sample_rate, sample_rate, __ATOMIC_RELEASE);
     return ESP_OK;
 }
 
@@ -217,7 +429,7 @@ void audio_output_set_volume(uint8_t volume_percent)
     // Actualizar configuración DSP
     dsp_config.gain_db = volume_db;
     
-    ESP_LOGI(TAG, "Volume set to %d%% (%.1f dB)", volume_percent, volume_db);
+    TRACE_D(TAG, "Volume set to %d%% (%.1f dB)", volume_percent, volume_db);
 }
 
 // Funciones nuevas para controlar el DSP
@@ -225,7 +437,7 @@ void audio_output_set_volume(uint8_t volume_percent)
 void audio_output_enable_dsp(bool enable)
 {
     dsp_enabled = enable;
-    ESP_LOGI(TAG, "DSP %s", enable ? "enabled" : "disabled");
+    TRACE_D(TAG, "DSP enabled: %d", enable);
 }
 
 void audio_output_set_eq(float bass_db, float mid_db, float treble_db)
@@ -234,7 +446,7 @@ void audio_output_set_eq(float bass_db, float mid_db, float treble_db)
     dsp_config.mid_gain_db = mid_db;
     dsp_config.treble_gain_db = treble_db;
     
-    ESP_LOGI(TAG, "EQ set - Bass: %.1f dB, Mid: %.1f dB, Treble: %.1f dB",
+    TRACE_D(TAG, "EQ set - Bass: %.1f dB, Mid: %.1f dB, Treble: %.1f dB",
              bass_db, mid_db, treble_db);
 }
 
@@ -244,10 +456,20 @@ void audio_output_set_channel_balance(float left_gain_db, float right_gain_db)
     dsp_config.left_gain_db = left_gain_db;
     dsp_config.right_gain_db = right_gain_db;
     
-    ESP_LOGI(TAG, "Channel balance set - Left: %.1f dB, Right: %.1f dB",
+    TRACE_D(TAG, "Channel balance set - Left: %.1f dB, Right: %.1f dB",
              left_gain_db, right_gain_db);
 }
 
+void audio_output_set_limiter(float threshold_db)
+{
+    if (threshold_db > 0.0f) {
+        threshold_db = 0.0f;
+    }
+    dsp_config.limiter_threshold_db = threshold_db;
+    
+    TRACE_D(TAG, "Limiter threshold set to %.1f dB", threshold_db);
+}
+
 void audio_output_reset_dsp(void)
 {
     audio_dsp_default_config(&dsp_config);
@@ -255,4 +477,21 @@ void audio_output_reset_dsp(void)
     dsp_config.separate_channels = false;
     
     ESP_LOGI(TAG, "DSP settings reset to defaults");
+}
+
+void audio_output_get_stats(audio_output_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    audio_probe_totals_t probe;
+    audio_probe_get(&probe);
+    stats->blocks = probe.blocks;
+    stats->underruns = probe.underruns;
+    stats->dsp_cycles_last = probe.dsp_cycles_last;
+    stats->dsp_cycles_avg = probe.dsp_cycles_avg;
+    stats->dsp_cycles_max = probe.dsp_cycles_max;
+    stats->sample_rate = current_sample_rate;
+    stats->ring_fill_pct = audio_output_get_ring_fill();
+    stats->ring_drops = probe.ring_drops;
 }
\ No newline at end of file
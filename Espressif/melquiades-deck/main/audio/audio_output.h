@@ -7,7 +7,29 @@
 #include <stdbool.h>
 #include "esp_err.h"
 
+// Contadores del camino de audio
+typedef struct {
+    uint32_t blocks;            // Bloques escritos al I2S
+    uint32_t underruns;         // Veces que el DMA se quedo sin datos entre bloques
+    uint32_t dsp_cycles_last;   // Ciclos de CPU del ultimo bloque DSP
+    uint32_t dsp_cycles_avg;    // Promedio de ciclos por bloque DSP
+    uint32_t dsp_cycles_max;    // Maximo de ciclos por bloque DSP
+    uint32_t sample_rate;       // Frecuencia de muestreo actual
+    uint8_t ring_fill_pct;      // Ocupacion del ring entre A2DP e I2S
+    uint32_t ring_drops;        // Paquetes descartados por ring lleno
+} audio_output_stats_t;
 
+// Estado completo de los controles del DSP que aplica la tarea I2S
+typedef struct {
+    bool dsp_enabled;
+    uint8_t volume;             // Porcentaje
+    float bass_db;
+    float mid_db;
+    float treble_db;
+    float left_gain_db;         // Balance ya convertido a ganancia por canal
+    float right_gain_db;
+    float limiter_db;
+} audio_output_controls_t;
 
 /**
  * @brief Inicializa el sistema de audio I2S para el DAC PCM5102A
@@ -24,19 +46,39 @@ esp_err_t audio_output_init(void);
 esp_err_t audio_output_deinit(void);
 
 /**
- * @brief Escribe datos de audio al DAC PCM5102A a través de I2S
+ * @brief Encola datos de audio hacia el DAC PCM5102A
+ *
+ * Los datos se copian al ring de audio y la tarea I2S aplica el DSP y los escribe.
  * 
  * @param data Puntero a los datos de audio
  * @param length Longitud de los datos en bytes
- * @return esp_err_t ESP_OK si la escritura es exitosa
+ * @return esp_err_t ESP_OK si se encolaron, ESP_ERR_TIMEOUT si el ring estaba lleno,
+ *         ESP_ERR_INVALID_STATE si la salida no esta inicializada (los datos se descartan)
  */
 esp_err_t audio_output_write(uint8_t* data, size_t length);
 
 /**
- * @brief Establece la tasa de muestreo para la salida de audio
+ * @brief Entrega el estado completo de los controles del DSP a la tarea I2S
+ *
+ * Reemplaza cualquier entrega que todavia no se aplico; la tarea I2S aplica la ultima entre dos
+ * bloques. Se puede llamar desde cualquier tarea, no bloquea.
+ */
+void audio_output_post_controls(const audio_output_controls_t *controls);
+
+/**
+ * @brief Ocupacion actual del ring de audio
+ *
+ * @return uint8_t Porcentaje de 0 a 100
+ */
+uint8_t audio_output_get_ring_fill(void);
+
+/**
+ * @brief Pide un cambio de tasa de muestreo para la salida de audio
+ *
+ * La tarea I2S aplica el cambio al I2S y al DSP entre dos bloques; si llegan varios vale el ultimo.
  * 
  * @param sample_rate Tasa de muestreo en Hz (por ejemplo, 44100, 48000)
- * @return esp_err_t ESP_OK si el cambio es exitoso
+ * @return esp_err_t ESP_OK si el cambio quedo pendiente, ESP_ERR_INVALID_ARG con 0
  */
 esp_err_t audio_output_set_sample_rate(uint32_t sample_rate);
 
@@ -71,9 +113,23 @@ void audio_output_set_eq(float bass_db, float mid_db, float treble_db);
  */
 void audio_output_set_channel_balance(float left_gain_db, float right_gain_db);
 
+/**
+ * @brief Configura el umbral del limitador de pico
+ * 
+ * @param threshold_db Umbral en dBFS (-20 a 0), 0 desactiva el limitador
+ */
+void audio_output_set_limiter(float threshold_db);
+
 /**
  * @brief Restablece la configuración DSP a valores por defecto
  */
 void audio_output_reset_dsp(void);
 
+/**
+ * @brief Obtiene una copia de los contadores del camino de audio
+ * 
+ * @param stats Estructura donde se copian los contadores
+ */
+void audio_output_get_stats(audio_output_stats_t* stats);
+
 #endif // AUDIO_OUTPUT_H
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "audio_probe.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "../shell/bin_protocol.h"
+
+// Instante de llegada de un paquete y total de bytes encolados al terminar de copiarlo
+typedef struct {
+    uint32_t end_bytes;
+    uint32_t entry_us;
+} audio_probe_stamp_t;
+
+static audio_probe_core_t cores[AUDIO_PROBE_CORES];
+
+// Cola de un productor (callback A2DP) y un consumidor (tarea I2S) para los instantes de
+// llegada; si se llena se pierde la muestra de latencia, nunca el audio
+static audio_probe_stamp_t stamps[AUDIO_PROBE_STAMP_SLOTS];
+static uint32_t stamp_head = 0;     // Solo la escribe el productor
+static uint32_t stamp_tail = 0;     // Solo la escribe el consumidor
+static uint32_t enqueued_bytes = 0;
+static uint32_t dequeued_bytes = 0;
+static int64_t entry_us = 0;        // Entrada al callback del paquete en curso
+
+static audio_probe_core_t *this_core(void)
+{
+    BaseType_t core = xPortGetCoreID();
+    return &cores[core < AUDIO_PROBE_CORES ? core : 0];
+}
+
+static int hist_bucket(uint32_t us)
+{
+    uint32_t steps = us / AUDIO_PROBE_HIST_MIN_US;
+    int bucket = steps == 0 ? 0 : 32 - __builtin_clz(steps);
+    return bucket < AUDIO_PROBE_HIST_BUCKETS ? bucket : AUDIO_PROBE_HIST_BUCKETS - 1;
+}
+
+void audio_probe_a2dp_entry(uint32_t len)
+{
+    audio_probe_core_t *c = this_core();
+    entry_us = esp_timer_get_time();
+    c->packets++;
+    c->packet_bytes += len;
+}
+
+void audio_probe_enqueued(uint32_t len)
+{
+    int64_t t = entry_us != 0 ? entry_us : esp_timer_get_time();
+    entry_us = 0;
+    enqueued_bytes += len;
+    uint32_t head = stamp_head;
+    uint32_t next = (head + 1) % AUDIO_PROBE_STAMP_SLOTS;
+    if (next == __atomic_load_n(&stamp_tail, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    stamps[head].end_bytes = enqueued_bytes;
+    stamps[head].entry_us = (uint32_t)t;
+    __atomic_store_n(&stamp_head, next, __ATOMIC_RELEASE);
+}
+
+void audio_probe_ring_drop(void)
+{
+    entry_us = 0;
+    this_core()->ring_drops++;
+}
+
+int64_t audio_probe_block_start(uint32_t len)
+{
+    int64_t now = esp_timer_get_time();
+    audio_probe_core_t *c = this_core();
+    dequeued_bytes += len;
+    // Cada paquete que termina dentro de este bloque espero desde su llegada hasta ahora
+    uint32_t tail = stamp_tail;
+    while (tail != __atomic_load_n(&stamp_head, __ATOMIC_ACQUIRE) &&
+           (int32_t)(stamps[tail].end_bytes - dequeued_bytes) <= 0) {
+        uint32_t waited = (uint32_t)now - stamps[tail].entry_us;
+        c->queue_hist[hist_bucket(waited)]++;
+        if (waited > c->queue_max_us) {
+            c->queue_max_us = waited;
+        }
+        tail = (tail + 1) % AUDIO_PROBE_STAMP_SLOTS;
+    }
+    __atomic_store_n(&stamp_tail, tail, __ATOMIC_RELEASE);
+    return now;
+}
+
+void audio_probe_block_done(uint32_t dsp_cycles, int64_t dsp_end_us, int64_t write_end_us,
+                            bool short_write, bool underrun)
+{
+    audio_probe_core_t *c = this_core();
+    // Los campos de 64 bits no se leen de una vez en el ESP32: el lector reintenta si seq cambia
+    __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    c->blocks++;
+    if (dsp_cycles > 0) {
+        c->dsp_blocks++;
+        c->dsp_cycles_total += dsp_cycles;
+        c->dsp_cycles_last = dsp_cycles;
+        if (dsp_cycles < c->dsp_cycles_min || c->dsp_blocks == 1) {
+            c->dsp_cycles_min = dsp_cycles;
+        }
+        if (dsp_cycles > c->dsp_cycles_max) {
+            c->dsp_cycles_max = dsp_cycles;
+        }
+    }
+    c->short_writes += short_write;
+    c->underruns += underrun;
+    c->write_hist[hist_bucket((uint32_t)(write_end_us - dsp_end_us))]++;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELEASE);
+}
+
+void audio_probe_dma_event(bool late)
+{
+    audio_probe_core_t *c = this_core();
+    if (late) {
+        c->dma_late++;
+    } else {
+        c->dma_done++;
+    }
+}
+
+// Copia un nucleo sin frenar al escritor: se repite si un bloque se actualizo en el medio
+static void read_core(int core, audio_probe_core_t *copy)
+{
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&cores[core].seq, __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        memcpy(copy, (const void *)&cores[core], sizeof(*copy));
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    } while ((seq & 1) != 0 || seq != __atomic_load_n(&cores[core].seq, __ATOMIC_ACQUIRE));
+}
+
+void audio_probe_get(audio_probe_totals_t *totals)
+{
+    uint64_t cycles = 0;
+    memset(totals, 0, sizeof(*totals));
+    for (int core = 0; core < AUDIO_PROBE_CORES; core++) {
+        audio_probe_core_t c;
+        read_core(core, &c);
+        totals->packets += c.packets;
+        totals->packet_bytes += c.packet_bytes;
+        totals->ring_drops += c.ring_drops;
+        totals->blocks += c.blocks;
+        if (c.dsp_blocks > 0 && (totals->dsp_blocks == 0 || c.dsp_cycles_min < totals->dsp_cycles_min)) {
+            totals->dsp_cycles_min = c.dsp_cycles_min;
+        }
+        if (c.dsp_blocks > 0) {
+            totals->dsp_cycles_last = c.dsp_cycles_last;
+        }
+        totals->dsp_blocks += c.dsp_blocks;
+        cycles += c.dsp_cycles_total;
+        if (c.dsp_cycles_max > totals->dsp_cycles_max) {
+            totals->dsp_cycles_max = c.dsp_cycles_max;
+        }
+        totals->short_writes += c.short_writes;
+        totals->underruns += c.underruns;
+        totals->dma_done += c.dma_done;
+        totals->dma_late += c.dma_late;
+        if (c.queue_max_us > totals->queue_max_us) {
+            totals->queue_max_us = c.queue_max_us;
+        }
+        for (int b = 0; b < AUDIO_PROBE_HIST_BUCKETS; b++) {
+            totals->queue_hist[b] += c.queue_hist[b];
+            totals->write_hist[b] += c.write_hist[b];
+        }
+    }
+    totals->dsp_cycles_avg = totals->dsp_blocks > 0 ? (uint32_t)(cycles / totals->dsp_blocks) : 0;
+}
+
+void audio_probe_reset(void)
+{
+    for (int core = 0; core < AUDIO_PROBE_CORES; core++) {
+        uint32_t seq = cores[core].seq;
+        memset(&cores[core], 0, sizeof(cores[core]));
+        // seq se conserva par para que un lector en curso no quede esperando
+        cores[core].seq = seq & ~1u;
+    }
+}
+
+static size_t format_hist(const char *label, const uint32_t *hist, char *out, size_t size)
+{
+    size_t len = 0;
+    int n = snprintf(out, size, "%s:", label);
+    len = n > 0 ? (size_t)n : 0;
+    for (int b = 0; b < AUDIO_PROBE_HIST_BUCKETS && len < size; b++) {
+        uint32_t edge_us = (uint32_t)AUDIO_PROBE_HIST_MIN_US << b;
+        if (b == AUDIO_PROBE_HIST_BUCKETS - 1) {
+            n = snprintf(out + len, size - len, " >=%ums %u", (unsigned)(edge_us / 2000), hist[b]);
+        } else if (edge_us < 1000) {
+            n = snprintf(out + len, size - len, " <%uus %u", (unsigned)edge_us, hist[b]);
+        } else {
+            n = snprintf(out + len, size - len, " <%ums %u", (unsigned)(edge_us / 1000), hist[b]);
+        }
+        len += n > 0 ? (size_t)n : 0;
+    }
+    if (len < size) {
+        n = snprintf(out + len, size - len, "\n");
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len;
+}
+
+size_t audio_probe_format_text(const audio_probe_totals_t *t, char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+
+#define APPEND(...) do { \
+        if (len < size) { \
+            n = snprintf(out + len, size - len, __VA_ARGS__); \
+            if (n > 0) len += (size_t)n; \
+        } \
+    } while (0)
+
+    APPEND("A2DP: %u paquetes, %u bytes, %u descartados por ring lleno\n",
+           t->packets, t->packet_bytes, t->ring_drops);
+    APPEND("DSP: %u bloques, ciclos min %u prom %u max %u ultimo %u (%u us prom a %d MHz)\n",
+           t->dsp_blocks, t->dsp_cycles_min, t->dsp_cycles_avg, t->dsp_cycles_max, t->dsp_cycles_last,
+           t->dsp_cycles_avg / CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ, CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ);
+    APPEND("I2S: %u bloques, %u escrituras cortas, %u underruns, DMA %u buffers %u tarde\n",
+           t->blocks, t->short_writes, t->underruns, t->dma_done, t->dma_late);
+    APPEND("Cola max: %u.%03u ms\n", t->queue_max_us / 1000, t->queue_max_us % 1000);
+    if (len < size) {
+        len += format_hist("Cola (llegada -> DSP)", t->queue_hist, out + len, size - len);
+    }
+    if (len < size) {
+        len += format_hist("Escritura (DSP -> I2S)", t->write_hist, out + len, size - len);
+    }
+
+#undef APPEND
+
+    return len < size ? len : size - 1;
+}
+
+size_t audio_probe_encode_binary(const audio_probe_totals_t *t, uint8_t *out, size_t size)
+{
+    uint8_t payload[1 + 14 * 4 + 2 * AUDIO_PROBE_HIST_BUCKETS * 4];
+    uint8_t *p = payload;
+    p = bin_put_u8(p, AUDIO_PROBE_BIN_VERSION);
+    p = bin_put_u32(p, (uint32_t)(esp_timer_get_time() / 1000));
+    p = bin_put_u32(p, t->packets);
+    p = bin_put_u32(p, t->packet_bytes);
+    p = bin_put_u32(p, t->ring_drops);
+    p = bin_put_u32(p, t->blocks);
+    p = bin_put_u32(p, t->dsp_blocks);
+    p = bin_put_u32(p, t->dsp_cycles_min);
+    p = bin_put_u32(p, t->dsp_cycles_avg);
+    p = bin_put_u32(p, t->dsp_cycles_max);
+    p = bin_put_u32(p, t->short_writes);
+    p = bin_put_u32(p, t->underruns);
+    p = bin_put_u32(p, t->dma_done);
+    p = bin_put_u32(p, t->dma_late);
+    p = bin_put_u32(p, t->queue_max_us);
+    for (int b = 0; b < AUDIO_PROBE_HIST_BUCKETS; b++) {
+        p = bin_put_u32(p, t->queue_hist[b]);
+    }
+    for (int b = 0; b < AUDIO_PROBE_HIST_BUCKETS; b++) {
+        p = bin_put_u32(p, t->write_hist[b]);
+    }
+    return bin_frame_encode(BIN_FRAME_AUDIO, payload, (uint16_t)(p - payload), out, size);
+}
@@ -0,0 +1,133 @@
+#ifndef AUDIO_PROBE_H
+#define AUDIO_PROBE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Instrumentacion del camino A2DP -> ring -> DSP -> I2S. Cada nucleo escribe solo su juego de
+// contadores y cada campo tiene un unico escritor (callback A2DP en el nucleo del stack BT,
+// tarea I2S en el suyo), asi que no hay candados en el camino de audio; la lectura suma ambos.
+
+#define AUDIO_PROBE_CORES       2
+#define AUDIO_PROBE_HIST_BUCKETS 12     // Potencias de dos desde AUDIO_PROBE_HIST_MIN_US
+#define AUDIO_PROBE_HIST_MIN_US 256     // Cubeta 0: < 256 us, cubeta n: < 256 << n us, la ultima abierta
+#define AUDIO_PROBE_STAMP_SLOTS 32      // Paquetes en el ring con su instante de llegada
+
+// Version del payload binario BIN_FRAME_AUDIO
+#define AUDIO_PROBE_BIN_VERSION 1
+
+// Contadores de un nucleo
+typedef struct {
+    // Callback A2DP
+    uint32_t packets;           // Entradas al callback
+    uint32_t packet_bytes;
+    uint32_t ring_drops;        // Paquetes descartados por ring lleno
+    // Tarea I2S
+    uint32_t seq;               // Impar mientras se actualiza un bloque
+    uint32_t blocks;            // Bloques escritos al I2S
+    uint32_t dsp_blocks;
+    uint64_t dsp_cycles_total;
+    uint32_t dsp_cycles_min;
+    uint32_t dsp_cycles_max;
+    uint32_t dsp_cycles_last;
+    uint32_t short_writes;      // i2s_write devolvio menos bytes que los pedidos
+    uint32_t underruns;         // Hueco entre bloques mayor a lo que cubre el DMA
+    uint32_t dma_done;          // Buffers DMA enviados (I2S_EVENT_TX_DONE)
+    uint32_t dma_late;          // El DMA se quedo sin datos y repitio silencio (I2S_EVENT_TX_Q_OVF)
+    uint32_t queue_max_us;      // Peor espera en cola
+    uint32_t queue_hist[AUDIO_PROBE_HIST_BUCKETS];  // Entrada al callback -> inicio del DSP
+    uint32_t write_hist[AUDIO_PROBE_HIST_BUCKETS];  // Fin del DSP -> retorno de i2s_write
+} audio_probe_core_t;
+
+// Suma de ambos nucleos
+typedef struct {
+    uint32_t packets;
+    uint32_t packet_bytes;
+    uint32_t ring_drops;
+    uint32_t blocks;
+    uint32_t dsp_blocks;
+    uint32_t dsp_cycles_min;    // 0 sin bloques
+    uint32_t dsp_cycles_avg;
+    uint32_t dsp_cycles_max;
+    uint32_t dsp_cycles_last;
+    uint32_t short_writes;
+    uint32_t underruns;
+    uint32_t dma_done;
+    uint32_t dma_late;
+    uint32_t queue_max_us;      // Peor latencia de cola observada
+    uint32_t queue_hist[AUDIO_PROBE_HIST_BUCKETS];
+    uint32_t write_hist[AUDIO_PROBE_HIST_BUCKETS];
+} audio_probe_totals_t;
+
+/**
+ * @brief Entrada al callback de datos A2DP: cuenta el paquete y guarda el instante
+ */
+void audio_probe_a2dp_entry(uint32_t len);
+
+/**
+ * @brief El paquete de la ultima entrada quedo en el ring
+ *
+ * Asocia el instante de llegada con el total de bytes encolados para medir la cola cuando
+ * la tarea I2S los consuma. Sin entrada previa (tono de prueba) se usa el instante actual.
+ */
+void audio_probe_enqueued(uint32_t len);
+
+/**
+ * @brief El ring estaba lleno y se descarto el paquete
+ */
+void audio_probe_ring_drop(void);
+
+/**
+ * @brief La tarea I2S saco len bytes del ring y empieza el DSP
+ *
+ * @return int64_t Instante de inicio, para audio_probe_block_done
+ */
+int64_t audio_probe_block_start(uint32_t len);
+
+/**
+ * @brief Cierra un bloque: ciclos del DSP (0 si se salteo), fin del DSP y retorno de i2s_write
+ *
+ * @param dsp_cycles Ciclos de CPU dentro de audio_dsp_process
+ * @param dsp_end_us Instante en que termino el DSP
+ * @param write_end_us Instante en que retorno i2s_write
+ * @param short_write true si se escribieron menos bytes que los pedidos
+ * @param underrun true si el DMA se vacio desde el bloque anterior
+ */
+void audio_probe_block_done(uint32_t dsp_cycles, int64_t dsp_end_us, int64_t write_end_us,
+                            bool short_write, bool underrun);
+
+/**
+ * @brief Evento del DMA de salida leido de la cola del driver I2S
+ *
+ * @param late true para I2S_EVENT_TX_Q_OVF, false para I2S_EVENT_TX_DONE
+ */
+void audio_probe_dma_event(bool late);
+
+/**
+ * @brief Suma los contadores de ambos nucleos
+ */
+void audio_probe_get(audio_probe_totals_t *totals);
+
+/**
+ * @brief Pone todos los contadores en cero
+ *
+ * Lo llama el shell; un bloque en curso puede quedar contado a medias.
+ */
+void audio_probe_reset(void);
+
+/**
+ * @brief Formatea los contadores e histogramas como texto para el shell
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t audio_probe_format_text(const audio_probe_totals_t *totals, char *out, size_t size);
+
+/**
+ * @brief Codifica los contadores como trama binaria BIN_FRAME_AUDIO
+ *
+ * @return size_t Bytes escritos en out, 0 si no cabe
+ */
+size_t audio_probe_encode_binary(const audio_probe_totals_t *totals, uint8_t *out, size_t size);
+
+#endif // AUDIO_PROBE_H
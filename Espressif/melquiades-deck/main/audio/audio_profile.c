@@ -0,0 +1,313 @@
+#include "audio_profile.h"
+//Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+//bibliotecas custom
+#include "../system/task_table.h"
+
+#define TAG "AUDIO_PROFILE"
+
+#define PROFILE_NVS_NAMESPACE   "audio_prof"
+#define PROFILE_NVS_ACTIVE      "active"
+#define PROFILE_VERSION         1       // 0 marca un perfil vacio
+#define PROFILE_NO_ACTIVE       0xFF
+
+// Registro tal como queda en NVS, una clave por perfil
+typedef struct {
+    uint8_t version;
+    uint8_t reserved[3];
+    char name[AUDIO_PROFILE_NAME_LEN];
+    audio_profile_settings_t settings;
+} profile_record_t;
+
+_Static_assert(sizeof(profile_record_t) == 40, "profile_record_t cambio de tamano, suba PROFILE_VERSION");
+
+static profile_record_t profiles[AUDIO_PROFILE_COUNT];  // Contenido vigente
+static profile_record_t stored[AUDIO_PROFILE_COUNT];    // Lo que hay en flash
+static uint8_t active = 0;
+static uint8_t stored_active = PROFILE_NO_ACTIVE;
+static bool loaded = false;
+static bool pending = false;
+static int64_t first_change_us = 0;     // Primer cambio sin escribir
+static int64_t last_change_us = 0;
+static uint32_t write_count = 0;        // Claves escritas
+static uint32_t skip_count = 0;         // Escrituras evitadas porque la flash ya tenia lo mismo
+static uint32_t error_count = 0;
+static portMUX_TYPE profile_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void profile_key(int index, char key[4])
+{
+    key[0] = 'p';
+    key[1] = (char)('0' + index);
+    key[2] = '\0';
+}
+
+// Un perfil leido de flash solo se aplica si sus valores estan dentro de lo que aceptan los setters
+static bool settings_valid(const audio_profile_settings_t *s)
+{
+    return s->volume <= 100 &&
+           isfinite(s->bass_db) && isfinite(s->mid_db) && isfinite(s->treble_db) &&
+           s->balance >= -1.0f && s->balance <= 1.0f &&
+           s->limiter_db >= -20.0f && s->limiter_db <= 0.0f;
+}
+
+static void record_init(profile_record_t *rec, const char *name, const audio_profile_settings_t *settings)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->version = PROFILE_VERSION;
+    snprintf(rec->name, sizeof(rec->name), "%s", name);
+    rec->settings = *settings;
+}
+
+// Llamar con profile_lock tomado; devuelve true si hay que despertar a la tarea
+static bool mark_pending(void)
+{
+    int64_t now = esp_timer_get_time();
+    last_change_us = now;
+    if (pending) {
+        return false;
+    }
+    pending = true;
+    first_change_us = now;
+    return true;
+}
+
+static void wake_writer(void)
+{
+    TaskHandle_t handle = task_table_handle(TASK_AUDIO_PROFILE);
+    if (handle != NULL) {
+        xTaskNotifyGive(handle);
+    }
+}
+
+bool audio_profile_load_active(audio_profile_settings_t *settings)
+{
+    nvs_handle_t handle;
+    bool restored = false;
+    memset(stored, 0, sizeof(stored));
+    stored_active = PROFILE_NO_ACTIVE;
+    if (nvs_open(PROFILE_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        for (int i = 0; i < AUDIO_PROFILE_COUNT; i++) {
+            char key[4];
+            size_t len = sizeof(stored[i]);
+            profile_key(i, key);
+            esp_err_t ret = nvs_get_blob(handle, key, &stored[i], &len);
+            if (ret != ESP_OK || len != sizeof(stored[i]) || stored[i].version != PROFILE_VERSION ||
+                !settings_valid(&stored[i].settings)) {
+                if (ret == ESP_OK) {
+                    ESP_LOGW(TAG, "Perfil %d en NVS invalido, se descarta", i);
+                }
+                memset(&stored[i], 0, sizeof(stored[i]));
+            }
+            stored[i].name[AUDIO_PROFILE_NAME_LEN - 1] = '\0';
+        }
+        uint8_t index = PROFILE_NO_ACTIVE;
+        size_t len = sizeof(index);
+        if (nvs_get_blob(handle, PROFILE_NVS_ACTIVE, &index, &len) == ESP_OK && len == sizeof(index) &&
+            index < AUDIO_PROFILE_COUNT) {
+            stored_active = index;
+        }
+        nvs_close(handle);
+    }
+
+    portENTER_CRITICAL(&profile_lock);
+    memcpy(profiles, stored, sizeof(profiles));
+    active = stored_active != PROFILE_NO_ACTIVE ? stored_active : 0;
+    if (profiles[active].version == PROFILE_VERSION) {
+        *settings = profiles[active].settings;
+        restored = true;
+    } else {
+        // Sin perfil guardado: los valores de fabrica quedan en el perfil 0 y se escriben con el primer cambio
+        active = 0;
+        record_init(&profiles[0], "inicial", settings);
+    }
+    loaded = true;
+    portEXIT_CRITICAL(&profile_lock);
+
+    if (restored) {
+        ESP_LOGI(TAG, "Perfil %u (%s) restaurado", active, profiles[active].name);
+    }
+    return restored;
+}
+
+void audio_profile_changed(const audio_profile_settings_t *settings)
+{
+    bool wake = false;
+    portENTER_CRITICAL(&profile_lock);
+    // Antes de la carga el estado del DSP se va a reemplazar por el perfil guardado
+    if (loaded && memcmp(&profiles[active].settings, settings, sizeof(*settings)) != 0) {
+        profiles[active].settings = *settings;
+        wake = mark_pending();
+    }
+    portEXIT_CRITICAL(&profile_lock);
+    if (wake) {
+        wake_writer();
+    }
+}
+
+esp_err_t audio_profile_select(int index, audio_profile_settings_t *settings)
+{
+    if (index < 0 || index >= AUDIO_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bool wake = false;
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&profile_lock);
+    if (profiles[index].version != PROFILE_VERSION) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else {
+        *settings = profiles[index].settings;
+        if (active != index) {
+            active = (uint8_t)index;
+            wake = mark_pending();
+        }
+    }
+    portEXIT_CRITICAL(&profile_lock);
+    if (wake) {
+        wake_writer();
+    }
+    return ret;
+}
+
+esp_err_t audio_profile_save_as(int index, const char *name, const audio_profile_settings_t *settings)
+{
+    if (index < 0 || index >= AUDIO_PROFILE_COUNT || name == NULL || name[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&profile_lock);
+    record_init(&profiles[index], name, settings);
+    active = (uint8_t)index;
+    bool wake = mark_pending();
+    portEXIT_CRITICAL(&profile_lock);
+    if (wake) {
+        wake_writer();
+    }
+    return ESP_OK;
+}
+
+// Escribe solo las claves que difieren de la flash y hace un unico commit
+static void flush(void)
+{
+    profile_record_t snapshot[AUDIO_PROFILE_COUNT];
+    uint8_t snapshot_active;
+    int changed = 0;
+    portENTER_CRITICAL(&profile_lock);
+    memcpy(snapshot, profiles, sizeof(snapshot));
+    snapshot_active = active;
+    pending = false;
+    portEXIT_CRITICAL(&profile_lock);
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(PROFILE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        for (int i = 0; i < AUDIO_PROFILE_COUNT && ret == ESP_OK; i++) {
+            if (snapshot[i].version != PROFILE_VERSION || memcmp(&snapshot[i], &stored[i], sizeof(stored[i])) == 0) {
+                continue;
+            }
+            char key[4];
+            profile_key(i, key);
+            ret = nvs_set_blob(handle, key, &snapshot[i], sizeof(snapshot[i]));
+            if (ret == ESP_OK) {
+                stored[i] = snapshot[i];
+                changed++;
+            }
+        }
+        if (ret == ESP_OK && snapshot_active != stored_active) {
+            ret = nvs_set_blob(handle, PROFILE_NVS_ACTIVE, &snapshot_active, sizeof(snapshot_active));
+            if (ret == ESP_OK) {
+                stored_active = snapshot_active;
+                changed++;
+            }
+        }
+        if (ret == ESP_OK && changed > 0) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    if (ret != ESP_OK) {
+        // Se reintenta despues de otra espera completa
+        ESP_LOGE(TAG, "No se pudieron guardar los perfiles: %s", esp_err_to_name(ret));
+        error_count++;
+        portENTER_CRITICAL(&profile_lock);
+        mark_pending();
+        portEXIT_CRITICAL(&profile_lock);
+    } else if (changed > 0) {
+        write_count += (uint32_t)changed;
+    } else {
+        skip_count++;
+    }
+}
+
+void audio_profile_task(void *pvParameters)
+{
+    while (1) {
+        portENTER_CRITICAL(&profile_lock);
+        bool is_pending = pending;
+        int64_t due_us = last_change_us + (int64_t)AUDIO_PROFILE_DEBOUNCE_MS * 1000;
+        int64_t limit_us = first_change_us + (int64_t)AUDIO_PROFILE_MAX_DELAY_MS * 1000;
+        portEXIT_CRITICAL(&profile_lock);
+
+        if (!is_pending) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        // Cada cambio corre el plazo; la espera se recalcula al despertar
+        if (limit_us < due_us) {
+            due_us = limit_us;
+        }
+        int64_t now_us = esp_timer_get_time();
+        if (now_us < due_us) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((due_us - now_us) / 1000) + 1);
+            continue;
+        }
+        flush();
+    }
+}
+
+size_t audio_profile_format(char *out, size_t size)
+{
+    profile_record_t snapshot[AUDIO_PROFILE_COUNT];
+    uint8_t snapshot_active;
+    bool is_pending;
+    size_t len = 0;
+    int n;
+    if (size == 0) {
+        return 0;
+    }
+    portENTER_CRITICAL(&profile_lock);
+    memcpy(snapshot, profiles, sizeof(snapshot));
+    snapshot_active = active;
+    is_pending = pending;
+    portEXIT_CRITICAL(&profile_lock);
+
+    n = snprintf(out, size, "Perfil activo: %u, cambios pendientes de escribir: %s\n"
+                 " #  nombre       dsp  vol eq graves medios agudos balance limit  flash\n",
+                 snapshot_active, is_pending ? "si" : "no");
+    len = n > 0 && (size_t)n < size ? (size_t)n : 0;
+    for (int i = 0; i < AUDIO_PROFILE_COUNT && len < size; i++) {
+        const profile_record_t *rec = &snapshot[i];
+        const audio_profile_settings_t *s = &rec->settings;
+        if (rec->version != PROFILE_VERSION) {
+            n = snprintf(out + len, size - len, " %d  (vacio)\n", i);
+        } else {
+            n = snprintf(out + len, size - len, "%c%d  %-11s  %-3s %4u %2u %6.1f %6.1f %6.1f %7.2f %5.1f  %s\n",
+                         i == snapshot_active ? '*' : ' ', i, rec->name, s->enabled ? "si" : "no", s->volume,
+                         s->eq_preset, s->bass_db, s->mid_db, s->treble_db, s->balance, s->limiter_db,
+                         memcmp(rec, &stored[i], sizeof(*rec)) == 0 ? "si" : "no");
+        }
+        len += n > 0 ? (size_t)n : 0;
+    }
+    if (len < size) {
+        n = snprintf(out + len, size - len, "Escrituras: %u claves, evitadas sin cambios: %u, errores: %u\n",
+                     write_count, skip_count, error_count);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
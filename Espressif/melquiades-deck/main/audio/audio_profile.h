@@ -0,0 +1,78 @@
+#ifndef AUDIO_PROFILE_H
+#define AUDIO_PROFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Perfiles de audio con nombre en NVS. El perfil activo sigue al estado del DSP: cada cambio
+// marca el perfil como pendiente y una tarea de baja prioridad lo escribe cuando los controles
+// dejan de moverse, asi girar un pot no escribe la flash en cada muestra. Antes de escribir se
+// compara con lo que ya esta en flash y si no cambio nada no se escribe.
+
+#define AUDIO_PROFILE_COUNT         4
+#define AUDIO_PROFILE_NAME_LEN      12      // Con el terminador
+#define AUDIO_PROFILE_DEBOUNCE_MS   3000    // Quietud de los controles antes de escribir
+#define AUDIO_PROFILE_MAX_DELAY_MS  30000   // Con los controles siempre en movimiento, se escribe igual
+
+// Estado completo del DSP que se guarda en un perfil
+typedef struct {
+    bool enabled;
+    uint8_t eq_preset;      // eq_preset_t
+    uint8_t volume;         // Porcentaje
+    uint8_t reserved;
+    float bass_db;          // Ganancias activas del EQ (preset o personalizadas)
+    float mid_db;
+    float treble_db;
+    float balance;          // -1.0 (izq) a 1.0 (der)
+    float limiter_db;       // Umbral del limitador, 0 lo desactiva
+} audio_profile_settings_t;
+
+/**
+ * @brief Lee los perfiles de NVS y copia el activo en settings
+ *
+ * Se llama al iniciar el audio, antes del primer bloque. Si no hay perfil guardado settings
+ * queda como esta y pasa a ser el contenido inicial del perfil 0.
+ *
+ * @param settings Valores por defecto a la entrada, perfil activo a la salida
+ * @return true si se restauro un perfil guardado
+ */
+bool audio_profile_load_active(audio_profile_settings_t *settings);
+
+/**
+ * @brief Avisa que cambio el estado del DSP; copia settings en el perfil activo y agenda la escritura
+ *
+ * No toca la flash, se puede llamar en cada paso de un pot.
+ */
+void audio_profile_changed(const audio_profile_settings_t *settings);
+
+/**
+ * @brief Cambia el perfil activo y devuelve su contenido
+ *
+ * @param index Perfil de 0 a AUDIO_PROFILE_COUNT - 1
+ * @param settings Contenido del perfil
+ * @return esp_err_t ESP_ERR_NOT_FOUND si el perfil esta vacio
+ */
+esp_err_t audio_profile_select(int index, audio_profile_settings_t *settings);
+
+/**
+ * @brief Guarda settings en un perfil con nombre y lo deja activo
+ *
+ * @param name Nombre, se recorta a AUDIO_PROFILE_NAME_LEN - 1 caracteres
+ */
+esp_err_t audio_profile_save_as(int index, const char *name, const audio_profile_settings_t *settings);
+
+/**
+ * @brief Tarea que escribe los perfiles pendientes; se crea desde la tabla de tareas
+ */
+void audio_profile_task(void *pvParameters);
+
+/**
+ * @brief Formatea los perfiles, el activo, lo pendiente y las escrituras hechas y evitadas
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t audio_profile_format(char *out, size_t size);
+
+#endif // AUDIO_PROFILE_H
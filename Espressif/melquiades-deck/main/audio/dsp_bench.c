@@ -0,0 +1,142 @@
+#include "dsp_bench.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "../system/mem_track.h"
+
+#define BENCH_GAIN_DB       6.0f    // Misma ganancia que aplica audio_output_init
+#define SWEEP_START_HZ      20.0f
+#define SWEEP_AMPLITUDE     16384   // -6 dBFS
+#define NOISE_SHIFT         2       // -12 dBFS
+
+static const char *signal_names[DSP_BENCH_SIGNAL_MAX] = {"sweep", "noise", "silence"};
+
+const char *dsp_bench_signal_name(dsp_bench_signal_t signal)
+{
+    return signal < DSP_BENCH_SIGNAL_MAX ? signal_names[signal] : "?";
+}
+
+void dsp_bench_fill_signal(dsp_bench_signal_t signal, int16_t *pcm, uint32_t frames, uint32_t sample_rate)
+{
+    uint32_t seed = 0x4d51u;
+    float stop_hz = 0.45f * sample_rate;
+    float k = logf(stop_hz / SWEEP_START_HZ);
+    float duration = (float)frames / sample_rate;
+    for (uint32_t i = 0; i < frames; i++) {
+        int16_t left = 0;
+        int16_t right = 0;
+        if (signal == DSP_BENCH_SWEEP) {
+            // Fase del barrido exponencial, los dos canales en cuadratura
+            float t = (float)i / sample_rate;
+            float phase = 2.0f * M_PI * SWEEP_START_HZ * duration / k * (expf(t / duration * k) - 1.0f);
+            left = (int16_t)(SWEEP_AMPLITUDE * sinf(phase));
+            right = (int16_t)(SWEEP_AMPLITUDE * cosf(phase));
+        } else if (signal == DSP_BENCH_NOISE) {
+            seed = seed * 1664525u + 1013904223u;
+            left = (int16_t)(seed >> 16) >> NOISE_SHIFT;
+            seed = seed * 1664525u + 1013904223u;
+            right = (int16_t)(seed >> 16) >> NOISE_SHIFT;
+        }
+        pcm[2 * i] = left;
+        pcm[2 * i + 1] = right;
+    }
+}
+
+const char *dsp_bench_preset_config(eq_preset_t preset, dsp_config_t *config)
+{
+    audio_dsp_default_config(config);
+    config->gain_db = BENCH_GAIN_DB;
+    return get_eq_preset_bands(preset, &config->bass_gain_db, &config->mid_gain_db, &config->treble_gain_db);
+}
+
+esp_err_t dsp_bench_reset(uint32_t sample_rate)
+{
+    // audio_dsp_init vuelve a disenar los filtros y deja el limitador en reposo
+    return audio_dsp_init(sample_rate);
+}
+
+esp_err_t dsp_bench_run(const int16_t *pcm, uint32_t frames, size_t block_bytes, const dsp_config_t *config,
+                        dsp_bench_result_t *result)
+{
+    uint32_t block_frames = block_bytes / DSP_BENCH_FRAME_BYTES;
+    if (block_frames == 0 || frames < block_frames) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t *out = MEM_MALLOC(MEM_MOD_BENCH, block_bytes);
+    if (out == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = ESP_OK;
+    for (uint32_t f = 0; f + block_frames <= frames && ret == ESP_OK; f += block_frames) {
+        uint32_t start = esp_cpu_get_ccount();
+        ret = audio_dsp_process((const uint8_t *)&pcm[2 * f], out, block_frames * DSP_BENCH_FRAME_BYTES, config);
+        uint32_t cycles = esp_cpu_get_ccount() - start;
+        result->cycles += cycles;
+        result->frames += block_frames;
+        result->blocks++;
+        if (cycles > result->max_block_cycles) {
+            result->max_block_cycles = cycles;
+        }
+    }
+    MEM_FREE(out);
+    return ret;
+}
+
+float dsp_bench_ns_per_frame(const dsp_bench_result_t *result)
+{
+    if (result->frames == 0) {
+        return 0.0f;
+    }
+    return (float)result->cycles * 1000.0f / CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ / result->frames;
+}
+
+float dsp_bench_max_block_us(const dsp_bench_result_t *result)
+{
+    return (float)result->max_block_cycles / CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ;
+}
+
+size_t dsp_bench_format(size_t block_bytes, uint32_t restore_rate, char *output, size_t size)
+{
+    static const uint32_t rates[] = DSP_BENCH_RATES;
+    size_t len = 0;
+    int n;
+    if (block_bytes < DSP_BENCH_FRAME_BYTES || block_bytes > DSP_BENCH_TARGET_FRAMES * DSP_BENCH_FRAME_BYTES) {
+        return (size_t)snprintf(output, size, "Error: bloque entre %d y %d bytes.\n",
+                                DSP_BENCH_FRAME_BYTES, DSP_BENCH_TARGET_FRAMES * DSP_BENCH_FRAME_BYTES);
+    }
+    int16_t *pcm = MEM_MALLOC(MEM_MOD_BENCH, DSP_BENCH_TARGET_FRAMES * DSP_BENCH_FRAME_BYTES);
+    if (pcm == NULL) {
+        return (size_t)snprintf(output, size, "Error: sin memoria para el benchmark.\n");
+    }
+    // audio_dsp_init informa cada reinicio
+    esp_log_level_set("AUDIO_DSP", ESP_LOG_WARN);
+    n = snprintf(output, size, "DSP bench: bloque %u B, %u frames por caso, CPU %d MHz\n",
+                 (uint32_t)block_bytes, DSP_BENCH_TARGET_FRAMES * DSP_BENCH_TARGET_PASSES,
+                 CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ);
+    len = n > 0 ? (size_t)n : 0;
+    for (int r = 0; r < DSP_BENCH_RATE_COUNT; r++) {
+        dsp_bench_fill_signal(DSP_BENCH_SWEEP, pcm, DSP_BENCH_TARGET_FRAMES, rates[r]);
+        for (eq_preset_t p = 0; p < EQ_MAX_PRESETS && len < size; p++) {
+            dsp_config_t config;
+            dsp_bench_result_t res = {0};
+            const char *name = dsp_bench_preset_config(p, &config);
+            dsp_bench_reset(rates[r]);
+            for (int pass = 0; pass < DSP_BENCH_TARGET_PASSES; pass++) {
+                dsp_bench_run(pcm, DSP_BENCH_TARGET_FRAMES, block_bytes, &config, &res);
+            }
+            float ns = dsp_bench_ns_per_frame(&res);
+            // Fraccion de cada segundo de audio que se va en el DSP
+            float rt_pct = ns * rates[r] / 1e7f;
+            n = snprintf(output + len, size - len, "  %-15s %5u Hz: %6.1f ns/frame, %6.0fk frames/s, max %6.1f us, %5.2f%% RT\n",
+                         name, rates[r], ns, ns > 0.0f ? 1e6f / ns : 0.0f, dsp_bench_max_block_us(&res), rt_pct);
+            len += n > 0 ? (size_t)n : 0;
+        }
+    }
+    MEM_FREE(pcm);
+    dsp_bench_reset(restore_rate);
+    esp_log_level_set("AUDIO_DSP", ESP_LOG_INFO);
+    return len < size ? len : size - 1;
+}
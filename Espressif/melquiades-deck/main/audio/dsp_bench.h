@@ -0,0 +1,105 @@
+#ifndef DSP_BENCH_H
+#define DSP_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "audio_dsp.h"
+#include "../bluetooth/a2dp_sink.h"
+
+// Mide lo que cuesta audio_dsp_process con el contador de ciclos de la CPU. El mismo codigo
+// corre en el ESP32 (comando dsp bench) y en el build de host (dsp-bench con corpus WAV).
+
+// Frecuencias que negocia A2DP (SBC)
+#define DSP_BENCH_RATES     {16000, 32000, 44100, 48000}
+#define DSP_BENCH_RATE_COUNT 4
+
+// Bloques en bytes: paquete SBC chico, bloque de la tarea I2S y paquete A2DP grande
+#define DSP_BENCH_BLOCKS    {512, 2048, 4096}
+#define DSP_BENCH_BLOCK_COUNT 3
+
+#define DSP_BENCH_FRAME_BYTES 4     // 16 bits estereo
+
+// En el equipo se barre un buffer chico varias veces para no ocupar heap
+#define DSP_BENCH_TARGET_FRAMES 2048
+#define DSP_BENCH_TARGET_PASSES 4
+
+// Senales sinteticas, para medir sin archivos
+typedef enum {
+    DSP_BENCH_SWEEP = 0,    // Barrido logaritmico 20 Hz - 0.9 Nyquist a -6 dBFS
+    DSP_BENCH_NOISE,        // Ruido blanco a -12 dBFS
+    DSP_BENCH_SILENCE,      // Ceros, los filtros IIR decaen hacia valores subnormales
+    DSP_BENCH_SIGNAL_MAX
+} dsp_bench_signal_t;
+
+// Resultado acumulado de una o mas pasadas
+typedef struct {
+    uint32_t frames;            // Frames procesados
+    uint32_t blocks;            // Llamadas a audio_dsp_process
+    uint64_t cycles;            // Ciclos totales dentro de audio_dsp_process
+    uint32_t max_block_cycles;  // Peor bloque
+} dsp_bench_result_t;
+
+/**
+ * @brief Nombre corto de una senal sintetica
+ */
+const char *dsp_bench_signal_name(dsp_bench_signal_t signal);
+
+/**
+ * @brief Genera una senal sintetica estereo intercalada
+ *
+ * @param signal Senal a generar
+ * @param pcm Destino, frames * 2 muestras
+ * @param frames Frames a generar
+ * @param sample_rate Frecuencia para la que se genera el barrido
+ */
+void dsp_bench_fill_signal(dsp_bench_signal_t signal, int16_t *pcm, uint32_t frames, uint32_t sample_rate);
+
+/**
+ * @brief Configuracion DSP de la salida de audio (+6 dB) con las bandas de un preset
+ *
+ * @return Nombre del preset, NULL si no existe
+ */
+const char *dsp_bench_preset_config(eq_preset_t preset, dsp_config_t *config);
+
+/**
+ * @brief Reinicia el DSP a la frecuencia dada, con los filtros en cero
+ *
+ * Comparte estado con la salida de audio: solo se usa sin stream activo.
+ */
+esp_err_t dsp_bench_reset(uint32_t sample_rate);
+
+/**
+ * @brief Procesa el audio en bloques y acumula los ciclos en result
+ *
+ * @param pcm Audio estereo de 16 bits; se ignora la cola que no completa un bloque
+ * @param frames Frames de pcm
+ * @param block_bytes Bytes por llamada a audio_dsp_process
+ * @param config Configuracion DSP
+ * @param result Acumulador, el llamador lo pone en cero
+ */
+esp_err_t dsp_bench_run(const int16_t *pcm, uint32_t frames, size_t block_bytes, const dsp_config_t *config,
+                        dsp_bench_result_t *result);
+
+/**
+ * @brief Nanosegundos por frame a la frecuencia de CPU configurada
+ */
+float dsp_bench_ns_per_frame(const dsp_bench_result_t *result);
+
+/**
+ * @brief Microsegundos del peor bloque a la frecuencia de CPU configurada
+ */
+float dsp_bench_max_block_us(const dsp_bench_result_t *result);
+
+/**
+ * @brief Corre todos los presets y frecuencias con un bloque y deja el informe en texto
+ *
+ * Usa el barrido sintetico y al terminar reinicia el DSP a restore_rate. Solo sin stream activo.
+ *
+ * @param block_bytes Bytes por llamada a audio_dsp_process
+ * @param restore_rate Frecuencia en la que queda el DSP
+ * @return Bytes escritos en output
+ */
+size_t dsp_bench_format(size_t block_bytes, uint32_t restore_rate, char *output, size_t size);
+
+#endif // DSP_BENCH_H
@@ -1,4 +1,5 @@
 #include "sine_wave.h"
+#include "../system/mem_track.h"
 
 #define TAG "SINE_EXAMPLE"
 // Configuración de la onda senoidal
@@ -30,7 +31,7 @@ void generate_sine_wave(int16_t* buffer, size_t buffer_size, float frequency, in
 
 void sine_wave_task(void *pvParameters) {
     esp_err_t ret;
-    int16_t *buffer = malloc(BUFFER_SIZE * sizeof(int16_t));
+    int16_t *buffer = MEM_MALLOC(MEM_MOD_AUDIO, BUFFER_SIZE * sizeof(int16_t));
     
     if (buffer == NULL) {
         ESP_LOGE(TAG, "Failed to allocate memory for buffer");
@@ -42,7 +43,7 @@ void sine_wave_task(void *pvParameters) {
     ret = audio_output_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize audio output");
-        free(buffer);
+        MEM_FREE(buffer);
         vTaskDelete(NULL);
         return;
     }
@@ -52,7 +53,7 @@ void sine_wave_task(void *pvParameters) {
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set sample rate");
         audio_output_deinit();
-        free(buffer);
+        MEM_FREE(buffer);
         vTaskDelete(NULL);
         return;
     }
@@ -95,6 +96,6 @@ void sine_wave_task(void *pvParameters) {
     
     // En teoria no deberia de llegar aca, por yolo liberamos todo para evitar colapsos
     audio_output_deinit();
-    free(buffer);
+    MEM_FREE(buffer);
     vTaskDelete(NULL);
 }
\ No newline at end of file
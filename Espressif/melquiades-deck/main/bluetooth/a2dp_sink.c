@@ -10,9 +10,15 @@
 #include "esp_gap_bt_api.h"
 #include "esp_a2dp_api.h"
 #include "esp_avrc_api.h"
+#include "nvs.h"
 //bibliotecas custom
 #include "bluetooth_common.h"
 #include "../audio/audio_output.h"
+#include "../audio/audio_probe.h"
+#include "../audio/audio_profile.h"
+#include "../telemetry/trace_log.h"
+#include "../boot/boot_profile.h"
+#include "../system/event_bus.h"
 
 
 #define BT_A2DP_TAG "Melquiades_Deck_A2DP"
@@ -23,10 +29,18 @@
 #define CUSTOM_AVRC_CMD_EQ_PRESET  0x02
 #define CUSTOM_AVRC_CMD_BALANCE    0x03
 
+// Ultima fuente conectada, para reconectar activamente al arrancar
+#define A2DP_NVS_NAMESPACE  "a2dp"
+#define A2DP_NVS_LAST_SRC   "last_src"
+#define RECONNECT_ATTEMPTS  3
+
 static uint32_t m_pkt_cnt = 0;
 static esp_a2d_audio_state_t m_audio_state = ESP_A2D_AUDIO_STATE_STOPPED;
 static const char *m_a2d_conn_state_str[] = {"Desconectado", "Conectando", "Conectado", "Desconectando"};
 static const char *m_a2d_audio_state_str[] = {"Suspendido", "Parado", "Iniciado"};
+static volatile bool m_audio_ready = false;
+static esp_bd_addr_t m_last_src;
+static uint8_t m_reconnect_left = 0;
 
 
 static const struct {
@@ -42,24 +56,26 @@ static const struct {
     {"Vocal",          -3.0f,  6.0f,  3.0f}
 };
 
-// Estado actual del DSP
-static struct {
-    bool enabled;
-    eq_preset_t eq_preset;
-    uint8_t volume;
-    float balance;  // -1.0 (izq) a 1.0 (der)
-} dsp_state = {
+// Estado actual del DSP; es el contenido del perfil de audio activo
+static audio_profile_settings_t dsp_state = {
     .enabled = true,
     .eq_preset = EQ_FLAT,
+    .bass_db = 0.0f,
+    .mid_db = 0.0f,
+    .treble_db = 0.0f,
     .volume = 75,     // 75% volumen por defecto
-    .balance = 0.0f   // Balance centrado
+    .balance = 0.0f,  // Balance centrado
+    .limiter_db = 0.0f
 };
+// Los setters se llaman desde el shell, los sensores y el stack BT: cada cambio sube la secuencia
+static portMUX_TYPE dsp_state_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t dsp_state_seq = 0;
 
 static void bt_app_gap_cb(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *param);
 static void bt_app_a2d_cb(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param);
 static void bt_app_avrc_ct_cb(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param_t *param);
 static void bt_app_a2d_data_cb(const uint8_t *data, uint32_t len);
-static void apply_dsp_settings(void);
+static void commit_dsp_state(void);
 
 void init_a2dp_sink(void)
 {
@@ -73,12 +89,6 @@ void init_a2dp_sink(void)
         return;
     }
 
-    /* Inicializar el hardware de audio */
-    audio_output_init();
-    
-    // Aplicar configuración inicial de DSP
-    apply_dsp_settings();
-
     /* Registrar el callback GAP para gestionar eventos GAP como detección de dispositivos */
     if ((ret = esp_bt_gap_register_callback(bt_app_gap_cb)) != ESP_OK) {
         ESP_LOGE(BT_A2DP_TAG, "Registro de callback GAP falló: %s", esp_err_to_name(ret));
@@ -115,61 +125,189 @@ void init_a2dp_sink(void)
         return;
     }
 
-    /* Configurar Bluetooth como visible y conectable */
-    if ((ret = esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE)) != ESP_OK) {
-        ESP_LOGE(BT_A2DP_TAG, "Configuración del modo de escaneo falló: %s", esp_err_to_name(ret));
+    // El modo visible/conectable lo fija SPP una sola vez al iniciar su servidor
+    boot_profile_mark(BOOT_PHASE_A2DP);
+    ESP_LOGI(BT_A2DP_TAG, "A2DP sink inicializado correctamente - Esperando conexión...");
+}
+
+void a2dp_sink_init_audio(void)
+{
+    /* Inicializar el hardware de audio */
+    if (audio_output_init() != ESP_OK) {
+        ESP_LOGE(BT_A2DP_TAG, "Inicialización de audio falló");
         return;
     }
 
-    ESP_LOGI(BT_A2DP_TAG, "A2DP sink inicializado correctamente - Esperando conexión...");
+    // Restaurar el perfil guardado y aplicarlo antes del primer bloque
+    audio_profile_load_active(&dsp_state);
+    commit_dsp_state();
+    m_audio_ready = true;
+    boot_profile_mark(BOOT_PHASE_AUDIO_HW);
 }
 
-static void apply_dsp_settings(void)
+// Guarda la fuente en NVS solo si cambio, para no gastar escrituras de flash en cada conexion
+static void save_last_source(const esp_bd_addr_t bda)
 {
-    // Activar/desactivar DSP
-    audio_output_enable_dsp(dsp_state.enabled);
-    
-    // Aplicar preset de EQ
-    eq_preset_t preset = dsp_state.eq_preset;
-    if (preset < EQ_MAX_PRESETS) {
-        audio_output_set_eq(
-            eq_presets[preset].bass,
-            eq_presets[preset].mid,
-            eq_presets[preset].treble
-        );
-        ESP_LOGI(BT_A2DP_TAG, "Aplicando preset EQ: %s", eq_presets[preset].name);
+    nvs_handle_t handle;
+    if (memcmp(bda, m_last_src, sizeof(esp_bd_addr_t)) == 0) {
+        return;
     }
-    
-    // Aplicar volumen
-    audio_output_set_volume(dsp_state.volume);
-    
-    // Aplicar balance
-    float balance = dsp_state.balance;
+    memcpy(m_last_src, bda, sizeof(esp_bd_addr_t));
+    if (nvs_open(A2DP_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(handle, A2DP_NVS_LAST_SRC, bda, sizeof(esp_bd_addr_t)) == ESP_OK) {
+        nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
+
+// La fuente guardada solo sirve si sigue emparejada
+static bool is_bonded(const esp_bd_addr_t bda)
+{
+    esp_bd_addr_t bonded[8];
+    int count = esp_bt_gap_get_bond_device_num();
+    if (count <= 0) {
+        return false;
+    }
+    if (count > 8) {
+        count = 8;
+    }
+    if (esp_bt_gap_get_bond_device_list(&count, bonded) != ESP_OK) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (memcmp(bonded[i], bda, sizeof(esp_bd_addr_t)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void a2dp_sink_reconnect_last(void)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(esp_bd_addr_t);
+    if (nvs_open(A2DP_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        ESP_LOGI(BT_A2DP_TAG, "Sin fuente previa, esperando conexión del teléfono");
+        return;
+    }
+    esp_err_t ret = nvs_get_blob(handle, A2DP_NVS_LAST_SRC, m_last_src, &len);
+    nvs_close(handle);
+    if (ret != ESP_OK || len != sizeof(esp_bd_addr_t) || !is_bonded(m_last_src)) {
+        ESP_LOGI(BT_A2DP_TAG, "Sin fuente previa emparejada, esperando conexión del teléfono");
+        return;
+    }
+
+    ESP_LOGI(BT_A2DP_TAG, "Reconectando a la última fuente [%02x:%02x:%02x:%02x:%02x:%02x]",
+             m_last_src[0], m_last_src[1], m_last_src[2], m_last_src[3], m_last_src[4], m_last_src[5]);
+    m_reconnect_left = RECONNECT_ATTEMPTS - 1;
+    boot_profile_mark(BOOT_PHASE_PAGE);
+    esp_a2d_sink_connect(m_last_src);
+}
+
+// Ganancias por canal en dB segun el balance
+static void balance_gains(float balance, float gains[3])
+{
+    gains[0] = 0.0f;
+    gains[1] = 0.0f;
+    gains[2] = 0.0f;
     if (balance < 0) {
         // Aumentar canal izquierdo, atenuar derecho
-        audio_output_set_channel_balance(0.0f, balance * -10.0f);
+        gains[1] = balance * -10.0f;
     } else if (balance > 0) {
         // Aumentar canal derecho, atenuar izquierdo
-        audio_output_set_channel_balance(balance * -10.0f, 0.0f);
-    } else {
-        // Balance neutral
-        audio_output_set_channel_balance(0.0f, 0.0f);
+        gains[0] = balance * -10.0f;
     }
 }
 
+// Entrega el estado completo a la tarea I2S, que lo aplica entre dos bloques, y al perfil activo.
+// Nunca se manda un delta: si dos setters se cruzan, el que publico una copia vieja vuelve a
+// publicar hasta que la secuencia no cambie, asi lo ultimo aplicado es siempre el estado actual.
+static void commit_dsp_state(void)
+{
+    audio_profile_settings_t state;
+    audio_output_controls_t controls;
+    float gains[3];
+    uint32_t seq;
+    do {
+        portENTER_CRITICAL(&dsp_state_lock);
+        state = dsp_state;
+        seq = dsp_state_seq;
+        portEXIT_CRITICAL(&dsp_state_lock);
+
+        balance_gains(state.balance, gains);
+        controls.dsp_enabled = state.enabled;
+        controls.volume = state.volume;
+        controls.bass_db = state.bass_db;
+        controls.mid_db = state.mid_db;
+        controls.treble_db = state.treble_db;
+        controls.left_gain_db = gains[0];
+        controls.right_gain_db = gains[1];
+        controls.limiter_db = state.limiter_db;
+        audio_output_post_controls(&controls);
+        audio_profile_changed(&state);
+    } while (__atomic_load_n(&dsp_state_seq, __ATOMIC_ACQUIRE) != seq);
+}
+
+#define DSP_STATE_UPDATE(statement)             \
+    do {                                        \
+        portENTER_CRITICAL(&dsp_state_lock);    \
+        statement;                              \
+        dsp_state_seq++;                        \
+        portEXIT_CRITICAL(&dsp_state_lock);     \
+        commit_dsp_state();                     \
+    } while (0)
+
 void set_dsp_enabled(bool enabled)
 {
-    dsp_state.enabled = enabled;
-    apply_dsp_settings();
-    ESP_LOGI(BT_A2DP_TAG, "DSP %s", enabled ? "activado" : "desactivado");
+    DSP_STATE_UPDATE(dsp_state.enabled = enabled);
+    TRACE_D(BT_A2DP_TAG, "DSP activado: %d", enabled);
 }
 
 void set_eq_preset(eq_preset_t preset)
 {
     if (preset < EQ_MAX_PRESETS) {
-        dsp_state.eq_preset = preset;
-        apply_dsp_settings();
-        ESP_LOGI(BT_A2DP_TAG, "Preset EQ cambiado a: %s", eq_presets[preset].name);
+        DSP_STATE_UPDATE({
+            dsp_state.eq_preset = preset;
+            dsp_state.bass_db = eq_presets[preset].bass;
+            dsp_state.mid_db = eq_presets[preset].mid;
+            dsp_state.treble_db = eq_presets[preset].treble;
+        });
+        TRACE_D(BT_A2DP_TAG, "Preset EQ cambiado a: %d", preset);
+    }
+}
+
+const char *get_eq_preset_bands(eq_preset_t preset, float *bass_db, float *mid_db, float *treble_db)
+{
+    if (preset >= EQ_MAX_PRESETS) {
+        return NULL;
+    }
+    *bass_db = eq_presets[preset].bass;
+    *mid_db = eq_presets[preset].mid;
+    *treble_db = eq_presets[preset].treble;
+    return eq_presets[preset].name;
+}
+
+void set_eq_bands(float bass_db, float mid_db, float treble_db)
+{
+    DSP_STATE_UPDATE({
+        dsp_state.bass_db = bass_db;
+        dsp_state.mid_db = mid_db;
+        dsp_state.treble_db = treble_db;
+    });
+    TRACE_D(BT_A2DP_TAG, "EQ personalizado: %.1f / %.1f / %.1f dB", bass_db, mid_db, treble_db);
+}
+
+void set_eq_band(int band, float gain_db)
+{
+    // Cambia una banda y conserva las otras dos del preset o del EQ personalizado
+    if (band == 0) {
+        DSP_STATE_UPDATE(dsp_state.bass_db = gain_db);
+    } else if (band == 1) {
+        DSP_STATE_UPDATE(dsp_state.mid_db = gain_db);
+    } else if (band == 2) {
+        DSP_STATE_UPDATE(dsp_state.treble_db = gain_db);
     }
 }
 
@@ -178,9 +316,8 @@ void set_volume(uint8_t volume)
     if (volume > 100) {
         volume = 100;
     }
-    dsp_state.volume = volume;
-    apply_dsp_settings();
-    ESP_LOGI(BT_A2DP_TAG, "Volumen configurado: %d%%", volume);
+    DSP_STATE_UPDATE(dsp_state.volume = volume);
+    TRACE_D(BT_A2DP_TAG, "Volumen configurado: %d%%", volume);
 }
 
 void set_balance(float balance)
@@ -189,16 +326,41 @@ void set_balance(float balance)
     if (balance < -1.0f) balance = -1.0f;
     if (balance > 1.0f) balance = 1.0f;
     
-    dsp_state.balance = balance;
-    apply_dsp_settings();
+    DSP_STATE_UPDATE(dsp_state.balance = balance);
     
-    if (balance < 0) {
-        ESP_LOGI(BT_A2DP_TAG, "Balance configurado: %.1f%% (hacia izquierda)", balance * -100.0f);
-    } else if (balance > 0) {
-        ESP_LOGI(BT_A2DP_TAG, "Balance configurado: %.1f%% (hacia derecha)", balance * 100.0f);
-    } else {
-        ESP_LOGI(BT_A2DP_TAG, "Balance configurado: centrado");
+    // Negativo hacia la izquierda
+    TRACE_D(BT_A2DP_TAG, "Balance configurado: %.1f%%", balance * 100.0f);
+}
+
+void set_limiter(float threshold_db)
+{
+    if (threshold_db < -20.0f) threshold_db = -20.0f;
+    if (threshold_db > 0.0f) threshold_db = 0.0f;
+    
+    DSP_STATE_UPDATE(dsp_state.limiter_db = threshold_db);
+    TRACE_D(BT_A2DP_TAG, "Limitador configurado: %.1f dB", threshold_db);
+}
+
+esp_err_t a2dp_sink_load_profile(int index)
+{
+    audio_profile_settings_t profile;
+    esp_err_t ret = audio_profile_select(index, &profile);
+    if (ret != ESP_OK) {
+        return ret;
     }
+    // Todo el perfil va en una sola entrega; la tarea I2S lo aplica entre dos bloques
+    DSP_STATE_UPDATE(dsp_state = profile);
+    ESP_LOGI(BT_A2DP_TAG, "Perfil de audio %d cargado", index);
+    return ESP_OK;
+}
+
+esp_err_t a2dp_sink_save_profile(int index, const char *name)
+{
+    audio_profile_settings_t state;
+    portENTER_CRITICAL(&dsp_state_lock);
+    state = dsp_state;
+    portEXIT_CRITICAL(&dsp_state_lock);
+    return audio_profile_save_as(index, name, &state);
 }
 
 static void bt_app_gap_cb(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *param)
@@ -230,13 +392,30 @@ static void bt_app_a2d_cb(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param)
         if (param->conn_stat.state == ESP_A2D_CONNECTION_STATE_DISCONNECTED) {
             // Reiniciar contador de paquetes cuando se desconecta
             m_pkt_cnt = 0;
+            // Sin conexion no hay stream aunque el stack no haya mandado el STOPPED
+            m_audio_state = ESP_A2D_AUDIO_STATE_STOPPED;
+            // Un page sin respuesta tambien termina aqui, reintentamos unas pocas veces
+            if (m_reconnect_left > 0) {
+                m_reconnect_left--;
+                esp_a2d_sink_connect(m_last_src);
+            }
+        } else if (param->conn_stat.state == ESP_A2D_CONNECTION_STATE_CONNECTED) {
+            m_reconnect_left = 0;
+            boot_profile_mark(BOOT_PHASE_A2DP_CONNECTED);
+            save_last_source(param->conn_stat.remote_bda);
         }
+        event_bus_publish_u32(BUS_TOPIC_TRANSPORT, BUS_TRANSPORT_A2DP_CONN, param->conn_stat.state);
         break;
     }
     case ESP_A2D_AUDIO_STATE_EVT: {
         ESP_LOGI(BT_A2DP_TAG, "Estado de audio A2DP cambiado: %s",
                  m_a2d_audio_state_str[param->audio_stat.state]);
         m_audio_state = param->audio_stat.state;
+        if (m_audio_state == ESP_A2D_AUDIO_STATE_STARTED) {
+            boot_profile_mark(BOOT_PHASE_AUDIO_STARTED);
+        }
+        event_bus_publish_u32(BUS_TOPIC_TRANSPORT, BUS_TRANSPORT_A2DP_AUDIO,
+                              m_audio_state == ESP_A2D_AUDIO_STATE_STARTED);
         break;
     }
     case ESP_A2D_AUDIO_CFG_EVT: {
@@ -254,23 +433,27 @@ static void bt_app_a2d_cb(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param)
         ESP_LOGI(BT_A2DP_TAG, "Configure audio player: %d", sample_rate);
         // Configurar la salida de audio
         audio_output_set_sample_rate(sample_rate);
+        event_bus_publish_u32(BUS_TOPIC_TRANSPORT, BUS_TRANSPORT_SAMPLE_RATE, sample_rate);
         break;
     }
     default:
-        ESP_LOGI(BT_A2DP_TAG, "Evento A2DP no gestionado: %d", event);
+        TRACE_D(BT_A2DP_TAG, "Evento A2DP no gestionado: %d", event);
         break;
     }
 }
 
 static void bt_app_a2d_data_cb(const uint8_t *data, uint32_t len)
 {
-    // Esta función recibe los datos de audio decodificados
-    /*
-    if (++m_pkt_cnt % 100 == 0) {
-        ESP_LOGI(BT_A2DP_TAG, "Audio recibido: paquete n° %u, longitud %u", m_pkt_cnt, len);
-    }
-    */
+    // Esta función recibe los datos de audio decodificados; el instante de entrada mide la cola
+    audio_probe_a2dp_entry(len);
+    m_pkt_cnt++;
+    TRACE_V(BT_A2DP_TAG, "Audio recibido: paquete %u, longitud %u", m_pkt_cnt, len);
     
+    // Si el hardware de audio aun no termina de arrancar se descarta el paquete
+    if (!m_audio_ready) {
+        return;
+    }
+
     // Enviar los datos de audio al procesador DSP y luego al DAC
     audio_output_write((uint8_t *)data, len);
 }
@@ -287,7 +470,7 @@ static void bt_app_avrc_ct_cb(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param
         break;
     }
     default:
-        ESP_LOGI(BT_A2DP_TAG, "Evento AVRC no gestionado: %d", event);
+        TRACE_D(BT_A2DP_TAG, "Evento AVRC no gestionado: %d", event);
         break;
     }
 }
@@ -301,7 +484,7 @@ void dsp_toggle_enabled(void)
 
 void dsp_next_eq_preset(void)
 {
-    eq_preset_t next = (dsp_state.eq_preset + 1) % EQ_MAX_PRESETS;
+    eq_preset_t next = (eq_preset_t)((dsp_state.eq_preset + 1) % EQ_MAX_PRESETS);
     set_eq_preset(next);
 }
 
@@ -337,4 +520,14 @@ void dsp_balance_right(void)
 void dsp_balance_center(void)
 {
     set_balance(0.0f);
+}
+
+uint32_t a2dp_get_packet_count(void)
+{
+    return m_pkt_cnt;
+}
+
+bool a2dp_is_streaming(void)
+{
+    return m_audio_state == ESP_A2D_AUDIO_STATE_STARTED;
 }
\ No newline at end of file
@@ -20,6 +20,18 @@ typedef enum {
  */
 void init_a2dp_sink(void);
 
+/**
+ * @brief Inicializa I2S, DSP y la tarea de audio
+ *
+ * Es independiente de Bluedroid, se puede correr en paralelo con init_a2dp_sink.
+ */
+void a2dp_sink_init_audio(void);
+
+/**
+ * @brief Conecta activamente a la ultima fuente guardada en NVS si sigue emparejada
+ */
+void a2dp_sink_reconnect_last(void);
+
 /**
  * @brief Activa o desactiva el procesamiento DSP
  * 
@@ -34,6 +46,34 @@ void set_dsp_enabled(bool enabled);
  */
 void set_eq_preset(eq_preset_t preset);
 
+/**
+ * @brief Ganancias de un preset de ecualizador sin aplicarlo
+ * 
+ * @param preset Preset de EQ consultado
+ * @param bass_db Ganancia de bajos en dB
+ * @param mid_db Ganancia de medios en dB
+ * @param treble_db Ganancia de agudos en dB
+ * @return Nombre del preset, NULL si no existe
+ */
+const char *get_eq_preset_bands(eq_preset_t preset, float *bass_db, float *mid_db, float *treble_db);
+
+/**
+ * @brief Configura ganancias personalizadas del ecualizador de 3 bandas
+ * 
+ * @param bass_db Ganancia de bajos en dB
+ * @param mid_db Ganancia de medios en dB
+ * @param treble_db Ganancia de agudos en dB
+ */
+void set_eq_bands(float bass_db, float mid_db, float treble_db);
+
+/**
+ * @brief Configura la ganancia de una sola banda del ecualizador
+ * 
+ * @param band 0 = bajos, 1 = medios, 2 = agudos
+ * @param gain_db Ganancia en dB
+ */
+void set_eq_band(int band, float gain_db);
+
 /**
  * @brief Configura el volumen global
  * 
@@ -48,6 +88,29 @@ void set_volume(uint8_t volume);
  */
 void set_balance(float balance);
 
+/**
+ * @brief Configura el umbral del limitador de pico
+ * 
+ * @param threshold_db Umbral en dBFS (-20 a 0), 0 desactiva el limitador
+ */
+void set_limiter(float threshold_db);
+
+/**
+ * @brief Carga un perfil de audio guardado y lo aplica completo
+ *
+ * @param index Perfil de 0 a AUDIO_PROFILE_COUNT - 1
+ * @return esp_err_t ESP_ERR_NOT_FOUND si el perfil esta vacio
+ */
+esp_err_t a2dp_sink_load_profile(int index);
+
+/**
+ * @brief Guarda el estado actual del DSP como perfil con nombre y lo deja activo
+ *
+ * @param index Perfil de 0 a AUDIO_PROFILE_COUNT - 1
+ * @param name Nombre del perfil
+ */
+esp_err_t a2dp_sink_save_profile(int index, const char *name);
+
 /**
  * @brief Alterna entre DSP activado/desactivado
  */
@@ -83,4 +146,14 @@ void dsp_balance_right(void);
  */
 void dsp_balance_center(void);
 
+/**
+ * @brief Paquetes de audio recibidos desde la ultima conexion
+ */
+uint32_t a2dp_get_packet_count(void);
+
+/**
+ * @brief Indica si hay un stream de audio A2DP activo
+ */
+bool a2dp_is_streaming(void);
+
 #endif /* A2DP_SINK_H */
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "esp_bt_main.h"
 #include "esp_bt_device.h"
 #include "esp_gap_bt_api.h"
+//bibliotecas custom
+#include "../boot/boot_profile.h"
 
 #define BT_COMMON_TAG "BT_COMMON"
 #define BT_DEVICE_NAME "Melquiades-Deck"
@@ -53,11 +55,9 @@ esp_err_t init_bluetooth_common(void)
 
     // Establecer el nombre del dispositivo - un solo nombre para ambos perfiles
     esp_bt_dev_set_device_name(BT_DEVICE_NAME);
-    
-    // Configurar el dispositivo como visible y conectable
-    esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
 
     bluetooth_initialized = true;
+    boot_profile_mark(BOOT_PHASE_BT_STACK);
     ESP_LOGI(BT_COMMON_TAG, "Bluetooth inicializado correctamente");
     return ESP_OK;
 }
\ No newline at end of file
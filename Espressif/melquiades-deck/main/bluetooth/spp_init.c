@@ -16,31 +16,70 @@
 #include "esp_spp_api.h"
 // Bibliotecas custom
 #include "a2dp_sink.h"
+#include "audio_output.h"
+#include "audio_probe.h"
 #include "bluetooth_common.h"
+#include "spp_session.h"
+#include "../boot/boot_profile.h"
 #include "../state.h"
 #include "../shell/common_shell.h"
+#include "../shell/bin_shell.h"
+#include "../shell/bin_protocol.h"
+#include "../telemetry/trace_log.h"
 
 
 // Definiciones de archivo
 #define SPP_TAG "Melquiades_Deck_SPP"
 #define SPP_SERVER_NAME "Melquiades_Deck_ESP32"
-#define BT_DEVICE_NAME "Melquiades-Deck"
+#define CMD_QUEUE_LEN 32
+#define METERS_PERIOD_MS 1000
 
 static const esp_spp_mode_t esp_spp_mode = ESP_SPP_MODE_CB;
 static const esp_spp_sec_t sec_mask = ESP_SPP_SEC_AUTHENTICATE;
 static const esp_spp_role_t role_slave = ESP_SPP_ROLE_SLAVE;
 
-static uint32_t spp_handle = 0;
 static QueueHandle_t cmd_queue;
-static bool bt_connected = false;
+// Sesion cuyo comando esta ejecutando bt_shell_task
+static int shell_session = -1;
+
+// Modo binario por sesion (opt-in con "bin_mode on"), los parsers solo los toca el callback SPP
+static volatile bool binary_mode[SPP_MAX_SESSIONS];
+static bin_parser_t bin_parsers[SPP_MAX_SESSIONS];
+static uint32_t bin_dropped = 0;
 
 // Estructura para mensajes en la cola
 typedef struct
 {
     char data[64];
     int len;
+    bool binary;     // true: data es el payload de una trama con opcode
+    uint8_t opcode;
+    int session;     // Sesion SPP que envio el comando
 } bt_cmd_t;
 
+// Encola las tramas completas recibidas en modo binario, sin eco ni logs
+static void process_binary_data(int session, const uint8_t *data, uint16_t len)
+{
+    bt_cmd_t cmd;
+    bin_parser_t *parser = &bin_parsers[session];
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (bin_parser_feed(parser, data[i]))
+        {
+            cmd.binary = true;
+            cmd.opcode = parser->type;
+            cmd.len = parser->len;
+            cmd.session = session;
+            memcpy(cmd.data, parser->payload, parser->len);
+            // No bloqueamos la tarea del stack BT, si la cola esta llena se descarta
+            if (xQueueSend(cmd_queue, &cmd, 0) != pdTRUE)
+            {
+                bin_dropped++;
+            }
+        }
+    }
+}
+
 // Callback para eventos GAP
 static void esp_bt_gap_cb(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *param)
 {
@@ -65,6 +104,7 @@ static void esp_bt_gap_cb(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *pa
 static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
 {
     bt_cmd_t cmd;
+    int session;
 
     switch (event)
     {
@@ -76,33 +116,55 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
 
     case ESP_SPP_START_EVT:
         ESP_LOGI(SPP_TAG, "ESP_SPP_START_EVT");
-        // Establecer el nombre del dispositivo después de iniciar SPP
-        esp_bt_dev_set_device_name(BT_DEVICE_NAME);
-        // Configurar el dispositivo como visible y conectable
+        // Unico punto donde el dispositivo pasa a visible y conectable, con A2DP y SPP ya registrados
         esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
+        boot_profile_mark(BOOT_PHASE_SPP);
         break;
 
     case ESP_SPP_SRV_OPEN_EVT:
-        ESP_LOGI(SPP_TAG, "ESP_SPP_SRV_OPEN_EVT - Cliente conectado");
-        spp_handle = param->srv_open.handle;
-        bt_connected = true;
+        session = spp_session_open(param->srv_open.handle);
+        if (session < 0)
+        {
+            // Sin espacio en la tabla de sesiones
+            esp_spp_disconnect(param->srv_open.handle);
+            break;
+        }
+        ESP_LOGI(SPP_TAG, "ESP_SPP_SRV_OPEN_EVT - Cliente conectado en sesion %d", session);
+        binary_mode[session] = false;
 
         // Enviar mensaje de bienvenida
         const char *welcome_msg = "Bienvenido a Melquiades Deck\r\n";
-        esp_spp_write(spp_handle, strlen(welcome_msg), (uint8_t *)welcome_msg);
+        spp_session_send(session, welcome_msg, strlen(welcome_msg));
 
         // Enviar menú de ayuda        
-        esp_spp_write(spp_handle, strlen(cmd_commands), (uint8_t *)cmd_commands);
+        spp_session_send(session, cmd_commands, strlen(cmd_commands));
         break;
 
     case ESP_SPP_CLOSE_EVT:
-        ESP_LOGI(SPP_TAG, "ESP_SPP_CLOSE_EVT - Cliente desconectado");
-        bt_connected = false;
+        session = spp_session_find(param->close.handle);
+        ESP_LOGI(SPP_TAG, "ESP_SPP_CLOSE_EVT - Cliente desconectado de sesion %d", session);
+        if (session >= 0)
+        {
+            binary_mode[session] = false;
+        }
+        // El streaming BT sigue mientras quede algun suscriptor
+        spp_session_close(param->close.handle);
         break;
 
     case ESP_SPP_DATA_IND_EVT:
+        session = spp_session_find(param->data_ind.handle);
+        if (session < 0)
+        {
+            break;
+        }
+        if (binary_mode[session])
+        {
+            process_binary_data(session, param->data_ind.data, param->data_ind.len);
+            break;
+        }
+
         // Recepción de datos
-        ESP_LOGI(SPP_TAG, "ESP_SPP_DATA_IND_EVT len=%d", param->data_ind.len);
+        TRACE_D(SPP_TAG, "ESP_SPP_DATA_IND_EVT sesion %d len=%d", session, param->data_ind.len);
 
         // Procesar solo comandos de tamaño razonable
         if (param->data_ind.len < sizeof(cmd.data) - 1)
@@ -111,6 +173,8 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
             memcpy(cmd.data, param->data_ind.data, param->data_ind.len);
             cmd.data[param->data_ind.len] = '\0';
             cmd.len = param->data_ind.len;
+            cmd.binary = false;
+            cmd.session = session;
 
             // Eliminar caracteres de retorno de carro y nueva línea
             for (int i = 0; i < cmd.len; i++)
@@ -121,7 +185,8 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
                 }
             }
 
-            ESP_LOGI(SPP_TAG, "Comando recibido: %s", cmd.data);
+            // El texto ya vuelve como eco a la sesion, la traza solo guarda el largo
+            TRACE_D(SPP_TAG, "Comando recibido en sesion %d, %d bytes", session, (int)strlen(cmd.data));
 
             // Enviar a la cola de comandos si no está vacío
             if (strlen(cmd.data) > 0)
@@ -131,13 +196,20 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
                 // Enviar eco del comando
                 char echo[80];
                 snprintf(echo, sizeof(echo), "Comando: %s\r\n", cmd.data);
-                esp_spp_write(spp_handle, strlen(echo), (uint8_t *)echo);
+                spp_session_send(session, echo, strlen(echo));
             }
         }
         break;
 
     case ESP_SPP_WRITE_EVT:
-        // No es necesario hacer nada después de escribir
+        // El stack confirma la escritura, la sacamos de las pendientes
+        spp_session_write_done(param->write.handle, param->write.status == ESP_SPP_SUCCESS);
+        spp_session_set_congested(param->write.handle, param->write.cong);
+        break;
+
+    case ESP_SPP_CONG_EVT:
+        // Cambio en el estado de congestion del enlace
+        spp_session_set_congested(param->cong.handle, param->cong.cong);
         break;
 
     default:
@@ -145,12 +217,40 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
     }
 }
 
-// Función para enviar respuesta por Bluetooth si hay conexión
-void send_bt_response(const char *response)
+// Sesion que origino el comando en ejecucion (solo valido dentro de handle_command)
+int spp_shell_session(void)
 {
-    if (bt_connected && spp_handle > 0)
+    return shell_session;
+}
+
+// Activa o desactiva el canal binario de control
+void spp_set_binary_mode(bool enabled)
+{
+    int session = shell_session;
+    if (session < 0 || session >= SPP_MAX_SESSIONS)
+    {
+        return;
+    }
+    if (enabled && !binary_mode[session])
     {
-        esp_spp_write(spp_handle, strlen(response), (uint8_t *)response);
+        bin_parser_reset(&bin_parsers[session]);
+    }
+    binary_mode[session] = enabled;
+    ESP_LOGI(SPP_TAG, "Sesion %d en modo %s", session, enabled ? "binario" : "texto");
+}
+
+// Copia de los contadores de transmision
+void spp_get_tx_stats(spp_tx_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        spp_session_get_totals(stats);
+        stats->rx_dropped = bin_dropped;
+        stats->rx_crc_errors = 0;
+        for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+        {
+            stats->rx_crc_errors += bin_parsers[i].crc_errors;
+        }
     }
 }
 
@@ -158,9 +258,10 @@ void send_bt_response(const char *response)
 void init_bluetooth(void)
 {
     esp_err_t ret;
-    cmd_queue = xQueueCreate(10, sizeof(bt_cmd_t));
+    cmd_queue = xQueueCreate(CMD_QUEUE_LEN, sizeof(bt_cmd_t));
 
     ESP_LOGI(SPP_TAG, "Inicializando Bluetooth SPP...");
+    spp_session_init();
 
     // Usar la inicialización común del Bluetooth
     if ((ret = init_bluetooth_common()) != ESP_OK) {
@@ -192,18 +293,90 @@ void init_bluetooth(void)
     ESP_LOGI(SPP_TAG, "Bluetooth inicializado correctamente");
 }
 
+// Linea compacta de medidores para el tema meters, se formatea una sola vez para todas las sesiones
+static void publish_meters(void)
+{
+    char line[160];
+    audio_output_stats_t audio;
+    spp_tx_stats_t spp;
+    audio_output_get_stats(&audio);
+    spp_get_tx_stats(&spp);
+    snprintf(line, sizeof(line), "Meters: heap %u, audio %s %u paquetes, underruns %u, dsp %u ciclos, spp %u tramas %u pendientes\r\n",
+             esp_get_free_heap_size(), a2dp_is_streaming() ? "on" : "off", a2dp_get_packet_count(),
+             audio.underruns, audio.dsp_cycles_avg, spp.frames, spp.in_flight);
+    spp_publish(SPP_TOPIC_METERS, line, strlen(line));
+}
+
+// Contadores del camino de audio en binario para el tema audio, mismo periodo que meters
+static void publish_audio_probe(void)
+{
+    uint8_t frame[SPP_FRAME_SIZE];
+    audio_probe_totals_t totals;
+    audio_probe_get(&totals);
+    size_t len = audio_probe_encode_binary(&totals, frame, sizeof(frame));
+    if (len > 0)
+    {
+        spp_publish(SPP_TOPIC_AUDIO, frame, len);
+    }
+}
+
 // Tarea para procesar comandos de la cola
 void bt_shell_task(void *pvParameter)
 {
-    char response[1024];
+    static char response[SHELL_RESPONSE_SIZE];
     bt_cmd_t cmd;    
+    TickType_t next_meters = xTaskGetTickCount() + pdMS_TO_TICKS(METERS_PERIOD_MS);
     while (1)
     {
-        if (xQueueReceive(cmd_queue, &cmd, portMAX_DELAY))
+        // La espera de la cola es lo que falta para el proximo meters: un cliente que manda
+        // comandos seguido no frena la publicacion periodica
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = (int32_t)(next_meters - now) > 0 ? next_meters - now : 0;
+        bool received = xQueueReceive(cmd_queue, &cmd, wait) == pdTRUE;
+        now = xTaskGetTickCount();
+        if ((int32_t)(next_meters - now) <= 0)
+        {
+            if (spp_topic_has_subscribers(SPP_TOPIC_METERS))
+            {
+                publish_meters();
+            }
+            if (spp_topic_has_subscribers(SPP_TOPIC_AUDIO))
+            {
+                publish_audio_probe();
+            }
+            next_meters += pdMS_TO_TICKS(METERS_PERIOD_MS);
+            // Despues de un comando largo no se recuperan periodos perdidos
+            if ((int32_t)(next_meters - now) <= 0)
+            {
+                next_meters = now + pdMS_TO_TICKS(METERS_PERIOD_MS);
+            }
+        }
+        if (received)
         {            
-            handle_command(cmd.data, response, sizeof(response), "BT");
-            send_bt_response(response);
+            shell_session = cmd.session;
+            if (cmd.binary)
+            {
+                bool exit_binary = false;
+                size_t len = handle_bin_command(cmd.opcode, (const uint8_t *)cmd.data, cmd.len,
+                                                (uint8_t *)response, sizeof(response), &exit_binary);
+                if (spp_session_send(cmd.session, response, len) != ESP_OK)
+                {
+                    ESP_LOGW(SPP_TAG, "Respuesta binaria de %u B descartada en sesion %d", (uint32_t)len, cmd.session);
+                }
+                if (exit_binary)
+                {
+                    spp_set_binary_mode(false);
+                }
+            }
+            else
+            {
+                size_t len = handle_command(cmd.data, response, sizeof(response), "BT");
+                if (spp_session_send(cmd.session, response, len) != ESP_OK)
+                {
+                    ESP_LOGW(SPP_TAG, "Respuesta de %u B descartada en sesion %d", (uint32_t)len, cmd.session);
+                }
+            }
+            shell_session = -1;
         }
-        vTaskDelay(pdMS_TO_TICKS(500)); // Delay para que el sistema no se emperique
     }
 }
@@ -1,8 +1,27 @@
 #ifndef INIT_H
 #define INIT_H
 
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Contadores de transmision SPP (suma de todas las sesiones)
+typedef struct {
+    uint32_t frames;        // Escrituras aceptadas por el stack
+    uint32_t bytes;         // Bytes encolados en el stack
+    uint32_t errors;        // Escrituras rechazadas o fallidas
+    uint32_t cong_events;   // Veces que el enlace entro en congestion
+    uint32_t in_flight;     // Escrituras pendientes de confirmacion (ESP_SPP_WRITE_EVT)
+    uint32_t in_flight_max; // Maximo de escrituras pendientes observado
+    bool congested;         // Estado actual de congestion
+    uint32_t rx_dropped;    // Tramas binarias descartadas por cola llena
+    uint32_t rx_crc_errors; // Tramas binarias con CRC invalido
+} spp_tx_stats_t;
+
 void init_bluetooth();
-void bt_shell_task();
-void send_bt_response();
+void bt_shell_task(void *pvParameter);
+void spp_get_tx_stats(spp_tx_stats_t *stats);
+void spp_set_binary_mode(bool enabled);
+int spp_shell_session(void);
 
-#endif // INIT_H
\ No newline at end of file
+#endif // INIT_H
@@ -0,0 +1,178 @@
+#include "spp_qos.h"
+// Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+
+#define SPP_QOS_DEFAULT_BUDGET_BPS  2048
+#define SPP_QOS_DEFAULT_BURST       512
+#define SPP_QOS_DEFAULT_RING_LOW    25
+#define SPP_QOS_DEFAULT_DECIMATE    4
+#define SPP_QOS_MIN_BUDGET_BPS      64
+#define SPP_QOS_MIN_BURST           256     // Al menos una trama completa del pool
+
+static const char *policy_names[SPP_QOS_POLICY_COUNT] = {"libre", "audio"};
+
+void spp_qos_default_config(spp_qos_config_t *cfg)
+{
+    cfg->enabled = true;
+    cfg->budget_bps = SPP_QOS_DEFAULT_BUDGET_BPS;
+    cfg->burst_bytes = SPP_QOS_DEFAULT_BURST;
+    cfg->ring_low_pct = SPP_QOS_DEFAULT_RING_LOW;
+    cfg->decimate_n = SPP_QOS_DEFAULT_DECIMATE;
+}
+
+void spp_qos_init(spp_qos_t *qos, const spp_qos_config_t *cfg, uint32_t now_ms)
+{
+    memset(qos, 0, sizeof(*qos));
+    qos->policy = SPP_QOS_POLICY_OPEN;
+    qos->last_ms = now_ms;
+    spp_qos_set_config(qos, cfg);
+    qos->tokens = (int32_t)qos->cfg.burst_bytes;
+}
+
+void spp_qos_set_config(spp_qos_t *qos, const spp_qos_config_t *cfg)
+{
+    qos->cfg = *cfg;
+    if (qos->cfg.decimate_n == 0)
+    {
+        qos->cfg.decimate_n = 1;
+    }
+    if (qos->cfg.budget_bps < SPP_QOS_MIN_BUDGET_BPS)
+    {
+        qos->cfg.budget_bps = SPP_QOS_MIN_BUDGET_BPS;
+    }
+    if (qos->cfg.burst_bytes < SPP_QOS_MIN_BURST)
+    {
+        qos->cfg.burst_bytes = SPP_QOS_MIN_BURST;
+    }
+    if (qos->tokens > (int32_t)qos->cfg.burst_bytes)
+    {
+        qos->tokens = (int32_t)qos->cfg.burst_bytes;
+    }
+}
+
+void spp_qos_update(spp_qos_t *qos, bool audio_streaming, uint8_t ring_fill_pct, uint32_t now_ms)
+{
+    qos->ring_fill_pct = ring_fill_pct;
+    qos->policy = (qos->cfg.enabled && audio_streaming) ? SPP_QOS_POLICY_AUDIO : SPP_QOS_POLICY_OPEN;
+
+    if (qos->policy == SPP_QOS_POLICY_OPEN)
+    {
+        // Sin audio el balde queda lleno para que el cambio de politica no arranque en deuda
+        qos->tokens = (int32_t)qos->cfg.burst_bytes;
+        qos->last_ms = now_ms;
+        return;
+    }
+
+    // Solo avanzamos last_ms por el tiempo que ya se convirtio en tokens, sin perder fracciones
+    uint32_t elapsed = now_ms - qos->last_ms;
+    uint32_t refill = (uint32_t)((uint64_t)elapsed * qos->cfg.budget_bps / 1000);
+    if (refill > 0)
+    {
+        qos->last_ms += (uint32_t)((uint64_t)refill * 1000 / qos->cfg.budget_bps);
+        int64_t tokens = (int64_t)qos->tokens + refill;
+        if (tokens > (int64_t)qos->cfg.burst_bytes)
+        {
+            tokens = qos->cfg.burst_bytes;
+            qos->last_ms = now_ms;
+        }
+        qos->tokens = (int32_t)tokens;
+    }
+}
+
+bool spp_qos_decimate(spp_qos_t *qos)
+{
+    if (qos->policy != SPP_QOS_POLICY_AUDIO || qos->ring_fill_pct >= qos->cfg.ring_low_pct)
+    {
+        return false;
+    }
+    // Con el ring de audio en peligro solo pasa 1 de cada N tramas publicadas
+    qos->decimate_count++;
+    if (qos->decimate_count % qos->cfg.decimate_n == 0)
+    {
+        return false;
+    }
+    qos->stats[qos->policy].decimated++;
+    return true;
+}
+
+uint32_t spp_qos_allowance(const spp_qos_t *qos)
+{
+    if (qos->policy == SPP_QOS_POLICY_OPEN)
+    {
+        return UINT32_MAX;
+    }
+    return qos->tokens > 0 ? (uint32_t)qos->tokens : 0;
+}
+
+uint32_t spp_qos_wait_ms(const spp_qos_t *qos, uint32_t bytes)
+{
+    uint32_t allowance = spp_qos_allowance(qos);
+    if (allowance >= bytes || qos->cfg.budget_bps == 0)
+    {
+        return 0;
+    }
+    uint32_t missing = bytes - allowance;
+    return (uint32_t)(((uint64_t)missing * 1000 + qos->cfg.budget_bps - 1) / qos->cfg.budget_bps);
+}
+
+void spp_qos_charge(spp_qos_t *qos, uint32_t bytes, uint32_t frames)
+{
+    spp_qos_policy_stats_t *st = &qos->stats[qos->policy];
+    st->writes++;
+    st->bytes += bytes;
+    st->frames += frames;
+    if (qos->policy == SPP_QOS_POLICY_AUDIO)
+    {
+        qos->tokens -= (int32_t)bytes;
+    }
+}
+
+void spp_qos_note_throttled(spp_qos_t *qos)
+{
+    qos->stats[qos->policy].throttled++;
+}
+
+void spp_qos_record_latency(spp_qos_t *qos, uint32_t latency_ms)
+{
+    spp_qos_policy_stats_t *st = &qos->stats[qos->policy];
+    st->latency_samples++;
+    st->latency_total_ms += latency_ms;
+    if (latency_ms > st->latency_max_ms)
+    {
+        st->latency_max_ms = latency_ms;
+    }
+}
+
+void spp_qos_record_underruns(spp_qos_t *qos, uint32_t underruns)
+{
+    qos->stats[qos->policy].underruns += underruns;
+}
+
+size_t spp_qos_format(const spp_qos_t *qos, char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    if (out == NULL || size == 0)
+    {
+        return 0;
+    }
+    n = snprintf(out, size, "QoS %s: presupuesto %u B/s, rafaga %u B, ring bajo %u%%, diezmado 1/%u\n"
+                 "Politica actual: %s, tokens %d, ring %u%%\n",
+                 qos->cfg.enabled ? "activo" : "inactivo", qos->cfg.budget_bps, qos->cfg.burst_bytes,
+                 qos->cfg.ring_low_pct, qos->cfg.decimate_n, policy_names[qos->policy],
+                 qos->tokens, qos->ring_fill_pct);
+    len = n > 0 ? (size_t)n : 0;
+    for (int i = 0; i < SPP_QOS_POLICY_COUNT && len < size; i++)
+    {
+        const spp_qos_policy_stats_t *st = &qos->stats[i];
+        uint32_t avg = st->latency_samples > 0 ? (uint32_t)(st->latency_total_ms / st->latency_samples) : 0;
+        n = snprintf(out + len, size - len,
+                     "  %-5s: tramas %u, bytes %u, escrituras %u, diezmadas %u, esperas %u, "
+                     "underruns %u, latencia sensores prom %u ms max %u ms\n",
+                     policy_names[i], st->frames, st->bytes, st->writes, st->decimated, st->throttled,
+                     st->underruns, avg, st->latency_max_ms);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
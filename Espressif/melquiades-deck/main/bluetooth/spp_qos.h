@@ -0,0 +1,118 @@
+#ifndef SPP_QOS_H
+#define SPP_QOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Politica activa del planificador SPP
+typedef enum {
+    SPP_QOS_POLICY_OPEN = 0,    // Sin limite: audio detenido o QoS desactivado
+    SPP_QOS_POLICY_AUDIO,       // Presupuesto de aire mientras suena A2DP
+    SPP_QOS_POLICY_COUNT
+} spp_qos_policy_t;
+
+// Parametros configurables desde el shell
+typedef struct {
+    bool enabled;
+    uint32_t budget_bps;        // Bytes por segundo permitidos con audio activo
+    uint32_t burst_bytes;       // Maximo acumulable en el balde de tokens
+    uint8_t ring_low_pct;       // Bajo esta ocupacion del ring se diezman los temas
+    uint8_t decimate_n;         // Con ring bajo pasa 1 de cada N tramas publicadas
+} spp_qos_config_t;
+
+// Metricas acumuladas por politica
+typedef struct {
+    uint32_t frames;            // Tramas publicadas enviadas
+    uint32_t bytes;
+    uint32_t writes;            // Escrituras al stack (varias tramas por lote)
+    uint32_t decimated;         // Tramas descartadas por diezmado
+    uint32_t throttled;         // Veces que el envio espero por tokens
+    uint32_t underruns;         // Underruns de audio observados con esta politica
+    uint32_t latency_samples;   // Tramas de sensores medidas
+    uint64_t latency_total_ms;
+    uint32_t latency_max_ms;
+} spp_qos_policy_stats_t;
+
+// Estado del planificador, sin dependencias de FreeRTOS para poder probarlo en host
+typedef struct {
+    spp_qos_config_t cfg;
+    spp_qos_policy_t policy;
+    int32_t tokens;             // Puede quedar negativo tras una respuesta directa
+    uint32_t last_ms;
+    uint8_t ring_fill_pct;
+    uint32_t decimate_count;
+    spp_qos_policy_stats_t stats[SPP_QOS_POLICY_COUNT];
+} spp_qos_t;
+
+/**
+ * @brief Valores por defecto: 2 kB/s con audio, ring bajo al 25%, diezmado 1 de 4
+ */
+void spp_qos_default_config(spp_qos_config_t *cfg);
+
+/**
+ * @brief Inicializa el planificador con la configuracion dada
+ */
+void spp_qos_init(spp_qos_t *qos, const spp_qos_config_t *cfg, uint32_t now_ms);
+
+/**
+ * @brief Cambia la configuracion conservando las metricas
+ */
+void spp_qos_set_config(spp_qos_t *qos, const spp_qos_config_t *cfg);
+
+/**
+ * @brief Recalcula la politica segun el estado del audio y recarga tokens
+ *
+ * @param audio_streaming true si A2DP esta en ESP_A2D_AUDIO_STATE_STARTED
+ * @param ring_fill_pct Ocupacion del ring de audio (0-100)
+ * @param now_ms Tiempo actual en milisegundos
+ */
+void spp_qos_update(spp_qos_t *qos, bool audio_streaming, uint8_t ring_fill_pct, uint32_t now_ms);
+
+/**
+ * @brief Decide si una trama publicada se descarta por diezmado
+ *
+ * @return true si la trama debe descartarse
+ */
+bool spp_qos_decimate(spp_qos_t *qos);
+
+/**
+ * @brief Bytes que se pueden enviar ahora sin exceder el presupuesto
+ */
+uint32_t spp_qos_allowance(const spp_qos_t *qos);
+
+/**
+ * @brief Milisegundos hasta poder enviar la cantidad de bytes indicada
+ */
+uint32_t spp_qos_wait_ms(const spp_qos_t *qos, uint32_t bytes);
+
+/**
+ * @brief Descuenta bytes enviados del presupuesto
+ *
+ * @param frames Tramas publicadas incluidas en la escritura (0 para respuestas directas)
+ */
+void spp_qos_charge(spp_qos_t *qos, uint32_t bytes, uint32_t frames);
+
+/**
+ * @brief Registra que el envio tuvo que esperar por tokens
+ */
+void spp_qos_note_throttled(spp_qos_t *qos);
+
+/**
+ * @brief Registra la latencia publicacion-envio de una trama de sensores
+ */
+void spp_qos_record_latency(spp_qos_t *qos, uint32_t latency_ms);
+
+/**
+ * @brief Atribuye underruns de audio a la politica activa
+ */
+void spp_qos_record_underruns(spp_qos_t *qos, uint32_t underruns);
+
+/**
+ * @brief Formatea configuracion y metricas por politica en texto
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t spp_qos_format(const spp_qos_t *qos, char *out, size_t size);
+
+#endif // SPP_QOS_H
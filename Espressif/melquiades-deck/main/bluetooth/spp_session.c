@@ -0,0 +1,741 @@
+#include "spp_session.h"
+// Bibliotecas de sistema
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_spp_api.h"
+#include "esp_timer.h"
+// Bibliotecas custom
+#include "spp_init.h"
+#include "a2dp_sink.h"
+#include "../audio/audio_output.h"
+#include "../system/event_bus.h"
+
+#define SPP_SESSION_TAG "SPP_SESSION"
+// Periodo maximo de la tarea TX sin eventos, tambien refresca la politica QoS
+#define SPP_TX_IDLE_WAIT_MS 100
+
+typedef struct {
+    bool active;
+    uint32_t handle;
+    uint32_t generation;    // Sube en cada apertura, invalida la trama retenida por la tarea TX
+    uint32_t topics;
+    bool congested;
+    uint32_t in_flight;
+    QueueHandle_t txq;      // Punteros a spp_frame_t pendientes
+    // Respuestas directas: se copian enteras aqui y la tarea TX las parte en escrituras
+    uint8_t resp_buf[SPP_RESP_BUF_SIZE];
+    size_t resp_len;
+    size_t resp_sent;
+    spp_session_stats_t stats;
+} spp_session_t;
+
+static spp_session_t sessions[SPP_MAX_SESSIONS];
+static spp_frame_t frame_pool[SPP_FRAME_POOL_SIZE];
+static QueueHandle_t free_frames;   // Lista libre del pool
+static TaskHandle_t tx_task_handle = NULL;
+// Protege los buffers de respuesta: escriben el callback del stack y el shell, lee la tarea TX
+static portMUX_TYPE resp_lock = portMUX_INITIALIZER_UNLOCKED;
+// Trama que la tarea TX ya saco de la cola de una sesion pero no pudo enviar (sin presupuesto o
+// sin lugar en el lote). Solo la toca la tarea TX: cerrar la sesion vacia la cola sin carrera
+// con ella, y la generacion detecta que la sesion se cerro mientras la trama estaba retenida.
+static spp_frame_t *tx_head[SPP_MAX_SESSIONS];
+static uint32_t tx_head_gen[SPP_MAX_SESSIONS];
+
+// Totales de todas las sesiones (se exponen en status)
+static spp_tx_stats_t totals = {0};
+// Protege totals y los contadores de escritura de cada sesion: la tarea TX escribe y el callback
+// del stack confirma, un decremento perdido dejaria in_flight dando la vuelta
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+// Salida de logs original, se sigue usando para la UART
+static vprintf_like_t default_vprintf = NULL;
+
+// Planificador de aire: lo modifican la tarea TX y quienes publican (diezmado), siempre con
+// qos_lock tomado. El shell deja la configuracion pendiente y la aplica la tarea TX.
+static spp_qos_t qos;
+static spp_qos_config_t pending_qos_cfg;
+static bool qos_cfg_pending = false;
+static portMUX_TYPE qos_lock = portMUX_INITIALIZER_UNLOCKED;
+// Suscripcion al bus de la tarea TX: transporte y telemetria solo la despiertan y cuentan underruns
+static int bus_subscriber = -1;
+// Lote de tramas publicadas agrupadas en una sola escritura mientras suena audio
+static uint8_t batch_buf[SPP_FRAME_SIZE];
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void notify_tx_task(void)
+{
+    if (tx_task_handle != NULL)
+    {
+        xTaskNotifyGive(tx_task_handle);
+    }
+}
+
+static bool valid_session(int session)
+{
+    return session >= 0 && session < SPP_MAX_SESSIONS && sessions[session].active;
+}
+
+// Encola una referencia del buffer en la sesion, sin bloquear
+static bool enqueue_frame(spp_session_t *s, spp_frame_t *frame, TickType_t wait)
+{
+    __atomic_fetch_add(&frame->refcount, 1, __ATOMIC_RELAXED);
+    if (xQueueSend(s->txq, &frame, wait) != pdTRUE)
+    {
+        __atomic_fetch_add(&s->stats.dropped, 1, __ATOMIC_RELAXED);
+        spp_frame_release(frame);
+        return false;
+    }
+    uint32_t queued = uxQueueMessagesWaiting(s->txq);
+    if (queued > s->stats.queue_max)
+    {
+        s->stats.queue_max = queued;
+    }
+    return true;
+}
+
+static void drain_queue(spp_session_t *s)
+{
+    spp_frame_t *frame;
+    while (xQueueReceive(s->txq, &frame, 0) == pdTRUE)
+    {
+        spp_frame_release(frame);
+    }
+}
+
+static void reset_response(spp_session_t *s)
+{
+    portENTER_CRITICAL(&resp_lock);
+    s->resp_len = 0;
+    s->resp_sent = 0;
+    portEXIT_CRITICAL(&resp_lock);
+}
+
+// Copia cada linea de log al tema logs, formateada directamente sobre un buffer del pool
+static int spp_log_vprintf(const char *fmt, va_list args)
+{
+    if (spp_topic_has_subscribers(SPP_TOPIC_LOGS))
+    {
+        spp_frame_t *frame = spp_frame_alloc();
+        if (frame != NULL)
+        {
+            va_list copy;
+            va_copy(copy, args);
+            int n = vsnprintf((char *)frame->data, SPP_FRAME_SIZE, fmt, copy);
+            va_end(copy);
+            if (n > 0)
+            {
+                frame->len = (uint16_t)(n < SPP_FRAME_SIZE ? n : SPP_FRAME_SIZE - 1);
+                spp_publish_frame(SPP_TOPIC_LOGS, frame);
+            }
+            spp_frame_release(frame);
+        }
+    }
+    return default_vprintf(fmt, args);
+}
+
+void spp_session_init(void)
+{
+    free_frames = xQueueCreate(SPP_FRAME_POOL_SIZE, sizeof(spp_frame_t *));
+    for (int i = 0; i < SPP_FRAME_POOL_SIZE; i++)
+    {
+        spp_frame_t *frame = &frame_pool[i];
+        frame->refcount = 0;
+        xQueueSend(free_frames, &frame, 0);
+    }
+    for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+    {
+        memset(&sessions[i], 0, sizeof(sessions[i]));
+        sessions[i].txq = xQueueCreate(SPP_SESSION_QUEUE_LEN, sizeof(spp_frame_t *));
+    }
+    spp_qos_config_t cfg;
+    spp_qos_default_config(&cfg);
+    spp_qos_init(&qos, &cfg, now_ms());
+    default_vprintf = esp_log_set_vprintf(spp_log_vprintf);
+}
+
+int spp_session_open(uint32_t handle)
+{
+    for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+    {
+        spp_session_t *s = &sessions[i];
+        if (!s->active)
+        {
+            drain_queue(s);
+            reset_response(s);
+            s->generation++;
+            s->topics = 0;
+            s->congested = false;
+            portENTER_CRITICAL(&stats_lock);
+            s->in_flight = 0;
+            memset(&s->stats, 0, sizeof(s->stats));
+            portEXIT_CRITICAL(&stats_lock);
+            s->handle = handle;
+            s->active = true;
+            event_bus_publish_u32(BUS_TOPIC_TRANSPORT, BUS_TRANSPORT_SPP_OPEN, (uint32_t)i);
+            return i;
+        }
+    }
+    ESP_LOGW(SPP_SESSION_TAG, "Tabla de sesiones llena, se rechaza handle %u", handle);
+    return -1;
+}
+
+void spp_session_close(uint32_t handle)
+{
+    int session = spp_session_find(handle);
+    if (session < 0)
+    {
+        return;
+    }
+    spp_session_t *s = &sessions[session];
+    s->active = false;
+    s->topics = 0;
+    s->congested = false;
+    portENTER_CRITICAL(&stats_lock);
+    totals.in_flight = (s->in_flight < totals.in_flight) ? totals.in_flight - s->in_flight : 0;
+    s->in_flight = 0;
+    portEXIT_CRITICAL(&stats_lock);
+    drain_queue(s);
+    reset_response(s);
+    event_bus_publish_u32(BUS_TOPIC_TRANSPORT, BUS_TRANSPORT_SPP_CLOSE, (uint32_t)session);
+}
+
+int spp_session_find(uint32_t handle)
+{
+    for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].active && sessions[i].handle == handle)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void spp_session_set_congested(uint32_t handle, bool congested)
+{
+    int session = spp_session_find(handle);
+    if (session < 0)
+    {
+        return;
+    }
+    spp_session_t *s = &sessions[session];
+    if (congested && !s->congested)
+    {
+        portENTER_CRITICAL(&stats_lock);
+        totals.cong_events++;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+    s->congested = congested;
+    if (!congested)
+    {
+        notify_tx_task();
+    }
+}
+
+void spp_session_write_done(uint32_t handle, bool ok)
+{
+    int session = spp_session_find(handle);
+    if (session < 0)
+    {
+        return;
+    }
+    spp_session_t *s = &sessions[session];
+    portENTER_CRITICAL(&stats_lock);
+    if (s->in_flight > 0)
+    {
+        s->in_flight--;
+        totals.in_flight--;
+    }
+    if (!ok)
+    {
+        s->stats.errors++;
+        totals.errors++;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void spp_session_subscribe(int session, uint32_t topics, bool enable)
+{
+    if (!valid_session(session))
+    {
+        return;
+    }
+    if (enable)
+    {
+        sessions[session].topics |= topics;
+    }
+    else
+    {
+        sessions[session].topics &= ~topics;
+    }
+}
+
+bool spp_session_is_subscribed(int session, uint32_t topic)
+{
+    return valid_session(session) && (sessions[session].topics & topic) != 0;
+}
+
+bool spp_topic_has_subscribers(uint32_t topic)
+{
+    for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].active && (sessions[i].topics & topic))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t spp_topic_from_name(const char *name)
+{
+    if (strcmp(name, "sensors") == 0)
+    {
+        return SPP_TOPIC_SENSORS;
+    }
+    if (strcmp(name, "meters") == 0)
+    {
+        return SPP_TOPIC_METERS;
+    }
+    if (strcmp(name, "logs") == 0)
+    {
+        return SPP_TOPIC_LOGS;
+    }
+    if (strcmp(name, "keys") == 0)
+    {
+        return SPP_TOPIC_KEYS;
+    }
+    if (strcmp(name, "audio") == 0)
+    {
+        return SPP_TOPIC_AUDIO;
+    }
+    return 0;
+}
+
+spp_frame_t *spp_frame_alloc(void)
+{
+    spp_frame_t *frame = NULL;
+    if (xQueueReceive(free_frames, &frame, 0) != pdTRUE)
+    {
+        return NULL;
+    }
+    frame->refcount = 1;
+    frame->len = 0;
+    return frame;
+}
+
+void spp_frame_release(spp_frame_t *frame)
+{
+    if (frame == NULL)
+    {
+        return;
+    }
+    if (__atomic_sub_fetch(&frame->refcount, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        xQueueSend(free_frames, &frame, 0);
+    }
+}
+
+void spp_publish_frame(uint32_t topic, spp_frame_t *frame)
+{
+    bool queued = false;
+    frame->topic = topic;
+    frame->stamp_us = esp_timer_get_time();
+    // Mientras el ring de audio este bajo se deja pasar solo una parte de las tramas
+    portENTER_CRITICAL(&qos_lock);
+    bool decimated = spp_qos_decimate(&qos);
+    portEXIT_CRITICAL(&qos_lock);
+    if (decimated)
+    {
+        return;
+    }
+    for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+    {
+        spp_session_t *s = &sessions[i];
+        if (s->active && (s->topics & topic))
+        {
+            queued |= enqueue_frame(s, frame, 0);
+        }
+    }
+    if (queued)
+    {
+        notify_tx_task();
+    }
+}
+
+void spp_publish(uint32_t topic, const void *data, size_t len)
+{
+    if (len == 0 || len > SPP_FRAME_SIZE || !spp_topic_has_subscribers(topic))
+    {
+        return;
+    }
+    spp_frame_t *frame = spp_frame_alloc();
+    if (frame == NULL)
+    {
+        // Sin buffers: cuenta como descarte en todas las sesiones suscritas
+        for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+        {
+            if (sessions[i].active && (sessions[i].topics & topic))
+            {
+                __atomic_fetch_add(&sessions[i].stats.dropped, 1, __ATOMIC_RELAXED);
+            }
+        }
+        return;
+    }
+    memcpy(frame->data, data, len);
+    frame->len = (uint16_t)len;
+    spp_publish_frame(topic, frame);
+    spp_frame_release(frame);
+}
+
+esp_err_t spp_session_send(int session, const void *data, size_t len)
+{
+    if (!valid_session(session))
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len == 0)
+    {
+        return ESP_OK;
+    }
+    spp_session_t *s = &sessions[session];
+    bool fits;
+    // Copia de hasta 2 kB con la seccion critica tomada: unos pocos microsegundos
+    portENTER_CRITICAL(&resp_lock);
+    if (s->resp_len + len > SPP_RESP_BUF_SIZE && s->resp_sent > 0)
+    {
+        // Corre lo pendiente al principio para hacer lugar
+        memmove(s->resp_buf, s->resp_buf + s->resp_sent, s->resp_len - s->resp_sent);
+        s->resp_len -= s->resp_sent;
+        s->resp_sent = 0;
+    }
+    fits = s->resp_len + len <= SPP_RESP_BUF_SIZE;
+    if (fits)
+    {
+        memcpy(s->resp_buf + s->resp_len, data, len);
+        s->resp_len += len;
+    }
+    portEXIT_CRITICAL(&resp_lock);
+    if (!fits)
+    {
+        __atomic_fetch_add(&s->stats.dropped, 1, __ATOMIC_RELAXED);
+        return ESP_ERR_NO_MEM;
+    }
+    notify_tx_task();
+    return ESP_OK;
+}
+
+void spp_session_get_stats(int session, spp_session_stats_t *stats)
+{
+    if (stats == NULL || session < 0 || session >= SPP_MAX_SESSIONS)
+    {
+        return;
+    }
+    spp_session_t *s = &sessions[session];
+    portENTER_CRITICAL(&stats_lock);
+    *stats = s->stats;
+    portEXIT_CRITICAL(&stats_lock);
+    stats->active = s->active;
+    stats->topics = s->topics;
+    stats->congested = s->congested;
+    stats->queued = uxQueueMessagesWaiting(s->txq);
+    portENTER_CRITICAL(&resp_lock);
+    stats->resp_pending = (uint32_t)(s->resp_len - s->resp_sent);
+    portEXIT_CRITICAL(&resp_lock);
+}
+
+void spp_session_get_totals(spp_tx_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    *stats = totals;
+    portEXIT_CRITICAL(&stats_lock);
+    stats->congested = false;
+    for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].active && sessions[i].congested)
+        {
+            stats->congested = true;
+        }
+    }
+}
+
+void spp_session_get_qos(spp_qos_t *out)
+{
+    if (out != NULL)
+    {
+        portENTER_CRITICAL(&qos_lock);
+        *out = qos;
+        if (qos_cfg_pending)
+        {
+            out->cfg = pending_qos_cfg;
+        }
+        portEXIT_CRITICAL(&qos_lock);
+    }
+}
+
+void spp_session_set_qos_config(const spp_qos_config_t *cfg)
+{
+    portENTER_CRITICAL(&qos_lock);
+    pending_qos_cfg = *cfg;
+    qos_cfg_pending = true;
+    portEXIT_CRITICAL(&qos_lock);
+    notify_tx_task();
+}
+
+// Escribe al stack, que copia los datos antes de volver. La escritura se cuenta en vuelo antes de
+// llamarlo porque la confirmacion puede llegar al callback antes de que esp_spp_write vuelva.
+static void write_data(spp_session_t *s, const uint8_t *data, uint16_t len)
+{
+    portENTER_CRITICAL(&stats_lock);
+    s->in_flight++;
+    totals.in_flight++;
+    if (totals.in_flight > totals.in_flight_max)
+    {
+        totals.in_flight_max = totals.in_flight;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    esp_err_t ret = esp_spp_write(s->handle, len, (uint8_t *)data);
+    portENTER_CRITICAL(&stats_lock);
+    if (ret == ESP_OK)
+    {
+        s->stats.frames++;
+        s->stats.bytes += len;
+        totals.frames++;
+        totals.bytes += len;
+    }
+    else
+    {
+        if (s->in_flight > 0)
+        {
+            s->in_flight--;
+            totals.in_flight--;
+        }
+        s->stats.errors++;
+        totals.errors++;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+static void qos_charge(uint32_t bytes, uint32_t frames)
+{
+    portENTER_CRITICAL(&qos_lock);
+    spp_qos_charge(&qos, bytes, frames);
+    portEXIT_CRITICAL(&qos_lock);
+}
+
+// Actualiza la politica con el estado de A2DP y el ring, y atribuye los underruns nuevos
+static void qos_refresh(void)
+{
+    bus_event_t event;
+    uint32_t underruns = 0;
+    // Los eventos de transporte solo despiertan a la tarea: con la cola llena se pierden, el
+    // estado del stream se lee siempre de A2DP
+    while (event_bus_receive(bus_subscriber, &event))
+    {
+        if (event.type == BUS_TELEMETRY_UNDERRUN)
+        {
+            underruns++;
+        }
+    }
+    bool audio_streaming = a2dp_is_streaming();
+    uint8_t ring_fill = audio_output_get_ring_fill();
+    portENTER_CRITICAL(&qos_lock);
+    if (qos_cfg_pending)
+    {
+        qos_cfg_pending = false;
+        spp_qos_set_config(&qos, &pending_qos_cfg);
+    }
+    spp_qos_record_underruns(&qos, underruns);
+    spp_qos_update(&qos, audio_streaming, ring_fill, now_ms());
+    portEXIT_CRITICAL(&qos_lock);
+}
+
+// Latencia desde la publicacion hasta la entrega al stack, solo para sensores
+static void note_sent(spp_frame_t *frame)
+{
+    if (frame->topic & SPP_TOPIC_SENSORS)
+    {
+        uint32_t latency_ms = (uint32_t)((esp_timer_get_time() - frame->stamp_us) / 1000);
+        portENTER_CRITICAL(&qos_lock);
+        spp_qos_record_latency(&qos, latency_ms);
+        portEXIT_CRITICAL(&qos_lock);
+    }
+    spp_frame_release(frame);
+}
+
+// Envia el siguiente trozo de las respuestas directas, que nunca esperan por presupuesto
+static bool service_response(spp_session_t *s)
+{
+    size_t len = 0;
+    portENTER_CRITICAL(&resp_lock);
+    size_t pending = s->resp_len - s->resp_sent;
+    if (pending > 0)
+    {
+        len = pending > SPP_FRAME_SIZE ? SPP_FRAME_SIZE : pending;
+        memcpy(batch_buf, s->resp_buf + s->resp_sent, len);
+        s->resp_sent += len;
+        if (s->resp_sent == s->resp_len)
+        {
+            s->resp_len = 0;
+            s->resp_sent = 0;
+        }
+    }
+    portEXIT_CRITICAL(&resp_lock);
+    if (len == 0)
+    {
+        return false;
+    }
+    write_data(s, batch_buf, (uint16_t)len);
+    // Si consumen presupuesto: el balde puede quedar negativo
+    qos_charge(len, 0);
+    return true;
+}
+
+// Siguiente trama de la sesion: la retenida o la cabeza de la cola. La tarea TX pasa a ser duenia
+// de la referencia apenas la saca de la cola.
+static spp_frame_t *take_frame(int session, uint32_t *generation)
+{
+    spp_session_t *s = &sessions[session];
+    spp_frame_t *frame = tx_head[session];
+    if (frame != NULL)
+    {
+        tx_head[session] = NULL;
+        if (tx_head_gen[session] == s->generation)
+        {
+            *generation = tx_head_gen[session];
+            return frame;
+        }
+        // La sesion se cerro (y quizas se reabrio) con la trama retenida
+        spp_frame_release(frame);
+    }
+    *generation = __atomic_load_n(&s->generation, __ATOMIC_ACQUIRE);
+    if (xQueueReceive(s->txq, &frame, 0) != pdTRUE)
+    {
+        return NULL;
+    }
+    if (__atomic_load_n(&s->generation, __ATOMIC_ACQUIRE) != *generation)
+    {
+        spp_frame_release(frame);
+        return NULL;
+    }
+    return frame;
+}
+
+static void hold_frame(int session, spp_frame_t *frame, uint32_t generation)
+{
+    tx_head[session] = frame;
+    tx_head_gen[session] = generation;
+}
+
+// Envia una respuesta pendiente o la cabeza de la cola de una sesion si el presupuesto lo permite
+static bool service_session(int session, uint32_t *wait_ms)
+{
+    spp_session_t *s = &sessions[session];
+    spp_frame_t *frame;
+    uint32_t generation;
+    if (service_response(s))
+    {
+        return true;
+    }
+    frame = take_frame(session, &generation);
+    if (frame == NULL)
+    {
+        return false;
+    }
+    if (spp_qos_allowance(&qos) < frame->len)
+    {
+        uint32_t wait = spp_qos_wait_ms(&qos, frame->len);
+        portENTER_CRITICAL(&qos_lock);
+        spp_qos_note_throttled(&qos);
+        portEXIT_CRITICAL(&qos_lock);
+        if (wait < *wait_ms)
+        {
+            *wait_ms = wait;
+        }
+        hold_frame(session, frame, generation);
+        return false;
+    }
+
+    if (qos.policy == SPP_QOS_POLICY_OPEN)
+    {
+        write_data(s, frame->data, frame->len);
+        qos_charge(frame->len, 1);
+        note_sent(frame);
+        return true;
+    }
+
+    // Con audio activo se agrupan tramas publicadas consecutivas para ahorrar paquetes de aire
+    uint16_t len = frame->len;
+    uint32_t frames = 1;
+    memcpy(batch_buf, frame->data, frame->len);
+    note_sent(frame);
+    while ((frame = take_frame(session, &generation)) != NULL)
+    {
+        if (len + frame->len > SPP_FRAME_SIZE || len + frame->len > spp_qos_allowance(&qos))
+        {
+            hold_frame(session, frame, generation);
+            break;
+        }
+        memcpy(batch_buf + len, frame->data, frame->len);
+        len += frame->len;
+        frames++;
+        note_sent(frame);
+    }
+    write_data(s, batch_buf, len);
+    qos_charge(len, frames);
+    return true;
+}
+
+void spp_tx_task(void *pvParameters)
+{
+    uint32_t wait_ms = SPP_TX_IDLE_WAIT_MS;
+    tx_task_handle = xTaskGetCurrentTaskHandle();
+    // El cambio de estado del audio o un underrun despiertan a la tarea y ajustan el presupuesto al momento
+    bus_subscriber = event_bus_subscribe("spp_tx", BUS_TOPIC_MASK(BUS_TOPIC_TRANSPORT) |
+                                         BUS_TOPIC_MASK(BUS_TOPIC_TELEMETRY), tx_task_handle);
+    while (1)
+    {
+        // Despierta al publicar, al liberarse la congestion o cuando hay tokens de nuevo
+        TickType_t ticks = pdMS_TO_TICKS(wait_ms);
+        ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+        qos_refresh();
+        wait_ms = SPP_TX_IDLE_WAIT_MS;
+
+        // Round-robin: una escritura por sesion en cada vuelta
+        bool pending = true;
+        while (pending)
+        {
+            pending = false;
+            for (int i = 0; i < SPP_MAX_SESSIONS; i++)
+            {
+                spp_session_t *s = &sessions[i];
+                if (!s->active && tx_head[i] != NULL)
+                {
+                    // No retener un buffer del pool para una sesion cerrada
+                    spp_frame_release(tx_head[i]);
+                    tx_head[i] = NULL;
+                }
+                if (!s->active || s->congested)
+                {
+                    continue;
+                }
+                if (service_session(i, &wait_ms))
+                {
+                    pending = true;
+                }
+            }
+        }
+    }
+}
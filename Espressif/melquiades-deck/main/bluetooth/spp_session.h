@@ -0,0 +1,167 @@
+#ifndef SPP_SESSION_H
+#define SPP_SESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "spp_init.h"
+#include "spp_qos.h"
+
+// Una sesion por cada enlace ACL BR/EDR permitido por el controlador
+#define SPP_MAX_SESSIONS        CONFIG_BTDM_CTRL_BR_EDR_MAX_ACL_CONN
+#define SPP_FRAME_SIZE          256     // Bytes utiles por buffer del pool
+#define SPP_FRAME_POOL_SIZE     16      // Buffers compartidos entre todas las sesiones
+#define SPP_SESSION_QUEUE_LEN   12      // Tramas pendientes por sesion
+#define SPP_RESP_BUF_SIZE       4096    // Respuestas directas pendientes por sesion (dos respuestas completas del shell)
+
+// Temas a los que se puede suscribir cada cliente
+typedef enum {
+    SPP_TOPIC_SENSORS = (1 << 0),   // Lecturas de pots y botones
+    SPP_TOPIC_METERS = (1 << 1),    // Telemetria periodica (audio, colas)
+    SPP_TOPIC_LOGS = (1 << 2),      // Copia de los logs del sistema
+    SPP_TOPIC_KEYS = (1 << 3),      // Reportes de atajos en tramas binarias BIN_FRAME_KEYS
+    SPP_TOPIC_AUDIO = (1 << 4),     // Contadores del camino de audio en tramas BIN_FRAME_AUDIO
+} spp_topic_t;
+
+// Buffer con contador de referencias: se formatea una vez y se comparte entre sesiones
+typedef struct {
+    uint32_t refcount;
+    uint32_t topic;         // Tema publicado
+    int64_t stamp_us;       // Momento de publicacion, para medir latencia
+    uint16_t len;
+    uint8_t data[SPP_FRAME_SIZE];
+} spp_frame_t;
+
+// Estadisticas por sesion
+typedef struct {
+    bool active;
+    uint32_t topics;
+    uint32_t frames;        // Tramas escritas al stack
+    uint32_t bytes;         // Bytes escritos al stack
+    uint32_t dropped;       // Tramas descartadas por cola llena
+    uint32_t errors;        // Escrituras rechazadas por el stack
+    uint32_t queued;        // Tramas esperando en la cola de la sesion
+    uint32_t resp_pending;  // Bytes de respuestas directas sin enviar
+    uint32_t queue_max;     // Maximo de tramas en cola observado
+    bool congested;
+} spp_session_stats_t;
+
+/**
+ * @brief Inicializa la tabla de sesiones y el pool de buffers
+ */
+void spp_session_init(void);
+
+/**
+ * @brief Registra un cliente nuevo (ESP_SPP_SRV_OPEN_EVT)
+ *
+ * @return int Indice de sesion, -1 si la tabla esta llena
+ */
+int spp_session_open(uint32_t handle);
+
+/**
+ * @brief Libera la sesion asociada al handle (ESP_SPP_CLOSE_EVT)
+ */
+void spp_session_close(uint32_t handle);
+
+/**
+ * @brief Busca la sesion asociada a un handle SPP
+ *
+ * @return int Indice de sesion, -1 si no existe
+ */
+int spp_session_find(uint32_t handle);
+
+/**
+ * @brief Actualiza el estado de congestion de una sesion y despierta la tarea TX si se libera
+ */
+void spp_session_set_congested(uint32_t handle, bool congested);
+
+/**
+ * @brief Confirma una escritura completada por el stack (ESP_SPP_WRITE_EVT)
+ */
+void spp_session_write_done(uint32_t handle, bool ok);
+
+/**
+ * @brief Suscribe o desuscribe una sesion a uno o varios temas
+ */
+void spp_session_subscribe(int session, uint32_t topics, bool enable);
+
+/**
+ * @brief Indica si una sesion esta suscrita a un tema
+ */
+bool spp_session_is_subscribed(int session, uint32_t topic);
+
+/**
+ * @brief Indica si alguna sesion activa esta suscrita a un tema
+ */
+bool spp_topic_has_subscribers(uint32_t topic);
+
+/**
+ * @brief Traduce un nombre de tema (sensors, meters, logs, keys) a su mascara
+ *
+ * @return uint32_t Mascara del tema, 0 si el nombre no existe
+ */
+uint32_t spp_topic_from_name(const char *name);
+
+/**
+ * @brief Toma un buffer del pool con una referencia para quien lo pide
+ *
+ * @return spp_frame_t* Buffer o NULL si el pool esta agotado
+ */
+spp_frame_t *spp_frame_alloc(void);
+
+/**
+ * @brief Suelta una referencia, el buffer vuelve al pool cuando llega a cero
+ */
+void spp_frame_release(spp_frame_t *frame);
+
+/**
+ * @brief Encola un buffer ya formateado en todas las sesiones suscritas al tema
+ *
+ * Cada sesion toma su propia referencia, quien publica conserva la suya y debe liberarla.
+ */
+void spp_publish_frame(uint32_t topic, spp_frame_t *frame);
+
+/**
+ * @brief Copia datos a un buffer del pool una sola vez y lo reparte entre los suscriptores
+ */
+void spp_publish(uint32_t topic, const void *data, size_t len);
+
+/**
+ * @brief Envia datos solo a una sesion sin bloquear
+ *
+ * La respuesta se copia entera al buffer de la sesion y la tarea TX la parte en escrituras,
+ * asi que se puede llamar desde el callback del stack. Nunca se encola una parte.
+ *
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE si la sesion no existe o ESP_ERR_NO_MEM
+ *         si no entra en el buffer (se cuenta como descarte)
+ */
+esp_err_t spp_session_send(int session, const void *data, size_t len);
+
+/**
+ * @brief Copia las estadisticas de una sesion
+ */
+void spp_session_get_stats(int session, spp_session_stats_t *stats);
+
+/**
+ * @brief Copia los contadores de transmision sumados de todas las sesiones
+ */
+void spp_session_get_totals(spp_tx_stats_t *stats);
+
+/**
+ * @brief Copia el estado y las metricas del planificador QoS
+ */
+void spp_session_get_qos(spp_qos_t *qos);
+
+/**
+ * @brief Cambia la configuracion del planificador QoS
+ */
+void spp_session_set_qos_config(const spp_qos_config_t *cfg);
+
+/**
+ * @brief Tarea que drena las colas de todas las sesiones hacia el stack SPP
+ */
+void spp_tx_task(void *pvParameters);
+
+#endif // SPP_SESSION_H
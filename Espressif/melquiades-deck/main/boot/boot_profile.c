@@ -0,0 +1,96 @@
+#include "boot_profile.h"
+//Bibliotecas de sistema
+#include <stdio.h>
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#define TAG "BOOT_PROFILE"
+
+static const char *phase_names[BOOT_PHASE_COUNT] = {
+    "app_main", "nvs", "perifericos", "bt_stack", "audio_hw", "a2dp",
+    "spp", "page", "a2dp_conectado", "audio_iniciado", "primer_sample"
+};
+
+static const char *reset_reason_names[] = {
+    "desconocido", "encendido", "externo", "software", "panic", "int_wdt",
+    "task_wdt", "wdt", "deep_sleep", "brownout", "sdio"
+};
+
+// Instante de cada fase en us desde el arranque del temporizador, 0 = pendiente
+static int64_t phase_us[BOOT_PHASE_COUNT];
+
+bool boot_profile_mark(boot_phase_t phase)
+{
+    if (phase >= BOOT_PHASE_COUNT) {
+        return false;
+    }
+    // Lectura rapida para no costar nada en el camino de audio tras la primera marca
+    if (__atomic_load_n(&phase_us[phase], __ATOMIC_RELAXED) != 0) {
+        return false;
+    }
+    int64_t expected = 0;
+    int64_t now = esp_timer_get_time();
+    if (now == 0) {
+        now = 1;
+    }
+    if (!__atomic_compare_exchange_n(&phase_us[phase], &expected, now, false,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    ESP_LOGI(TAG, "%s a %u.%03u ms", phase_names[phase], (uint32_t)(now / 1000), (uint32_t)(now % 1000));
+    return true;
+}
+
+int64_t boot_profile_get(boot_phase_t phase)
+{
+    if (phase >= BOOT_PHASE_COUNT) {
+        return 0;
+    }
+    return __atomic_load_n(&phase_us[phase], __ATOMIC_RELAXED);
+}
+
+size_t boot_profile_format(char *out, size_t size)
+{
+    size_t len = 0;
+    int64_t prev = 0;
+    if (out == NULL || size == 0) {
+        return 0;
+    }
+
+// Acumula texto sin pasarse del buffer
+#define APPEND(...) do { \
+        if (len < size) { \
+            int n = snprintf(out + len, size - len, __VA_ARGS__); \
+            if (n > 0) len += (size_t)n; \
+        } \
+    } while (0)
+
+    esp_reset_reason_t reason = esp_reset_reason();
+    APPEND("Reset: %s. Tiempos desde el arranque de la app (sin bootloader):\n",
+           (size_t)reason < sizeof(reset_reason_names) / sizeof(reset_reason_names[0])
+               ? reset_reason_names[reason] : "otro");
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        int64_t t = boot_profile_get((boot_phase_t)i);
+        if (t == 0) {
+            APPEND("  %-15s pendiente\n", phase_names[i]);
+            continue;
+        }
+        // Las fases en paralelo pueden terminar antes que la anterior en la lista
+        uint32_t t_x10 = (uint32_t)(t / 100);
+        uint32_t delta_x10 = (prev > 0 && t > prev) ? (uint32_t)((t - prev) / 100) : 0;
+        APPEND("  %-15s %6u.%u ms  (+%u.%u ms)\n", phase_names[i],
+               t_x10 / 10, t_x10 % 10, delta_x10 / 10, delta_x10 % 10);
+        if (t > prev) {
+            prev = t;
+        }
+    }
+    int64_t first = boot_profile_get(BOOT_PHASE_FIRST_SAMPLE);
+    if (first > 0) {
+        APPEND("Reset a primer sample audible: %u ms\n", (uint32_t)(first / 1000));
+    }
+
+#undef APPEND
+
+    return len < size ? len : size - 1;
+}
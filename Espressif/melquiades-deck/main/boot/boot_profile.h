@@ -0,0 +1,47 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Fases del arranque, en el orden esperado
+typedef enum {
+    BOOT_PHASE_APP_MAIN = 0,    // Entrada a app_main
+    BOOT_PHASE_NVS,             // NVS listo
+    BOOT_PHASE_PERIPHERALS,     // Sensores y LED configurados
+    BOOT_PHASE_BT_STACK,        // Controlador y Bluedroid habilitados
+    BOOT_PHASE_AUDIO_HW,        // I2S, DSP y tarea de audio listos (en paralelo con BT)
+    BOOT_PHASE_A2DP,            // A2DP sink y AVRCP registrados
+    BOOT_PHASE_SPP,             // Servidor SPP iniciado y visible
+    BOOT_PHASE_PAGE,            // Inicio de conexion activa a la ultima fuente
+    BOOT_PHASE_A2DP_CONNECTED,  // Fuente A2DP conectada
+    BOOT_PHASE_AUDIO_STARTED,   // Estado de audio A2DP iniciado
+    BOOT_PHASE_FIRST_SAMPLE,    // Primer bloque escrito al DAC
+    BOOT_PHASE_COUNT
+} boot_phase_t;
+
+/**
+ * @brief Registra el instante de una fase, solo la primera vez que ocurre
+ *
+ * Es seguro llamarla desde cualquier tarea y varias veces por fase.
+ *
+ * @return true si es la primera marca de la fase
+ */
+bool boot_profile_mark(boot_phase_t phase);
+
+/**
+ * @brief Tiempo en microsegundos desde el arranque en que ocurrio la fase
+ *
+ * @return int64_t Microsegundos, 0 si la fase aun no ocurre
+ */
+int64_t boot_profile_get(boot_phase_t phase);
+
+/**
+ * @brief Formatea el desglose de fases para el comando boot_profile
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t boot_profile_format(char *out, size_t size);
+
+#endif // BOOT_PROFILE_H
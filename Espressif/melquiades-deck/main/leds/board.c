@@ -2,21 +2,38 @@
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "../system/task_table.h"
 
 // Led de la board
 #define LED_GPIO 19
 
-void init_led_board(){
-    gpio_pad_select_gpio(LED_GPIO);
-    gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
-}
-
-void manage_led_board(){
+// Parpadeo del LED; entre ciclos se estaciona si led_board stop la pauso, siempre con el LED apagado
+static void manage_led_board(void *pvParameters){
     while (1)
     {
+        task_table_wait_run(TASK_LED_BOARD);
         gpio_set_level(LED_GPIO, 1); // Encender LED
         vTaskDelay(1000 / portTICK_PERIOD_MS);
         gpio_set_level(LED_GPIO, 0); // Apagar LED
         vTaskDelay(1000 / portTICK_PERIOD_MS);
     }
 }
+
+void init_led_board(){
+    gpio_pad_select_gpio(LED_GPIO);
+    gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
+    // La tarea se crea pausada y vive siempre; led_board start/stop solo la notifica
+    task_table_create(TASK_LED_BOARD, manage_led_board, NULL);
+}
+
+void led_board_start(){
+    task_table_run(TASK_LED_BOARD);
+}
+
+void led_board_stop(){
+    task_table_stop(TASK_LED_BOARD, 0);
+}
+
+bool led_board_is_running(){
+    return task_table_is_running(TASK_LED_BOARD);
+}
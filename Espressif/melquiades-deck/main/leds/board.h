@@ -1,7 +1,11 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include <stdbool.h>
+
 void init_led_board();
-void manage_led_board();
+void led_board_start();
+void led_board_stop();
+bool led_board_is_running();
 
-#endif // BOARD_H
\ No newline at end of file
+#endif // BOARD_H
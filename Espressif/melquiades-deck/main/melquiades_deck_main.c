@@ -9,21 +9,34 @@
 
 // Bibliotecas custom
 #include "state.h"
+#include "boot/boot_profile.h"
 #include "audio/audio_output.h"
+#include "audio/audio_profile.h"
 #include "audio/sine_wave.h"
 #include "bluetooth/a2dp_sink.h"
 #include "bluetooth/spp_init.h"
+#include "bluetooth/spp_session.h"
 #include "leds/board.h"
-#include "sensors/buttons.h"
-#include "sensors/potentiometers.h"
+#include "sensors/sensor_scheduler.h"
 #include "shell/uart_shell.h"
+#include "system/task_table.h"
+#include "system/power_manager.h"
+#include "system/mem_track.h"
 
 
+// Inicializa el hardware de audio en el core 1 mientras Bluedroid arranca en app_main
+static void audio_boot_task(void *pvParameters)
+{
+    a2dp_sink_init_audio();
+    task_table_exit(TASK_AUDIO_BOOT);
+}
+
 // Funcion ppal de la app
 void app_main()
 {
-    //Habilitamos un log mas amplio en la consola del esp32
-    esp_log_level_set("*", ESP_LOG_VERBOSE);
+    boot_profile_mark(BOOT_PHASE_APP_MAIN);
+    // El log verbose global retrasa el arranque por UART, usamos INFO
+    esp_log_level_set("*", ESP_LOG_INFO);
     // Inicializar NVS
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -31,17 +44,27 @@ void app_main()
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    boot_profile_mark(BOOT_PHASE_NVS);
+    mem_track_init();
+    // El audio no depende de Bluedroid, lo arrancamos en paralelo
+    task_table_create(TASK_AUDIO_BOOT, audio_boot_task, NULL);
     //Inicializamos componentes de board y sensores
-    init_potentiometers();
-    init_pulsadores();
+    sensor_scheduler_init();
     init_led_board();    
+    boot_profile_mark(BOOT_PHASE_PERIPHERALS);
     // Inicializar los perfiles Bluetooth
     init_a2dp_sink();  // Inicializar A2DP para audio
     init_bluetooth();  // Inicializar SPP para comandos
+    // Con el stack arriba no esperamos al telefono: lo buscamos nosotros
+    a2dp_sink_reconnect_last();
 
-    // Crear tareas
-    xTaskCreate(bt_shell_task, "bt_shell_task", 4096, NULL, 5, NULL);
-    xTaskCreate(uart_shell_task, "uart_shell_task", 4096, NULL, 5, NULL);    
+    // Crear tareas: stack, prioridad y core vienen de la tabla de tareas
+    task_table_create(TASK_BT_SHELL, bt_shell_task, NULL);
+    task_table_create(TASK_SPP_TX, spp_tx_task, NULL);
+    task_table_create(TASK_UART_SHELL, uart_shell_task, NULL);
+    task_table_create(TASK_AUDIO_PROFILE, audio_profile_task, NULL);
+    // Con todo arriba se deja bajar la frecuencia cuando no hay audio ni sensores en uso
+    power_manager_init();
 
     //Creamos tarea para onda senoidal (prueba de psm5102)
     //xTaskCreate(sine_wave_task, "sine_wave_task", 4096, NULL, 5, NULL);
@@ -0,0 +1,47 @@
+#include "button_debounce.h"
+
+void btn_debounce_init(btn_debounce_t *d, bool pressed)
+{
+    d->pressed = pressed;
+    d->settling = false;
+    d->burst_start_us = 0;
+    d->last_edge_us = 0;
+    d->edges = 0;
+    d->bounces = 0;
+}
+
+int64_t btn_debounce_edge(btn_debounce_t *d, int64_t t_us)
+{
+    d->edges++;
+    if (!d->settling) {
+        // Primer flanco de una rafaga: de aqui sale el timestamp del evento
+        d->settling = true;
+        d->burst_start_us = t_us;
+    } else {
+        d->bounces++;
+    }
+    d->last_edge_us = t_us;
+    return t_us + BTN_DEBOUNCE_US;
+}
+
+bool btn_debounce_poll(btn_debounce_t *d, bool pressed_now, int64_t now_us, btn_event_t *ev)
+{
+    if (!d->settling || now_us - d->last_edge_us < BTN_DEBOUNCE_US) {
+        return false;
+    }
+    d->settling = false;
+    if (pressed_now == d->pressed) {
+        // Pulso espurio: la rafaga volvio al nivel original
+        d->bounces++;
+        return false;
+    }
+    d->pressed = pressed_now;
+    ev->type = pressed_now ? BTN_EVENT_PRESS : BTN_EVENT_RELEASE;
+    ev->t_us = d->burst_start_us;
+    return true;
+}
+
+int64_t btn_debounce_deadline(const btn_debounce_t *d)
+{
+    return d->settling ? d->last_edge_us + BTN_DEBOUNCE_US : -1;
+}
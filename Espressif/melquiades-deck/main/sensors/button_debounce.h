@@ -0,0 +1,103 @@
+#ifndef BUTTON_DEBOUNCE_H
+#define BUTTON_DEBOUNCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Logica de antirrebote en C puro (sin ESP-IDF) para poder probarla en host con trazas sinteticas
+
+#define BTN_DEBOUNCE_US     5000    // Tiempo sin flancos para dar un nivel por estable
+#define BTN_EDGE_QUEUE_LEN  64      // Potencia de 2
+
+typedef enum {
+    BTN_EVENT_PRESS = 0,
+    BTN_EVENT_RELEASE
+} btn_event_type_t;
+
+// Evento limpio de un boton, con el instante del primer flanco de la rafaga
+typedef struct {
+    uint8_t button;
+    btn_event_type_t type;
+    int64_t t_us;
+} btn_event_t;
+
+// Estado de antirrebote de un boton
+typedef struct {
+    bool pressed;           // Ultimo estado reportado
+    bool settling;          // Hay flancos sin confirmar
+    int64_t burst_start_us; // Primer flanco de la rafaga actual
+    int64_t last_edge_us;   // Ultimo flanco visto
+    uint32_t edges;         // Flancos crudos recibidos
+    uint32_t bounces;       // Flancos absorbidos sin cambio de estado
+} btn_debounce_t;
+
+// Flanco crudo tal como lo registra la ISR
+typedef struct {
+    uint8_t button;
+    int64_t t_us;
+} btn_edge_t;
+
+// Cola sin bloqueo de un productor (ISR) y un consumidor (tarea de botones)
+typedef struct {
+    btn_edge_t items[BTN_EDGE_QUEUE_LEN];
+    uint32_t head;          // Lo escribe solo el productor
+    uint32_t tail;          // Lo escribe solo el consumidor
+    uint32_t overflows;
+} btn_edge_queue_t;
+
+/**
+ * @brief Inicializa el antirrebote con el nivel actual del boton
+ */
+void btn_debounce_init(btn_debounce_t *d, bool pressed);
+
+/**
+ * @brief Registra un flanco crudo
+ *
+ * @return int64_t Instante en que hay que evaluar el boton con btn_debounce_poll
+ */
+int64_t btn_debounce_edge(btn_debounce_t *d, int64_t t_us);
+
+/**
+ * @brief Evalua el boton con su nivel actual
+ *
+ * Si pasaron BTN_DEBOUNCE_US sin flancos y el nivel difiere del reportado, genera un evento
+ * con el instante del primer flanco de la rafaga.
+ *
+ * @return true si se genero un evento en ev (ev->button lo completa quien llama)
+ */
+bool btn_debounce_poll(btn_debounce_t *d, bool pressed_now, int64_t now_us, btn_event_t *ev);
+
+/**
+ * @brief Instante de la proxima evaluacion pendiente, o -1 si el boton esta estable
+ */
+int64_t btn_debounce_deadline(const btn_debounce_t *d);
+
+// Seguro desde ISR: solo copia el flanco y publica head
+static inline __attribute__((always_inline)) bool btn_edge_queue_push(btn_edge_queue_t *q, uint8_t button, int64_t t_us)
+{
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= BTN_EDGE_QUEUE_LEN) {
+        q->overflows++;
+        return false;
+    }
+    btn_edge_t *slot = &q->items[head & (BTN_EDGE_QUEUE_LEN - 1)];
+    slot->button = button;
+    slot->t_us = t_us;
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static inline bool btn_edge_queue_pop(btn_edge_queue_t *q, btn_edge_t *out)
+{
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    if (tail == head) {
+        return false;
+    }
+    *out = q->items[tail & (BTN_EDGE_QUEUE_LEN - 1)];
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#endif // BUTTON_DEBOUNCE_H
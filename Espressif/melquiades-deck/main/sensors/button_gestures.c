@@ -0,0 +1,203 @@
+#include "button_gestures.h"
+#include <string.h>
+
+#define DEFAULT_DOUBLE_TAP_US   250000
+#define DEFAULT_LONG_PRESS_US   600000
+#define DEFAULT_REPEAT_US       150000
+#define DEFAULT_CHORD_US        60000
+
+// Estados por boton
+enum {
+    GST_IDLE = 0,
+    GST_PRESSED,        // Presionado, aun puede ser tap, long-press o parte de un acorde
+    GST_WAIT_SECOND,    // Soltado, esperando un posible doble toque
+    GST_HELD,           // Long-press ya emitido, repitiendo si hay regla
+    GST_CONSUMED        // Ya genero su gesto, se ignora hasta soltar
+};
+
+static const char *gesture_names[BTN_GESTURE_TYPE_COUNT] = {
+    "press", "release", "tap", "double_tap", "long_press", "hold_repeat", "chord"
+};
+
+// Accion asignada al gesto sobre esos botones, 0 si la tabla no lo usa
+static uint8_t find_action(const btn_gesture_engine_t *eng, uint8_t mask, btn_gesture_type_t type)
+{
+    for (int i = 0; i < eng->rule_count; i++) {
+        if (eng->rules[i].buttons_mask == mask && eng->rules[i].type == type) {
+            return eng->rules[i].action;
+        }
+    }
+    return 0;
+}
+
+// Agrega el gesto a la salida solo si la tabla le asigna una accion
+static int emit(const btn_gesture_engine_t *eng, btn_gesture_t *out, int n, btn_gesture_type_t type,
+                uint8_t button, uint8_t button2, int64_t t_us)
+{
+    uint8_t mask = (uint8_t)(1u << (button - 1));
+    if (button2 > 0) {
+        mask |= (uint8_t)(1u << (button2 - 1));
+    }
+    uint8_t action = find_action(eng, mask, type);
+    if (action == 0 || n >= BTN_GESTURE_MAX_OUT) {
+        return n;
+    }
+    out[n].type = type;
+    out[n].button = button;
+    out[n].button2 = button2;
+    out[n].action = action;
+    out[n].t_us = t_us;
+    return n + 1;
+}
+
+void btn_gesture_default_timing(btn_gesture_timing_t *timing)
+{
+    timing->double_tap_us = DEFAULT_DOUBLE_TAP_US;
+    timing->long_press_us = DEFAULT_LONG_PRESS_US;
+    timing->repeat_us = DEFAULT_REPEAT_US;
+    timing->chord_us = DEFAULT_CHORD_US;
+}
+
+void btn_gesture_init(btn_gesture_engine_t *eng, const btn_gesture_timing_t *timing,
+                      const btn_gesture_rule_t *rules, uint8_t rule_count)
+{
+    memset(eng, 0, sizeof(*eng));
+    eng->timing = *timing;
+    eng->rules = rules;
+    eng->rule_count = rule_count;
+    for (int i = 0; i < BTN_GESTURE_MAX_BUTTONS; i++) {
+        eng->buttons[i].deadline = -1;
+    }
+}
+
+static int handle_press(btn_gesture_engine_t *eng, uint8_t button, int64_t t, btn_gesture_t *out, int n)
+{
+    uint8_t idx = button - 1;
+    btn_gesture_button_t *b = &eng->buttons[idx];
+
+    // Acorde: otro boton presionado hace poco y todavia sin gesto
+    for (int i = 0; i < BTN_GESTURE_MAX_BUTTONS; i++) {
+        btn_gesture_button_t *other = &eng->buttons[i];
+        if (i == idx || other->state != GST_PRESSED || t - other->t_press > eng->timing.chord_us) {
+            continue;
+        }
+        uint8_t mask = (uint8_t)((1u << i) | (1u << idx));
+        if (find_action(eng, mask, BTN_GESTURE_CHORD) != 0) {
+            n = emit(eng, out, n, BTN_GESTURE_CHORD, (uint8_t)(i + 1), button, t);
+            other->state = GST_CONSUMED;
+            other->deadline = -1;
+            b->state = GST_CONSUMED;
+            b->deadline = -1;
+            return n;
+        }
+    }
+
+    if (b->state == GST_WAIT_SECOND) {
+        if (t - b->t_release <= eng->timing.double_tap_us) {
+            n = emit(eng, out, n, BTN_GESTURE_DOUBLE_TAP, button, 0, t);
+            b->state = GST_CONSUMED;
+            b->deadline = -1;
+            return n;
+        }
+        // La ventana vencio sin que llegara el tick: el primer toque fue un tap
+        n = emit(eng, out, n, BTN_GESTURE_TAP, button, 0, b->t_press);
+    }
+
+    b->state = GST_PRESSED;
+    b->t_press = t;
+    // Solo hace falta timeout si algun gesto largo esta en la tabla
+    uint8_t mask = (uint8_t)(1u << idx);
+    bool needs_long = find_action(eng, mask, BTN_GESTURE_LONG_PRESS) != 0 ||
+                      find_action(eng, mask, BTN_GESTURE_HOLD_REPEAT) != 0;
+    b->deadline = needs_long ? t + eng->timing.long_press_us : -1;
+    return n;
+}
+
+static int handle_release(btn_gesture_engine_t *eng, uint8_t button, int64_t t, btn_gesture_t *out, int n)
+{
+    btn_gesture_button_t *b = &eng->buttons[button - 1];
+    uint8_t mask = (uint8_t)(1u << (button - 1));
+
+    if (b->state == GST_PRESSED && t - b->t_press < eng->timing.long_press_us) {
+        if (find_action(eng, mask, BTN_GESTURE_DOUBLE_TAP) != 0) {
+            // Esperamos el segundo toque antes de decidir
+            b->state = GST_WAIT_SECOND;
+            b->t_release = t;
+            b->deadline = t + eng->timing.double_tap_us;
+            return n;
+        }
+        // Sin doble toque en la tabla el tap sale sin demora
+        n = emit(eng, out, n, BTN_GESTURE_TAP, button, 0, b->t_press);
+    }
+    b->state = GST_IDLE;
+    b->deadline = -1;
+    return n;
+}
+
+int btn_gesture_feed(btn_gesture_engine_t *eng, const btn_event_t *ev, btn_gesture_t *out)
+{
+    if (ev->button == 0 || ev->button > BTN_GESTURE_MAX_BUTTONS) {
+        return 0;
+    }
+    // Primero los timeouts que vencieron antes de este evento
+    int n = btn_gesture_tick(eng, ev->t_us, out);
+    if (ev->type == BTN_EVENT_PRESS) {
+        return handle_press(eng, ev->button, ev->t_us, out, n);
+    }
+    return handle_release(eng, ev->button, ev->t_us, out, n);
+}
+
+int btn_gesture_tick(btn_gesture_engine_t *eng, int64_t now_us, btn_gesture_t *out)
+{
+    int n = 0;
+    for (int i = 0; i < BTN_GESTURE_MAX_BUTTONS; i++) {
+        btn_gesture_button_t *b = &eng->buttons[i];
+        uint8_t button = (uint8_t)(i + 1);
+        uint8_t mask = (uint8_t)(1u << i);
+        if (b->deadline < 0 || now_us < b->deadline) {
+            continue;
+        }
+        switch (b->state) {
+        case GST_PRESSED:
+            n = emit(eng, out, n, BTN_GESTURE_LONG_PRESS, button, 0, b->deadline);
+            b->state = GST_HELD;
+            b->deadline = find_action(eng, mask, BTN_GESTURE_HOLD_REPEAT) != 0
+                              ? b->deadline + eng->timing.repeat_us : -1;
+            break;
+        case GST_HELD:
+            n = emit(eng, out, n, BTN_GESTURE_HOLD_REPEAT, button, 0, b->deadline);
+            b->deadline += eng->timing.repeat_us;
+            // Si nos atrasamos no recuperamos repeticiones perdidas
+            if (b->deadline <= now_us) {
+                b->deadline = now_us + eng->timing.repeat_us;
+            }
+            break;
+        case GST_WAIT_SECOND:
+            n = emit(eng, out, n, BTN_GESTURE_TAP, button, 0, b->t_press);
+            b->state = GST_IDLE;
+            b->deadline = -1;
+            break;
+        default:
+            b->deadline = -1;
+            break;
+        }
+    }
+    return n;
+}
+
+int64_t btn_gesture_deadline(const btn_gesture_engine_t *eng)
+{
+    int64_t next = -1;
+    for (int i = 0; i < BTN_GESTURE_MAX_BUTTONS; i++) {
+        int64_t d = eng->buttons[i].deadline;
+        if (d >= 0 && (next < 0 || d < next)) {
+            next = d;
+        }
+    }
+    return next;
+}
+
+const char *btn_gesture_name(btn_gesture_type_t type)
+{
+    return type < BTN_GESTURE_TYPE_COUNT ? gesture_names[type] : "?";
+}
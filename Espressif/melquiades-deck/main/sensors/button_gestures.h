@@ -0,0 +1,97 @@
+#ifndef BUTTON_GESTURES_H
+#define BUTTON_GESTURES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "button_debounce.h"
+
+// Reconocedor de gestos en C puro, alimentado con los eventos limpios del antirrebote
+
+#define BTN_GESTURE_MAX_BUTTONS 8
+#define BTN_GESTURE_MAX_OUT     4   // Gestos que puede generar un solo evento o tick
+
+typedef enum {
+    BTN_GESTURE_PRESS = 0,      // Evento crudo (modo sin gestos)
+    BTN_GESTURE_RELEASE,        // Evento crudo (modo sin gestos)
+    BTN_GESTURE_TAP,
+    BTN_GESTURE_DOUBLE_TAP,
+    BTN_GESTURE_LONG_PRESS,
+    BTN_GESTURE_HOLD_REPEAT,
+    BTN_GESTURE_CHORD,
+    BTN_GESTURE_TYPE_COUNT
+} btn_gesture_type_t;
+
+// Gesto de alto nivel entregado al resto del sistema
+typedef struct {
+    btn_gesture_type_t type;
+    uint8_t button;             // 1..N
+    uint8_t button2;            // Segundo boton en acordes, 0 si no aplica
+    uint8_t action;             // Accion (slot) asignada por la tabla
+    int64_t t_us;
+} btn_gesture_t;
+
+// Regla de la tabla: que gesto sobre que botones dispara que accion
+typedef struct {
+    uint8_t buttons_mask;       // bit (n-1) por boton, dos bits para acordes
+    btn_gesture_type_t type;
+    uint8_t action;
+} btn_gesture_rule_t;
+
+// Tiempos configurables
+typedef struct {
+    uint32_t double_tap_us;     // Ventana para el segundo toque
+    uint32_t long_press_us;     // Presion minima para long-press (y maxima para tap)
+    uint32_t repeat_us;         // Periodo de hold-repeat despues del long-press
+    uint32_t chord_us;          // Separacion maxima entre presiones de un acorde
+} btn_gesture_timing_t;
+
+typedef struct {
+    uint8_t state;
+    int64_t t_press;
+    int64_t t_release;
+    int64_t deadline;           // -1 sin timeout pendiente
+} btn_gesture_button_t;
+
+typedef struct {
+    btn_gesture_timing_t timing;
+    const btn_gesture_rule_t *rules;
+    uint8_t rule_count;
+    btn_gesture_button_t buttons[BTN_GESTURE_MAX_BUTTONS];
+} btn_gesture_engine_t;
+
+/**
+ * @brief Tiempos por defecto: doble toque 250 ms, long-press 600 ms, repeticion 150 ms, acorde 60 ms
+ */
+void btn_gesture_default_timing(btn_gesture_timing_t *timing);
+
+/**
+ * @brief Inicializa el motor con una tabla de reglas (la tabla no se copia)
+ */
+void btn_gesture_init(btn_gesture_engine_t *eng, const btn_gesture_timing_t *timing,
+                      const btn_gesture_rule_t *rules, uint8_t rule_count);
+
+/**
+ * @brief Procesa un evento press/release
+ *
+ * @return int Cantidad de gestos escritos en out (maximo BTN_GESTURE_MAX_OUT)
+ */
+int btn_gesture_feed(btn_gesture_engine_t *eng, const btn_event_t *ev, btn_gesture_t *out);
+
+/**
+ * @brief Procesa los timeouts vencidos (long-press, repeticion, fin de ventana de doble toque)
+ *
+ * @return int Cantidad de gestos escritos en out (maximo BTN_GESTURE_MAX_OUT)
+ */
+int btn_gesture_tick(btn_gesture_engine_t *eng, int64_t now_us, btn_gesture_t *out);
+
+/**
+ * @brief Proximo instante en que hay que llamar a btn_gesture_tick, -1 si no hay pendientes
+ */
+int64_t btn_gesture_deadline(const btn_gesture_engine_t *eng);
+
+/**
+ * @brief Nombre corto de un tipo de gesto
+ */
+const char *btn_gesture_name(btn_gesture_type_t type);
+
+#endif // BUTTON_GESTURES_H
@@ -1,44 +1,361 @@
 #include "buttons.h"
 //Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_sleep.h"
 //bibliotecas custom
-#include "../state.h"
-#include "../bluetooth/spp_init.h"
+#include "../system/task_table.h"
 
-void init_pulsadores()
+#define TAG "BUTTONS"
+// Nivel del GPIO con el boton presionado (pull-down externo)
+#define BTN_ACTIVE_LEVEL    1
+#define BTN_EVENT_QUEUE_LEN 16
+
+static gpio_num_t btn_pins[BTN_MAX];
+static int btn_count = 0;
+
+#define MASK(n) (1u << ((n) - 1))
+// Tabla de gestos: 6 taps + 6 long-press cubren los 12 slots, el resto son extras
+static const btn_gesture_rule_t gesture_rules[] = {
+    {MASK(1), BTN_GESTURE_TAP, 1},
+    {MASK(2), BTN_GESTURE_TAP, 2},
+    {MASK(3), BTN_GESTURE_TAP, 3},
+    {MASK(4), BTN_GESTURE_TAP, 4},
+    {MASK(5), BTN_GESTURE_TAP, 5},
+    {MASK(6), BTN_GESTURE_TAP, 6},
+    {MASK(1), BTN_GESTURE_LONG_PRESS, 7},
+    {MASK(2), BTN_GESTURE_LONG_PRESS, 8},
+    {MASK(3), BTN_GESTURE_LONG_PRESS, 9},
+    {MASK(4), BTN_GESTURE_LONG_PRESS, 10},
+    {MASK(5), BTN_GESTURE_LONG_PRESS, 11},
+    {MASK(6), BTN_GESTURE_LONG_PRESS, 12},
+    {MASK(5), BTN_GESTURE_DOUBLE_TAP, 13},
+    {MASK(6), BTN_GESTURE_DOUBLE_TAP, 14},
+    {MASK(3), BTN_GESTURE_HOLD_REPEAT, 15},
+    {MASK(4), BTN_GESTURE_HOLD_REPEAT, 16},
+    {MASK(1) | MASK(2), BTN_GESTURE_CHORD, 17},
+};
+#define GESTURE_RULE_COUNT (sizeof(gesture_rules) / sizeof(gesture_rules[0]))
+
+static btn_gesture_engine_t gesture_engine;
+// Los tiempos son varios campos: el shell deja la copia pendiente y la tarea del motor la aplica
+static btn_gesture_timing_t pending_timing;
+static bool timing_pending = false;
+static portMUX_TYPE timing_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool gestures_enabled = true;
+static uint32_t gesture_cycles_max = 0;
+static uint64_t gesture_cycles_total = 0;
+static uint32_t gesture_calls = 0;
+
+static btn_edge_queue_t edge_queue;
+static btn_debounce_t debouncers[BTN_MAX];
+static TaskHandle_t engine_task_handle = NULL;
+static esp_timer_handle_t debounce_timer = NULL;
+static QueueHandle_t event_queue = NULL;
+
+// Eventos generados (para calcular la tasa en status)
+static uint32_t sample_count = 0;
+static buttons_stats_t stats = {0};
+static uint64_t latency_total_us = 0;
+
+// La ISR solo sella el flanco y despierta al motor
+static void IRAM_ATTR button_isr(void *arg)
 {
+    BaseType_t woken = pdFALSE;
+    btn_edge_queue_push(&edge_queue, (uint8_t)(uintptr_t)arg, esp_timer_get_time());
+    vTaskNotifyGiveFromISR(engine_task_handle, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// El esp_timer marca el fin de la ventana de antirrebote
+static void debounce_timer_cb(void *arg)
+{
+    xTaskNotifyGive(engine_task_handle);
+}
+
+static void queue_gestures(const btn_gesture_t *out, int n)
+{
+    for (int i = 0; i < n; i++) {
+        if (xQueueSend(event_queue, &out[i], 0) != pdTRUE) {
+            stats.dropped++;
+        }
+    }
+}
+
+// Mide ciclos del reconocedor por llamada para reportar su costo
+static void account_gesture_cycles(uint32_t start)
+{
+    uint32_t cycles = esp_cpu_get_ccount() - start;
+    gesture_calls++;
+    gesture_cycles_total += cycles;
+    if (cycles > gesture_cycles_max) {
+        gesture_cycles_max = cycles;
+    }
+}
+
+static void emit_event(const btn_event_t *ev, int64_t now_us)
+{
+    btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+    uint32_t latency = (uint32_t)(now_us - ev->t_us);
+    stats.events++;
+    sample_count++;
+    latency_total_us += latency;
+    stats.latency_avg_us = (uint32_t)(latency_total_us / stats.events);
+    if (latency > stats.latency_max_us) {
+        stats.latency_max_us = latency;
+    }
+
+    if (!gestures_enabled) {
+        // Modo crudo: press/release tal cual salen del antirrebote
+        out[0].type = ev->type == BTN_EVENT_PRESS ? BTN_GESTURE_PRESS : BTN_GESTURE_RELEASE;
+        out[0].button = ev->button;
+        out[0].button2 = 0;
+        out[0].action = 0;
+        out[0].t_us = ev->t_us;
+        queue_gestures(out, 1);
+        return;
+    }
+    uint32_t start = esp_cpu_get_ccount();
+    int n = btn_gesture_feed(&gesture_engine, ev, out);
+    account_gesture_cycles(start);
+    queue_gestures(out, n);
+}
+
+static void take_pending_timing(void)
+{
+    portENTER_CRITICAL(&timing_lock);
+    if (timing_pending) {
+        gesture_engine.timing = pending_timing;
+        timing_pending = false;
+    }
+    portEXIT_CRITICAL(&timing_lock);
+}
+
+static void buttons_engine_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        take_pending_timing();
+
+        btn_edge_t edge;
+        while (btn_edge_queue_pop(&edge_queue, &edge)) {
+            if (edge.button < btn_count) {
+                btn_debounce_edge(&debouncers[edge.button], edge.t_us);
+            }
+        }
+
+        int64_t now = esp_timer_get_time();
+        int64_t next = -1;
+        for (int i = 0; i < btn_count; i++) {
+            btn_event_t ev;
+            bool pressed = gpio_get_level(btn_pins[i]) == BTN_ACTIVE_LEVEL;
+            if (btn_debounce_poll(&debouncers[i], pressed, now, &ev)) {
+                ev.button = (uint8_t)(i + 1);
+                emit_event(&ev, now);
+            }
+            int64_t deadline = btn_debounce_deadline(&debouncers[i]);
+            if (deadline >= 0 && (next < 0 || deadline < next)) {
+                next = deadline;
+            }
+        }
+
+        // Timeouts de gestos (long-press, repeticion, ventana de doble toque)
+        if (gestures_enabled) {
+            btn_gesture_t out[BTN_GESTURE_MAX_OUT];
+            int64_t deadline = btn_gesture_deadline(&gesture_engine);
+            if (deadline >= 0 && deadline <= now) {
+                uint32_t start = esp_cpu_get_ccount();
+                int n = btn_gesture_tick(&gesture_engine, now, out);
+                account_gesture_cycles(start);
+                queue_gestures(out, n);
+                deadline = btn_gesture_deadline(&gesture_engine);
+            }
+            if (deadline >= 0 && (next < 0 || deadline < next)) {
+                next = deadline;
+            }
+        }
+
+        // Un solo timer para antirrebote y gestos, apuntando a lo que vence primero
+        if (next >= 0) {
+            esp_timer_stop(debounce_timer);
+            esp_timer_start_once(debounce_timer, next > now ? (uint64_t)(next - now) : 1);
+        }
+    }
+}
+
+void init_pulsadores(const gpio_num_t *pins, int count)
+{
+    uint64_t mask = 0;
+    btn_count = count < BTN_MAX ? count : BTN_MAX;
+    for (int i = 0; i < btn_count; i++) {
+        btn_pins[i] = pins[i];
+        mask |= 1ULL << pins[i];
+    }
     gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << BTN1) | (1ULL << BTN2) | (1ULL << BTN3) |
-                        (1ULL << BTN4) | (1ULL << BTN5) | (1ULL << BTN6),
+        .pin_bit_mask = mask,
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,     // Desactivar pull-up interno
         .pull_down_en = GPIO_PULLDOWN_DISABLE, // Sin pull-down interno (usamos externo)
-        .intr_type = GPIO_INTR_DISABLE};
-    gpio_config(&io_conf);
+        .intr_type = GPIO_INTR_ANYEDGE};
+    if (btn_count > 0) {
+        gpio_config(&io_conf);
+    }
+
+    for (int i = 0; i < btn_count; i++) {
+        btn_debounce_init(&debouncers[i], gpio_get_level(btn_pins[i]) == BTN_ACTIVE_LEVEL);
+    }
+    event_queue = xQueueCreate(BTN_EVENT_QUEUE_LEN, sizeof(btn_gesture_t));
+
+    btn_gesture_timing_t timing;
+    btn_gesture_default_timing(&timing);
+    btn_gesture_init(&gesture_engine, &timing, gesture_rules, GESTURE_RULE_COUNT);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = debounce_timer_cb,
+        .name = "btn_debounce"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &debounce_timer));
+    engine_task_handle = task_table_create(TASK_BUTTONS, buttons_engine_task, NULL);
+
+    // La ISR solo se habilita con la tarea ya creada
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "No se pudo instalar el servicio de ISR GPIO: %s", esp_err_to_name(ret));
+        return;
+    }
+    for (int i = 0; i < btn_count; i++) {
+        gpio_isr_handler_add(btn_pins[i], button_isr, (void *)(uintptr_t)i);
+    }
+}
+
+bool pulsadores_wait_event(btn_gesture_t *ev, uint32_t timeout_ms)
+{
+    return xQueueReceive(event_queue, ev, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
 }
 
-void leer_pulsadores()
-{    
-    char response[100];  // Reservas espacio suficiente
-    while (1)
+size_t pulsadores_format_event(const btn_gesture_t *ev, char *out, size_t size)
+{
+    int n;
+    if (ev->type == BTN_GESTURE_PRESS || ev->type == BTN_GESTURE_RELEASE)
+    {
+        n = snprintf(out, size, "Boton %u: %s t=%u.%03u ms\n", ev->button,
+                     ev->type == BTN_GESTURE_PRESS ? "presionado" : "liberado",
+                     (uint32_t)(ev->t_us / 1000), (uint32_t)(ev->t_us % 1000));
+    }
+    else if (ev->type == BTN_GESTURE_CHORD)
+    {
+        n = snprintf(out, size, "Gesto %s: botones %u+%u accion %u t=%u.%03u ms\n",
+                     btn_gesture_name(ev->type), ev->button, ev->button2, ev->action,
+                     (uint32_t)(ev->t_us / 1000), (uint32_t)(ev->t_us % 1000));
+    }
+    else
     {
-        //construimos valores de pulsadores
-        int estado1 = gpio_get_level(BTN1);
-        int estado2 = gpio_get_level(BTN2);
-        int estado3 = gpio_get_level(BTN3);
-        int estado4 = gpio_get_level(BTN4);
-        int estado5 = gpio_get_level(BTN5);
-        int estado6 = gpio_get_level(BTN6);
-        //construimos response        
-        snprintf(response, sizeof(response), "Botones: %d, %d, %d, %d, %d, %d\n", estado1, estado2, estado3, estado4, estado5, estado6);
-        //Validamos el shell activo        
-        if(sensors_streaming_uart){            
-            printf("%s", response);
-        }else if(sensors_streaming_bt){
-            send_bt_response(response);
-        }                    
-        // Espera 500ms entre lecturas
-        vTaskDelay(pdMS_TO_TICKS(500));
+        n = snprintf(out, size, "Gesto %s: boton %u accion %u t=%u.%03u ms\n",
+                     btn_gesture_name(ev->type), ev->button, ev->action,
+                     (uint32_t)(ev->t_us / 1000), (uint32_t)(ev->t_us % 1000));
+    }
+    if (n < 0) {
+        return 0;
+    }
+    return (size_t)n < size ? (size_t)n : size - 1;
+}
+
+uint32_t pulsadores_get_sample_count(void)
+{
+    return sample_count;
+}
+
+void pulsadores_get_stats(buttons_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    *out = stats;
+    out->edge_overflows = edge_queue.overflows;
+    out->bounces = 0;
+    out->edges = 0;
+    for (int i = 0; i < btn_count; i++) {
+        out->edges += debouncers[i].edges;
+        out->bounces += debouncers[i].bounces;
+    }
+}
+
+void pulsadores_set_gestures(bool enabled)
+{
+    gestures_enabled = enabled;
+}
+
+void pulsadores_set_gesture_timing(const btn_gesture_timing_t *timing)
+{
+    portENTER_CRITICAL(&timing_lock);
+    pending_timing = *timing;
+    timing_pending = true;
+    portEXIT_CRITICAL(&timing_lock);
+    if (engine_task_handle != NULL) {
+        xTaskNotifyGive(engine_task_handle);
+    }
+}
+
+void pulsadores_get_gesture_timing(btn_gesture_timing_t *timing)
+{
+    // Si hay un cambio sin aplicar se parte de el para no perderlo
+    portENTER_CRITICAL(&timing_lock);
+    *timing = timing_pending ? pending_timing : gesture_engine.timing;
+    portEXIT_CRITICAL(&timing_lock);
+}
+
+const btn_gesture_rule_t *pulsadores_gesture_rules(uint8_t *count)
+{
+    *count = (uint8_t)GESTURE_RULE_COUNT;
+    return gesture_rules;
+}
+
+size_t pulsadores_format_gestures(char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    btn_gesture_timing_t timing;
+    const btn_gesture_timing_t *t = &timing;
+    uint32_t avg = gesture_calls > 0 ? (uint32_t)(gesture_cycles_total / gesture_calls) : 0;
+
+    pulsadores_get_gesture_timing(&timing);
+
+    n = snprintf(out, size, "Gestos %s: doble %u ms, largo %u ms, repeticion %u ms, acorde %u ms\n"
+                 "Costo: %u llamadas, ciclos prom %u, max %u; memoria motor %u B + tabla %u B\n"
+                 "Reglas (%u):\n",
+                 gestures_enabled ? "activos" : "inactivos (eventos crudos)",
+                 t->double_tap_us / 1000, t->long_press_us / 1000, t->repeat_us / 1000, t->chord_us / 1000,
+                 gesture_calls, avg, gesture_cycles_max,
+                 (uint32_t)sizeof(gesture_engine), (uint32_t)sizeof(gesture_rules),
+                 (uint32_t)GESTURE_RULE_COUNT);
+    len = n > 0 ? (size_t)n : 0;
+    for (size_t i = 0; i < GESTURE_RULE_COUNT && len < size; i++) {
+        n = snprintf(out + len, size - len, "  accion %2u: %-11s mascara 0x%02x\n", gesture_rules[i].action,
+                     btn_gesture_name(gesture_rules[i].type), gesture_rules[i].buttons_mask);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
+
+// ext1 en vez de gpio_wakeup_enable: este ultimo pasa los pines a interrupcion por nivel y la ISR
+// de flancos se dispararia sin parar mientras el boton sigue presionado
+esp_err_t pulsadores_enable_wakeup(void)
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < btn_count; i++) {
+        mask |= 1ULL << btn_pins[i];
+    }
+    if (mask == 0) {
+        return ESP_ERR_INVALID_STATE;
     }
+    return esp_sleep_enable_ext1_wakeup(mask, BTN_ACTIVE_LEVEL ? ESP_EXT1_WAKEUP_ANY_HIGH : ESP_EXT1_WAKEUP_ALL_LOW);
 }
@@ -2,16 +2,100 @@
 #define BUTTONS_H
 
 #include "driver/gpio.h"
+#include "button_debounce.h"
+#include "button_gestures.h"
+#include "sensor_board.h"
+#include "sensor_registry.h"
 
-// Puertos asignados a pulsadores/botones
+// Puertos de los pulsadores/botones en la tabla de slots por defecto
 #define BTN1 GPIO_NUM_27 // ADC17
 #define BTN2 GPIO_NUM_25 // ADC18
-#define BTN3 GPIO_NUM_32 // ADC04
+#define BTN3 SENSOR_BOARD_BTN3 // Depende de la revision de placa
 #define BTN4 GPIO_NUM_4  // ADC10
 #define BTN5 GPIO_NUM_0  // ADC11
 #define BTN6 GPIO_NUM_2  // ADC12
 
-void init_pulsadores();
-void leer_pulsadores();
+#define BTN_DEFAULT_COUNT 6
+#define BTN_MAX SENSOR_MAX_BUTTONS
 
-#endif // BUTTONS_H
\ No newline at end of file
+// Contadores del motor de botones
+typedef struct {
+    uint32_t edges;             // Flancos crudos vistos por la ISR
+    uint32_t bounces;           // Flancos absorbidos por el antirrebote
+    uint32_t events;            // Eventos limpios generados
+    uint32_t dropped;           // Eventos descartados por cola llena
+    uint32_t edge_overflows;    // Flancos perdidos por cola de la ISR llena
+    uint32_t latency_avg_us;    // Primer flanco -> evento disponible
+    uint32_t latency_max_us;
+} buttons_stats_t;
+
+/**
+ * @brief Configura los GPIO con interrupcion por flanco y arranca el motor de antirrebote
+ *
+ * @param pins GPIO de cada boton, en el orden de los slots del registro (boton 1..N)
+ * @param count Cantidad de botones (maximo BTN_MAX)
+ */
+void init_pulsadores(const gpio_num_t *pins, int count);
+
+/**
+ * @brief Espera el siguiente evento o gesto de botones
+ *
+ * @param timeout_ms Espera maxima, 0 para consultar sin bloquear
+ * @return true si se obtuvo un evento
+ */
+bool pulsadores_wait_event(btn_gesture_t *ev, uint32_t timeout_ms);
+
+/**
+ * @brief Formatea un evento o gesto como linea de texto para el streaming
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t pulsadores_format_event(const btn_gesture_t *ev, char *out, size_t size);
+
+/**
+ * @brief Eventos de botones generados desde el arranque
+ */
+uint32_t pulsadores_get_sample_count(void);
+
+/**
+ * @brief Copia los contadores del motor de botones
+ */
+void pulsadores_get_stats(buttons_stats_t *stats);
+
+/**
+ * @brief Activa el reconocedor de gestos o vuelve a eventos press/release crudos
+ */
+void pulsadores_set_gestures(bool enabled);
+
+/**
+ * @brief Cambia los tiempos del reconocedor de gestos; la tarea del motor los toma al despertar
+ */
+void pulsadores_set_gesture_timing(const btn_gesture_timing_t *timing);
+
+/**
+ * @brief Copia los tiempos actuales del reconocedor de gestos
+ */
+void pulsadores_get_gesture_timing(btn_gesture_timing_t *timing);
+
+/**
+ * @brief Tabla de gestos del equipo: botones y gesto -> accion de keymap
+ *
+ * @param count Recibe la cantidad de reglas
+ */
+const btn_gesture_rule_t *pulsadores_gesture_rules(uint8_t *count);
+
+/**
+ * @brief Formatea tiempos, tabla de reglas y costo en CPU/memoria del reconocedor
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t pulsadores_format_gestures(char *out, size_t size);
+
+/**
+ * @brief Habilita los botones como fuente para despertar del light sleep
+ *
+ * @return esp_err_t Resultado de esp_sleep_enable_ext1_wakeup
+ */
+esp_err_t pulsadores_enable_wakeup(void);
+
+#endif // BUTTONS_H
@@ -0,0 +1,159 @@
+#include "keymap.h"
+// Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+
+// Usages de la pagina consumer (0x0C)
+#define USAGE_PLAY_PAUSE    0x00CD
+#define USAGE_NEXT_TRACK    0x00B5
+#define USAGE_PREV_TRACK    0x00B6
+#define USAGE_VOLUME_UP     0x00E9
+#define USAGE_VOLUME_DOWN   0x00EA
+#define USAGE_MUTE          0x00E2
+
+static const char *action_names[KEYMAP_ACTION_COUNT] = {"nada", "tecla", "media", "macro"};
+
+void keymap_default(keymap_t *map)
+{
+    static const uint16_t taps[] = {USAGE_PLAY_PAUSE, USAGE_PREV_TRACK, USAGE_NEXT_TRACK,
+                                    USAGE_VOLUME_DOWN, USAGE_VOLUME_UP, USAGE_MUTE};
+    memset(map, 0, sizeof(*map));
+    map->version = KEYMAP_VERSION;
+    // Las acciones 1-6 son los taps de cada boton en la tabla de gestos
+    for (int i = 0; i < sizeof(taps) / sizeof(taps[0]); i++) {
+        map->entries[i].kind = KEYMAP_ACTION_MEDIA;
+        map->entries[i].code = taps[i];
+    }
+}
+
+bool keymap_validate(const keymap_t *map)
+{
+    if (map->version != KEYMAP_VERSION) {
+        return false;
+    }
+    for (int i = 0; i < KEYMAP_MAX_ACTIONS; i++) {
+        const keymap_entry_t *e = &map->entries[i];
+        if (e->kind >= KEYMAP_ACTION_COUNT ||
+            (e->kind == KEYMAP_ACTION_KEY && e->code > 0xFF) ||
+            (e->kind == KEYMAP_ACTION_MACRO && e->code >= KEYMAP_MAX_MACROS)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static keymap_report_t key_report(uint8_t modifiers, uint8_t key)
+{
+    keymap_report_t r = {.id = KEYMAP_REPORT_KEYBOARD, .modifiers = modifiers, .key = key, .usage = 0};
+    return r;
+}
+
+static keymap_report_t media_report(uint16_t usage)
+{
+    keymap_report_t r = {.id = KEYMAP_REPORT_CONSUMER, .modifiers = 0, .key = 0, .usage = usage};
+    return r;
+}
+
+int keymap_process(const keymap_t *map, const btn_gesture_t *ev, keymap_report_t *out)
+{
+    // En modo crudo la accion es el numero de boton
+    uint8_t action = ev->type == BTN_GESTURE_PRESS || ev->type == BTN_GESTURE_RELEASE ? ev->button : ev->action;
+    if (action < 1 || action > KEYMAP_MAX_ACTIONS) {
+        return 0;
+    }
+    const keymap_entry_t *e = &map->entries[action - 1];
+    bool down = ev->type != BTN_GESTURE_RELEASE;
+    bool up = ev->type != BTN_GESTURE_PRESS;
+    int n = 0;
+
+    switch (e->kind) {
+    case KEYMAP_ACTION_KEY:
+        if (down) {
+            out[n++] = key_report(e->modifiers, (uint8_t)e->code);
+        }
+        if (up) {
+            out[n++] = key_report(0, 0);
+        }
+        break;
+    case KEYMAP_ACTION_MEDIA:
+        if (down) {
+            out[n++] = media_report(e->code);
+        }
+        if (up) {
+            out[n++] = media_report(0);
+        }
+        break;
+    case KEYMAP_ACTION_MACRO:
+        // El macro sale completo al presionar; la suelta en modo crudo no agrega nada
+        if (!down) {
+            break;
+        }
+        for (int s = 0; s < KEYMAP_MACRO_STEPS && map->macros[e->code][s].key != 0; s++) {
+            out[n++] = key_report(map->macros[e->code][s].modifiers, map->macros[e->code][s].key);
+            out[n++] = key_report(0, 0);
+        }
+        break;
+    default:
+        break;
+    }
+    return n;
+}
+
+void keymap_report_encode(const keymap_report_t *r, uint8_t seq, uint8_t *out)
+{
+    out[0] = seq;
+    out[1] = r->id;
+    if (r->id == KEYMAP_REPORT_CONSUMER) {
+        out[2] = (uint8_t)(r->usage & 0xFF);
+        out[3] = (uint8_t)(r->usage >> 8);
+    } else {
+        out[2] = r->modifiers;
+        out[3] = r->key;
+    }
+}
+
+const char *keymap_action_name(uint8_t kind)
+{
+    return kind < KEYMAP_ACTION_COUNT ? action_names[kind] : "?";
+}
+
+size_t keymap_format(const keymap_t *map, char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    if (out == NULL || size == 0) {
+        return 0;
+    }
+    n = snprintf(out, size, "Atajos (tabla %u B, reporte %u B + trama):\n", (uint32_t)sizeof(*map), KEYMAP_REPORT_BYTES);
+    len = n > 0 ? (size_t)n : 0;
+    for (int i = 0; i < KEYMAP_MAX_ACTIONS && len < size; i++) {
+        const keymap_entry_t *e = &map->entries[i];
+        if (e->kind == KEYMAP_ACTION_NONE) {
+            continue;
+        }
+        if (e->kind == KEYMAP_ACTION_MACRO) {
+            n = snprintf(out + len, size - len, "  accion %2d: macro %u\n", i + 1, e->code);
+        } else if (e->kind == KEYMAP_ACTION_MEDIA) {
+            n = snprintf(out + len, size - len, "  accion %2d: media 0x%03x\n", i + 1, e->code);
+        } else {
+            n = snprintf(out + len, size - len, "  accion %2d: tecla 0x%02x mod 0x%02x\n", i + 1, e->code, e->modifiers);
+        }
+        len += n > 0 ? (size_t)n : 0;
+    }
+    for (int m = 0; m < KEYMAP_MAX_MACROS && len < size; m++) {
+        if (map->macros[m][0].key == 0) {
+            continue;
+        }
+        n = snprintf(out + len, size - len, "  macro %d:", m);
+        len += n > 0 ? (size_t)n : 0;
+        for (int s = 0; s < KEYMAP_MACRO_STEPS && map->macros[m][s].key != 0 && len < size; s++) {
+            n = snprintf(out + len, size - len, " %02x:%02x", map->macros[m][s].modifiers, map->macros[m][s].key);
+            len += n > 0 ? (size_t)n : 0;
+        }
+        if (len < size) {
+            n = snprintf(out + len, size - len, "\n");
+            len += n > 0 ? (size_t)n : 0;
+        }
+    }
+    return len < size ? len : size - 1;
+}
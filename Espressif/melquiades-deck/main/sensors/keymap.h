@@ -0,0 +1,105 @@
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "button_gestures.h"
+
+// Motor de atajos en C puro: cada accion del reconocedor de gestos (1..N) se traduce
+// a reportes compactos estilo HID; el escritorio solo los inyecta.
+// Blob de NVS como la tabla de sensores (ver sensor_registry.h): cambiar KEYMAP_MAX_ACTIONS
+// o el tamano de las macros cambia el blob y obliga a subir KEYMAP_VERSION.
+
+#define KEYMAP_VERSION          1
+#define KEYMAP_MAX_ACTIONS      32
+#define KEYMAP_MAX_MACROS       4
+#define KEYMAP_MACRO_STEPS      8
+#define KEYMAP_MAX_REPORTS      (2 * KEYMAP_MACRO_STEPS)   // Un macro completo: presion y suelta por paso
+#define KEYMAP_REPORT_BYTES     4                           // [seq][id][dato][dato]
+
+// Modificadores del reporte de teclado HID (byte 0)
+#define KEYMAP_MOD_CTRL         0x01
+#define KEYMAP_MOD_SHIFT        0x02
+#define KEYMAP_MOD_ALT          0x04
+#define KEYMAP_MOD_GUI          0x08
+
+typedef enum {
+    KEYMAP_ACTION_NONE = 0,
+    KEYMAP_ACTION_KEY,          // Tecla con modificadores (usage page 0x07)
+    KEYMAP_ACTION_MEDIA,        // Tecla multimedia (usage page 0x0C, consumer)
+    KEYMAP_ACTION_MACRO,        // Secuencia de teclas
+    KEYMAP_ACTION_COUNT
+} keymap_action_t;
+
+typedef enum {
+    KEYMAP_REPORT_KEYBOARD = 1, // [modificadores][tecla]
+    KEYMAP_REPORT_CONSUMER = 2, // [usage lo][usage hi]
+} keymap_report_id_t;
+
+// Entrada de la tabla para una accion
+typedef struct {
+    uint8_t kind;           // keymap_action_t
+    uint8_t modifiers;      // Teclas: KEYMAP_MOD_*
+    uint16_t code;          // Teclas: usage de teclado; multimedia: usage consumer; macros: indice
+} keymap_entry_t;
+
+// Paso de un macro: una pulsacion completa de tecla con modificadores
+typedef struct {
+    uint8_t modifiers;
+    uint8_t key;            // 0 termina el macro
+} keymap_step_t;
+
+typedef struct {
+    uint16_t version;
+    keymap_entry_t entries[KEYMAP_MAX_ACTIONS];     // Indice = accion - 1
+    keymap_step_t macros[KEYMAP_MAX_MACROS][KEYMAP_MACRO_STEPS];
+} keymap_t;
+
+// Reporte ya resuelto, antes de serializar
+typedef struct {
+    uint8_t id;             // keymap_report_id_t
+    uint8_t modifiers;
+    uint8_t key;
+    uint16_t usage;
+} keymap_report_t;
+
+/**
+ * @brief Tabla por defecto: los taps de los 6 botones como teclas multimedia
+ */
+void keymap_default(keymap_t *map);
+
+/**
+ * @brief Valida version, tipos e indices de macro
+ */
+bool keymap_validate(const keymap_t *map);
+
+/**
+ * @brief Traduce un evento del reconocedor a reportes
+ *
+ * Los gestos producen una pulsacion completa (presion y suelta). En modo crudo la presion
+ * y la suelta del boton n usan la accion n y generan solo la mitad que corresponde,
+ * asi una tecla puede mantenerse apretada.
+ *
+ * @return int Reportes escritos en out (como maximo KEYMAP_MAX_REPORTS)
+ */
+int keymap_process(const keymap_t *map, const btn_gesture_t *ev, keymap_report_t *out);
+
+/**
+ * @brief Serializa un reporte en KEYMAP_REPORT_BYTES bytes
+ */
+void keymap_report_encode(const keymap_report_t *r, uint8_t seq, uint8_t *out);
+
+/**
+ * @brief Nombre corto de un tipo de accion
+ */
+const char *keymap_action_name(uint8_t kind);
+
+/**
+ * @brief Formatea las acciones asignadas y los macros en texto
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t keymap_format(const keymap_t *map, char *out, size_t size);
+
+#endif // KEYMAP_H
@@ -0,0 +1,222 @@
+#include "knob_binding.h"
+// Bibliotecas de sistema
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define KNOB_RAW_MAX 4095
+
+static const char *target_names[KNOB_TARGET_COUNT] = {"off", "volume", "balance", "bass", "mid", "treble", "limiter"};
+static const char *curve_names[KNOB_CURVE_COUNT] = {"linear", "log", "detent"};
+
+// Limites que acepta cada parametro, su valor por defecto de extremo a extremo y la resolucion con que se entrega
+static const struct {
+    float lo;
+    float hi;
+    uint8_t curve;
+    float resolution;
+} target_limits[KNOB_TARGET_COUNT] = {
+    [KNOB_TARGET_NONE]    = {0.0f, 0.0f, KNOB_CURVE_LINEAR, 1.0f},
+    // set_volume ya convierte el porcentaje a dB, la curva lineal da pasos de volumen parejos
+    [KNOB_TARGET_VOLUME]  = {0.0f, 100.0f, KNOB_CURVE_LINEAR, 1.0f},
+    [KNOB_TARGET_BALANCE] = {-1.0f, 1.0f, KNOB_CURVE_DETENT, 0.01f},
+    [KNOB_TARGET_BASS]    = {-20.0f, 20.0f, KNOB_CURVE_DETENT, 0.1f},
+    [KNOB_TARGET_MID]     = {-20.0f, 20.0f, KNOB_CURVE_DETENT, 0.1f},
+    [KNOB_TARGET_TREBLE]  = {-20.0f, 20.0f, KNOB_CURVE_DETENT, 0.1f},
+    [KNOB_TARGET_LIMITER] = {-20.0f, 0.0f, KNOB_CURVE_LINEAR, 0.1f},
+};
+
+void knob_binding_default(knob_binding_t *b, knob_target_t target)
+{
+    memset(b, 0, sizeof(*b));
+    if (target <= KNOB_TARGET_NONE || target >= KNOB_TARGET_COUNT) {
+        return;
+    }
+    b->target = (uint8_t)target;
+    b->curve = target_limits[target].curve;
+    b->smooth_shift = 1;
+    b->detent_pct = 8;
+    b->min = target_limits[target].lo;
+    b->max = target_limits[target].hi;
+    // EQ de -12 a +12 dB por defecto, el resto del rango queda para configurarlo a mano
+    if (target == KNOB_TARGET_BASS || target == KNOB_TARGET_MID || target == KNOB_TARGET_TREBLE) {
+        b->min = -12.0f;
+        b->max = 12.0f;
+    }
+}
+
+void knob_binding_table_init(knob_binding_table_t *table)
+{
+    memset(table, 0, sizeof(*table));
+    table->version = KNOB_BINDING_VERSION;
+}
+
+static bool in_limits(uint8_t target, float v)
+{
+    return isfinite(v) && v >= target_limits[target].lo && v <= target_limits[target].hi;
+}
+
+bool knob_binding_validate(const knob_binding_table_t *table, const sensor_registry_t *reg)
+{
+    if (table->version != KNOB_BINDING_VERSION) {
+        return false;
+    }
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        const knob_binding_t *b = &table->slots[i];
+        if (b->target == KNOB_TARGET_NONE) {
+            continue;
+        }
+        if (b->target >= KNOB_TARGET_COUNT || b->curve >= KNOB_CURVE_COUNT ||
+            b->smooth_shift > KNOB_BINDING_MAX_SHIFT || b->detent_pct > 50 ||
+            !in_limits(b->target, b->min) || !in_limits(b->target, b->max) ||
+            reg->slots[i].type != SENSOR_TYPE_POT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float knob_binding_map(const knob_binding_t *b, uint16_t raw12)
+{
+    float x = (float)(raw12 > KNOB_RAW_MAX ? KNOB_RAW_MAX : raw12) / KNOB_RAW_MAX;
+    switch (b->curve) {
+    case KNOB_CURVE_LOG:
+        // (10^(2x) - 1) / 99: 40 dB de recorrido, la mitad del pot cae en ~9 %
+        x = (powf(10.0f, 2.0f * x) - 1.0f) / 99.0f;
+        break;
+    case KNOB_CURVE_DETENT: {
+        float half = (float)b->detent_pct / 200.0f;
+        if (fabsf(x - 0.5f) <= half) {
+            x = 0.5f;
+        } else if (x < 0.5f) {
+            x = 0.5f * x / (0.5f - half);
+        } else {
+            x = 0.5f + 0.5f * (x - 0.5f - half) / (0.5f - half);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return b->min + (b->max - b->min) * x;
+}
+
+static float quantize(uint8_t target, float v)
+{
+    float res = target_limits[target < KNOB_TARGET_COUNT ? target : KNOB_TARGET_NONE].resolution;
+    return roundf(v / res) * res;
+}
+
+bool knob_binding_update(const knob_binding_t *b, knob_binding_state_t *st, uint16_t raw12)
+{
+    if (!st->seeded) {
+        // Punto de partida sin aplicar: el DSP sigue con el perfil restaurado hasta que el pot se mueva
+        st->raw = raw12;
+        st->target = knob_binding_map(b, raw12);
+        st->current = st->target;
+        st->settled = true;
+        st->seeded = true;
+        return false;
+    }
+    if (raw12 == st->raw) {
+        return false;
+    }
+    st->raw = raw12;
+    st->target = knob_binding_map(b, raw12);
+    st->settled = false;
+    st->updates++;
+    return true;
+}
+
+bool knob_binding_step(const knob_binding_t *b, knob_binding_state_t *st)
+{
+    if (!st->seeded || st->settled) {
+        return false;
+    }
+    float diff = st->target - st->current;
+    // Al llegar a una milesima del rango se salta al objetivo para no arrastrar la cola del suavizado
+    float epsilon = fabsf(b->max - b->min) / 1000.0f;
+    if (b->smooth_shift == 0 || fabsf(diff) <= epsilon) {
+        st->current = st->target;
+        st->settled = true;
+    } else {
+        st->current += diff / (float)(1u << b->smooth_shift);
+    }
+    // Cada entrega publica en el bus y marca el perfil, los pasos que no mueven el valor se saltan
+    float value = quantize(b->target, st->current);
+    if (value == st->applied) {
+        return false;
+    }
+    st->applied = value;
+    st->applies++;
+    return true;
+}
+
+void knob_binding_reset_state(knob_binding_state_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    // NAN obliga a entregar el primer valor despues de un movimiento, aunque redondee igual que el inicial
+    st->applied = NAN;
+}
+
+const char *knob_target_name(uint8_t target)
+{
+    return target < KNOB_TARGET_COUNT ? target_names[target] : "?";
+}
+
+const char *knob_curve_name(uint8_t curve)
+{
+    return curve < KNOB_CURVE_COUNT ? curve_names[curve] : "?";
+}
+
+int knob_target_parse(const char *name)
+{
+    for (int i = 0; i < KNOB_TARGET_COUNT; i++) {
+        if (strcmp(name, target_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int knob_curve_parse(const char *name)
+{
+    for (int i = 0; i < KNOB_CURVE_COUNT; i++) {
+        if (strcmp(name, curve_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t knob_binding_format(const knob_binding_table_t *table, const knob_binding_state_t *state,
+                           char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    int bound = 0;
+    if (out == NULL || size == 0) {
+        return 0;
+    }
+    n = snprintf(out, size, "Asociaciones pot -> DSP (paso %u ms):\n", KNOB_BINDING_PERIOD_MS);
+    len = n > 0 ? (size_t)n : 0;
+    for (int i = 0; i < SENSOR_SLOT_COUNT && len < size; i++) {
+        const knob_binding_t *b = &table->slots[i];
+        const knob_binding_state_t *st = &state[i];
+        if (b->target == KNOB_TARGET_NONE) {
+            continue;
+        }
+        bound++;
+        n = snprintf(out + len, size - len,
+                     "  slot %2d: %-7s %-6s %.2f..%.2f suavizado 1/%u reten %u%% | lectura %u -> %.2f (aplicado %.2f), lecturas %u, aplicaciones %u\n",
+                     i + 1, knob_target_name(b->target), knob_curve_name(b->curve), b->min, b->max,
+                     1u << b->smooth_shift, b->detent_pct, st->raw, st->target, st->current,
+                     st->updates, st->applies);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    if (bound == 0 && len < size) {
+        n = snprintf(out + len, size - len, "  (sin asociaciones)\n");
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
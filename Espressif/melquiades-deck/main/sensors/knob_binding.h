@@ -0,0 +1,127 @@
+#ifndef KNOB_BINDING_H
+#define KNOB_BINDING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sensor_registry.h"
+
+// Asociacion de slots de pot a parametros del DSP, en C puro para probarla en host.
+// El equipo aplica la curva y el suavizado sin pasar por SPP ni por la app de escritorio.
+// Blob de NVS como la tabla de sensores (ver sensor_registry.h); al cargarla tambien se
+// descarta si alguna asociacion cae en un slot que ya no es pot.
+
+#define KNOB_BINDING_VERSION    1
+#define KNOB_BINDING_MAX_SHIFT  6   // Suavizado maximo 1/64 por paso
+#define KNOB_BINDING_PERIOD_MS  10  // Paso del suavizado, del orden de un bloque de audio de 2048 B a 44.1 kHz
+
+typedef enum {
+    KNOB_TARGET_NONE = 0,
+    KNOB_TARGET_VOLUME,         // 0..100 %
+    KNOB_TARGET_BALANCE,        // -1 (izq) .. 1 (der)
+    KNOB_TARGET_BASS,           // dB
+    KNOB_TARGET_MID,            // dB
+    KNOB_TARGET_TREBLE,         // dB
+    KNOB_TARGET_LIMITER,        // Umbral del limitador en dBFS
+    KNOB_TARGET_COUNT
+} knob_target_t;
+
+typedef enum {
+    KNOB_CURVE_LINEAR = 0,
+    KNOB_CURVE_LOG,             // Cono de audio: resolucion fina en la parte baja del recorrido
+    KNOB_CURVE_DETENT,          // Lineal con una zona muerta en el centro del recorrido
+    KNOB_CURVE_COUNT
+} knob_curve_t;
+
+// Asociacion de un slot
+typedef struct {
+    uint8_t target;         // knob_target_t
+    uint8_t curve;          // knob_curve_t
+    uint8_t smooth_shift;   // Suavizado: y += (x - y) / 2^n por paso, 0 aplica al instante
+    uint8_t detent_pct;     // Ancho de la zona central de la curva con retén (% del recorrido)
+    float min;              // Valor con el pot al minimo
+    float max;              // Valor con el pot al maximo
+} knob_binding_t;
+
+typedef struct {
+    uint16_t version;
+    knob_binding_t slots[SENSOR_SLOT_COUNT];
+} knob_binding_table_t;
+
+// Estado de una asociacion
+typedef struct {
+    uint16_t raw;           // Ultima lectura de 12 bits aplicada
+    float target;           // Valor de la curva para esa lectura
+    float current;          // Valor suavizado
+    float applied;          // Ultimo valor entregado al DSP en la resolucion del parametro, NAN sin entregar
+    bool seeded;            // Ya se tomo la primera lectura real del pot
+    bool settled;           // current ya alcanzo target
+    uint32_t updates;       // Lecturas nuevas recibidas
+    uint32_t applies;       // Valores entregados al DSP
+} knob_binding_state_t;
+
+/**
+ * @brief Rango, curva y suavizado por defecto de un parametro
+ */
+void knob_binding_default(knob_binding_t *b, knob_target_t target);
+
+/**
+ * @brief Deja la tabla sin asociaciones
+ */
+void knob_binding_table_init(knob_binding_table_t *table);
+
+/**
+ * @brief Valida version, parametros, curvas y que cada asociacion caiga en un slot de pot
+ */
+bool knob_binding_validate(const knob_binding_table_t *table, const sensor_registry_t *reg);
+
+/**
+ * @brief Aplica la curva de la asociacion a una lectura de 12 bits
+ */
+float knob_binding_map(const knob_binding_t *b, uint16_t raw12);
+
+/**
+ * @brief Registra una lectura nueva y recalcula el objetivo
+ *
+ * La primera lectura despues de knob_binding_reset_state solo fija el punto de partida:
+ * el DSP conserva su valor (el perfil restaurado) hasta que el pot se mueva.
+ *
+ * @return true si la lectura difiere de la anterior
+ */
+bool knob_binding_update(const knob_binding_t *b, knob_binding_state_t *st, uint16_t raw12);
+
+/**
+ * @brief Avanza un paso del suavizado hacia el objetivo
+ *
+ * @return true si applied cambio en la resolucion del parametro y hay que aplicarlo al DSP
+ */
+bool knob_binding_step(const knob_binding_t *b, knob_binding_state_t *st);
+
+/**
+ * @brief Deja el estado esperando la primera lectura real del pot
+ */
+void knob_binding_reset_state(knob_binding_state_t *st);
+
+/**
+ * @brief Nombre corto de un parametro o de una curva
+ */
+const char *knob_target_name(uint8_t target);
+const char *knob_curve_name(uint8_t curve);
+
+/**
+ * @brief Busca un parametro o una curva por nombre
+ *
+ * @return int Valor del enum, -1 si no existe
+ */
+int knob_target_parse(const char *name);
+int knob_curve_parse(const char *name);
+
+/**
+ * @brief Formatea las asociaciones activas y su estado en texto
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t knob_binding_format(const knob_binding_table_t *table, const knob_binding_state_t *state,
+                           char *out, size_t size);
+
+#endif // KNOB_BINDING_H
@@ -0,0 +1,68 @@
+#include "pot_calib.h"
+#include <stddef.h>
+#include "pot_filter.h"
+
+#define RAW_MAX     4095
+#define GRID_STEP   (4096 >> POT_CALIB_LUT_BITS)
+
+bool pot_calib_points_valid(const pot_calib_points_t *pts)
+{
+    if (pts == NULL || pts->max == 0 || pts->max > RAW_MAX || pts->min >= pts->max ||
+        pts->max - pts->min < POT_CALIB_MIN_SPAN) {
+        return false;
+    }
+    return pts->centre == 0 || (pts->centre > pts->min && pts->centre < pts->max);
+}
+
+uint32_t pot_calib_mv(const uint16_t *mv_grid, uint16_t raw12)
+{
+    if (mv_grid == NULL) {
+        return raw12;
+    }
+    if (raw12 > RAW_MAX) {
+        raw12 = RAW_MAX;
+    }
+    uint32_t idx = raw12 / GRID_STEP;
+    uint32_t frac = raw12 % GRID_STEP;
+    if (idx >= POT_CALIB_LUT_SIZE - 1) {
+        return mv_grid[POT_CALIB_LUT_SIZE - 1];
+    }
+    // La ultima celda va de 4080 a 4095: un LSB mas corta que las demas
+    uint32_t step = idx == POT_CALIB_LUT_SIZE - 2 ? RAW_MAX - idx * GRID_STEP : GRID_STEP;
+    int32_t a = mv_grid[idx];
+    int32_t b = mv_grid[idx + 1];
+    return (uint32_t)(a + (b - a) * (int32_t)frac / (int32_t)step);
+}
+
+// Lleva mv del tramo [lo, hi] al tramo de salida [out_lo, out_hi] en Q4, saturando en los extremos
+static uint16_t map_segment(uint32_t mv, uint32_t lo, uint32_t hi, uint32_t out_lo, uint32_t out_hi)
+{
+    if (mv <= lo || hi <= lo) {
+        return (uint16_t)out_lo;
+    }
+    if (mv >= hi) {
+        return (uint16_t)out_hi;
+    }
+    return (uint16_t)(out_lo + (uint64_t)(mv - lo) * (out_hi - out_lo) / (hi - lo));
+}
+
+void pot_calib_build(uint16_t *lut, const uint16_t *mv_grid, const pot_calib_points_t *pts)
+{
+    bool manual = pot_calib_points_valid(pts);
+    uint32_t lo = pot_calib_mv(mv_grid, manual ? pts->min : 0);
+    uint32_t hi = pot_calib_mv(mv_grid, manual ? pts->max : RAW_MAX);
+    uint32_t mid = manual && pts->centre != 0 ? pot_calib_mv(mv_grid, pts->centre) : 0;
+    const uint32_t out_mid = 2048u << POT_FILTER_FRAC_BITS;
+
+    for (int i = 0; i < POT_CALIB_LUT_SIZE; i++) {
+        // Cada entrada corresponde a la lectura i * 16 (la ultima se recorta a 4095)
+        uint32_t raw = (uint32_t)i * GRID_STEP;
+        uint32_t mv = pot_calib_mv(mv_grid, (uint16_t)(raw > RAW_MAX ? RAW_MAX : raw));
+        if (mid != 0) {
+            lut[i] = mv < mid ? map_segment(mv, lo, mid, 0, out_mid)
+                              : map_segment(mv, mid, hi, out_mid, POT_FILTER_MAX);
+        } else {
+            lut[i] = map_segment(mv, lo, hi, 0, POT_FILTER_MAX);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef POT_CALIB_H
+#define POT_CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Linealizacion de pots en C puro: la curva de eFuse (raw -> mV) y los puntos min/centro/max
+// de cada pot se pliegan en una tabla que se arma una vez; el camino caliente solo la consulta.
+// Entrada y salida en Q4 (12 bits << 4), como el resto de la cadena de pot_filter.
+
+#define POT_CALIB_LUT_BITS  8
+#define POT_CALIB_LUT_SIZE  ((1 << POT_CALIB_LUT_BITS) + 1)    // 257 puntos, uno cada 16 LSB
+#define POT_CALIB_MIN_SPAN  256     // Recorrido minimo entre min y max (LSB de 12 bits)
+// La ultima celda va de 4080 a 4095: 240 pasos Q4 en lugar de 256
+#define POT_CALIB_LAST_CELL_Q4  ((4095 << 4) - ((POT_CALIB_LUT_SIZE - 2) << (16 - POT_CALIB_LUT_BITS)))
+
+// Puntos capturados a mano de un pot, en LSB crudos de 12 bits
+typedef struct {
+    uint16_t min;           // Lectura con el pot al minimo
+    uint16_t centre;        // Lectura en el reten central, 0 sin punto central
+    uint16_t max;           // Lectura con el pot al maximo, 0 sin calibracion manual
+} pot_calib_points_t;
+
+/**
+ * @brief Indica si los puntos forman una calibracion manual utilizable
+ */
+bool pot_calib_points_valid(const pot_calib_points_t *pts);
+
+/**
+ * @brief Interpola los mV de una lectura cruda en la grilla de caracterizacion
+ *
+ * @param mv_grid mV de las lecturas 0, 16, 32 ... 4095 (POT_CALIB_LUT_SIZE puntos)
+ */
+uint32_t pot_calib_mv(const uint16_t *mv_grid, uint16_t raw12);
+
+/**
+ * @brief Arma la tabla de un pot
+ *
+ * Sin puntos manuales el recorrido en mV de la grilla completa se lleva a 0..4095;
+ * con puntos, min y max (y el centro si existe) se llevan a 0, 2048 y 4095.
+ *
+ * @param lut Tabla de POT_CALIB_LUT_SIZE entradas en Q4
+ * @param mv_grid mV de la curva de eFuse, NULL para una respuesta lineal ideal
+ * @param pts Puntos manuales, NULL o invalidos para no usarlos
+ */
+void pot_calib_build(uint16_t *lut, const uint16_t *mv_grid, const pot_calib_points_t *pts);
+
+/**
+ * @brief Aplica la tabla a un valor en Q4: una consulta y una interpolacion entera
+ */
+static inline uint16_t pot_calib_apply(const uint16_t *lut, uint16_t x_q4)
+{
+    uint32_t idx = x_q4 >> (16 - POT_CALIB_LUT_BITS);
+    uint32_t frac = x_q4 & ((1u << (16 - POT_CALIB_LUT_BITS)) - 1);
+    int32_t a = lut[idx];
+    int32_t b = lut[idx + 1];
+    if (idx == POT_CALIB_LUT_SIZE - 2) {
+        // Solo la celda corta paga la division; 4095 llega exacto a lut[256]
+        return frac >= POT_CALIB_LAST_CELL_Q4 ? (uint16_t)b
+                                              : (uint16_t)(a + (b - a) * (int32_t)frac / POT_CALIB_LAST_CELL_Q4);
+    }
+    return (uint16_t)(a + (((b - a) * (int32_t)frac) >> (16 - POT_CALIB_LUT_BITS)));
+}
+
+#endif // POT_CALIB_H
@@ -0,0 +1,50 @@
+#include "pot_filter.h"
+#include "pot_calib.h"
+#include <string.h>
+
+void pot_filter_init(pot_filter_t *f)
+{
+    memset(f, 0, sizeof(*f));
+}
+
+bool pot_filter_push(pot_filter_t *f, const pot_filter_config_t *cfg, uint16_t raw)
+{
+    uint16_t decimation = cfg->decimation > 0 ? cfg->decimation : 1;
+    f->acc += raw & 0x0FFF;
+    if (++f->count < decimation) {
+        return false;
+    }
+
+    // Promedio del bloque con los bits de resolucion ganados al sobremuestrear
+    int32_t x = (int32_t)(((uint64_t)f->acc << POT_FILTER_FRAC_BITS) / decimation);
+    f->raw_avg = (uint16_t)x;
+    // Linealizacion: una consulta por salida diezmada, no por muestra cruda
+    if (cfg->lut != NULL) {
+        x = pot_calib_apply(cfg->lut, (uint16_t)x);
+    }
+    f->acc = 0;
+    f->count = 0;
+    f->outputs++;
+
+    if (!f->primed) {
+        f->smooth_q8 = x << 8;
+        f->value = (uint16_t)x;
+        f->reported = (uint16_t)x;
+        f->primed = true;
+        f->changes++;
+        return true;
+    }
+
+    // Filtro de un polo en entero, sin flotantes en el camino caliente
+    f->smooth_q8 += ((x << 8) - f->smooth_q8) >> cfg->smooth_shift;
+    f->value = (uint16_t)((f->smooth_q8 + 128) >> 8);
+
+    // Histeresis: solo se mueve el valor reportado si sale de la banda muerta
+    int32_t diff = (int32_t)f->value - (int32_t)f->reported;
+    if (diff > (int32_t)cfg->deadband || -diff > (int32_t)cfg->deadband) {
+        f->reported = f->value;
+        f->changes++;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,52 @@
+#ifndef POT_FILTER_H
+#define POT_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Cadena de filtrado por canal en C puro: diezmado -> linealizacion -> suavizado de un polo -> banda muerta
+// Los valores van en Q4 (12 bits del ADC << 4), el sobremuestreo aporta los bits extra
+
+#define POT_FILTER_FRAC_BITS 4
+#define POT_FILTER_MAX       (4095 << POT_FILTER_FRAC_BITS)
+
+typedef struct {
+    uint16_t decimation;    // Muestras crudas promediadas por salida
+    uint8_t smooth_shift;   // Suavizado: y += (x - y) >> shift, 0 lo desactiva
+    uint16_t deadband;      // Cambio minimo en Q4 para reportar un valor nuevo
+    const uint16_t *lut;    // Tabla de pot_calib aplicada a cada salida diezmada, NULL sin calibrar
+} pot_filter_config_t;
+
+typedef struct {
+    uint32_t acc;           // Suma de muestras crudas del bloque actual
+    uint16_t count;
+    uint16_t raw_avg;       // Ultimo promedio diezmado antes de la tabla (Q4), para capturar puntos
+    int32_t smooth_q8;      // Estado del suavizado con 8 bits extra de fraccion
+    uint16_t value;         // Salida suavizada (Q4)
+    uint16_t reported;      // Ultimo valor que supero la banda muerta (Q4)
+    bool primed;
+    uint32_t outputs;       // Salidas diezmadas producidas
+    uint32_t changes;       // Veces que se supero la banda muerta
+} pot_filter_t;
+
+/**
+ * @brief Reinicia el estado del filtro
+ */
+void pot_filter_init(pot_filter_t *f);
+
+/**
+ * @brief Agrega una muestra cruda de 12 bits
+ *
+ * @return true si el valor reportado cambio (supero la banda muerta)
+ */
+bool pot_filter_push(pot_filter_t *f, const pot_filter_config_t *cfg, uint16_t raw);
+
+/**
+ * @brief Ultimo valor reportado en la escala de 12 bits del ADC
+ */
+static inline uint16_t pot_filter_reported_12bit(const pot_filter_t *f)
+{
+    return (uint16_t)((f->reported + (1 << (POT_FILTER_FRAC_BITS - 1))) >> POT_FILTER_FRAC_BITS);
+}
+
+#endif // POT_FILTER_H
@@ -1,54 +1,583 @@
 #include "potentiometers.h"
 //bibliotecas de sistema
 #include "driver/adc.h"
+#include "driver/gpio.h"
+#include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_adc_cal.h"
+#include "nvs.h"
 //bibliotecas custom
-#include "../state.h"
-#include "../bluetooth/spp_init.h"
-// Puertos asignados a los potenciometros
-#define ADC_POT_1 ADC1_CHANNEL_0 // GPIO36 (ADC00)
-#define ADC_POT_2 ADC2_CHANNEL_9 // GPIO26 (ADC19)
-#define ADC_POT_3 ADC1_CHANNEL_3 // GPIO39 (ADC03)
-#define ADC_POT_4 ADC1_CHANNEL_7 // GPIO35 (ADC07)
-#define ADC_POT_5 ADC1_CHANNEL_5 // GPIO33 (ADC05)
-#define ADC_POT_6 ADC1_CHANNEL_6 // GPIO34 (ADC10)
-
-void init_potentiometers(){
-    // Configurar ADC1
-    adc1_config_width(ADC_WIDTH_BIT_12);
-    adc1_config_channel_atten(ADC_POT_1, ADC_ATTEN_DB_11);
-    adc1_config_channel_atten(ADC_POT_3, ADC_ATTEN_DB_11);
-    adc1_config_channel_atten(ADC_POT_4, ADC_ATTEN_DB_11);
-    adc1_config_channel_atten(ADC_POT_5, ADC_ATTEN_DB_11);
-    adc1_config_channel_atten(ADC_POT_6, ADC_ATTEN_DB_11);
-    // Configurar ADC2
-    adc2_config_channel_atten(ADC_POT_2, ADC_ATTEN_DB_11);
-}
-
-void read_potentiometers(){
-    char response[100];  // Reservas espacio suficiente
-    while (1)
-    {
-        int val1 = adc1_get_raw(ADC_POT_1);
-        int val3 = adc1_get_raw(ADC_POT_3);
-        int val4 = adc1_get_raw(ADC_POT_4);
-        int val5 = adc1_get_raw(ADC_POT_5);
-        int val6 = adc1_get_raw(ADC_POT_6);
-
-        // Como GPIO26 está en ADC2, hay que leerlo con adc2_get_raw
-        int val2;
-        adc2_get_raw(ADC_POT_2, ADC_WIDTH_BIT_12, &val2);
-        //construimos response        
-        snprintf(response, sizeof(response), "Potenciómetros: %d, %d, %d, %d, %d, %d\r\n", val1, val2, val3, val4, val5, val6);
-        //Validamos el shell activo        
-        if(sensors_streaming_uart){
-            printf("%s", response);
-        }else if(sensors_streaming_bt){
-            send_bt_response(response);
-        }        
-        //Delay para no sobrecargar
-        vTaskDelay(pdMS_TO_TICKS(500));
+#include "pot_calib.h"
+
+#define TAG "POTENTIOMETERS"
+
+// Modo continuo de ADC1 (en ESP32 usa el DMA de I2S0, por eso el audio va en I2S1)
+#define POT_SAMPLE_HZ_DEFAULT   20000   // Minimo del controlador digital del ESP32
+#define POT_SAMPLE_HZ_MAX       2000000
+#define POT_DMA_FRAME_BYTES     SENSOR_BOARD_DMA_FRAME
+#define POT_DMA_STORE_BYTES     4096
+#define POT_STALE_MS            200     // Sin salidas nuevas en este tiempo el pot se marca caido
+#define POT_DEFAULT_VREF_MV     1100    // Vref nominal si el chip no trae calibracion en eFuse
+#define POT_NVS_NAMESPACE       "sensors"
+#define POT_NVS_CALIB           "pot_calib"
+
+// Cableado y filtro de cada pot, tomados del registro de sensores
+static pot_wiring_t pot_wiring[POT_MAX];
+static pot_filter_config_t filter_cfg[POT_MAX];
+static int pot_count = 0;
+static const char *source_names[] = {"adc1", "adc2", "mux"};
+
+static pot_filter_t filters[POT_MAX];
+static volatile bool pending_change[POT_MAX];
+static int64_t change_us[POT_MAX];     // Instante en que se vio el primer cambio aun no consultado
+static int64_t frame_us = 0;           // Instante en que se vacio el bloque en proceso
+static int8_t adc1_to_pot[ADC1_CHANNEL_MAX];
+static uint32_t sample_hz = POT_SAMPLE_HZ_DEFAULT;
+static bool dma_running = false;
+static volatile uint32_t pending_rate_hz = 0;
+static uint8_t dma_buf[POT_DMA_FRAME_BYTES];
+
+// Salud de cada pot: ultima salida nueva y caidas detectadas
+static uint32_t last_outputs[POT_MAX];
+static int64_t last_update_us[POT_MAX];
+static bool pot_stale[POT_MAX];
+static uint32_t stale_events[POT_MAX];
+
+// Errores de ADC2: con la radio activa adc2_get_raw devuelve ESP_ERR_TIMEOUT
+static uint32_t adc2_reads = 0;
+static uint32_t adc2_radio_busy = 0;
+static uint32_t adc2_errors = 0;
+static esp_err_t adc2_last_error = ESP_OK;
+
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+// Mux externo: cada entrada ocupa dos bloques, el primero se descarta porque el DMA
+// ya lo estaba convirtiendo antes del cambio de selector y la salida aun no se asienta
+static const gpio_num_t mux_sel[] = SENSOR_BOARD_MUX_SEL;
+static int8_t mux_to_pot[8];
+static uint8_t mux_input = 0;
+static bool mux_settled = false;
+static uint32_t mux_discarded = 0;
+#endif
+
+// Calibracion: curva raw -> mV de cada unidad (eFuse) y tabla por pot con sus puntos manuales
+static esp_adc_cal_value_t cal_source[2];
+static uint16_t mv_grid[2][POT_CALIB_LUT_SIZE];
+static uint16_t luts[POT_MAX][POT_CALIB_LUT_SIZE];
+static pot_calib_points_t cal_points[POT_MAX];
+static uint32_t pending_calib_mask = 0;
+static const char *cal_source_names[] = {"eFuse Vref", "eFuse Two Point", "Vref por defecto"};
+
+// Contadores del muestreo
+static uint32_t dma_frames = 0;
+static uint32_t dma_overflows = 0;
+static uint64_t raw_samples = 0;
+static uint64_t filter_cycles = 0;
+
+static esp_err_t configure_adc1_dma(void)
+{
+    adc_digi_pattern_config_t pattern[POT_MAX];
+    uint32_t mask = 0;
+    uint32_t count = 0;
+    for (int i = 0; i < pot_count; i++) {
+        uint8_t channel;
+        if (pot_wiring[i].source == POT_SRC_ADC1 && pot_wiring[i].channel < ADC1_CHANNEL_MAX) {
+            channel = pot_wiring[i].channel;
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+        } else if (pot_wiring[i].source == POT_SRC_MUX) {
+            channel = SENSOR_BOARD_MUX_CHANNEL;
+#endif
+        } else {
+            continue;
+        }
+        if (mask & (1u << channel)) {
+            continue;
+        }
+        pattern[count].atten = ADC_ATTEN_DB_11;
+        pattern[count].channel = channel;
+        pattern[count].unit = 0;
+        pattern[count].bit_width = 12;
+        mask |= 1u << channel;
+        count++;
+    }
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    adc_digi_init_config_t init_cfg = {
+        .max_store_buf_size = POT_DMA_STORE_BYTES,
+        .conv_num_each_intr = POT_DMA_FRAME_BYTES,
+        .adc1_chan_mask = mask,
+        .adc2_chan_mask = 0,
+    };
+    esp_err_t ret = adc_digi_initialize(&init_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    adc_digi_configuration_t dig_cfg = {
+        .conv_limit_en = true,
+        .conv_limit_num = 250,
+        .pattern_num = count,
+        .adc_pattern = pattern,
+        .sample_freq_hz = sample_hz,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    ret = adc_digi_controller_configure(&dig_cfg);
+    if (ret == ESP_OK) {
+        ret = adc_digi_start();
+    }
+    if (ret != ESP_OK) {
+        adc_digi_deinitialize();
+        return ret;
+    }
+    dma_running = true;
+    return ESP_OK;
+}
+
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+static void mux_select(uint8_t input)
+{
+    for (int b = 0; b < sizeof(mux_sel) / sizeof(mux_sel[0]); b++) {
+        gpio_set_level(mux_sel[b], (input >> b) & 1);
+    }
+}
+
+static void init_mux(void)
+{
+    uint64_t mask = 0;
+    for (int b = 0; b < sizeof(mux_sel) / sizeof(mux_sel[0]); b++) {
+        mask |= 1ULL << mux_sel[b];
+    }
+    gpio_config_t io_conf = {
+        .pin_bit_mask = mask,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE};
+    gpio_config(&io_conf);
+
+    memset(mux_to_pot, -1, sizeof(mux_to_pot));
+    for (int i = 0; i < pot_count; i++) {
+        if (pot_wiring[i].source == POT_SRC_MUX) {
+            mux_to_pot[pot_wiring[i].mux_input & 7] = (int8_t)i;
+        }
+    }
+    // Primera entrada cableada
+    while (mux_to_pot[mux_input] < 0 && mux_input < 7) {
+        mux_input++;
+    }
+    mux_select(mux_input);
+}
+
+static bool mux_in_use(void)
+{
+    for (int i = 0; i < 8; i++) {
+        if (mux_to_pot[i] >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Avanza a la siguiente entrada cableada despues de usar un bloque asentado
+static void mux_advance(void)
+{
+    if (!mux_settled) {
+        mux_settled = true;
+        mux_discarded++;
+        return;
+    }
+    do {
+        mux_input = (mux_input + 1) & 7;
+    } while (mux_to_pot[mux_input] < 0);
+    mux_select(mux_input);
+    mux_settled = false;
+}
+#endif
+
+// Caracteriza ADC1 y ADC2 con lo que traiga el eFuse y guarda la curva en una grilla cada 16 LSB
+static void characterize_adc(void)
+{
+    for (int unit = 0; unit < 2; unit++) {
+        esp_adc_cal_characteristics_t chars;
+        cal_source[unit] = esp_adc_cal_characterize(unit == 0 ? ADC_UNIT_1 : ADC_UNIT_2, ADC_ATTEN_DB_11,
+                                                    ADC_WIDTH_BIT_12, POT_DEFAULT_VREF_MV, &chars);
+        for (int i = 0; i < POT_CALIB_LUT_SIZE; i++) {
+            uint32_t raw = (uint32_t)i * (4096 >> POT_CALIB_LUT_BITS);
+            mv_grid[unit][i] = (uint16_t)esp_adc_cal_raw_to_voltage(raw > 4095 ? 4095 : raw, &chars);
+        }
+    }
+}
+
+// Los puntos se guardan por indice de pot; si cambia la tabla de slots conviene recalibrar
+static void load_calibration(void)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(cal_points);
+    memset(cal_points, 0, sizeof(cal_points));
+    if (nvs_open(POT_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_get_blob(handle, POT_NVS_CALIB, cal_points, &len) != ESP_OK || len != sizeof(cal_points)) {
+        memset(cal_points, 0, sizeof(cal_points));
+    }
+    nvs_close(handle);
+}
+
+static void build_lut(int pot)
+{
+    int unit = pot_wiring[pot].source == POT_SRC_ADC2 ? 1 : 0;
+    pot_calib_build(luts[pot], mv_grid[unit], &cal_points[pot]);
+    filter_cfg[pot].lut = luts[pot];
+}
+
+void init_potentiometers(const pot_wiring_t *wiring, const pot_filter_config_t *cfg, int count){
+    pot_count = count < POT_MAX ? count : POT_MAX;
+    memcpy(pot_wiring, wiring, sizeof(pot_wiring_t) * pot_count);
+    memcpy(filter_cfg, cfg, sizeof(pot_filter_config_t) * pot_count);
+    // Mapa canal ADC1 -> pot para decodificar las conversiones del DMA
+    memset(adc1_to_pot, -1, sizeof(adc1_to_pot));
+    characterize_adc();
+    load_calibration();
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < pot_count; i++) {
+        pot_filter_init(&filters[i]);
+        build_lut(i);
+        last_update_us[i] = now;
+        if (pot_wiring[i].source == POT_SRC_ADC1 && pot_wiring[i].channel < ADC1_CHANNEL_MAX) {
+            adc1_to_pot[pot_wiring[i].channel] = (int8_t)i;
+        } else if (pot_wiring[i].source == POT_SRC_ADC2) {
+            adc2_config_channel_atten(pot_wiring[i].channel, ADC_ATTEN_DB_11);
+        }
+#ifndef SENSOR_BOARD_MUX_CHANNEL
+        else if (pot_wiring[i].source == POT_SRC_MUX) {
+            ESP_LOGE(TAG, "Pot %d configurado en mux, pero esta placa no tiene mux", i + 1);
+        }
+#endif
+    }
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+    init_mux();
+#endif
+    // ADC1 en modo continuo
+    esp_err_t ret = configure_adc1_dma();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "No se pudo iniciar el ADC continuo: %s", esp_err_to_name(ret));
+    }
+    ESP_LOGI(TAG, "Placa de sensores '%s', calibracion ADC1: %s, ADC2: %s", SENSOR_BOARD_NAME,
+             cal_source_names[cal_source[0]], cal_source_names[cal_source[1]]);
+}
+
+// ADC2 no tiene DMA: una lectura por bloque, sin diezmado, y se cuentan los rechazos
+static bool read_adc2(int pot)
+{
+    int raw;
+    esp_err_t ret = adc2_get_raw(pot_wiring[pot].channel, ADC_WIDTH_BIT_12, &raw);
+    adc2_reads++;
+    if (ret != ESP_OK) {
+        if (ret == ESP_ERR_TIMEOUT) {
+            adc2_radio_busy++;
+        } else {
+            adc2_errors++;
+        }
+        adc2_last_error = ret;
+        return false;
+    }
+    pot_filter_config_t adc2_cfg = filter_cfg[pot];
+    adc2_cfg.decimation = 1;
+    return pot_filter_push(&filters[pot], &adc2_cfg, (uint16_t)raw);
+}
+
+static void mark_change(int pot)
+{
+    if (!pending_change[pot]) {
+        change_us[pot] = frame_us;
+    }
+    pending_change[pot] = true;
+}
+
+// Procesa un bloque DMA y marca los pots que salieron de su banda muerta
+static void push_sample(int pot, uint16_t raw)
+{
+    if (pot_filter_push(&filters[pot], &filter_cfg[pot], raw)) {
+        mark_change(pot);
     }
 }
 
+static void process_frame(const uint8_t *buf, uint32_t len)
+{
+    uint32_t start = esp_cpu_get_ccount();
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&buf[i];
+        uint8_t channel = p->type1.channel;
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+        if (channel == SENSOR_BOARD_MUX_CHANNEL) {
+            if (mux_settled && mux_to_pot[mux_input] >= 0) {
+                push_sample(mux_to_pot[mux_input], p->type1.data);
+            }
+            continue;
+        }
+#endif
+        if (channel < ADC1_CHANNEL_MAX && adc1_to_pot[channel] >= 0) {
+            push_sample(adc1_to_pot[channel], p->type1.data);
+        }
+    }
+    raw_samples += len / SOC_ADC_DIGI_RESULT_BYTES;
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+    if (mux_in_use()) {
+        mux_advance();
+    }
+#endif
+
+    for (int i = 0; i < pot_count; i++) {
+        if (pot_wiring[i].source == POT_SRC_ADC2 && read_adc2(i)) {
+            mark_change(i);
+        }
+    }
+    filter_cycles += esp_cpu_get_ccount() - start;
+}
+
+// Marca como caido el pot que deja de producir salidas y avisa una sola vez por caida
+static void check_health(void)
+{
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < pot_count; i++) {
+        if (filters[i].outputs != last_outputs[i]) {
+            last_outputs[i] = filters[i].outputs;
+            last_update_us[i] = now;
+            if (pot_stale[i]) {
+                pot_stale[i] = false;
+                ESP_LOGI(TAG, "Pot %d (%s) vuelve a actualizar", i + 1, source_names[pot_wiring[i].source]);
+            }
+        } else if (!pot_stale[i] && now - last_update_us[i] > (int64_t)POT_STALE_MS * 1000) {
+            pot_stale[i] = true;
+            stale_events[i]++;
+            if (pot_wiring[i].source == POT_SRC_ADC2) {
+                ESP_LOGE(TAG, "Pot %d sin lecturas de ADC2 hace %d ms (ultimo error %s), se conserva el ultimo valor",
+                         i + 1, POT_STALE_MS, esp_err_to_name(adc2_last_error));
+            } else {
+                ESP_LOGE(TAG, "Pot %d sin lecturas hace %d ms", i + 1, POT_STALE_MS);
+            }
+        }
+    }
+}
+
+void potentiometers_drain(void)
+{
+    if (pending_rate_hz != 0) {
+        // El controlador digital solo se reconfigura detenido
+        if (dma_running) {
+            adc_digi_stop();
+            adc_digi_deinitialize();
+            dma_running = false;
+        }
+        sample_hz = pending_rate_hz;
+        pending_rate_hz = 0;
+        esp_err_t ret = configure_adc1_dma();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "No se pudo reconfigurar el ADC a %u Hz: %s", sample_hz, esp_err_to_name(ret));
+        }
+    }
+    // Las tablas se rearman aqui para que ningun bloque las lea a medio escribir
+    uint32_t calib = __atomic_exchange_n(&pending_calib_mask, 0, __ATOMIC_ACQUIRE);
+    if (calib != 0) {
+        for (int i = 0; i < pot_count; i++) {
+            if (calib & (1u << i)) {
+                build_lut(i);
+            }
+        }
+    }
+    // El planificador de sensores llama sin bloquear, aqui solo se vacia lo que ya completo el DMA
+    while (dma_running) {
+        uint32_t len = 0;
+        esp_err_t ret = adc_digi_read_bytes(dma_buf, sizeof(dma_buf), &len, 0);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            // El buffer del driver se lleno antes de leerlo, los datos devueltos siguen siendo validos
+            dma_overflows++;
+        } else if (ret != ESP_OK) {
+            break;
+        }
+        dma_frames++;
+        frame_us = esp_timer_get_time();
+        process_frame(dma_buf, len);
+    }
+    check_health();
+}
+
+bool potentiometers_take_change(int pot, int64_t *t_us)
+{
+    if (pot < 0 || pot >= pot_count || !pending_change[pot]) {
+        return false;
+    }
+    if (t_us != NULL) {
+        *t_us = change_us[pot];
+    }
+    pending_change[pot] = false;
+    return true;
+}
+
+uint16_t potentiometers_get_value(int pot)
+{
+    return pot >= 0 && pot < pot_count ? pot_filter_reported_12bit(&filters[pot]) : 0;
+}
+
+bool potentiometers_has_value(int pot)
+{
+    return pot >= 0 && pot < pot_count && filters[pot].primed;
+}
+
+int potentiometers_count(void)
+{
+    return pot_count;
+}
+
+uint32_t potentiometers_get_sample_count(void){
+    return filters[0].outputs;
+}
+
+void potentiometers_get_health(pot_health_t *health)
+{
+    health->adc2_reads = adc2_reads;
+    health->adc2_radio_busy = adc2_radio_busy;
+    health->adc2_errors = adc2_errors;
+    health->stale = 0;
+    health->stale_events = 0;
+    for (int i = 0; i < pot_count; i++) {
+        health->stale += pot_stale[i] ? 1 : 0;
+        health->stale_events += stale_events[i];
+    }
+}
+
+esp_err_t potentiometers_set_rate(uint32_t hz)
+{
+    if (hz < POT_SAMPLE_HZ_DEFAULT || hz > POT_SAMPLE_HZ_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Se aplica en la tarea que lee el DMA para no desinicializar el driver en plena lectura
+    pending_rate_hz = hz;
+    return ESP_OK;
+}
+
+void potentiometers_set_filter(int pot, const pot_filter_config_t *cfg)
+{
+    if (pot < 0 || pot >= pot_count) {
+        return;
+    }
+    filter_cfg[pot] = *cfg;
+    filter_cfg[pot].lut = luts[pot];
+    if (filter_cfg[pot].decimation == 0) {
+        filter_cfg[pot].decimation = 1;
+    }
+    if (filter_cfg[pot].smooth_shift > 8) {
+        filter_cfg[pot].smooth_shift = 8;
+    }
+}
+
+esp_err_t potentiometers_calibrate(int pot, pot_cal_point_t point)
+{
+    if (pot < 0 || pot >= pot_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (point == POT_CAL_CLEAR) {
+        memset(&cal_points[pot], 0, sizeof(cal_points[pot]));
+    } else {
+        if (filters[pot].outputs == 0) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        // Promedio diezmado sin calibrar, redondeado a 12 bits
+        uint16_t raw = (uint16_t)((filters[pot].raw_avg + (1 << (POT_FILTER_FRAC_BITS - 1))) >> POT_FILTER_FRAC_BITS);
+        if (raw > 4095) {
+            raw = 4095;
+        }
+        if (point == POT_CAL_MIN) {
+            cal_points[pot].min = raw;
+        } else if (point == POT_CAL_CENTRE) {
+            cal_points[pot].centre = raw;
+        } else {
+            cal_points[pot].max = raw;
+        }
+    }
+    // El shell puede marcar otro pot mientras la tarea toma la mascara, no se pierde ninguno
+    __atomic_fetch_or(&pending_calib_mask, 1u << pot, __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
+bool potentiometers_calibration_active(int pot)
+{
+    return pot >= 0 && pot < pot_count && pot_calib_points_valid(&cal_points[pot]);
+}
+
+esp_err_t potentiometers_save_calibration(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(POT_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_set_blob(handle, POT_NVS_CALIB, cal_points, sizeof(cal_points));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+size_t potentiometers_format(char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    uint32_t adc1_channels = 0;
+    for (int i = 0; i < pot_count; i++) {
+        adc1_channels += pot_wiring[i].source == POT_SRC_ADC1 ? 1 : 0;
+    }
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+    adc1_channels += mux_in_use() ? 1 : 0;
+#endif
+    uint32_t per_channel_hz = adc1_channels > 0 ? sample_hz / adc1_channels : 0;
+    uint32_t cycles_x10 = raw_samples > 0 ? (uint32_t)(filter_cycles * 10 / raw_samples) : 0;
+    int64_t now = esp_timer_get_time();
+
+    n = snprintf(out, size, "Placa %s. ADC1 continuo: %u Hz (%u Hz por canal)\n"
+                 "DMA: bloques %u, desbordes %u, ciclos por muestra %u.%u\n"
+                 "ADC2: lecturas %u, rechazadas por radio %u, otros errores %u\n",
+                 SENSOR_BOARD_NAME, sample_hz, per_channel_hz, dma_frames, dma_overflows, cycles_x10 / 10, cycles_x10 % 10,
+                 adc2_reads, adc2_radio_busy, adc2_errors);
+    len = n > 0 ? (size_t)n : 0;
+    if (len < size) {
+        n = snprintf(out + len, size - len, "Calibracion: ADC1 %s, ADC2 %s, tabla de %u puntos por pot (%u B)\n",
+                     cal_source_names[cal_source[0]], cal_source_names[cal_source[1]],
+                     POT_CALIB_LUT_SIZE, (uint32_t)sizeof(luts[0]));
+        len += n > 0 ? (size_t)n : 0;
+    }
+#ifdef SENSOR_BOARD_MUX_CHANNEL
+    if (len < size) {
+        n = snprintf(out + len, size - len, "Mux: entrada actual %u, bloques descartados al asentar %u\n",
+                     mux_input, mux_discarded);
+        len += n > 0 ? (size_t)n : 0;
+    }
+#endif
+    for (int i = 0; i < pot_count && len < size; i++) {
+        const pot_filter_t *f = &filters[i];
+        const pot_wiring_t *w = &pot_wiring[i];
+        n = snprintf(out + len, size - len, "  pot %d (%s %u): valor %u.%02u, salidas %u, cambios %u, ultima hace %u ms%s, caidas %u\n",
+                     i + 1, source_names[w->source], w->source == POT_SRC_MUX ? w->mux_input : w->channel,
+                     f->reported >> POT_FILTER_FRAC_BITS,
+                     (f->reported & ((1 << POT_FILTER_FRAC_BITS) - 1)) * 100 >> POT_FILTER_FRAC_BITS,
+                     f->outputs, f->changes, (uint32_t)((now - last_update_us[i]) / 1000),
+                     pot_stale[i] ? " CAIDO" : "", stale_events[i]);
+        len += n > 0 ? (size_t)n : 0;
+        const pot_calib_points_t *c = &cal_points[i];
+        if (len < size && (c->min != 0 || c->centre != 0 || c->max != 0)) {
+            n = snprintf(out + len, size - len, "         crudo %u, puntos min %u centro %u max %u%s\n",
+                         (uint32_t)(f->raw_avg >> POT_FILTER_FRAC_BITS), c->min, c->centre, c->max,
+                         pot_calib_points_valid(c) ? "" : " (incompleta, solo eFuse)");
+            len += n > 0 ? (size_t)n : 0;
+        }
+    }
+    return len < size ? len : size - 1;
+}
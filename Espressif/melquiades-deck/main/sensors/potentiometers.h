@@ -1,7 +1,116 @@
 #ifndef POTENTIOMETERS_H
 #define POTENTIOMETERS_H
 
-void init_potentiometers();
-void read_potentiometers();
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "pot_filter.h"
+#include "sensor_board.h"
+#include "sensor_registry.h"
 
-#endif // POTENTIOMETERS_H
\ No newline at end of file
+#define POT_MAX SENSOR_MAX_POTS
+
+// Punto de calibracion manual que se captura con la posicion actual del pot
+typedef enum {
+    POT_CAL_MIN = 0,
+    POT_CAL_CENTRE,
+    POT_CAL_MAX,
+    POT_CAL_CLEAR,      // Borra los puntos, queda solo la curva de eFuse
+} pot_cal_point_t;
+
+// Salud del muestreo de pots
+typedef struct {
+    uint32_t adc2_reads;        // Lecturas de ADC2 intentadas
+    uint32_t adc2_radio_busy;   // Rechazadas con ESP_ERR_TIMEOUT por la radio
+    uint32_t adc2_errors;       // Rechazadas por cualquier otro error
+    uint8_t stale;              // Pots sin salidas nuevas en los ultimos 200 ms
+    uint32_t stale_events;      // Caidas detectadas desde el arranque
+} pot_health_t;
+
+/**
+ * @brief Configura ADC2 y arranca el muestreo continuo por DMA de ADC1 para los pots dados
+ *
+ * @param wiring Origen de cada pot, en el orden de los slots del registro
+ * @param filters Filtro de cada pot
+ * @param count Cantidad de pots (maximo POT_MAX)
+ */
+void init_potentiometers(const pot_wiring_t *wiring, const pot_filter_config_t *filters, int count);
+
+/**
+ * @brief Vacia sin bloquear los bloques DMA disponibles y alimenta los filtros
+ */
+void potentiometers_drain(void);
+
+/**
+ * @brief Indica si el pot supero su banda muerta desde la ultima consulta y limpia la marca
+ *
+ * @param t_us Si no es NULL recibe el instante (esp_timer) del primer cambio sin consultar
+ */
+bool potentiometers_take_change(int pot, int64_t *t_us);
+
+/**
+ * @brief Ultimo valor reportado del pot en la escala de 12 bits del ADC
+ */
+uint16_t potentiometers_get_value(int pot);
+
+/**
+ * @brief Indica si el filtro del pot ya produjo su primera salida
+ */
+bool potentiometers_has_value(int pot);
+
+/**
+ * @brief Cantidad de pots configurados
+ */
+int potentiometers_count(void);
+
+/**
+ * @brief Salidas filtradas del pot 1 desde el arranque (tasa de actualizacion por canal)
+ */
+uint32_t potentiometers_get_sample_count(void);
+
+/**
+ * @brief Copia los contadores de errores de ADC2 y de pots caidos
+ */
+void potentiometers_get_health(pot_health_t *health);
+
+/**
+ * @brief Cambia la frecuencia total de muestreo del ADC1 (20 kHz a 2 MHz en ESP32)
+ */
+esp_err_t potentiometers_set_rate(uint32_t sample_hz);
+
+/**
+ * @brief Cambia diezmado, suavizado y banda muerta de un pot
+ *
+ * Solo desde la tarea que llama a potentiometers_drain(), que es la que usa el filtro.
+ */
+void potentiometers_set_filter(int pot, const pot_filter_config_t *cfg);
+
+/**
+ * @brief Captura un punto de calibracion con el promedio crudo actual del pot
+ *
+ * La tabla del pot se rearma en la siguiente pasada del planificador; min y max son obligatorios,
+ * el centro es opcional.
+ *
+ * @return esp_err_t ESP_ERR_INVALID_STATE si el pot aun no produjo lecturas
+ */
+esp_err_t potentiometers_calibrate(int pot, pot_cal_point_t point);
+
+/**
+ * @brief Indica si el pot tiene min y max manuales validos
+ */
+bool potentiometers_calibration_active(int pot);
+
+/**
+ * @brief Guarda los puntos de calibracion de todos los pots en NVS
+ */
+esp_err_t potentiometers_save_calibration(void);
+
+/**
+ * @brief Formatea configuracion, valores y costo por muestra del muestreo de pots
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t potentiometers_format(char *out, size_t size);
+
+#endif // POTENTIOMETERS_H
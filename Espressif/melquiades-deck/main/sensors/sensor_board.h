@@ -0,0 +1,81 @@
+#ifndef SENSOR_BOARD_H
+#define SENSOR_BOARD_H
+
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "driver/adc.h"
+
+// Cableado de potenciometros y botones segun la revision de la placa.
+// Se elige al compilar, por ejemplo con -DSENSOR_BOARD_LAYOUT=SENSOR_BOARD_SWAP
+#define SENSOR_BOARD_ADC2   0   // Original: pot 2 en GPIO26 (ADC2), falla mientras la radio esta activa
+#define SENSOR_BOARD_SWAP   1   // Pot 2 y boton 3 intercambian pines: pot 2 en GPIO32 (ADC1_CH4)
+#define SENSOR_BOARD_MUX    2   // Los 6 pots por un mux analogico 74HC4051 hacia GPIO36 (ADC1_CH0)
+
+#ifndef SENSOR_BOARD_LAYOUT
+#define SENSOR_BOARD_LAYOUT SENSOR_BOARD_ADC2
+#endif
+
+// Origen de la lectura de cada pot
+typedef enum {
+    POT_SRC_ADC1 = 0,   // Canal propio en ADC1, muestreado por DMA
+    POT_SRC_ADC2,       // ADC2 sin DMA, una lectura por bloque y sujeta a la radio
+    POT_SRC_MUX,        // Entrada del mux externo, comparte un canal de ADC1 por turnos
+} pot_source_t;
+
+typedef struct {
+    pot_source_t source;
+    uint8_t channel;    // Canal ADC1/ADC2, sin uso para POT_SRC_MUX
+    uint8_t mux_input;  // Entrada del mux (0-7) para POT_SRC_MUX
+} pot_wiring_t;
+
+#if SENSOR_BOARD_LAYOUT == SENSOR_BOARD_ADC2
+
+#define SENSOR_BOARD_NAME       "adc2"
+#define SENSOR_BOARD_BTN3       GPIO_NUM_32 // ADC04
+#define SENSOR_BOARD_DMA_FRAME  1024        // 512 conversiones repartidas entre 5 canales
+#define SENSOR_BOARD_POTS { \
+    {POT_SRC_ADC1, ADC1_CHANNEL_0, 0},  /* GPIO36 */ \
+    {POT_SRC_ADC2, ADC2_CHANNEL_9, 0},  /* GPIO26 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_3, 0},  /* GPIO39 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_7, 0},  /* GPIO35 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_5, 0},  /* GPIO33 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_6, 0},  /* GPIO34 */ \
+}
+
+#elif SENSOR_BOARD_LAYOUT == SENSOR_BOARD_SWAP
+
+// GPIO26 sigue sirviendo como entrada digital con la radio activa, solo su ADC queda bloqueado
+#define SENSOR_BOARD_NAME       "swap"
+#define SENSOR_BOARD_BTN3       GPIO_NUM_26
+#define SENSOR_BOARD_DMA_FRAME  1024        // 512 conversiones repartidas entre 6 canales
+#define SENSOR_BOARD_POTS { \
+    {POT_SRC_ADC1, ADC1_CHANNEL_0, 0},  /* GPIO36 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_4, 0},  /* GPIO32 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_3, 0},  /* GPIO39 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_7, 0},  /* GPIO35 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_5, 0},  /* GPIO33 */ \
+    {POT_SRC_ADC1, ADC1_CHANNEL_6, 0},  /* GPIO34 */ \
+}
+
+#elif SENSOR_BOARD_LAYOUT == SENSOR_BOARD_MUX
+
+// Selectores S0-S2 en pines libres; bloques DMA cortos para rotar rapido entre entradas
+#define SENSOR_BOARD_NAME       "mux"
+#define SENSOR_BOARD_BTN3       GPIO_NUM_32 // ADC04
+#define SENSOR_BOARD_DMA_FRAME  128         // 64 conversiones (3.2 ms a 20 kHz) por entrada
+#define SENSOR_BOARD_MUX_CHANNEL ADC1_CHANNEL_0 // GPIO36, salida comun del mux
+#define SENSOR_BOARD_MUX_SEL    {GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_21}
+#define SENSOR_BOARD_POTS { \
+    {POT_SRC_MUX, 0, 0}, \
+    {POT_SRC_MUX, 0, 1}, \
+    {POT_SRC_MUX, 0, 2}, \
+    {POT_SRC_MUX, 0, 3}, \
+    {POT_SRC_MUX, 0, 4}, \
+    {POT_SRC_MUX, 0, 5}, \
+}
+
+#else
+#error "SENSOR_BOARD_LAYOUT desconocido"
+#endif
+
+#endif // SENSOR_BOARD_H
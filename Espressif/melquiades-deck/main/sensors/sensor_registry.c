@@ -0,0 +1,143 @@
+#include "sensor_registry.h"
+// Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+
+static const char *type_names[] = {"vacio", "pot", "boton"};
+static const char *source_names[] = {"adc1", "adc2", "mux"};
+
+static bool period_valid(uint16_t ms)
+{
+    return ms >= SENSOR_PERIOD_MIN_MS && ms <= SENSOR_PERIOD_MAX_MS;
+}
+
+bool sensor_registry_validate(const sensor_registry_t *reg)
+{
+    if (reg->version != SENSOR_REGISTRY_VERSION) {
+        return false;
+    }
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        const sensor_slot_config_t *s = &reg->slots[i];
+        switch (s->type) {
+        case SENSOR_TYPE_NONE:
+            break;
+        case SENSOR_TYPE_POT:
+            if (s->source > 2 || s->decimation == 0 || s->smooth_shift > 8 ||
+                !period_valid(s->active_ms) || !period_valid(s->idle_ms) ||
+                s->min_interval_ms > SENSOR_PERIOD_MAX_MS ||
+                (s->heartbeat_ms != 0 && s->heartbeat_ms < s->min_interval_ms)) {
+                return false;
+            }
+            break;
+        case SENSOR_TYPE_BUTTON:
+            // Los botones llegan por interrupcion, el GPIO es lo unico obligatorio
+            if (s->channel > 39) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return sensor_registry_count(reg, SENSOR_TYPE_POT) <= SENSOR_MAX_POTS &&
+           sensor_registry_count(reg, SENSOR_TYPE_BUTTON) <= SENSOR_MAX_BUTTONS;
+}
+
+int sensor_registry_count(const sensor_registry_t *reg, sensor_type_t type)
+{
+    int count = 0;
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        count += reg->slots[i].type == type ? 1 : 0;
+    }
+    return count;
+}
+
+void sensor_registry_init_state(const sensor_registry_t *reg, sensor_slot_state_t *state, uint32_t now_ms)
+{
+    uint8_t pots = 0;
+    uint8_t buttons = 0;
+    memset(state, 0, sizeof(sensor_slot_state_t) * SENSOR_SLOT_COUNT);
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        state[i].next_due_ms = now_ms;
+        state[i].last_change_ms = now_ms;
+        if (reg->slots[i].type == SENSOR_TYPE_POT) {
+            state[i].index = pots++;
+        } else if (reg->slots[i].type == SENSOR_TYPE_BUTTON) {
+            state[i].index = buttons++;
+        }
+    }
+}
+
+void sensor_slot_schedule(const sensor_registry_t *reg, int slot, sensor_slot_state_t *st,
+                          bool changed, uint32_t now_ms)
+{
+    const sensor_slot_config_t *cfg = &reg->slots[slot];
+    st->evaluations++;
+    if (changed) {
+        st->changes++;
+        st->last_change_ms = now_ms;
+        st->active = true;
+    } else if (st->active && now_ms - st->last_change_ms >= reg->idle_after_ms) {
+        st->active = false;
+    }
+    st->next_due_ms = now_ms + (st->active ? cfg->active_ms : cfg->idle_ms);
+}
+
+uint32_t sensor_registry_next_wait(const sensor_registry_t *reg, const sensor_slot_state_t *state,
+                                   uint32_t now_ms, uint32_t max_ms)
+{
+    uint32_t wait = max_ms;
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        // Solo los pots son periodicos, los botones despiertan al planificador por su cola
+        if (reg->slots[i].type != SENSOR_TYPE_POT) {
+            continue;
+        }
+        int32_t left = (int32_t)(state[i].next_due_ms - now_ms);
+        if (left <= 0) {
+            return 0;
+        }
+        if ((uint32_t)left < wait) {
+            wait = (uint32_t)left;
+        }
+    }
+    return wait;
+}
+
+const char *sensor_type_name(uint8_t type)
+{
+    return type <= SENSOR_TYPE_BUTTON ? type_names[type] : "?";
+}
+
+size_t sensor_registry_format(const sensor_registry_t *reg, const sensor_slot_state_t *state,
+                              char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    if (out == NULL || size == 0) {
+        return 0;
+    }
+    n = snprintf(out, size, "Slots: %d pots, %d botones, reposo tras %u ms sin cambios\n",
+                 sensor_registry_count(reg, SENSOR_TYPE_POT), sensor_registry_count(reg, SENSOR_TYPE_BUTTON),
+                 reg->idle_after_ms);
+    len = n > 0 ? (size_t)n : 0;
+    for (int i = 0; i < SENSOR_SLOT_COUNT && len < size; i++) {
+        const sensor_slot_config_t *s = &reg->slots[i];
+        const sensor_slot_state_t *st = &state[i];
+        if (s->type == SENSOR_TYPE_POT) {
+            n = snprintf(out + len, size - len,
+                         "  %2d pot %u: %s %u, diezmado %u, suavizado 1/%u, banda %u LSB, periodo %u/%u ms, "
+                         "reporte min %u ms latido %u ms, %s, evaluado %u, cambios %u\n",
+                         i + 1, st->index + 1, s->source <= 2 ? source_names[s->source] : "?", s->channel,
+                         s->decimation, 1u << s->smooth_shift, s->deadband >> POT_FILTER_FRAC_BITS, s->active_ms, s->idle_ms,
+                         s->min_interval_ms, s->heartbeat_ms,
+                         st->active ? "activo" : "reposo", st->evaluations, st->changes);
+        } else if (s->type == SENSOR_TYPE_BUTTON) {
+            n = snprintf(out + len, size - len, "  %2d boton %u: GPIO%u, por interrupcion, eventos %u\n",
+                         i + 1, st->index + 1, s->channel, st->changes);
+        } else {
+            n = snprintf(out + len, size - len, "  %2d vacio\n", i + 1);
+        }
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,105 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "pot_filter.h"
+
+// Tabla de los 12 slots de sensores y su planificacion, en C puro para probarla en host.
+// La tabla se guarda tal cual como blob en NVS, por eso lleva version y tamanos fijos.
+
+#define SENSOR_SLOT_COUNT       12
+#define SENSOR_REGISTRY_VERSION 2
+#define SENSOR_MAX_POTS         8   // Canales de ADC1 o entradas de un mux 74HC4051
+#define SENSOR_MAX_BUTTONS      8   // Limite del reconocedor de gestos
+#define SENSOR_PERIOD_MIN_MS    1   // 1 kHz
+#define SENSOR_PERIOD_MAX_MS    60000
+
+typedef enum {
+    SENSOR_TYPE_NONE = 0,
+    SENSOR_TYPE_POT,
+    SENSOR_TYPE_BUTTON,
+} sensor_type_t;
+
+// Configuracion de un slot
+typedef struct {
+    uint8_t type;           // sensor_type_t
+    uint8_t source;         // Pots: pot_source_t (adc1, adc2, mux)
+    uint8_t channel;        // Pots: canal ADC o entrada del mux; botones: GPIO
+    uint8_t smooth_shift;   // Pots: suavizado 1/2^n
+    uint16_t decimation;    // Pots: muestras crudas por salida
+    uint16_t deadband;      // Pots: cambio minimo a reportar (Q4)
+    uint16_t active_ms;     // Periodo de evaluacion mientras el slot se mueve
+    uint16_t idle_ms;       // Periodo de evaluacion en reposo
+    uint16_t min_interval_ms;   // Separacion minima entre reportes del slot
+    uint16_t heartbeat_ms;      // Silencio maximo antes de repetir el valor, 0 sin latido
+} sensor_slot_config_t;
+
+typedef struct {
+    uint16_t version;
+    uint16_t idle_after_ms; // Sin cambios este tiempo el slot pasa a reposo
+    sensor_slot_config_t slots[SENSOR_SLOT_COUNT];
+} sensor_registry_t;
+
+// Estado de planificacion de un slot
+typedef struct {
+    uint32_t next_due_ms;
+    uint32_t last_change_ms;
+    bool active;
+    uint8_t index;          // Posicion del slot dentro de su tipo (pot n, boton n)
+    uint32_t evaluations;   // Veces que el planificador lo atendio
+    uint32_t changes;
+} sensor_slot_state_t;
+
+/**
+ * @brief Valida tipos, limites por tipo y periodos de la tabla
+ *
+ * @return true si la tabla se puede aplicar
+ */
+bool sensor_registry_validate(const sensor_registry_t *reg);
+
+/**
+ * @brief Cuenta los slots de un tipo
+ */
+int sensor_registry_count(const sensor_registry_t *reg, sensor_type_t type);
+
+/**
+ * @brief Reinicia el estado de planificacion y asigna el indice de cada slot dentro de su tipo
+ */
+void sensor_registry_init_state(const sensor_registry_t *reg, sensor_slot_state_t *state, uint32_t now_ms);
+
+/**
+ * @brief Indica si un slot debe atenderse en este instante
+ */
+static inline bool sensor_slot_due(const sensor_slot_state_t *st, uint32_t now_ms)
+{
+    return (int32_t)(now_ms - st->next_due_ms) >= 0;
+}
+
+/**
+ * @brief Registra la evaluacion de un slot y agenda la siguiente segun su actividad
+ */
+void sensor_slot_schedule(const sensor_registry_t *reg, int slot, sensor_slot_state_t *st,
+                          bool changed, uint32_t now_ms);
+
+/**
+ * @brief Milisegundos hasta el siguiente slot periodico, como maximo max_ms
+ */
+uint32_t sensor_registry_next_wait(const sensor_registry_t *reg, const sensor_slot_state_t *state,
+                                   uint32_t now_ms, uint32_t max_ms);
+
+/**
+ * @brief Nombre corto del tipo de sensor
+ */
+const char *sensor_type_name(uint8_t type);
+
+/**
+ * @brief Formatea la tabla y el estado de cada slot en texto
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t sensor_registry_format(const sensor_registry_t *reg, const sensor_slot_state_t *state,
+                              char *out, size_t size);
+
+#endif // SENSOR_REGISTRY_H
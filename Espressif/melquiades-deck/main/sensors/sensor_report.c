@@ -0,0 +1,131 @@
+#include "sensor_report.h"
+// Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+
+static const char *mode_names[SENSOR_REPORT_MODE_COUNT] = {"reposo", "activo"};
+
+void sensor_report_init(sensor_report_t *r, uint32_t now_ms)
+{
+    memset(r, 0, sizeof(*r));
+    r->last_account_ms = now_ms;
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        r->slots[i].last_report_ms = now_ms;
+    }
+}
+
+void sensor_report_change(sensor_report_t *r, int slot, uint16_t value, int64_t t_us)
+{
+    if (slot < 0 || slot >= SENSOR_SLOT_COUNT) {
+        return;
+    }
+    if (!r->slots[slot].has_pending) {
+        r->slots[slot].pending_us = t_us;
+    }
+    r->slots[slot].pending = value;
+    r->slots[slot].has_pending = true;
+}
+
+size_t sensor_report_build(sensor_report_t *r, const sensor_registry_t *reg, const uint16_t *values,
+                           sensor_report_mode_t mode, uint32_t now_ms, char *out, size_t size)
+{
+    sensor_report_mode_stats_t *st = &r->modes[mode];
+    size_t len = 0;
+    int n;
+    uint32_t entries = 0;
+    int64_t stamp_us = (int64_t)now_ms * 1000;
+    // Los slots se cortan antes para que siempre quepa el instante al final
+    size_t room = size > SENSOR_REPORT_STAMP_BYTES ? size - SENSOR_REPORT_STAMP_BYTES : 0;
+
+    n = snprintf(out, size, "Sensores:");
+    len = n > 0 ? (size_t)n : 0;
+    for (int i = 0; i < SENSOR_SLOT_COUNT && len < room; i++) {
+        const sensor_slot_config_t *cfg = &reg->slots[i];
+        sensor_report_slot_t *s = &r->slots[i];
+        if (cfg->type != SENSOR_TYPE_POT) {
+            continue;
+        }
+        uint32_t silence = now_ms - s->last_report_ms;
+        bool was_pending = s->has_pending;
+        uint16_t value;
+        if (was_pending) {
+            if (silence < cfg->min_interval_ms) {
+                // Se conserva el cambio, sale en cuanto se cumpla el intervalo
+                st->deferred++;
+                continue;
+            }
+            value = s->pending;
+        } else if (cfg->heartbeat_ms != 0 && silence >= cfg->heartbeat_ms) {
+            value = values[i];
+            st->heartbeats++;
+        } else {
+            continue;
+        }
+        n = snprintf(out + len, room - len, " %d=%u", i + 1, value);
+        if (n < 0 || (size_t)n >= room - len) {
+            // Sin espacio: el slot queda pendiente para la siguiente linea
+            if (!was_pending) {
+                s->pending_us = stamp_us;
+            }
+            s->pending = value;
+            s->has_pending = true;
+            break;
+        }
+        len += (size_t)n;
+        if (was_pending && s->pending_us < stamp_us) {
+            stamp_us = s->pending_us;
+        }
+        s->has_pending = false;
+        s->value = value;
+        s->last_report_ms = now_ms;
+        entries++;
+    }
+    if (entries == 0) {
+        return 0;
+    }
+    n = snprintf(out + len, size - len, " t=%u.%03u ms\r\n",
+                 (uint32_t)(stamp_us / 1000), (uint32_t)(stamp_us % 1000));
+    len += n > 0 ? (size_t)n : 0;
+    st->entries += entries;
+    sensor_report_count(r, mode, len);
+    return len;
+}
+
+void sensor_report_count(sensor_report_t *r, sensor_report_mode_t mode, size_t bytes)
+{
+    r->modes[mode].frames++;
+    r->modes[mode].bytes += (uint32_t)bytes;
+}
+
+void sensor_report_account(sensor_report_t *r, sensor_report_mode_t mode, uint32_t now_ms)
+{
+    r->modes[mode].time_ms += now_ms - r->last_account_ms;
+    r->last_account_ms = now_ms;
+}
+
+size_t sensor_report_format(const sensor_report_t *r, uint32_t legacy_line_bytes, char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    uint32_t legacy_bps = SENSOR_REPORT_LEGACY_FPS * legacy_line_bytes;
+    if (out == NULL || size == 0) {
+        return 0;
+    }
+    n = snprintf(out, size, "Reporte por cambios (esquema anterior: %u tramas/s, %u B/s):\n",
+                 SENSOR_REPORT_LEGACY_FPS, legacy_bps);
+    len = n > 0 ? (size_t)n : 0;
+    for (int i = 0; i < SENSOR_REPORT_MODE_COUNT && len < size; i++) {
+        const sensor_report_mode_stats_t *st = &r->modes[i];
+        // Tasas en centesimas para no usar punto flotante
+        uint32_t secs_x100 = st->time_ms / 10;
+        uint32_t fps_x100 = secs_x100 > 0 ? (uint32_t)((uint64_t)st->frames * 10000 / secs_x100) : 0;
+        uint32_t bps = secs_x100 > 0 ? (uint32_t)((uint64_t)st->bytes * 100 / secs_x100) : 0;
+        uint32_t saved = legacy_bps > 0 && bps < legacy_bps ? (legacy_bps - bps) * 100 / legacy_bps : 0;
+        n = snprintf(out + len, size - len,
+                     "  %-6s: %u.%02u s, %u.%02u tramas/s, %u B/s (-%u%%), slots %u, latidos %u, retenidos %u\n",
+                     mode_names[i], secs_x100 / 100, secs_x100 % 100, fps_x100 / 100, fps_x100 % 100, bps, saved,
+                     st->entries, st->heartbeats, st->deferred);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
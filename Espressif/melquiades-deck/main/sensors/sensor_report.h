@@ -0,0 +1,92 @@
+#ifndef SENSOR_REPORT_H
+#define SENSOR_REPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sensor_registry.h"
+
+// Reporte por cambios de los slots de sensores, en C puro para probarlo en host.
+// Cada linea lleva solo los slots que cambiaron (o cuyo latido vencio) y el instante del cambio
+// mas antiguo que incluye, con el mismo formato que los eventos de botones: "Sensores: 1=2048 3=1022 t=1234.567 ms"
+
+#define SENSOR_REPORT_LEGACY_FPS 2  // El esquema anterior mandaba la linea completa cada 500 ms
+#define SENSOR_REPORT_STAMP_BYTES 24 // " t=4294967295.999 ms\r\n" y el terminador
+
+typedef enum {
+    SENSOR_REPORT_IDLE = 0,     // Ningun slot en movimiento
+    SENSOR_REPORT_ACTIVE,       // Algun slot en movimiento
+    SENSOR_REPORT_MODE_COUNT
+} sensor_report_mode_t;
+
+// Estado de reporte de un slot
+typedef struct {
+    uint16_t value;             // Ultimo valor reportado
+    uint16_t pending;           // Valor nuevo esperando su intervalo minimo
+    bool has_pending;
+    int64_t pending_us;         // Instante del primer cambio pendiente
+    uint32_t last_report_ms;
+} sensor_report_slot_t;
+
+// Trafico acumulado en cada modo
+typedef struct {
+    uint32_t time_ms;
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t entries;           // Slots incluidos en las lineas
+    uint32_t heartbeats;        // Slots incluidos solo por latido
+    uint32_t deferred;          // Evaluaciones en que un cambio espero su intervalo minimo
+} sensor_report_mode_stats_t;
+
+typedef struct {
+    sensor_report_slot_t slots[SENSOR_SLOT_COUNT];
+    sensor_report_mode_stats_t modes[SENSOR_REPORT_MODE_COUNT];
+    uint32_t last_account_ms;
+} sensor_report_t;
+
+/**
+ * @brief Reinicia estados y contadores
+ */
+void sensor_report_init(sensor_report_t *r, uint32_t now_ms);
+
+/**
+ * @brief Registra un valor que supero la banda muerta del slot
+ *
+ * @param t_us Instante en que se detecto el cambio; si ya habia uno pendiente se conserva el anterior
+ */
+void sensor_report_change(sensor_report_t *r, int slot, uint16_t value, int64_t t_us);
+
+/**
+ * @brief Arma la linea con los slots que toca reportar
+ *
+ * Un cambio sale si paso el intervalo minimo del slot desde su ultimo reporte;
+ * un slot sin reportes durante su latido sale con su valor actual.
+ *
+ * @param values Valor actual de cada slot (para los latidos)
+ * @param mode Modo al que se atribuyen los contadores
+ * @return size_t Bytes de la linea, 0 si no hay nada que reportar
+ */
+size_t sensor_report_build(sensor_report_t *r, const sensor_registry_t *reg, const uint16_t *values,
+                           sensor_report_mode_t mode, uint32_t now_ms, char *out, size_t size);
+
+// Una linea solo de latidos lleva el instante en que se armo (now_ms)
+
+/**
+ * @brief Suma una linea ya enviada (por ejemplo un evento de boton) a los contadores del modo
+ */
+void sensor_report_count(sensor_report_t *r, sensor_report_mode_t mode, size_t bytes);
+
+/**
+ * @brief Acumula el tiempo transcurrido en el modo actual
+ */
+void sensor_report_account(sensor_report_t *r, sensor_report_mode_t mode, uint32_t now_ms);
+
+/**
+ * @brief Formatea tramas/s y bytes/s por modo frente al esquema anterior
+ *
+ * @param legacy_line_bytes Largo de la linea completa que mandaba el esquema anterior
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t sensor_report_format(const sensor_report_t *r, uint32_t legacy_line_bytes, char *out, size_t size);
+
+#endif // SENSOR_REPORT_H
@@ -0,0 +1,680 @@
+#include "sensor_scheduler.h"
+//bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "nvs.h"
+//bibliotecas custom
+#include "buttons.h"
+#include "keymap.h"
+#include "knob_binding.h"
+#include "potentiometers.h"
+#include "sensor_board.h"
+#include "sensor_report.h"
+#include "../bluetooth/a2dp_sink.h"
+#include "../bluetooth/spp_session.h"
+#include "../shell/bin_protocol.h"
+#include "../system/task_table.h"
+#include "../system/event_bus.h"
+
+#define TAG "SENSOR_SCHEDULER"
+
+#define SENSOR_NVS_NAMESPACE    "sensors"
+#define SENSOR_NVS_REGISTRY     "registry"
+#define SENSOR_NVS_BINDINGS     "bindings"
+#define SENSOR_NVS_KEYMAP       "keymap"
+// El driver ADC guarda ~100 ms de conversiones, se vacia al menos cada 20 ms aunque todo este en reposo
+#define SENSOR_DRAIN_MS         20
+// En el modo de reposo de energia se despierta lo justo para que el driver no se llene
+#define SENSOR_LOW_POWER_DRAIN_MS 80
+#define SENSOR_IDLE_AFTER_MS    1000
+
+// Filtro y periodos por defecto de los pots: 50 Hz moviendose, 5 Hz en reposo,
+// como mucho 20 reportes por segundo por slot y un latido cada 5 s sin cambios
+#define POT_DEFAULT_DECIMATION  64
+#define POT_DEFAULT_SHIFT       2
+#define POT_DEFAULT_DEADBAND    (3 << POT_FILTER_FRAC_BITS)
+#define POT_DEFAULT_ACTIVE_MS   20
+#define POT_DEFAULT_IDLE_MS     200
+#define POT_DEFAULT_MIN_REPORT_MS 50
+#define POT_DEFAULT_HEARTBEAT_MS  5000
+
+static sensor_registry_t registry;
+static sensor_slot_state_t slot_state[SENSOR_SLOT_COUNT];
+static int8_t button_to_slot[BTN_MAX];
+static sensor_report_t report;
+static uint32_t wakeups = 0;
+
+// Cambios de slots desde el shell: se arma la tabla nueva completa y la tarea la toma entre pasadas
+static sensor_registry_t pending_registry;
+static uint32_t pending_resched_mask = 0;
+static uint32_t pending_filter_mask = 0;
+static volatile bool pending_registry_ready = false;
+
+// Asociaciones pot -> DSP; el shell deja el cambio pendiente y la tarea lo aplica entre evaluaciones
+static knob_binding_table_t bindings;
+static knob_binding_state_t binding_state[SENSOR_SLOT_COUNT];
+static knob_binding_t pending_binding;
+static volatile int pending_binding_slot = 0;
+
+// Tabla de atajos; el shell arma la nueva completa y la tarea la reemplaza entre eventos
+static keymap_t keymap;
+static keymap_t pending_keymap;
+static volatile bool pending_keymap_ready = false;
+static volatile bool keys_enabled = true;
+static volatile bool uart_stream = false;
+static volatile bool low_power = false;
+static uint8_t key_seq = 0;
+static uint32_t key_events = 0;
+static uint32_t key_reports = 0;
+static uint32_t key_bytes = 0;
+static uint32_t key_cycles_max = 0;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Tabla de la placa: pots de sensor_board.h en los slots 1-6 y botones en los 7-12
+static void registry_defaults(sensor_registry_t *reg)
+{
+    static const pot_wiring_t board_pots[] = SENSOR_BOARD_POTS;
+    static const gpio_num_t board_buttons[BTN_DEFAULT_COUNT] = {BTN1, BTN2, BTN3, BTN4, BTN5, BTN6};
+    int slot = 0;
+
+    memset(reg, 0, sizeof(*reg));
+    reg->version = SENSOR_REGISTRY_VERSION;
+    reg->idle_after_ms = SENSOR_IDLE_AFTER_MS;
+    for (int i = 0; i < sizeof(board_pots) / sizeof(board_pots[0]) && slot < SENSOR_SLOT_COUNT; i++, slot++) {
+        sensor_slot_config_t *s = &reg->slots[slot];
+        s->type = SENSOR_TYPE_POT;
+        s->source = board_pots[i].source;
+        s->channel = board_pots[i].source == POT_SRC_MUX ? board_pots[i].mux_input : board_pots[i].channel;
+        s->decimation = POT_DEFAULT_DECIMATION;
+        s->smooth_shift = POT_DEFAULT_SHIFT;
+        s->deadband = POT_DEFAULT_DEADBAND;
+        s->active_ms = POT_DEFAULT_ACTIVE_MS;
+        s->idle_ms = POT_DEFAULT_IDLE_MS;
+        s->min_interval_ms = POT_DEFAULT_MIN_REPORT_MS;
+        s->heartbeat_ms = POT_DEFAULT_HEARTBEAT_MS;
+    }
+    for (int i = 0; i < BTN_DEFAULT_COUNT && slot < SENSOR_SLOT_COUNT; i++, slot++) {
+        reg->slots[slot].type = SENSOR_TYPE_BUTTON;
+        reg->slots[slot].channel = (uint8_t)board_buttons[i];
+    }
+}
+
+// La tabla guardada solo se usa si tiene el tamano y la version esperados y pasa la validacion
+static bool registry_load(sensor_registry_t *reg)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(*reg);
+    if (nvs_open(SENSOR_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(handle, SENSOR_NVS_REGISTRY, reg, &len);
+    nvs_close(handle);
+    if (ret != ESP_OK || len != sizeof(*reg) || !sensor_registry_validate(reg)) {
+        if (ret == ESP_OK) {
+            ESP_LOGW(TAG, "Tabla de sensores en NVS invalida, se usa la de la placa");
+        }
+        return false;
+    }
+    return true;
+}
+
+// Las asociaciones guardadas solo se usan si coinciden con la tabla de slots vigente
+static bool bindings_load(knob_binding_table_t *table)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(*table);
+    if (nvs_open(SENSOR_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(handle, SENSOR_NVS_BINDINGS, table, &len);
+    nvs_close(handle);
+    if (ret != ESP_OK || len != sizeof(*table) || !knob_binding_validate(table, &registry)) {
+        if (ret == ESP_OK) {
+            ESP_LOGW(TAG, "Asociaciones pot -> DSP en NVS invalidas, se descartan");
+        }
+        return false;
+    }
+    return true;
+}
+
+static bool bindings_any(void)
+{
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        if (bindings.slots[i].target != KNOB_TARGET_NONE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Entrega el valor directamente a los setters del DSP, el bloque de audio siguiente ya lo usa
+static void apply_binding(uint8_t target, float value)
+{
+    switch (target) {
+    case KNOB_TARGET_VOLUME:
+        set_volume((uint8_t)(value + 0.5f));
+        break;
+    case KNOB_TARGET_BALANCE:
+        set_balance(value);
+        break;
+    case KNOB_TARGET_BASS:
+    case KNOB_TARGET_MID:
+    case KNOB_TARGET_TREBLE:
+        set_eq_band(target - KNOB_TARGET_BASS, value);
+        break;
+    case KNOB_TARGET_LIMITER:
+        set_limiter(value);
+        break;
+    default:
+        break;
+    }
+}
+
+static void take_pending_binding(void)
+{
+    int slot = pending_binding_slot;
+    if (slot == 0) {
+        return;
+    }
+    bindings.slots[slot - 1] = pending_binding;
+    knob_binding_reset_state(&binding_state[slot - 1]);
+    pending_binding_slot = 0;
+}
+
+// Lee todos los pots asociados en cada pasada, sin esperar al periodo de su slot
+static void update_bindings(void)
+{
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        const knob_binding_t *b = &bindings.slots[i];
+        // Sin salida del filtro la lectura es 0 y no la posicion del pot
+        if (b->target == KNOB_TARGET_NONE || !potentiometers_has_value(slot_state[i].index)) {
+            continue;
+        }
+        knob_binding_update(b, &binding_state[i], potentiometers_get_value(slot_state[i].index));
+        if (knob_binding_step(b, &binding_state[i])) {
+            apply_binding(b->target, binding_state[i].applied);
+        }
+    }
+}
+
+static bool keymap_load(keymap_t *map)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(*map);
+    if (nvs_open(SENSOR_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(handle, SENSOR_NVS_KEYMAP, map, &len);
+    nvs_close(handle);
+    if (ret != ESP_OK || len != sizeof(*map) || !keymap_validate(map)) {
+        if (ret == ESP_OK) {
+            ESP_LOGW(TAG, "Tabla de atajos en NVS invalida, se usa la de fabrica");
+        }
+        return false;
+    }
+    return true;
+}
+
+static void take_pending_keymap(void)
+{
+    if (pending_keymap_ready) {
+        keymap = pending_keymap;
+        pending_keymap_ready = false;
+    }
+}
+
+// Todos los reportes de un evento salen en una sola trama binaria hacia los suscriptores de keys
+static void emit_keys(const btn_gesture_t *ev)
+{
+    keymap_report_t reports[KEYMAP_MAX_REPORTS];
+    uint8_t payload[KEYMAP_MAX_REPORTS * KEYMAP_REPORT_BYTES];
+    uint8_t frame[sizeof(payload) + BIN_OVERHEAD];
+    if (!keys_enabled || !spp_topic_has_subscribers(SPP_TOPIC_KEYS)) {
+        return;
+    }
+    uint32_t start = esp_cpu_get_ccount();
+    int n = keymap_process(&keymap, ev, reports);
+    for (int i = 0; i < n; i++) {
+        keymap_report_encode(&reports[i], key_seq++, &payload[i * KEYMAP_REPORT_BYTES]);
+    }
+    uint32_t cycles = esp_cpu_get_ccount() - start;
+    if (cycles > key_cycles_max) {
+        key_cycles_max = cycles;
+    }
+    key_events++;
+    if (n == 0) {
+        return;
+    }
+    size_t len = bin_frame_encode(BIN_FRAME_KEYS, payload, (uint16_t)(n * KEYMAP_REPORT_BYTES), frame, sizeof(frame));
+    if (len > 0) {
+        spp_publish(SPP_TOPIC_KEYS, frame, len);
+        key_reports += n;
+        key_bytes += len;
+    }
+}
+
+static pot_filter_config_t slot_filter(const sensor_slot_config_t *s)
+{
+    pot_filter_config_t cfg = {
+        .decimation = s->decimation,
+        .smooth_shift = s->smooth_shift,
+        .deadband = s->deadband
+    };
+    return cfg;
+}
+
+// Los filtros se cambian aqui porque esta misma tarea es la que vacia el ADC y los usa
+static void take_pending_registry(void)
+{
+    if (!pending_registry_ready) {
+        return;
+    }
+    uint32_t now = now_ms();
+    registry = pending_registry;
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        if (pending_resched_mask & (1u << i)) {
+            slot_state[i].next_due_ms = now;
+        }
+        if (pending_filter_mask & (1u << i)) {
+            pot_filter_config_t applied = slot_filter(&registry.slots[i]);
+            potentiometers_set_filter(slot_state[i].index, &applied);
+        }
+    }
+    pending_resched_mask = 0;
+    pending_filter_mask = 0;
+    pending_registry_ready = false;
+}
+
+// Arma las listas de pots y botones en el orden de los slots y arranca el hardware
+static void apply_registry(void)
+{
+    pot_wiring_t wiring[POT_MAX];
+    pot_filter_config_t filters[POT_MAX];
+    gpio_num_t pins[BTN_MAX];
+    int pots = 0;
+    int buttons = 0;
+
+    memset(button_to_slot, -1, sizeof(button_to_slot));
+    sensor_registry_init_state(&registry, slot_state, now_ms());
+    sensor_report_init(&report, now_ms());
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        const sensor_slot_config_t *s = &registry.slots[i];
+        if (s->type == SENSOR_TYPE_POT) {
+            wiring[pots].source = (pot_source_t)s->source;
+            wiring[pots].channel = s->source == POT_SRC_MUX ? 0 : s->channel;
+            wiring[pots].mux_input = s->source == POT_SRC_MUX ? s->channel : 0;
+            filters[pots] = slot_filter(s);
+            pots++;
+        } else if (s->type == SENSOR_TYPE_BUTTON) {
+            pins[buttons] = (gpio_num_t)s->channel;
+            button_to_slot[buttons] = (int8_t)i;
+            buttons++;
+        }
+    }
+    init_potentiometers(wiring, filters, pots);
+    init_pulsadores(pins, buttons);
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        knob_binding_reset_state(&binding_state[i]);
+    }
+}
+
+static void publish_line(const char *line, size_t len)
+{
+    //Validamos el shell activo
+    if (uart_stream) {
+        printf("%s", line);
+        fflush(stdout);
+    }
+    // Se formatea una vez y se reparte a todas las sesiones suscritas
+    if (spp_topic_has_subscribers(SPP_TOPIC_SENSORS)) {
+        spp_publish(SPP_TOPIC_SENSORS, line, len);
+    }
+}
+
+static sensor_report_mode_t current_mode(void)
+{
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        if (registry.slots[i].type == SENSOR_TYPE_POT && slot_state[i].active) {
+            return SENSOR_REPORT_ACTIVE;
+        }
+    }
+    return SENSOR_REPORT_IDLE;
+}
+
+static void report_button(const btn_gesture_t *ev)
+{
+    char response[100];
+    if (ev->button >= 1 && ev->button <= BTN_MAX && button_to_slot[ev->button - 1] >= 0) {
+        int slot = button_to_slot[ev->button - 1];
+        slot_state[slot].changes++;
+        slot_state[slot].last_change_ms = now_ms();
+    }
+    uint32_t gesture[3] = {ev->button, ev->type, ev->action};
+    event_bus_publish(BUS_TOPIC_SENSOR, BUS_SENSOR_GESTURE, gesture, NULL);
+    emit_keys(ev);
+    size_t len = pulsadores_format_event(ev, response, sizeof(response));
+    sensor_report_count(&report, current_mode(), len);
+    publish_line(response, len);
+}
+
+// Solo los slots que cambiaron o cuyo latido vencio
+static void report_pots(uint32_t now)
+{
+    char response[128];
+    uint16_t values[SENSOR_SLOT_COUNT] = {0};
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        if (registry.slots[i].type == SENSOR_TYPE_POT) {
+            values[i] = potentiometers_get_value(slot_state[i].index);
+        }
+    }
+    size_t len = sensor_report_build(&report, &registry, values, current_mode(), now, response, sizeof(response));
+    if (len > 0) {
+        publish_line(response, len);
+    }
+}
+
+// Largo de la linea completa "Potenciómetros: a, b, ..." que se mandaba cada 500 ms
+static uint32_t legacy_line_bytes(void)
+{
+    char line[100];
+    int len = snprintf(line, sizeof(line), "Potenciómetros:");
+    for (int i = 0; i < potentiometers_count() && len > 0 && len < (int)sizeof(line); i++) {
+        len += snprintf(line + len, sizeof(line) - len, "%s %u", i == 0 ? "" : ",", potentiometers_get_value(i));
+    }
+    return len > 0 ? (uint32_t)len + 2 : 0;
+}
+
+// Unica tarea de sensores: los botones la despiertan por su cola, los pots segun el periodo de su slot
+static void sensor_scheduler_task(void *pvParameters)
+{
+    btn_gesture_t ev;
+    while (1)
+    {
+        take_pending_registry();
+        // Con asociaciones activas se vacia el ADC cada paso para que un giro llegue en un bloque de audio
+        uint32_t max_wait = low_power ? SENSOR_LOW_POWER_DRAIN_MS :
+                            bindings_any() ? KNOB_BINDING_PERIOD_MS : SENSOR_DRAIN_MS;
+        uint32_t wait = sensor_registry_next_wait(&registry, slot_state, now_ms(), max_wait);
+        // Redondeo hacia arriba al tick para no girar en vacio con periodos menores a un tick
+        uint32_t ticks = (wait + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        take_pending_keymap();
+        if (pulsadores_wait_event(&ev, ticks * portTICK_PERIOD_MS))
+        {
+            report_button(&ev);
+            while (pulsadores_wait_event(&ev, 0))
+            {
+                report_button(&ev);
+            }
+        }
+        wakeups++;
+
+        potentiometers_drain();
+        take_pending_binding();
+        update_bindings();
+        uint32_t now = now_ms();
+        sensor_report_account(&report, current_mode(), now);
+        for (int i = 0; i < SENSOR_SLOT_COUNT; i++)
+        {
+            if (registry.slots[i].type != SENSOR_TYPE_POT || !sensor_slot_due(&slot_state[i], now))
+            {
+                continue;
+            }
+            int64_t change_us = 0;
+            bool slot_changed = potentiometers_take_change(slot_state[i].index, &change_us);
+            sensor_slot_schedule(&registry, i, &slot_state[i], slot_changed, now);
+            if (slot_changed)
+            {
+                uint16_t value = potentiometers_get_value(slot_state[i].index);
+                uint32_t pot[3] = {(uint32_t)i + 1, value, 0};
+                sensor_report_change(&report, i, value, change_us);
+                event_bus_publish(BUS_TOPIC_SENSOR, BUS_SENSOR_POT, pot, NULL);
+            }
+        }
+        report_pots(now);
+    }
+}
+
+void sensor_scheduler_init(void)
+{
+    if (registry_load(&registry)) {
+        ESP_LOGI(TAG, "Tabla de sensores cargada desde NVS");
+    } else {
+        registry_defaults(&registry);
+    }
+    if (!bindings_load(&bindings)) {
+        knob_binding_table_init(&bindings);
+    }
+    if (!keymap_load(&keymap)) {
+        keymap_default(&keymap);
+    }
+    apply_registry();
+    task_table_create(TASK_SENSORS, sensor_scheduler_task, NULL);
+}
+
+// La tarea solo escribe la tabla al tomar un cambio pendiente, sin uno en curso el shell puede leerla
+static esp_err_t begin_registry_change(void)
+{
+    if (pending_registry_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pending_registry = registry;
+    return ESP_OK;
+}
+
+esp_err_t sensor_scheduler_set_rate(int slot, uint16_t active_ms, uint16_t idle_ms)
+{
+    if (slot < 1 || slot > SENSOR_SLOT_COUNT || registry.slots[slot - 1].type != SENSOR_TYPE_POT ||
+        active_ms < SENSOR_PERIOD_MIN_MS || active_ms > SENSOR_PERIOD_MAX_MS ||
+        idle_ms < SENSOR_PERIOD_MIN_MS || idle_ms > SENSOR_PERIOD_MAX_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = begin_registry_change();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    pending_registry.slots[slot - 1].active_ms = active_ms;
+    pending_registry.slots[slot - 1].idle_ms = idle_ms;
+    // El slot se evalua de inmediato para que el periodo nuevo corra desde ahora
+    pending_resched_mask = 1u << (slot - 1);
+    pending_registry_ready = true;
+    return ESP_OK;
+}
+
+esp_err_t sensor_scheduler_set_report(int slot, uint16_t min_interval_ms, uint16_t heartbeat_ms)
+{
+    if (slot < 1 || slot > SENSOR_SLOT_COUNT || registry.slots[slot - 1].type != SENSOR_TYPE_POT ||
+        min_interval_ms > SENSOR_PERIOD_MAX_MS || (heartbeat_ms != 0 && heartbeat_ms < min_interval_ms)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = begin_registry_change();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    pending_registry.slots[slot - 1].min_interval_ms = min_interval_ms;
+    pending_registry.slots[slot - 1].heartbeat_ms = heartbeat_ms;
+    pending_registry_ready = true;
+    return ESP_OK;
+}
+
+esp_err_t sensor_scheduler_set_filter(int slot, const pot_filter_config_t *cfg)
+{
+    if (slot < 0 || slot > SENSOR_SLOT_COUNT || (slot > 0 && registry.slots[slot - 1].type != SENSOR_TYPE_POT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = begin_registry_change();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    uint32_t mask = 0;
+    for (int i = 0; i < SENSOR_SLOT_COUNT; i++) {
+        sensor_slot_config_t *s = &pending_registry.slots[i];
+        if (s->type != SENSOR_TYPE_POT || (slot > 0 && i != slot - 1)) {
+            continue;
+        }
+        s->decimation = cfg->decimation > 0 ? cfg->decimation : 1;
+        s->smooth_shift = cfg->smooth_shift > 8 ? 8 : cfg->smooth_shift;
+        s->deadband = cfg->deadband;
+        mask |= 1u << i;
+    }
+    pending_filter_mask = mask;
+    pending_registry_ready = true;
+    return ESP_OK;
+}
+
+esp_err_t sensor_scheduler_set_binding(int slot, const knob_binding_t *b)
+{
+    knob_binding_table_t check;
+    if (slot < 1 || slot > SENSOR_SLOT_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    knob_binding_table_init(&check);
+    check.slots[slot - 1] = *b;
+    if (!knob_binding_validate(&check, &registry)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // La tarea toma el cambio en su siguiente pasada (10-20 ms)
+    if (pending_binding_slot != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pending_binding = *b;
+    pending_binding_slot = slot;
+    return ESP_OK;
+}
+
+void sensor_scheduler_get_keymap(keymap_t *map)
+{
+    // Si hay un cambio sin aplicar se parte de el para no perderlo
+    *map = pending_keymap_ready ? pending_keymap : keymap;
+}
+
+esp_err_t sensor_scheduler_set_keymap(const keymap_t *map)
+{
+    if (!keymap_validate(map)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pending_keymap_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pending_keymap = *map;
+    pending_keymap_ready = true;
+    return ESP_OK;
+}
+
+void sensor_scheduler_set_keys_enabled(bool enabled)
+{
+    keys_enabled = enabled;
+}
+
+void sensor_scheduler_set_uart_stream(bool enabled)
+{
+    uart_stream = enabled;
+}
+
+bool sensor_scheduler_uart_stream(void)
+{
+    return uart_stream;
+}
+
+bool sensor_scheduler_bindings_active(void)
+{
+    return bindings_any();
+}
+
+void sensor_scheduler_set_low_power(bool enabled)
+{
+    low_power = enabled;
+}
+
+esp_err_t sensor_scheduler_save(void)
+{
+    // Los cambios que la tarea aun no tomo tambien se guardan, como si ya estuvieran aplicados
+    knob_binding_table_t saved_bindings = bindings;
+    int binding_slot = pending_binding_slot;
+    if (binding_slot != 0) {
+        saved_bindings.slots[binding_slot - 1] = pending_binding;
+    }
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(SENSOR_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_set_blob(handle, SENSOR_NVS_REGISTRY, pending_registry_ready ? &pending_registry : &registry,
+                       sizeof(registry));
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, SENSOR_NVS_BINDINGS, &saved_bindings, sizeof(saved_bindings));
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, SENSOR_NVS_KEYMAP, pending_keymap_ready ? &pending_keymap : &keymap,
+                           sizeof(keymap));
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+esp_err_t sensor_scheduler_reset(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(SENSOR_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_erase_key(handle, SENSOR_NVS_REGISTRY);
+    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = nvs_erase_key(handle, SENSOR_NVS_BINDINGS);
+    }
+    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = nvs_erase_key(handle, SENSOR_NVS_KEYMAP);
+    }
+    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+size_t sensor_scheduler_format(char *out, size_t size)
+{
+    size_t len = sensor_registry_format(&registry, slot_state, out, size);
+    TaskHandle_t task = task_table_handle(TASK_SENSORS);
+    if (len < size) {
+        // El tamano del stack esta en la tabla de tareas; aca interesa cuanto queda libre
+        int n = snprintf(out + len, size - len, "Tarea unica: %u despertares, stack libre %u B, tabla %u B\n",
+                         wakeups, task != NULL ? (uint32_t)uxTaskGetStackHighWaterMark(task) : 0,
+                         (uint32_t)sizeof(registry));
+        len += n > 0 ? (size_t)n : 0;
+    }
+    if (len < size) {
+        len += sensor_report_format(&report, legacy_line_bytes(), out + len, size - len);
+    }
+    return len < size ? len : size - 1;
+}
+
+size_t sensor_scheduler_format_bindings(char *out, size_t size)
+{
+    return knob_binding_format(&bindings, binding_state, out, size);
+}
+
+size_t sensor_scheduler_format_keys(char *out, size_t size)
+{
+    size_t len = keymap_format(&keymap, out, size);
+    if (len < size) {
+        int n = snprintf(out + len, size - len,
+                         "Emision %s: eventos %u, reportes %u, bytes %u, ciclos max %u, suscriptores %s\n",
+                         keys_enabled ? "activa" : "detenida", key_events, key_reports, key_bytes, key_cycles_max,
+                         spp_topic_has_subscribers(SPP_TOPIC_KEYS) ? "si" : "no");
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,116 @@
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "keymap.h"
+#include "knob_binding.h"
+#include "sensor_registry.h"
+
+/**
+ * @brief Carga la tabla de slots (NVS o valores por defecto), inicializa pots y botones
+ * y crea la unica tarea que atiende a todos los sensores
+ */
+void sensor_scheduler_init(void);
+
+/**
+ * @brief Cambia los periodos de evaluacion de un slot de pot
+ *
+ * Los cambios de slots (periodo, reporte y filtro) los aplica la tarea en su siguiente pasada.
+ *
+ * @param slot Slot 1..12
+ * @return esp_err_t ESP_ERR_INVALID_STATE si la tarea aun no aplico el cambio de slots anterior
+ */
+esp_err_t sensor_scheduler_set_rate(int slot, uint16_t active_ms, uint16_t idle_ms);
+
+/**
+ * @brief Cambia el intervalo minimo entre reportes y el latido de un slot de pot
+ *
+ * @param heartbeat_ms Silencio maximo antes de repetir el valor, 0 desactiva el latido
+ */
+esp_err_t sensor_scheduler_set_report(int slot, uint16_t min_interval_ms, uint16_t heartbeat_ms);
+
+/**
+ * @brief Cambia el filtro de un slot de pot, o de todos con slot 0
+ */
+esp_err_t sensor_scheduler_set_filter(int slot, const pot_filter_config_t *cfg);
+
+/**
+ * @brief Asocia un slot de pot a un parametro del DSP, o quita la asociacion con KNOB_TARGET_NONE
+ *
+ * @return esp_err_t ESP_ERR_INVALID_ARG si el slot no es un pot o la asociacion no es valida,
+ * ESP_ERR_INVALID_STATE si la tarea aun no aplico el cambio anterior
+ */
+esp_err_t sensor_scheduler_set_binding(int slot, const knob_binding_t *b);
+
+/**
+ * @brief Copia la tabla de atajos vigente (o la pendiente si aun no se aplico)
+ */
+void sensor_scheduler_get_keymap(keymap_t *map);
+
+/**
+ * @brief Reemplaza la tabla de atajos completa; la tarea la toma entre dos eventos
+ *
+ * @return esp_err_t ESP_ERR_INVALID_ARG si la tabla no es valida,
+ * ESP_ERR_INVALID_STATE si la tarea aun no aplico el cambio anterior
+ */
+esp_err_t sensor_scheduler_set_keymap(const keymap_t *map);
+
+/**
+ * @brief Activa o detiene la emision de reportes de atajos
+ */
+void sensor_scheduler_set_keys_enabled(bool enabled);
+
+/**
+ * @brief Activa o detiene las lineas de sensores por UART; por BT salen mientras haya suscriptores
+ */
+void sensor_scheduler_set_uart_stream(bool enabled);
+
+/**
+ * @brief true si las lineas de sensores salen por UART
+ */
+bool sensor_scheduler_uart_stream(void);
+
+/**
+ * @brief true si algun pot esta asociado a un parametro del DSP y se lee en cada pasada
+ */
+bool sensor_scheduler_bindings_active(void);
+
+/**
+ * @brief En bajo consumo la tarea vacia el ADC cada 80 ms en vez de cada 20 ms; la llama el power_manager
+ */
+void sensor_scheduler_set_low_power(bool enabled);
+
+/**
+ * @brief Guarda la tabla actual, las asociaciones y los atajos en NVS (pines y tipos se aplican al reiniciar)
+ */
+esp_err_t sensor_scheduler_save(void);
+
+/**
+ * @brief Borra la tabla, las asociaciones y los atajos guardados, el proximo arranque usa la de la placa
+ */
+esp_err_t sensor_scheduler_reset(void);
+
+/**
+ * @brief Formatea la tabla de slots, su estado y el costo de la tarea
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t sensor_scheduler_format(char *out, size_t size);
+
+/**
+ * @brief Formatea las asociaciones pot -> DSP y su estado
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t sensor_scheduler_format_bindings(char *out, size_t size);
+
+/**
+ * @brief Formatea la tabla de atajos y el trafico de reportes
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t sensor_scheduler_format_keys(char *out, size_t size);
+
+#endif // SENSOR_SCHEDULER_H
@@ -0,0 +1,125 @@
+#include "bin_protocol.h"
+#include <string.h>
+
+// Estados del parser
+enum {
+    PARSE_SYNC_0 = 0,
+    PARSE_SYNC_1,
+    PARSE_TYPE,
+    PARSE_LEN_LO,
+    PARSE_LEN_HI,
+    PARSE_PAYLOAD,
+    PARSE_CRC,
+};
+
+static uint8_t crc8_update(uint8_t crc, uint8_t byte)
+{
+    crc ^= byte;
+    for (int bit = 0; bit < 8; bit++)
+    {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+uint8_t bin_crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0x00;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = crc8_update(crc, data[i]);
+    }
+    return crc;
+}
+
+void bin_parser_reset(bin_parser_t *parser)
+{
+    parser->state = PARSE_SYNC_0;
+    parser->len = 0;
+    parser->pos = 0;
+    parser->crc = 0;
+}
+
+bool bin_parser_feed(bin_parser_t *parser, uint8_t byte)
+{
+    switch (parser->state)
+    {
+    case PARSE_SYNC_0:
+        if (byte == BIN_SYNC_0)
+        {
+            parser->state = PARSE_SYNC_1;
+        }
+        break;
+    case PARSE_SYNC_1:
+        // Permite resincronizar si llegan varios 0xA5 seguidos
+        parser->state = (byte == BIN_SYNC_1) ? PARSE_TYPE : (byte == BIN_SYNC_0 ? PARSE_SYNC_1 : PARSE_SYNC_0);
+        break;
+    case PARSE_TYPE:
+        parser->type = byte;
+        parser->crc = crc8_update(0, byte);
+        parser->state = PARSE_LEN_LO;
+        break;
+    case PARSE_LEN_LO:
+        parser->len = byte;
+        parser->crc = crc8_update(parser->crc, byte);
+        parser->state = PARSE_LEN_HI;
+        break;
+    case PARSE_LEN_HI:
+        parser->len |= (uint16_t)byte << 8;
+        parser->crc = crc8_update(parser->crc, byte);
+        parser->pos = 0;
+        if (parser->len > BIN_MAX_RX_PAYLOAD)
+        {
+            parser->oversized++;
+            bin_parser_reset(parser);
+        }
+        else
+        {
+            parser->state = parser->len > 0 ? PARSE_PAYLOAD : PARSE_CRC;
+        }
+        break;
+    case PARSE_PAYLOAD:
+        parser->payload[parser->pos++] = byte;
+        parser->crc = crc8_update(parser->crc, byte);
+        if (parser->pos >= parser->len)
+        {
+            parser->state = PARSE_CRC;
+        }
+        break;
+    case PARSE_CRC:
+    default:
+        {
+            bool valid = (parser->state == PARSE_CRC) && (byte == parser->crc);
+            if (parser->state == PARSE_CRC && !valid)
+            {
+                parser->crc_errors++;
+            }
+            parser->state = PARSE_SYNC_0;
+            return valid;
+        }
+    }
+    return false;
+}
+
+size_t bin_frame_encode(uint8_t type, const uint8_t *payload, uint16_t len, uint8_t *out, size_t out_size)
+{
+    size_t total = (size_t)len + BIN_OVERHEAD;
+    if (out == NULL || total > out_size)
+    {
+        return 0;
+    }
+
+    uint8_t *p = out;
+    p = bin_put_u8(p, BIN_SYNC_0);
+    p = bin_put_u8(p, BIN_SYNC_1);
+    p = bin_put_u8(p, type);
+    p = bin_put_u16(p, len);
+    if (len > 0 && payload != NULL)
+    {
+        memmove(p, payload, len);
+        p += len;
+    }
+    // El CRC cubre tipo, longitud y payload
+    *p = bin_crc8(out + 2, (size_t)len + 3);
+    return total;
+}
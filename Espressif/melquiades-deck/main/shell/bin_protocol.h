@@ -0,0 +1,114 @@
+#ifndef _BIN_PROTOCOL_H_
+#define _BIN_PROTOCOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Formato de trama binaria (little-endian):
+// [0xA5][0x5A][tipo][len_lo][len_hi][payload...][crc8]
+#define BIN_SYNC_0          0xA5
+#define BIN_SYNC_1          0x5A
+#define BIN_HEADER_SIZE     5
+#define BIN_TRAILER_SIZE    1
+#define BIN_OVERHEAD        (BIN_HEADER_SIZE + BIN_TRAILER_SIZE)
+#define BIN_MAX_RX_PAYLOAD  48  // Payload maximo aceptado en tramas recibidas
+
+// Tipos de trama enviados por el dispositivo
+typedef enum {
+    BIN_FRAME_STATUS = 0x01,    // Snapshot de telemetria (comando "status bin")
+    BIN_FRAME_ACK = 0x02,       // Confirmacion de un opcode: [opcode][seq][estado]
+    BIN_FRAME_KEYS = 0x03,      // Reportes de atajos, 4 bytes c/u: [seq][id][dato][dato] (ver keymap.h)
+    BIN_FRAME_AUDIO = 0x04,     // Contadores e histogramas del camino de audio (ver audio_probe.h)
+    BIN_FRAME_TRACE = 0x05,     // Volcado de la traza binaria (ver trace_log.h)
+} bin_frame_type_t;
+
+// Opcodes recibidos en modo binario, el payload siempre empieza con [seq]
+typedef enum {
+    BIN_OP_SET_VOLUME = 0x10,   // [u8 volumen 0-100]
+    BIN_OP_SET_BALANCE = 0x11,  // [i16 balance en milesimas, -1000 a 1000]
+    BIN_OP_SET_EQ_PRESET = 0x12,// [u8 preset]
+    BIN_OP_SET_EQ_BANDS = 0x13, // [i16 bajos][i16 medios][i16 agudos] en centesimas de dB
+    BIN_OP_SET_DSP = 0x14,      // [u8 0/1]
+    BIN_OP_STATUS = 0x20,       // Responde con BIN_FRAME_STATUS en lugar de ACK
+    BIN_OP_TEXT_MODE = 0x7F,    // Vuelve al shell de texto
+} bin_opcode_t;
+
+// Estados devueltos en el ACK
+typedef enum {
+    BIN_ACK_OK = 0,
+    BIN_ACK_BAD_LENGTH = 1,
+    BIN_ACK_BAD_VALUE = 2,
+    BIN_ACK_UNKNOWN_OP = 3,
+} bin_ack_status_t;
+
+// Parser incremental de tramas recibidas (tolera tramas partidas entre paquetes)
+typedef struct {
+    uint8_t state;
+    uint8_t type;
+    uint16_t len;
+    uint16_t pos;
+    uint8_t crc;
+    uint8_t payload[BIN_MAX_RX_PAYLOAD];
+    uint32_t crc_errors;    // Tramas descartadas por CRC
+    uint32_t oversized;     // Tramas descartadas por longitud
+} bin_parser_t;
+
+/**
+ * @brief Calcula CRC-8 (polinomio 0x07) sobre un bloque de bytes
+ */
+uint8_t bin_crc8(const uint8_t *data, size_t len);
+
+/**
+ * @brief Reinicia el parser descartando cualquier trama a medias
+ */
+void bin_parser_reset(bin_parser_t *parser);
+
+/**
+ * @brief Alimenta el parser con un byte recibido
+ *
+ * @return true cuando se completa una trama valida (type, len y payload quedan en el parser)
+ */
+bool bin_parser_feed(bin_parser_t *parser, uint8_t byte);
+
+/**
+ * @brief Construye una trama binaria completa en out
+ *
+ * @param type Tipo de trama
+ * @param payload Datos de la trama (puede ser NULL si len es 0)
+ * @param len Longitud del payload
+ * @param out Buffer de salida
+ * @param out_size Tamaño del buffer de salida
+ * @return size_t Bytes escritos, 0 si no cabe
+ */
+size_t bin_frame_encode(uint8_t type, const uint8_t *payload, uint16_t len, uint8_t *out, size_t out_size);
+
+// Helpers para serializar en little-endian, devuelven el puntero avanzado
+static inline uint8_t *bin_put_u8(uint8_t *p, uint8_t v)
+{
+    *p++ = v;
+    return p;
+}
+
+static inline uint8_t *bin_put_u16(uint8_t *p, uint16_t v)
+{
+    *p++ = (uint8_t)(v & 0xFF);
+    *p++ = (uint8_t)(v >> 8);
+    return p;
+}
+
+static inline uint16_t bin_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint8_t *bin_put_u32(uint8_t *p, uint32_t v)
+{
+    *p++ = (uint8_t)(v & 0xFF);
+    *p++ = (uint8_t)((v >> 8) & 0xFF);
+    *p++ = (uint8_t)((v >> 16) & 0xFF);
+    *p++ = (uint8_t)(v >> 24);
+    return p;
+}
+
+#endif /* _BIN_PROTOCOL_H_ */
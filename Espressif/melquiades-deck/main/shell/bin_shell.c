@@ -0,0 +1,130 @@
+#include "bin_shell.h"
+
+#include <string.h>
+
+#include "bin_protocol.h"
+#include "../bluetooth/a2dp_sink.h"
+#include "../telemetry/telemetry.h"
+
+// Construye el ACK [opcode][seq][estado]
+static size_t send_ack(uint8_t opcode, uint8_t seq, uint8_t status, uint8_t *out, size_t size)
+{
+    uint8_t ack[3] = {opcode, seq, status};
+    return bin_frame_encode(BIN_FRAME_ACK, ack, sizeof(ack), out, size);
+}
+
+size_t handle_bin_command(uint8_t opcode, const uint8_t *payload, uint16_t len, uint8_t *out, size_t size, bool *exit_binary)
+{
+    if (len < 1)
+    {
+        return send_ack(opcode, 0, BIN_ACK_BAD_LENGTH, out, size);
+    }
+
+    // Todo opcode trae primero el numero de secuencia
+    uint8_t seq = payload[0];
+    const uint8_t *args = payload + 1;
+    uint16_t args_len = len - 1;
+    uint8_t status = BIN_ACK_OK;
+
+    switch (opcode)
+    {
+    case BIN_OP_SET_VOLUME:
+        if (args_len != 1)
+        {
+            status = BIN_ACK_BAD_LENGTH;
+        }
+        else if (args[0] > 100)
+        {
+            status = BIN_ACK_BAD_VALUE;
+        }
+        else
+        {
+            set_volume(args[0]);
+        }
+        break;
+
+    case BIN_OP_SET_BALANCE:
+        if (args_len != 2)
+        {
+            status = BIN_ACK_BAD_LENGTH;
+        }
+        else
+        {
+            int16_t milli = (int16_t)bin_get_u16(args);
+            if (milli < -1000 || milli > 1000)
+            {
+                status = BIN_ACK_BAD_VALUE;
+            }
+            else
+            {
+                set_balance(milli / 1000.0f);
+            }
+        }
+        break;
+
+    case BIN_OP_SET_EQ_PRESET:
+        if (args_len != 1)
+        {
+            status = BIN_ACK_BAD_LENGTH;
+        }
+        else if (args[0] >= EQ_MAX_PRESETS)
+        {
+            status = BIN_ACK_BAD_VALUE;
+        }
+        else
+        {
+            set_eq_preset((eq_preset_t)args[0]);
+        }
+        break;
+
+    case BIN_OP_SET_EQ_BANDS:
+        if (args_len != 6)
+        {
+            status = BIN_ACK_BAD_LENGTH;
+        }
+        else
+        {
+            int16_t bass = (int16_t)bin_get_u16(args);
+            int16_t mid = (int16_t)bin_get_u16(args + 2);
+            int16_t treble = (int16_t)bin_get_u16(args + 4);
+            // El DSP limita cada banda a +-20 dB
+            if (bass < -2000 || bass > 2000 || mid < -2000 || mid > 2000 || treble < -2000 || treble > 2000)
+            {
+                status = BIN_ACK_BAD_VALUE;
+            }
+            else
+            {
+                set_eq_bands(bass / 100.0f, mid / 100.0f, treble / 100.0f);
+            }
+        }
+        break;
+
+    case BIN_OP_SET_DSP:
+        if (args_len != 1)
+        {
+            status = BIN_ACK_BAD_LENGTH;
+        }
+        else
+        {
+            set_dsp_enabled(args[0] != 0);
+        }
+        break;
+
+    case BIN_OP_STATUS:
+        {
+            telemetry_snapshot_t snap;
+            telemetry_capture(&snap);
+            return telemetry_encode_binary(&snap, out, size);
+        }
+
+    case BIN_OP_TEXT_MODE:
+        *exit_binary = true;
+        break;
+
+    default:
+        status = BIN_ACK_UNKNOWN_OP;
+        break;
+    }
+
+    return send_ack(opcode, seq, status, out, size);
+}
@@ -0,0 +1,24 @@
+#ifndef _BIN_SHELL_H_
+#define _BIN_SHELL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief Ejecuta un opcode del canal binario y construye la respuesta
+ *
+ * A diferencia del shell de texto no hay eco ni mensajes, solo un ACK
+ * (o la trama de estado para BIN_OP_STATUS).
+ *
+ * @param opcode Opcode recibido (bin_opcode_t)
+ * @param payload Payload de la trama, empieza con el numero de secuencia
+ * @param len Longitud del payload
+ * @param out Buffer donde se escribe la trama de respuesta
+ * @param size Tamaño del buffer de salida
+ * @param exit_binary Se pone en true si el host pide volver al modo texto
+ * @return size_t Bytes de la respuesta
+ */
+size_t handle_bin_command(uint8_t opcode, const uint8_t *payload, uint16_t len, uint8_t *out, size_t size, bool *exit_binary);
+
+#endif /* _BIN_SHELL_H_ */
@@ -6,20 +6,42 @@
 #include <ctype.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 
 #include "../state.h"
 #include "../leds/board.h"
 #include "../sensors/buttons.h"
 #include "../sensors/potentiometers.h"
+#include "../sensors/sensor_scheduler.h"
 #include "../bluetooth/a2dp_sink.h"
+#include "../bluetooth/spp_init.h"
+#include "../bluetooth/spp_session.h"
+#include "../telemetry/telemetry.h"
+#include "../telemetry/trace_log.h"
+#include "../boot/boot_profile.h"
+#include "../audio/audio_output.h"
+#include "../audio/dsp_bench.h"
+#include "../audio/audio_probe.h"
+#include "../audio/audio_profile.h"
+#include "../system/task_table.h"
+#include "../system/event_bus.h"
+#include "../system/power_manager.h"
+#include "../system/mem_track.h"
 
-void handle_command(const char *input, char *output, size_t size, const char *origen){    
+// Suscribe o desuscribe la sesion BT actual; el planificador de sensores siempre corre
+// y solo publica por BT mientras quede algun suscriptor
+static void bt_subscribe(uint32_t topics, bool enable)
+{
+    spp_session_subscribe(spp_shell_session(), topics, enable);
+}
+
+size_t handle_command(const char *input, char *output, size_t size, const char *origen){    
     /*****COMANDOS PARA LED*****/
     if (strcmp(input, "led_board start") == 0)
     {
-        if (tasl_ledboard_handle == NULL)
+        if (!led_board_is_running())
         {
-            xTaskCreate(manage_led_board, "manage_led_board", 2048, NULL, 5, &tasl_ledboard_handle);
+            led_board_start();
             snprintf(output, size, "Encendido en el led de la board ON.\n");            
         }
         else
@@ -29,75 +51,46 @@ void handle_command(const char *input, char *output, size_t size, const char *or
     }
     else if (strcmp(input, "led_board stop") == 0)
     {
-        if (tasl_ledboard_handle != NULL)
+        if (led_board_is_running())
         {
-            vTaskDelete(tasl_ledboard_handle);
-            tasl_ledboard_handle = NULL;
+            led_board_stop();
             snprintf(output, size, "Se pausa encendido de led.\n");            
         }
     }
     /*****COMANDOS PARA SENSORES*****/
     else if (strcmp(input, "sensors start") == 0)
     {        
-        bool crearTask = false;
         if (strcmp(origen, "UART") == 0){            
-            if (sensors_streaming_uart)
+            if (sensor_scheduler_uart_stream())
             {                
                 snprintf(output, size, "Actualmente nos encontramos transmitiendo data via UART.\n");
             }
             else
             {                
-                sensors_streaming_uart = true;
-                crearTask = true;
+                sensor_scheduler_set_uart_stream(true);
                 snprintf(output, size, "Iniciamos transmision UART.\n");
             }
         }
         if (strcmp(origen, "BT") == 0){                 
-            if (sensors_streaming_bt)
+            if (spp_session_is_subscribed(spp_shell_session(), SPP_TOPIC_SENSORS))
             {                
                 snprintf(output, size, "Actualmente nos encontramos transmitiendo data via BT.\n");
             }
             else
             {
-                sensors_streaming_bt = true;
-                crearTask = true;
+                bt_subscribe(SPP_TOPIC_SENSORS, true);
                 snprintf(output, size, "Iniciamos transmision BT.\n");
             }
         }
-
-        if(crearTask){
-            if (task_pot_handle == NULL)
-            {
-                xTaskCreate(read_potentiometers, "read_potentiometers", 2048, NULL, 5, &task_pot_handle);
-            }
-            if (task_btn_handle == NULL)
-            {
-                xTaskCreate(leer_pulsadores, "leer_pulsadores", 2048, NULL, 5, &task_btn_handle);
-            }            
-        }        
     }
     else if (strcmp(input, "sensors stop") == 0)
     {
         if (strcmp(origen, "BT") == 0){        
-            if (sensors_streaming_bt && !sensors_streaming_uart)
+            if (spp_session_is_subscribed(spp_shell_session(), SPP_TOPIC_SENSORS))
             {
-                sensors_streaming_bt = false;
-                if (task_pot_handle != NULL)
-                {
-                    vTaskDelete(task_pot_handle);
-                    task_pot_handle = NULL;
-                }
-                if (task_btn_handle != NULL)
-                {
-                    vTaskDelete(task_btn_handle);
-                    task_btn_handle = NULL;
-                }
-                snprintf(output, size, "Se cierra streaming en BT.\n");
-            }
-            else if (sensors_streaming_bt && sensors_streaming_uart)
-            {
-                sensors_streaming_bt = false;            
-                snprintf(output, size, "Se cierra streaming en BT, UART sigue transmitiendo.\n");
+                bt_subscribe(SPP_TOPIC_SENSORS, false);
+                snprintf(output, size, sensor_scheduler_uart_stream() ? "Se cierra streaming en BT, UART sigue transmitiendo.\n"
+                                                              : "Se cierra streaming en BT.\n");
             }
             else
             {            
@@ -105,24 +98,15 @@ void handle_command(const char *input, char *output, size_t size, const char *or
             }
         }
         if (strcmp(origen, "UART") == 0){        
-            if (sensors_streaming_uart && !sensors_streaming_bt)
+            bool bt_streaming = spp_topic_has_subscribers(SPP_TOPIC_SENSORS);
+            if (sensor_scheduler_uart_stream() && !bt_streaming)
             {
-                sensors_streaming_uart = false;
-                if (task_pot_handle != NULL)
-                {
-                    vTaskDelete(task_pot_handle);
-                    task_pot_handle = NULL;
-                }
-                if (task_btn_handle != NULL)
-                {
-                    vTaskDelete(task_btn_handle);
-                    task_btn_handle = NULL;
-                }
+                sensor_scheduler_set_uart_stream(false);
                 snprintf(output, size, "Se cierra streaming en UART.\n");
             }
-            else if (sensors_streaming_uart && sensors_streaming_bt)
+            else if (sensor_scheduler_uart_stream() && bt_streaming)
             {
-                sensors_streaming_uart = false;            
+                sensor_scheduler_set_uart_stream(false);
                 snprintf(output, size, "Se cierra streaming en UART, BT sigue transmitiendo.\n");
             }
             else
@@ -131,6 +115,335 @@ void handle_command(const char *input, char *output, size_t size, const char *or
             }
         }        
     }
+    /*****COMANDOS PARA GESTOS*****/
+    else if (strcmp(input, "gestures") == 0)
+    {
+        return pulsadores_format_gestures(output, size);
+    }
+    else if (strcmp(input, "gestures on") == 0 || strcmp(input, "gestures off") == 0)
+    {
+        bool enabled = strcmp(input, "gestures on") == 0;
+        pulsadores_set_gestures(enabled);
+        snprintf(output, size, enabled ? "Reconocedor de gestos activo.\n" : "Eventos crudos de botones.\n");
+    }
+    else if (strncmp(input, "gestures set ", 13) == 0)
+    {
+        char name[16];
+        int ms = 0;
+        btn_gesture_timing_t timing;
+        pulsadores_get_gesture_timing(&timing);
+        if (sscanf(input + 13, "%15s %d", name, &ms) == 2 && ms > 0)
+        {
+            uint32_t us = (uint32_t)ms * 1000;
+            if (strcmp(name, "double") == 0) timing.double_tap_us = us;
+            else if (strcmp(name, "long") == 0) timing.long_press_us = us;
+            else if (strcmp(name, "repeat") == 0) timing.repeat_us = us;
+            else if (strcmp(name, "chord") == 0) timing.chord_us = us;
+            else ms = 0;
+        }
+        else
+        {
+            ms = 0;
+        }
+        if (ms > 0)
+        {
+            pulsadores_set_gesture_timing(&timing);
+            snprintf(output, size, "Tiempo %s = %d ms.\n", name, ms);
+        }
+        else
+        {
+            snprintf(output, size, "Error: use gestures set <double|long|repeat|chord> <ms>.\n");
+        }
+    }
+    /*****COMANDOS PARA POTENCIOMETROS*****/
+    else if (strcmp(input, "pots") == 0)
+    {
+        return potentiometers_format(output, size);
+    }
+    else if (strncmp(input, "pots rate ", 10) == 0)
+    {
+        const char *param = input + 10;
+        esp_err_t ret = ESP_ERR_INVALID_ARG;
+        if (isdigit((unsigned char)param[0]))
+        {
+            ret = potentiometers_set_rate((uint32_t)atoi(param));
+        }
+        if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Muestreo ADC1: %d Hz.\n", atoi(param));
+        }
+        else
+        {
+            snprintf(output, size, "Error: frecuencia entre 20000 y 2000000 Hz.\n");
+        }
+    }
+    else if (strncmp(input, "pots filter ", 12) == 0)
+    {
+        unsigned decimation = 0, shift = 0, deadband = 0;
+        esp_err_t ret = ESP_ERR_INVALID_ARG;
+        if (sscanf(input + 12, "%u %u %u", &decimation, &shift, &deadband) == 3 && decimation > 0 && decimation <= 1024 && deadband <= 255)
+        {
+            pot_filter_config_t cfg = {
+                .decimation = (uint16_t)decimation,
+                .smooth_shift = (uint8_t)shift,
+                .deadband = (uint16_t)(deadband << POT_FILTER_FRAC_BITS)
+            };
+            ret = sensor_scheduler_set_filter(0, &cfg);
+        }
+        if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Filtro de pots: diezmado %u, suavizado 1/%u, banda muerta %u LSB.\n",
+                     decimation, 1u << (shift > 8 ? 8 : shift), deadband);
+        }
+        else if (ret == ESP_ERR_INVALID_STATE)
+        {
+            snprintf(output, size, "Error: cambio anterior pendiente, intente de nuevo.\n");
+        }
+        else
+        {
+            snprintf(output, size, "Error: use pots filter <diezmado 1-1024> <suavizado 0-8> <banda 0-255 LSB>.\n");
+        }
+    }
+    else if (strcmp(input, "pots cal save") == 0)
+    {
+        esp_err_t ret = potentiometers_save_calibration();
+        snprintf(output, size, ret == ESP_OK ? "Calibracion de pots guardada en NVS.\n"
+                                             : "Error: no se pudo guardar la calibracion de pots.\n");
+    }
+    else if (strncmp(input, "pots cal ", 9) == 0)
+    {
+        static const char *points[] = {"min", "centre", "max", "clear"};
+        int pot = 0;
+        char name[8] = "";
+        int point = -1;
+        if (sscanf(input + 9, "%d %7s", &pot, name) == 2)
+        {
+            for (int i = 0; i < sizeof(points) / sizeof(points[0]); i++)
+            {
+                if (strcmp(name, points[i]) == 0)
+                {
+                    point = i;
+                }
+            }
+        }
+        esp_err_t ret = point >= 0 ? potentiometers_calibrate(pot - 1, (pot_cal_point_t)point) : ESP_ERR_INVALID_ARG;
+        if (ret == ESP_OK && point == POT_CAL_CLEAR)
+        {
+            snprintf(output, size, "Pot %d sin puntos manuales, solo curva de eFuse.\n", pot);
+        }
+        else if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Pot %d: punto %s capturado.\n", pot, name);
+        }
+        else if (ret == ESP_ERR_INVALID_STATE)
+        {
+            snprintf(output, size, "Error: el pot %d aun no tiene lecturas.\n", pot);
+        }
+        else
+        {
+            snprintf(output, size, "Error: use pots cal <pot> <min|centre|max|clear> o pots cal save.\n");
+        }
+    }
+    /*****COMANDOS PARA SLOTS DE SENSORES*****/
+    else if (strcmp(input, "slots") == 0)
+    {
+        return sensor_scheduler_format(output, size);
+    }
+    else if (strncmp(input, "slots rate ", 11) == 0)
+    {
+        int slot = 0, active_ms = 0, idle_ms = 0;
+        esp_err_t ret = ESP_ERR_INVALID_ARG;
+        if (sscanf(input + 11, "%d %d %d", &slot, &active_ms, &idle_ms) == 3 &&
+            active_ms > 0 && active_ms <= 0xFFFF && idle_ms > 0 && idle_ms <= 0xFFFF)
+        {
+            ret = sensor_scheduler_set_rate(slot, (uint16_t)active_ms, (uint16_t)idle_ms);
+        }
+        if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Slot %d: %d ms en movimiento, %d ms en reposo.\n", slot, active_ms, idle_ms);
+        }
+        else if (ret == ESP_ERR_INVALID_STATE)
+        {
+            snprintf(output, size, "Error: cambio anterior pendiente, intente de nuevo.\n");
+        }
+        else
+        {
+            snprintf(output, size, "Error: use slots rate <slot de pot> <ms activo> <ms reposo> (1-60000).\n");
+        }
+    }
+    else if (strncmp(input, "slots report ", 13) == 0)
+    {
+        int slot = 0, min_ms = -1, heartbeat_ms = -1;
+        esp_err_t ret = ESP_ERR_INVALID_ARG;
+        if (sscanf(input + 13, "%d %d %d", &slot, &min_ms, &heartbeat_ms) == 3 &&
+            min_ms >= 0 && min_ms <= 0xFFFF && heartbeat_ms >= 0 && heartbeat_ms <= 0xFFFF)
+        {
+            ret = sensor_scheduler_set_report(slot, (uint16_t)min_ms, (uint16_t)heartbeat_ms);
+        }
+        if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Slot %d: reporte cada %d ms como minimo, latido %d ms.\n", slot, min_ms, heartbeat_ms);
+        }
+        else if (ret == ESP_ERR_INVALID_STATE)
+        {
+            snprintf(output, size, "Error: cambio anterior pendiente, intente de nuevo.\n");
+        }
+        else
+        {
+            snprintf(output, size, "Error: use slots report <slot de pot> <ms minimo> <ms latido, 0 sin latido>.\n");
+        }
+    }
+    else if (strcmp(input, "slots save") == 0)
+    {
+        esp_err_t ret = sensor_scheduler_save();
+        snprintf(output, size, ret == ESP_OK ? "Tabla de sensores guardada en NVS.\n"
+                                             : "Error: no se pudo guardar la tabla de sensores.\n");
+    }
+    else if (strcmp(input, "slots reset") == 0)
+    {
+        esp_err_t ret = sensor_scheduler_reset();
+        snprintf(output, size, ret == ESP_OK ? "Tabla de sensores borrada, se usa la de la placa al reiniciar.\n"
+                                             : "Error: no se pudo borrar la tabla de sensores.\n");
+    }
+    /*****COMANDOS PARA ASOCIACIONES POT -> DSP*****/
+    else if (strcmp(input, "bind") == 0)
+    {
+        return sensor_scheduler_format_bindings(output, size);
+    }
+    else if (strncmp(input, "bind ", 5) == 0)
+    {
+        int slot = 0;
+        char target_name[16] = "";
+        char curve_name[16] = "";
+        float min = 0.0f, max = 0.0f;
+        unsigned shift = 0;
+        int fields = sscanf(input + 5, "%d %15s %15s %f %f %u", &slot, target_name, curve_name, &min, &max, &shift);
+        int target = fields >= 2 ? knob_target_parse(target_name) : -1;
+        knob_binding_t binding;
+        esp_err_t ret = ESP_ERR_INVALID_ARG;
+        if (target >= 0)
+        {
+            knob_binding_default(&binding, (knob_target_t)target);
+            int curve = fields >= 3 ? knob_curve_parse(curve_name) : binding.curve;
+            if (curve >= 0 && fields != 4)
+            {
+                binding.curve = (uint8_t)curve;
+                if (fields >= 5)
+                {
+                    binding.min = min;
+                    binding.max = max;
+                }
+                if (fields >= 6)
+                {
+                    binding.smooth_shift = (uint8_t)(shift > 0xFF ? 0xFF : shift);
+                }
+                ret = sensor_scheduler_set_binding(slot, &binding);
+            }
+        }
+        if (ret == ESP_OK && target == KNOB_TARGET_NONE)
+        {
+            snprintf(output, size, "Slot %d sin asociacion.\n", slot);
+        }
+        else if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Slot %d -> %s, curva %s, %.2f..%.2f, suavizado 1/%u.\n", slot,
+                     knob_target_name(binding.target), knob_curve_name(binding.curve),
+                     binding.min, binding.max, 1u << binding.smooth_shift);
+        }
+        else if (ret == ESP_ERR_INVALID_STATE)
+        {
+            snprintf(output, size, "Error: cambio anterior pendiente, intente de nuevo.\n");
+        }
+        else
+        {
+            snprintf(output, size, "Error: use bind <slot de pot> <off|volume|balance|bass|mid|treble|limiter> [linear|log|detent] [min max] [suavizado 0-6].\n");
+        }
+    }
+    /*****COMANDOS PARA ATAJOS*****/
+    else if (strcmp(input, "keys") == 0)
+    {
+        return sensor_scheduler_format_keys(output, size);
+    }
+    else if (strcmp(input, "keys on") == 0 || strcmp(input, "keys off") == 0)
+    {
+        bool enabled = strcmp(input, "keys on") == 0;
+        sensor_scheduler_set_keys_enabled(enabled);
+        snprintf(output, size, "Reportes de atajos %s.\n", enabled ? "activados" : "detenidos");
+    }
+    else if (strncmp(input, "keys ", 5) == 0)
+    {
+        // La tabla se edita en una copia y se entrega completa, la tarea de sensores la cambia entre eventos
+        keymap_t map;
+        char kind[8] = "";
+        int action = 0, consumed = 0;
+        unsigned a = 0, b = 0;
+        bool parsed = false;
+        sensor_scheduler_get_keymap(&map);
+        if (strncmp(input + 5, "macro ", 6) == 0)
+        {
+            const char *p = input + 11;
+            int macro = -1;
+            if (sscanf(p, "%d%n", &macro, &consumed) == 1 && macro >= 0 && macro < KEYMAP_MAX_MACROS)
+            {
+                int steps = 0;
+                p += consumed;
+                memset(map.macros[macro], 0, sizeof(map.macros[macro]));
+                while (steps < KEYMAP_MACRO_STEPS && sscanf(p, " %x:%x%n", &a, &b, &consumed) == 2 && a <= 0xFF && b <= 0xFF)
+                {
+                    map.macros[macro][steps].modifiers = (uint8_t)a;
+                    map.macros[macro][steps].key = (uint8_t)b;
+                    steps++;
+                    p += consumed;
+                }
+                parsed = steps > 0;
+            }
+        }
+        else if (sscanf(input + 5, "%d %7s%n", &action, kind, &consumed) == 2 && action >= 1 && action <= KEYMAP_MAX_ACTIONS)
+        {
+            keymap_entry_t *e = &map.entries[action - 1];
+            const char *p = input + 5 + consumed;
+            if (strcmp(kind, "off") == 0)
+            {
+                memset(e, 0, sizeof(*e));
+                parsed = true;
+            }
+            else if (strcmp(kind, "key") == 0 && sscanf(p, " %x %x", &a, &b) == 2 && a <= 0xFF && b <= 0xFF)
+            {
+                e->kind = KEYMAP_ACTION_KEY;
+                e->modifiers = (uint8_t)a;
+                e->code = (uint16_t)b;
+                parsed = true;
+            }
+            else if (strcmp(kind, "media") == 0 && sscanf(p, " %x", &a) == 1 && a <= 0xFFFF)
+            {
+                e->kind = KEYMAP_ACTION_MEDIA;
+                e->modifiers = 0;
+                e->code = (uint16_t)a;
+                parsed = true;
+            }
+            else if (strcmp(kind, "macro") == 0 && sscanf(p, " %u", &a) == 1 && a < KEYMAP_MAX_MACROS)
+            {
+                e->kind = KEYMAP_ACTION_MACRO;
+                e->modifiers = 0;
+                e->code = (uint16_t)a;
+                parsed = true;
+            }
+        }
+        esp_err_t ret = parsed ? sensor_scheduler_set_keymap(&map) : ESP_ERR_INVALID_ARG;
+        if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Tabla de atajos actualizada.\n");
+        }
+        else if (ret == ESP_ERR_INVALID_STATE)
+        {
+            snprintf(output, size, "Error: cambio anterior pendiente, intente de nuevo.\n");
+        }
+        else
+        {
+            snprintf(output, size, "Error: use keys <accion> off|key <mod hex> <tecla hex>|media <usage hex>|macro <n>, "
+                                   "o keys macro <n> <mod:tecla> ... (hex).\n");
+        }
+    }
     /*****COMANDOS PARA VOLUMEN*****/
     else if (strncmp(input, "set_volume ", 11) == 0)
     {
@@ -204,13 +517,246 @@ void handle_command(const char *input, char *output, size_t size, const char *or
         set_dsp_enabled(false);
         snprintf(output, size, "Se desactiva DSP.\n");
     }
+    else if (strcmp(input, "dsp bench") == 0 || strncmp(input, "dsp bench ", 10) == 0)
+    {
+        // El benchmark reinicia los filtros del DSP que usa la salida: solo con el audio parado
+        if (a2dp_is_streaming())
+        {
+            snprintf(output, size, "Detenga el audio antes de correr el benchmark del DSP.\n");
+        }
+        else
+        {
+            audio_output_stats_t st;
+            audio_output_get_stats(&st);
+            size_t block = input[9] == ' ' ? (size_t)atoi(input + 10) : 2048;
+            return dsp_bench_format(block, st.sample_rate, output, size);
+        }
+    }
+    /*****INSTRUMENTACION DE AUDIO*****/
+    else if (strcmp(input, "audio") == 0)
+    {
+        audio_probe_totals_t totals;
+        audio_probe_get(&totals);
+        return audio_probe_format_text(&totals, output, size);
+    }
+    else if (strcmp(input, "audio reset") == 0)
+    {
+        audio_probe_reset();
+        snprintf(output, size, "Contadores de audio en cero.\n");
+    }
+    /*****PERFILES DE AUDIO*****/
+    else if (strcmp(input, "profile") == 0)
+    {
+        return audio_profile_format(output, size);
+    }
+    else if (strncmp(input, "profile load ", 13) == 0)
+    {
+        int index = -1;
+        esp_err_t ret = sscanf(input + 13, "%d", &index) == 1 ? a2dp_sink_load_profile(index) : ESP_ERR_INVALID_ARG;
+        if (ret == ESP_OK)
+        {
+            snprintf(output, size, "Perfil %d cargado.\n", index);
+        }
+        else if (ret == ESP_ERR_NOT_FOUND)
+        {
+            snprintf(output, size, "Error: el perfil %d esta vacio.\n", index);
+        }
+        else
+        {
+            snprintf(output, size, "Error: use profile load <0-%d>.\n", AUDIO_PROFILE_COUNT - 1);
+        }
+    }
+    else if (strncmp(input, "profile save ", 13) == 0)
+    {
+        int index = -1;
+        char name[AUDIO_PROFILE_NAME_LEN];
+        if (sscanf(input + 13, "%d %11s", &index, name) == 2 && a2dp_sink_save_profile(index, name) == ESP_OK)
+        {
+            snprintf(output, size, "Perfil %d (%s) activo, se guarda en NVS cuando los controles se quedan quietos.\n", index, name);
+        }
+        else
+        {
+            snprintf(output, size, "Error: use profile save <0-%d> <nombre>.\n", AUDIO_PROFILE_COUNT - 1);
+        }
+    }
+    /*****CANAL BINARIO*****/
+    else if (strcmp(input, "bin_mode on") == 0)
+    {
+        if (strcmp(origen, "BT") == 0)
+        {
+            spp_set_binary_mode(true);
+            snprintf(output, size, "Modo binario activo, opcode 0x7F para volver a texto.\n");
+        }
+        else
+        {
+            snprintf(output, size, "Modo binario solo disponible via BT.\n");
+        }
+    }
+    /*****SESIONES SPP*****/
+    else if (strncmp(input, "subscribe ", 10) == 0 || strncmp(input, "unsubscribe ", 12) == 0)
+    {
+        bool enable = input[0] == 's';
+        const char *param = input + (enable ? 10 : 12);
+        uint32_t topic = spp_topic_from_name(param);
+        if (strcmp(origen, "BT") != 0)
+        {
+            snprintf(output, size, "Suscripciones solo disponibles via BT.\n");
+        }
+        else if (topic == 0)
+        {
+            snprintf(output, size, "Error: tema inválido, use sensors, meters, logs, keys o audio.\n");
+        }
+        else
+        {
+            bt_subscribe(topic, enable);
+            snprintf(output, size, "Sesion %d %s a %s.\n", spp_shell_session(),
+                     enable ? "suscrita" : "desuscrita", param);
+        }
+    }
+    else if (strcmp(input, "sessions") == 0)
+    {
+        size_t len = 0;
+        int n = snprintf(output, size, "Sesiones SPP (max %d): topics tramas bytes descartes errores cola (max) respuesta congestion\n",
+                         SPP_MAX_SESSIONS);
+        len = n > 0 ? (size_t)n : 0;
+        for (int i = 0; i < SPP_MAX_SESSIONS && len < size; i++)
+        {
+            spp_session_stats_t st;
+            spp_session_get_stats(i, &st);
+            if (!st.active)
+            {
+                n = snprintf(output + len, size - len, "  %d: libre\n", i);
+            }
+            else
+            {
+                n = snprintf(output + len, size - len, "  %d:%s 0x%02x %u %u %u %u %u (%u) %u B %s\n", i,
+                             i == spp_shell_session() ? "*" : " ", st.topics, st.frames, st.bytes,
+                             st.dropped, st.errors, st.queued, st.queue_max, st.resp_pending,
+                             st.congested ? "si" : "no");
+            }
+            len += n > 0 ? (size_t)n : 0;
+        }
+    }
+    else if (strcmp(input, "qos") == 0)
+    {
+        spp_qos_t qos;
+        spp_session_get_qos(&qos);
+        return spp_qos_format(&qos, output, size);
+    }
+    else if (strcmp(input, "qos on") == 0 || strcmp(input, "qos off") == 0)
+    {
+        spp_qos_t qos;
+        spp_session_get_qos(&qos);
+        qos.cfg.enabled = strcmp(input, "qos on") == 0;
+        spp_session_set_qos_config(&qos.cfg);
+        snprintf(output, size, "QoS SPP %s.\n", qos.cfg.enabled ? "activado" : "desactivado");
+    }
+    else if (strncmp(input, "qos budget ", 11) == 0)
+    {
+        const char *param = input + 11;
+        if (isdigit((unsigned char)param[0]))
+        {
+            spp_qos_t qos;
+            spp_session_get_qos(&qos);
+            qos.cfg.budget_bps = (uint32_t)atoi(param);
+            spp_session_set_qos_config(&qos.cfg);
+            snprintf(output, size, "Presupuesto SPP con audio: %u B/s.\n", qos.cfg.budget_bps);
+        }
+        else
+        {
+            snprintf(output, size, "Error: presupuesto inválido.\n");
+        }
+    }
+    /*****COMANDOS DE DIAGNOSTICO*****/
+    else if (strcmp(input, "status") == 0)
+    {
+        telemetry_snapshot_t snap;
+        telemetry_capture(&snap);
+        return telemetry_format_text(&snap, output, size);
+    }
+    else if (strncmp(input, "ping ", 5) == 0)
+    {
+        // Sincronizacion de reloj estilo NTP: el cliente guarda su hora de envio y de recepcion
+        // y con el instante del equipo estima el desfase; se marca al parsear para no sumar el formateo
+        int64_t now_us = esp_timer_get_time();
+        unsigned token = 0;
+        if (sscanf(input + 5, "%u", &token) == 1)
+        {
+            snprintf(output, size, "pong %u t=%u.%03u ms\n", token,
+                     (uint32_t)(now_us / 1000), (uint32_t)(now_us % 1000));
+        }
+        else
+        {
+            snprintf(output, size, "Error: use ping <numero>.\n");
+        }
+    }
+    else if (strcmp(input, "boot_profile") == 0)
+    {
+        return boot_profile_format(output, size);
+    }
+    else if (strcmp(input, "tasks") == 0)
+    {
+        return task_table_format_text(output, size);
+    }
+    else if (strcmp(input, "bus") == 0)
+    {
+        return event_bus_format_text(output, size);
+    }
+    else if (strcmp(input, "power") == 0)
+    {
+        return power_manager_format(output, size);
+    }
+    else if (strcmp(input, "mem") == 0)
+    {
+        return mem_track_format(output, size);
+    }
+    else if (strcmp(input, "status bin") == 0)
+    {
+        telemetry_snapshot_t snap;
+        telemetry_capture(&snap);
+        return telemetry_encode_binary(&snap, (uint8_t *)output, size);
+    }
+    /*****TRAZA BINARIA*****/
+    else if (strcmp(input, "trace") == 0)
+    {
+        return trace_log_dump_text(output, size);
+    }
+    else if (strcmp(input, "trace bin") == 0)
+    {
+        return trace_log_dump_binary((uint8_t *)output, size);
+    }
+    else if (strcmp(input, "trace clear") == 0)
+    {
+        trace_log_clear();
+        snprintf(output, size, "Traza descartada.\n");
+    }
     /*****OTROS*****/
     else if (strcmp(input, "help") == 0)
     {
-        snprintf(output, size, cmd_commands);        
+        snprintf(output, size, "%s", cmd_commands);
+    }
+    else if (strncmp(input, "help ", 5) == 0)
+    {
+        const char *text = NULL;
+        for (size_t i = 0; i < cmd_help_group_count; i++)
+        {
+            if (strcmp(input + 5, cmd_help_groups[i].name) == 0)
+            {
+                text = cmd_help_groups[i].text;
+            }
+        }
+        if (text != NULL)
+        {
+            snprintf(output, size, "%s", text);
+        }
+        else
+        {
+            snprintf(output, size, "Error: grupo inválido, use audio, sensores, bt o sistema.\n");
+        }
     }
     else
     {
         snprintf(output, size, "Comando no válido. Escriba help para listado de comandos validos.\n");        
     }
+    return strlen(output);
 }
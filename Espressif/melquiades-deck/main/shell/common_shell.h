@@ -4,6 +4,14 @@
 
 #include <stddef.h>
 
-void handle_command(const char *input, char *output, size_t size, const char *origen);
+// Buffer de respuesta de los shells UART y BT, ninguna respuesta puede pasar de aqui
+#define SHELL_RESPONSE_SIZE 2048
+
+/**
+ * @brief Ejecuta un comando del shell y deja la respuesta en output
+ *
+ * @return size_t Bytes validos en output (las respuestas binarias pueden contener ceros)
+ */
+size_t handle_command(const char *input, char *output, size_t size, const char *origen);
 
 #endif /* _COMMON_SHELL_H_ */
\ No newline at end of file
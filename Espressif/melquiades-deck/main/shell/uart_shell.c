@@ -17,7 +17,7 @@
 // Funcion para manejar el shell usado via UART
 void uart_shell_task(void *pvParameters)
 {
-    char response[1024];
+    static char response[SHELL_RESPONSE_SIZE];
     char input[20]; // Buffer para recibir el comando
     printf("\nIngrese comando:\n");
     while (1)
@@ -27,8 +27,9 @@ void uart_shell_task(void *pvParameters)
             // Eliminar salto de línea
             input[strcspn(input, "\n")] = 0;
             
-            handle_command(input, response, sizeof(response), "UART");
-            printf(response);
+            size_t len = handle_command(input, response, sizeof(response), "UART");
+            fwrite(response, 1, len, stdout);
+            fflush(stdout);
         }
         vTaskDelay(pdMS_TO_TICKS(500)); // Delay para que el sistema no se emperique
     }
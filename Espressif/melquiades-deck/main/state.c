@@ -1,21 +1,18 @@
 #include "state.h"
-
-//Estados booleanos
-bool sensors_streaming_bt = false;
-bool sensors_streaming_uart = false;
-
-// Inicialización de TaskHandles
-TaskHandle_t tasl_ledboard_handle = NULL;
-TaskHandle_t task_pot_handle = NULL;
-TaskHandle_t task_btn_handle = NULL;
+#include "shell/common_shell.h"
 
 //Inicializamos CHARS
+// La ayuda va por grupos: cada texto tiene que entrar en el buffer de respuesta de los shells
 const char cmd_commands[] = 
-        "Comandos disponibles:\r\n"                         
-        "  led_board start - Iniciar LED\r\n"
-        "  led_board stop - Detener LED\r\n"
-        "  sensors start - Iniciamos lectura de sensores\r\n"
-        "  sensors stop - Detenemos lectura de sensores\r\n"
+        "Comandos disponibles (help <grupo> para ver cada uno):\r\n"
+        "  help audio - Volumen, ecualizacion, balance, DSP, contadores y perfiles de audio\r\n"
+        "  help sensores - LEDs, sensores, gestos, pots, slots, asociaciones y atajos\r\n"
+        "  help bt - Canal binario, suscripciones, sesiones SPP y QoS\r\n"
+        "  help sistema - Estado, arranque, tareas, bus, energia, memoria y traza\r\n"
+        "  help - Comando de ayuda, desplegamos los grupos de comandos\r\n";
+
+static const char help_audio[] =
+        "Comandos de audio:\r\n"
         "  set_volume 70 - Definimos volumen del dispositivo\r\n"
         "  eq flat - Cambiamos ecualizacion a defecto, flat\r\n"
         "  eq bass_boost - Cambiamos ecualizacion para bajos, bass_boost\r\n"
@@ -25,5 +22,72 @@ const char cmd_commands[] =
         "  headphone_balance -0.2 - Cambiamos balance de los audifonos, desplazamos a izquierda o derecha\r\n"
         "  dsp enabled - Activamos DSP, filtrado de audio\r\n"
         "  dsp disabled - Desactivamos DSP, dejamos audio como venga del sistema\r\n"
+        "  dsp bench 2048 - Costo del DSP por preset y frecuencia con ese bloque en bytes (audio parado)\r\n"
+        "  audio - Latencia de cola, ciclos del DSP, escrituras cortas y underruns del camino de audio\r\n"
+        "  audio reset - Pone en cero los contadores de audio\r\n"
+        "  profile - Perfiles de audio guardados, el activo y escrituras a NVS hechas y evitadas\r\n"
+        "  profile load 1 - Carga y aplica un perfil guardado (0-3)\r\n"
+        "  profile save 1 noche - Guarda el estado del DSP como perfil con nombre y lo deja activo\r\n";
+
+static const char help_sensors[] =
+        "Comandos de sensores:\r\n"
+        "  led_board start - Iniciar LED\r\n"
+        "  led_board stop - Detener LED\r\n"
+        "  sensors start - Iniciamos lectura de sensores\r\n"
+        "  sensors stop - Detenemos lectura de sensores\r\n"
+        "  gestures - Tiempos, reglas y costo del reconocedor de gestos de botones\r\n"
+        "  gestures on|off - Gestos (tap, doble, largo, repeticion, acorde) o eventos crudos\r\n"
+        "  gestures set long 600 - Cambia un tiempo: double, long, repeat o chord (ms)\r\n"
+        "  pots - Muestreo continuo de potenciometros: frecuencia, filtro, valores y ciclos por muestra\r\n"
+        "  pots rate 20000 - Frecuencia total del ADC1 en Hz (minimo 20000)\r\n"
+        "  pots filter 64 2 3 - Diezmado, suavizado (1/2^n) y banda muerta en LSB\r\n"
+        "  pots cal 1 min - Captura min, centre o max del pot con su posicion actual (clear los borra)\r\n"
+        "  pots cal save - Guarda los puntos de calibracion de los pots en NVS\r\n"
+        "  slots - Tabla de los 12 slots de sensores y su planificacion\r\n"
+        "  slots rate 1 20 1000 - Periodo de un slot de pot en movimiento y en reposo (ms)\r\n"
+        "  slots report 1 50 5000 - Intervalo minimo entre reportes y latido de un slot (ms)\r\n"
+        "  slots save|reset - Guarda la tabla y las asociaciones en NVS o vuelve a la de la placa al reiniciar\r\n"
+        "  bind - Asociaciones de pots a volumen, balance, EQ o limitador evaluadas en el equipo\r\n"
+        "  bind 1 volume log 0 100 1 - Asocia un slot de pot: parametro, curva, rango y suavizado (off la quita)\r\n"
+        "  keys - Tabla de atajos (accion de gesto -> tecla, tecla multimedia o macro) y reportes emitidos\r\n"
+        "  keys 7 key 01 06 - Asigna a una accion tecla HID con modificadores en hex (ctrl+c); media cd, macro 0 u off\r\n"
+        "  keys macro 0 02:0b 00:08 - Define un macro como pasos mod:tecla en hex\r\n"
+        "  keys on|off - Activa o detiene los reportes hacia los suscriptores de keys\r\n";
+
+static const char help_bt[] =
+        "Comandos de Bluetooth (SPP):\r\n"
+        "  bin_mode on - Canal binario de control (solo BT), opcode 0x7F vuelve a texto\r\n"
+        "  subscribe sensors|meters|logs|keys|audio - Suscribe esta sesion BT a un tema\r\n"
+        "  unsubscribe sensors|meters|logs|keys|audio - Cancela la suscripcion a un tema\r\n"
+        "  sessions - Clientes SPP conectados y sus colas\r\n"
+        "  qos - Presupuesto SPP con audio, underruns y latencia por politica\r\n"
+        "  qos on|off - Activa o desactiva el limite de SPP mientras suena audio\r\n"
+        "  qos budget 2048 - Bytes por segundo para SPP mientras suena audio\r\n";
+
+static const char help_system[] =
+        "Comandos de sistema:\r\n"
         "  status - Estado de variables y tasks\r\n"
-        "  help - Comando de ayuda, desplegamos comandos disponibles\r\n";
\ No newline at end of file
+        "  status bin - Estado en trama binaria para Melquiades Desktop\r\n"
+        "  ping 1 - Responde pong 1 con la hora del equipo, para sincronizar relojes y medir latencia\r\n"
+        "  boot_profile - Tiempos de cada fase del arranque hasta el primer sample audible\r\n"
+        "  tasks - Tabla de tareas estaticas: core, prioridad, stack, minimo libre y estado\r\n"
+        "  bus - Eventos por tema del bus interno (publicados, por segundo, perdidos) y colas\r\n"
+        "  power - Modo de energia (audio, activo, reposo), locks de esp_pm y tiempo en cada modo\r\n"
+        "  mem - Heap, reservas por modulo (build con MEM_TRACK=1) y minimo libre de cada stack\r\n"
+        "  trace - Vuelca en texto y consume la traza binaria de los caminos calientes\r\n"
+        "  trace bin - Igual en tramas binarias para trace-decode en el host\r\n"
+        "  trace clear - Descarta la traza pendiente\r\n";
+
+const cmd_help_group_t cmd_help_groups[] = {
+    {"audio", help_audio},
+    {"sensores", help_sensors},
+    {"bt", help_bt},
+    {"sistema", help_system},
+};
+const size_t cmd_help_group_count = sizeof(cmd_help_groups) / sizeof(cmd_help_groups[0]);
+
+_Static_assert(sizeof(cmd_commands) <= SHELL_RESPONSE_SIZE, "La ayuda no entra en la respuesta del shell");
+_Static_assert(sizeof(help_audio) <= SHELL_RESPONSE_SIZE, "help audio no entra en la respuesta del shell");
+_Static_assert(sizeof(help_sensors) <= SHELL_RESPONSE_SIZE, "help sensores no entra en la respuesta del shell");
+_Static_assert(sizeof(help_bt) <= SHELL_RESPONSE_SIZE, "help bt no entra en la respuesta del shell");
+_Static_assert(sizeof(help_system) <= SHELL_RESPONSE_SIZE, "help sistema no entra en la respuesta del shell");
@@ -4,17 +4,17 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <stdbool.h>
+#include <stddef.h>
 
-// Estados booleanos
-extern bool sensors_streaming_bt;
-extern bool sensors_streaming_uart;
-
-// TaskHandles globales
-extern TaskHandle_t tasl_ledboard_handle;
-extern TaskHandle_t task_pot_handle;
-extern TaskHandle_t task_btn_handle;
+// Grupo de la ayuda que se muestra con "help <nombre>"
+typedef struct {
+    const char *name;
+    const char *text;
+} cmd_help_group_t;
 
 //chars
 extern const char cmd_commands[];
+extern const cmd_help_group_t cmd_help_groups[];
+extern const size_t cmd_help_group_count;
 
 #endif // STATE_H
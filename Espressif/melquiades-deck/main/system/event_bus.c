@@ -0,0 +1,246 @@
+#include "event_bus.h"
+//Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define TAG "EVENT_BUS"
+
+#define QUEUE_MASK (EVENT_BUS_QUEUE_LEN - 1)
+
+_Static_assert((EVENT_BUS_QUEUE_LEN & QUEUE_MASK) == 0, "EVENT_BUS_QUEUE_LEN debe ser potencia de dos");
+_Static_assert(sizeof(bus_event_t) == 20, "bus_event_t cambio de tamano");
+
+// Celda de la cola: seq dice si esta libre para la vuelta actual del productor o lista para el
+// consumidor (cola acotada MPMC de Vyukov: un CAS para reservar la posicion y nada mas)
+typedef struct {
+    uint32_t seq;
+    bus_event_t event;
+} bus_cell_t;
+
+typedef struct {
+    const char *name;
+    uint32_t topics;
+    TaskHandle_t notify;
+    uint32_t enqueue_pos;
+    uint32_t dequeue_pos;
+    uint32_t received;
+    uint32_t dropped;
+    uint32_t depth_max;
+    bus_cell_t cells[EVENT_BUS_QUEUE_LEN];
+} bus_subscriber_t;
+
+static const char *topic_names[BUS_TOPIC_COUNT] = {"sensor", "control", "transport", "telemetry"};
+
+static bus_subscriber_t subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+static uint32_t subscriber_count = 0;
+static bus_topic_stats_t topic_stats[BUS_TOPIC_COUNT];
+static portMUX_TYPE subscribe_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Ultima consulta del comando bus, para calcular eventos por segundo
+static uint32_t prev_published[BUS_TOPIC_COUNT];
+static int64_t prev_format_us = 0;
+
+int event_bus_subscribe(const char *name, uint32_t topics, TaskHandle_t notify)
+{
+    int id = -1;
+    portENTER_CRITICAL(&subscribe_lock);
+    if (subscriber_count < EVENT_BUS_MAX_SUBSCRIBERS) {
+        id = (int)subscriber_count;
+        bus_subscriber_t *s = &subscribers[id];
+        s->name = name;
+        s->topics = topics;
+        s->notify = notify;
+        s->enqueue_pos = 0;
+        s->dequeue_pos = 0;
+        for (uint32_t i = 0; i < EVENT_BUS_QUEUE_LEN; i++) {
+            s->cells[i].seq = i;
+        }
+        // Los publicadores solo ven al suscriptor con su cola ya inicializada
+        __atomic_store_n(&subscriber_count, subscriber_count + 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&subscribe_lock);
+    if (id < 0) {
+        ESP_LOGE(TAG, "Sin lugar para el suscriptor %s", name);
+    }
+    return id;
+}
+
+static bool queue_push(bus_subscriber_t *s, const bus_event_t *event)
+{
+    uint32_t pos = __atomic_load_n(&s->enqueue_pos, __ATOMIC_RELAXED);
+    while (1) {
+        bus_cell_t *cell = &s->cells[pos & QUEUE_MASK];
+        uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            // Celda libre: se reserva la posicion; si otro productor gano, pos queda actualizado
+            if (__atomic_compare_exchange_n(&s->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->event = *event;
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (diff < 0) {
+            // El consumidor aun no libero la celda de la vuelta anterior: cola llena
+            return false;
+        } else {
+            pos = __atomic_load_n(&s->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static bool queue_pop(bus_subscriber_t *s, bus_event_t *event)
+{
+    uint32_t pos = __atomic_load_n(&s->dequeue_pos, __ATOMIC_RELAXED);
+    while (1) {
+        bus_cell_t *cell = &s->cells[pos & QUEUE_MASK];
+        uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&s->dequeue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *event = cell->event;
+                __atomic_store_n(&cell->seq, pos + EVENT_BUS_QUEUE_LEN, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&s->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void wake(TaskHandle_t task)
+{
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        xTaskNotifyGive(task);
+    }
+}
+
+int event_bus_publish(bus_topic_t topic, bus_event_type_t type, const uint32_t *u, const float *f)
+{
+    if (topic >= BUS_TOPIC_COUNT) {
+        return 0;
+    }
+    bus_event_t event = {
+        .topic = (uint8_t)topic,
+        .type = (uint8_t)type,
+        .stamp_ms = (uint32_t)(esp_timer_get_time() / 1000),
+    };
+    if (u != NULL) {
+        memcpy(event.u, u, sizeof(event.u));
+    } else if (f != NULL) {
+        memcpy(event.f, f, sizeof(event.f));
+    }
+    bus_topic_stats_t *stats = &topic_stats[topic];
+    __atomic_fetch_add(&stats->published, 1, __ATOMIC_RELAXED);
+
+    uint32_t mask = BUS_TOPIC_MASK(topic);
+    uint32_t count = __atomic_load_n(&subscriber_count, __ATOMIC_ACQUIRE);
+    int delivered = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        bus_subscriber_t *s = &subscribers[i];
+        if ((s->topics & mask) == 0) {
+            continue;
+        }
+        if (!queue_push(s, &event)) {
+            __atomic_fetch_add(&s->dropped, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&stats->dropped, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        // Profundidad aproximada: alcanza para dimensionar la cola
+        uint32_t depth = __atomic_load_n(&s->enqueue_pos, __ATOMIC_RELAXED) -
+                         __atomic_load_n(&s->dequeue_pos, __ATOMIC_RELAXED);
+        if (depth > s->depth_max && depth <= EVENT_BUS_QUEUE_LEN) {
+            s->depth_max = depth;
+        }
+        delivered++;
+        if (s->notify != NULL) {
+            wake(s->notify);
+        }
+    }
+    __atomic_fetch_add(&stats->delivered, (uint32_t)delivered, __ATOMIC_RELAXED);
+    return delivered;
+}
+
+int event_bus_publish_u32(bus_topic_t topic, bus_event_type_t type, uint32_t value)
+{
+    uint32_t u[3] = {value, 0, 0};
+    return event_bus_publish(topic, type, u, NULL);
+}
+
+bool event_bus_receive(int subscriber, bus_event_t *event)
+{
+    if (subscriber < 0 || (uint32_t)subscriber >= __atomic_load_n(&subscriber_count, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    bus_subscriber_t *s = &subscribers[subscriber];
+    if (!queue_pop(s, event)) {
+        return false;
+    }
+    __atomic_fetch_add(&s->received, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+void event_bus_get_topic_stats(bus_topic_t topic, bus_topic_stats_t *stats)
+{
+    if (topic >= BUS_TOPIC_COUNT) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    stats->published = __atomic_load_n(&topic_stats[topic].published, __ATOMIC_RELAXED);
+    stats->delivered = __atomic_load_n(&topic_stats[topic].delivered, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&topic_stats[topic].dropped, __ATOMIC_RELAXED);
+}
+
+size_t event_bus_format_text(char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    if (size == 0) {
+        return 0;
+    }
+    int64_t now_us = esp_timer_get_time();
+    int64_t elapsed_us = prev_format_us > 0 ? now_us - prev_format_us : now_us;
+    prev_format_us = now_us;
+
+    n = snprintf(out, size, "Tema        publicados  ev/s  entregados  perdidos\n");
+    len = n > 0 && (size_t)n < size ? (size_t)n : 0;
+    for (int t = 0; t < BUS_TOPIC_COUNT && len < size; t++) {
+        bus_topic_stats_t stats;
+        event_bus_get_topic_stats((bus_topic_t)t, &stats);
+        uint32_t rate_x10 = elapsed_us > 0 ?
+            (uint32_t)((uint64_t)(stats.published - prev_published[t]) * 10000000ULL / (uint64_t)elapsed_us) : 0;
+        prev_published[t] = stats.published;
+        n = snprintf(out + len, size - len, "%-10s %11u %3u.%u %11u %9u\n", topic_names[t], stats.published,
+                     rate_x10 / 10, rate_x10 % 10, stats.delivered, stats.dropped);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    uint32_t count = __atomic_load_n(&subscriber_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count && len < size; i++) {
+        const bus_subscriber_t *s = &subscribers[i];
+        char topics[48] = "";
+        size_t tl = 0;
+        for (int t = 0; t < BUS_TOPIC_COUNT; t++) {
+            if (s->topics & BUS_TOPIC_MASK(t)) {
+                int w = snprintf(topics + tl, sizeof(topics) - tl, "%s%s", tl > 0 ? "," : "", topic_names[t]);
+                tl += w > 0 && (size_t)w < sizeof(topics) - tl ? (size_t)w : 0;
+            }
+        }
+        uint32_t pending = __atomic_load_n(&s->enqueue_pos, __ATOMIC_RELAXED) -
+                           __atomic_load_n(&s->dequeue_pos, __ATOMIC_RELAXED);
+        n = snprintf(out + len, size - len, "Suscriptor %s (%s): recibidos %u, perdidos %u, cola %u/%u (max %u)\n",
+                     s->name, topics, s->received, s->dropped, pending, EVENT_BUS_QUEUE_LEN, s->depth_max);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,108 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Bus de eventos entre modulos: cada suscriptor tiene una cola MPMC sin candados, de tamano fijo
+// y reservada en .bss. Publicar copia un evento de 20 bytes en la cola de cada suscriptor del
+// tema, sin memoria dinamica y sin bloquear; si la cola esta llena el evento se cuenta como
+// perdido. Se puede publicar desde el callback de audio o una ISR. Por eso el bus no lleva estado
+// que no se pueda perder: los controles del DSP se entregan enteros con audio_output_post_controls.
+
+#define EVENT_BUS_MAX_SUBSCRIBERS   4
+#define EVENT_BUS_QUEUE_LEN         32      // Potencia de dos
+
+typedef enum {
+    BUS_TOPIC_SENSOR = 0,       // Gestos de botones y cambios de pots
+    BUS_TOPIC_CONTROL,          // Avisos de cambios del DSP (el estado no viaja por el bus)
+    BUS_TOPIC_TRANSPORT,        // Estado de A2DP y de las sesiones SPP
+    BUS_TOPIC_TELEMETRY,        // Underruns y paquetes descartados del camino de audio
+    BUS_TOPIC_COUNT
+} bus_topic_t;
+
+#define BUS_TOPIC_MASK(topic) (1u << (topic))
+
+typedef enum {
+    // BUS_TOPIC_SENSOR
+    BUS_SENSOR_GESTURE = 0,     // u[0] boton, u[1] tipo de gesto, u[2] accion
+    BUS_SENSOR_POT,             // u[0] slot, u[1] valor de 12 bits
+    // BUS_TOPIC_CONTROL
+    BUS_CONTROL_DSP,            // u[0] volumen; aviso de cambio, el estado va por audio_output_post_controls
+    // BUS_TOPIC_TRANSPORT
+    BUS_TRANSPORT_A2DP_CONN,    // u[0] esp_a2d_connection_state_t
+    BUS_TRANSPORT_A2DP_AUDIO,   // u[0] 1 si el audio A2DP esta iniciado
+    BUS_TRANSPORT_SAMPLE_RATE,  // u[0] Hz
+    BUS_TRANSPORT_SPP_OPEN,     // u[0] sesion
+    BUS_TRANSPORT_SPP_CLOSE,    // u[0] sesion
+    // BUS_TOPIC_TELEMETRY
+    BUS_TELEMETRY_UNDERRUN,     // u[0] hueco en us
+    BUS_TELEMETRY_RING_DROP,    // u[0] bytes descartados
+} bus_event_type_t;
+
+// Evento de tamano fijo; el significado de la carga depende del tipo
+typedef struct {
+    uint8_t topic;
+    uint8_t type;
+    uint16_t reserved;
+    uint32_t stamp_ms;
+    union {
+        uint32_t u[3];
+        float f[3];
+    };
+} bus_event_t;
+
+// Contadores de un tema desde el arranque
+typedef struct {
+    uint32_t published;
+    uint32_t delivered;         // Copias entregadas a colas de suscriptores
+    uint32_t dropped;           // Copias perdidas por cola llena
+} bus_topic_stats_t;
+
+/**
+ * @brief Registra un suscriptor con su propia cola; se llama una vez al iniciar cada modulo
+ *
+ * @param name Nombre para el comando bus
+ * @param topics Mascara de BUS_TOPIC_MASK
+ * @param notify Tarea a despertar con xTaskNotifyGive al llegar un evento, NULL para no avisar
+ * @return int Id del suscriptor, -1 si no quedan lugares
+ */
+int event_bus_subscribe(const char *name, uint32_t topics, TaskHandle_t notify);
+
+/**
+ * @brief Publica un evento a todos los suscriptores del tema, sin bloquear ni reservar memoria
+ *
+ * @param u Tres enteros de carga, o NULL
+ * @param f Tres floats de carga si u es NULL, o NULL para carga en cero
+ * @return int Suscriptores que lo recibieron
+ */
+int event_bus_publish(bus_topic_t topic, bus_event_type_t type, const uint32_t *u, const float *f);
+
+/**
+ * @brief Atajo para eventos con un solo entero
+ */
+int event_bus_publish_u32(bus_topic_t topic, bus_event_type_t type, uint32_t value);
+
+/**
+ * @brief Saca el evento mas viejo de la cola de un suscriptor
+ *
+ * @return true si habia un evento
+ */
+bool event_bus_receive(int subscriber, bus_event_t *event);
+
+/**
+ * @brief Contadores de un tema
+ */
+void event_bus_get_topic_stats(bus_topic_t topic, bus_topic_stats_t *stats);
+
+/**
+ * @brief Formatea temas con eventos por segundo desde la consulta anterior y las colas
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t event_bus_format_text(char *out, size_t size);
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,168 @@
+#include "mem_track.h"
+//Bibliotecas de sistema
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#define TAG "MEM_TRACK"
+
+#define REPORT_MAGIC    0x4D454D54u     // "MEMT", para reconocer el bloque en el core dump
+#define HEADER_MAGIC    0xA110u
+
+// Cabecera delante de cada reserva; 8 bytes para no perder la alineacion de malloc
+typedef struct {
+    uint32_t size;
+    uint16_t module;
+    uint16_t magic;
+} mem_header_t;
+
+_Static_assert(sizeof(mem_header_t) == 8, "mem_header_t debe ocupar 8 bytes");
+
+static const char *module_names[MEM_MOD_COUNT] = {"audio", "bench", "telemetry", "otros"};
+
+COREDUMP_DRAM_ATTR mem_track_report_t mem_track_report = {.magic = REPORT_MAGIC};
+
+static void raise_peak(mem_module_stats_t *m, uint32_t live)
+{
+    uint32_t peak = __atomic_load_n(&m->peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak &&
+           !__atomic_compare_exchange_n(&m->peak_bytes, &peak, live, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void *mem_track_malloc(mem_module_t module, size_t size)
+{
+    if (module >= MEM_MOD_COUNT) {
+        module = MEM_MOD_OTHER;
+    }
+    mem_module_stats_t *m = &mem_track_report.modules[module];
+    mem_header_t *header = malloc(sizeof(mem_header_t) + size);
+    if (header == NULL) {
+        __atomic_fetch_add(&m->failures, 1, __ATOMIC_RELAXED);
+        ESP_LOGE(TAG, "%s: sin memoria para %u B (libre %u B)", module_names[module], (uint32_t)size,
+                 esp_get_free_heap_size());
+        return NULL;
+    }
+    header->size = (uint32_t)size;
+    header->module = (uint16_t)module;
+    header->magic = HEADER_MAGIC;
+    __atomic_fetch_add(&m->allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->live_count, 1, __ATOMIC_RELAXED);
+    raise_peak(m, __atomic_add_fetch(&m->live_bytes, (uint32_t)size, __ATOMIC_RELAXED));
+    return header + 1;
+}
+
+void mem_track_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    mem_header_t *header = (mem_header_t *)ptr - 1;
+    if (header->magic != HEADER_MAGIC || header->module >= MEM_MOD_COUNT) {
+        // Reserva hecha con malloc directo: se libera igual, pero es un error de contabilidad
+        ESP_LOGE(TAG, "MEM_FREE de %p sin cabecera de MEM_MALLOC", ptr);
+        free(ptr);
+        return;
+    }
+    mem_module_stats_t *m = &mem_track_report.modules[header->module];
+    __atomic_fetch_sub(&m->live_bytes, header->size, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&m->live_count, 1, __ATOMIC_RELAXED);
+    header->magic = 0;
+    free(header);
+}
+
+void mem_track_sample(void)
+{
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    for (int i = 0; i < TASK_COUNT; i++) {
+        TaskHandle_t handle = task_table_handle((task_id_t)i);
+        if (handle == NULL) {
+            continue;
+        }
+        uint32_t free_bytes = (uint32_t)uxTaskGetStackHighWaterMark(handle);
+        mem_stack_stats_t *s = &mem_track_report.stacks[i];
+        if (s->min_free == 0 || free_bytes < s->min_free) {
+            s->min_free = free_bytes;
+            s->min_at_ms = now_ms;
+        }
+    }
+    mem_track_report.heap_free = esp_get_free_heap_size();
+    mem_track_report.heap_min_free = esp_get_minimum_free_heap_size();
+    mem_track_report.sampled_ms = now_ms;
+}
+
+#if MEM_TRACK
+static esp_timer_handle_t sample_timer = NULL;
+
+static void sample_timer_cb(void *arg)
+{
+    mem_track_sample();
+}
+#endif
+
+void mem_track_init(void)
+{
+#if MEM_TRACK
+    const esp_timer_create_args_t timer_args = {
+        .callback = sample_timer_cb,
+        .name = "mem_track"
+    };
+    if (esp_timer_create(&timer_args, &sample_timer) != ESP_OK ||
+        esp_timer_start_periodic(sample_timer, (uint64_t)MEM_TRACK_SAMPLE_MS * 1000) != ESP_OK) {
+        ESP_LOGE(TAG, "No se pudo iniciar el muestreo de memoria");
+        return;
+    }
+    ESP_LOGI(TAG, "Contabilidad de memoria activa, muestreo cada %d ms", MEM_TRACK_SAMPLE_MS);
+#endif
+}
+
+size_t mem_track_format(char *out, size_t size)
+{
+    size_t len = 0;
+    int n;
+    if (size == 0) {
+        return 0;
+    }
+    // Sin el timer del modo de depuracion el muestreo se hace al consultar
+    mem_track_sample();
+    n = snprintf(out, size, "Heap: libre %u B, minimo %u B\n", mem_track_report.heap_free,
+                 mem_track_report.heap_min_free);
+    len = n > 0 && (size_t)n < size ? (size_t)n : 0;
+
+    if (len < size) {
+        if (MEM_TRACK) {
+            n = snprintf(out + len, size - len, "Modulo      vivos  bytes   pico  reservas  fallos\n");
+        } else {
+            n = snprintf(out + len, size - len, "Reservas por modulo: compile con -DMEM_TRACK=1\n");
+        }
+        len += n > 0 ? (size_t)n : 0;
+    }
+    for (int i = 0; MEM_TRACK && i < MEM_MOD_COUNT && len < size; i++) {
+        const mem_module_stats_t *m = &mem_track_report.modules[i];
+        n = snprintf(out + len, size - len, "%-10s %6u %6u %6u %9u %7u\n", module_names[i], m->live_count,
+                     m->live_bytes, m->peak_bytes, m->allocs, m->failures);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    if (len < size) {
+        n = snprintf(out + len, size - len, "Tarea               stack  min libre  uso max  visto a (s)\n");
+        len += n > 0 ? (size_t)n : 0;
+    }
+    for (int i = 0; i < TASK_COUNT && len < size; i++) {
+        const mem_stack_stats_t *s = &mem_track_report.stacks[i];
+        uint32_t stack = task_table_stack_size((task_id_t)i);
+        if (s->min_free == 0) {
+            n = snprintf(out + len, size - len, "%-18s %6u          -        -            -\n",
+                         task_table_name((task_id_t)i), stack);
+        } else {
+            uint32_t used_pct = stack > 0 ? (stack - s->min_free) * 100 / stack : 0;
+            n = snprintf(out + len, size - len, "%-18s %6u %10u %7u%% %12.1f\n", task_table_name((task_id_t)i),
+                         stack, s->min_free, used_pct, s->min_at_ms / 1000.0);
+        }
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,91 @@
+#ifndef MEM_TRACK_H
+#define MEM_TRACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "task_table.h"
+
+// Contabilidad de memoria para dimensionar stacks y buffers con datos. Con MEM_TRACK=1 (build de
+// depuracion: idf.py -DMEM_TRACK=1 build) cada MEM_MALLOC guarda su tamano y modulo en una
+// cabecera de 8 bytes y se llevan bytes vivos, pico, cantidad y fallos por modulo. Un esp_timer
+// muestrea cada segundo el minimo libre del stack de cada tarea de la tabla. El reporte vive en
+// una seccion que entra en el core dump: despues de un reset por memoria se lee con
+// "idf.py coredump-info" y "p mem_track_report". Sin MEM_TRACK las macros son malloc y free.
+
+#ifndef MEM_TRACK
+#define MEM_TRACK 0
+#endif
+
+#define MEM_TRACK_SAMPLE_MS     1000
+
+// Modulo duenio de cada reserva
+typedef enum {
+    MEM_MOD_AUDIO = 0,          // Buffers del camino de audio
+    MEM_MOD_BENCH,              // Benchmark del DSP
+    MEM_MOD_TELEMETRY,          // Capturas de estado
+    MEM_MOD_OTHER,
+    MEM_MOD_COUNT
+} mem_module_t;
+
+typedef struct {
+    uint32_t live_bytes;
+    uint32_t live_count;
+    uint32_t peak_bytes;
+    uint32_t allocs;
+    uint32_t failures;          // malloc devolvio NULL
+} mem_module_stats_t;
+
+typedef struct {
+    uint32_t min_free;          // Bytes, 0 si la tarea aun no se muestreo
+    uint32_t min_at_ms;         // Cuando se vio ese minimo por primera vez
+} mem_stack_stats_t;
+
+// Todo lo que se necesita despues de un crash, sin punteros para leerlo directo del core dump
+typedef struct {
+    uint32_t magic;
+    uint32_t sampled_ms;        // Ultimo muestreo
+    uint32_t heap_free;
+    uint32_t heap_min_free;
+    mem_module_stats_t modules[MEM_MOD_COUNT];
+    mem_stack_stats_t stacks[TASK_COUNT];
+} mem_track_report_t;
+
+extern mem_track_report_t mem_track_report;
+
+#if MEM_TRACK
+#define MEM_MALLOC(module, size)    mem_track_malloc((module), (size))
+#define MEM_FREE(ptr)               mem_track_free(ptr)
+#else
+#define MEM_MALLOC(module, size)    malloc(size)
+#define MEM_FREE(ptr)               free(ptr)
+#endif
+
+/**
+ * @brief malloc con cabecera y contadores del modulo; usar con MEM_MALLOC
+ */
+void *mem_track_malloc(mem_module_t module, size_t size);
+
+/**
+ * @brief free de una reserva de mem_track_malloc; usar con MEM_FREE
+ */
+void mem_track_free(void *ptr);
+
+/**
+ * @brief Arranca el muestreo periodico de stacks y heap; sin MEM_TRACK no hace nada
+ */
+void mem_track_init(void);
+
+/**
+ * @brief Muestrea ahora el heap y el minimo libre de cada stack de la tabla de tareas
+ */
+void mem_track_sample(void);
+
+/**
+ * @brief Formatea heap, reservas por modulo y minimo libre de cada stack
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t mem_track_format(char *out, size_t size);
+
+#endif // MEM_TRACK_H
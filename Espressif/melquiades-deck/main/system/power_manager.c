@@ -0,0 +1,169 @@
+#include "power_manager.h"
+//Bibliotecas de sistema
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "sdkconfig.h"
+//bibliotecas custom
+#include "power_policy.h"
+#include "event_bus.h"
+#include "task_table.h"
+#include "../sensors/buttons.h"
+#include "../sensors/sensor_scheduler.h"
+#include "../bluetooth/a2dp_sink.h"
+#include "../bluetooth/spp_session.h"
+#include "../telemetry/trace_log.h"
+
+#define TAG "POWER"
+
+#define POWER_MIN_FREQ_MHZ      80      // Minimo con el APB a 80 MHz que piden I2S y el ADC
+#define POWER_AUDIO_HOLD_MS     5000    // Pausa entre temas sin soltar la CPU
+#define POWER_ACTIVE_HOLD_MS    10000   // Tras el ultimo gesto o giro
+#define POWER_POLL_MS           1000    // El stream de sensores por UART/BT se consulta, no llega por el bus
+
+static power_policy_t policy;
+static esp_pm_lock_handle_t cpu_lock = NULL;        // ESP_PM_CPU_FREQ_MAX
+static esp_pm_lock_handle_t awake_lock = NULL;      // ESP_PM_NO_LIGHT_SLEEP
+static bool cpu_held = false;
+static bool awake_held = false;
+static bool pm_enabled = false;
+static portMUX_TYPE power_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void set_lock(esp_pm_lock_handle_t lock, bool *held, bool want)
+{
+    if (*held == want) {
+        return;
+    }
+    if (lock != NULL) {
+        if (want) {
+            esp_pm_lock_acquire(lock);
+        } else {
+            esp_pm_lock_release(lock);
+        }
+    }
+    *held = want;
+}
+
+// El lock de light sleep se toma antes y se suelta despues que el de CPU: el equipo nunca
+// duerme con la CPU todavia fijada para el audio
+static void apply_mode(power_mode_t mode)
+{
+    bool want_awake = mode != POWER_MODE_IDLE;
+    if (want_awake) {
+        set_lock(awake_lock, &awake_held, true);
+    }
+    set_lock(cpu_lock, &cpu_held, mode == POWER_MODE_AUDIO);
+    if (!want_awake) {
+        set_lock(awake_lock, &awake_held, false);
+    }
+    sensor_scheduler_set_low_power(mode == POWER_MODE_IDLE);
+}
+
+static void power_task(void *pvParameters)
+{
+    int subscriber = event_bus_subscribe("power", BUS_TOPIC_MASK(BUS_TOPIC_SENSOR) |
+                                                  BUS_TOPIC_MASK(BUS_TOPIC_TRANSPORT),
+                                         xTaskGetCurrentTaskHandle());
+    power_mode_t mode = POWER_MODE_ACTIVE;
+    while (1) {
+        bus_event_t ev;
+        bool activity = false;
+        while (event_bus_receive(subscriber, &ev)) {
+            if (ev.topic == BUS_TOPIC_SENSOR) {
+                activity = true;
+            }
+        }
+        power_inputs_t in = {
+            .audio_streaming = a2dp_is_streaming(),
+            // Una asociacion necesita el ADC a 10 ms, el drenado de 80 ms del bajo consumo la frenaria
+            .sensors_streaming = sensor_scheduler_uart_stream() || spp_topic_has_subscribers(SPP_TOPIC_SENSORS) ||
+                                 sensor_scheduler_bindings_active(),
+            .activity = activity,
+        };
+        uint32_t now = now_ms();
+        portENTER_CRITICAL(&power_lock);
+        power_mode_t next = power_policy_step(&policy, &in, now);
+        uint32_t wait = power_policy_next_change_ms(&policy, now);
+        portEXIT_CRITICAL(&power_lock);
+
+        if (next != mode) {
+            TRACE_D(TAG, "Modo de energia %d -> %d", mode, next);
+            mode = next;
+        }
+        apply_mode(mode);
+        if (wait > POWER_POLL_MS) {
+            wait = POWER_POLL_MS;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait) + 1);
+    }
+}
+
+void power_manager_init(void)
+{
+    esp_pm_config_esp32_t cfg = {
+        .max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+    esp_err_t ret = esp_pm_configure(&cfg);
+    if (ret == ESP_OK) {
+        pm_enabled = true;
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "power_audio", &cpu_lock);
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "power_active", &awake_lock);
+    } else {
+        // Sin CONFIG_PM_ENABLE la politica corre igual y solo se cuentan los modos
+        ESP_LOGW(TAG, "Gestion de energia no disponible: %s", esp_err_to_name(ret));
+    }
+    if (pulsadores_enable_wakeup() != ESP_OK) {
+        ESP_LOGW(TAG, "Los botones no despiertan del light sleep");
+    }
+    power_policy_config_t policy_cfg = {
+        .audio_hold_ms = POWER_AUDIO_HOLD_MS,
+        .active_hold_ms = POWER_ACTIVE_HOLD_MS,
+    };
+    power_policy_init(&policy, &policy_cfg, now_ms());
+    apply_mode(POWER_MODE_ACTIVE);
+    task_table_create(TASK_POWER, power_task, NULL);
+}
+
+size_t power_manager_format(char *out, size_t size)
+{
+    uint64_t residency[POWER_MODE_COUNT];
+    uint32_t entries[POWER_MODE_COUNT];
+    uint64_t total = 0;
+    power_mode_t mode;
+    size_t len = 0;
+    int n;
+    if (size == 0) {
+        return 0;
+    }
+    portENTER_CRITICAL(&power_lock);
+    power_policy_residency(&policy, now_ms(), residency);
+    for (int i = 0; i < POWER_MODE_COUNT; i++) {
+        entries[i] = policy.entries[i];
+        total += residency[i];
+    }
+    mode = policy.mode;
+    portEXIT_CRITICAL(&power_lock);
+
+    n = snprintf(out, size, "Modo: %s, esp_pm: %s (%d-%d MHz), CPU al maximo: %s, light sleep bloqueado: %s\n"
+                 "Modo       tiempo (s)      %%  entradas\n",
+                 power_mode_name(mode), pm_enabled ? "activo" : "no disponible", POWER_MIN_FREQ_MHZ,
+                 CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ, cpu_held ? "si" : "no", awake_held ? "si" : "no");
+    len = n > 0 && (size_t)n < size ? (size_t)n : 0;
+    for (int i = 0; i < POWER_MODE_COUNT && len < size; i++) {
+        uint32_t pct_x10 = total > 0 ? (uint32_t)(residency[i] * 1000 / total) : 0;
+        n = snprintf(out + len, size - len, "%-8s %12.1f %4u.%u %9u\n", power_mode_name((power_mode_t)i),
+                     (double)residency[i] / 1000.0, pct_x10 / 10, pct_x10 % 10, entries[i]);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,28 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stddef.h>
+
+// Gestion de energia: configura el escalado de frecuencia y el light sleep automatico de esp_pm
+// y toma locks segun el modo de power_policy. Con audio se fija la CPU al maximo, con sensores en
+// uso se impide el light sleep y en reposo se sueltan ambos. El estado del audio y los gestos
+// llegan por el bus de eventos; los botones despiertan al equipo por ext1 y los pots con el
+// temporizador del planificador de sensores.
+//
+// Con el reloj de bajo consumo de BT en el cristal principal (sdkconfig) el controlador no deja
+// entrar en light sleep mientras Bluetooth este activo; el ahorro en ese caso es el escalado de
+// frecuencia y el modem sleep de BT. Con un cristal de 32 kHz el mismo codigo duerme entre ticks.
+
+/**
+ * @brief Configura esp_pm, crea los locks y la tarea del gestor; llamar con los botones iniciados
+ */
+void power_manager_init(void);
+
+/**
+ * @brief Formatea el modo actual, los locks tomados y el tiempo en cada modo
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t power_manager_format(char *out, size_t size);
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,74 @@
+#include "power_policy.h"
+//Bibliotecas de sistema
+#include <string.h>
+
+static const char *mode_names[POWER_MODE_COUNT] = {"audio", "activo", "reposo"};
+
+// Los instantes son ms de 32 bits: las comparaciones por diferencia soportan el desborde
+static bool before(uint32_t now_ms, uint32_t until_ms)
+{
+    return (int32_t)(until_ms - now_ms) > 0;
+}
+
+void power_policy_init(power_policy_t *p, const power_policy_config_t *cfg, uint32_t now_ms)
+{
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+    p->mode = POWER_MODE_ACTIVE;
+    p->last_step_ms = now_ms;
+    p->audio_until_ms = now_ms;
+    p->active_until_ms = now_ms + cfg->active_hold_ms;
+    p->entries[POWER_MODE_ACTIVE] = 1;
+}
+
+power_mode_t power_policy_step(power_policy_t *p, const power_inputs_t *in, uint32_t now_ms)
+{
+    p->residency_ms[p->mode] += now_ms - p->last_step_ms;
+    p->last_step_ms = now_ms;
+
+    // La espera corre desde el paso en que se vio parar el stream, no desde el ultimo paso con stream
+    if (in->audio_streaming || p->audio_streaming) {
+        p->audio_until_ms = now_ms + p->cfg.audio_hold_ms;
+    }
+    if (in->activity || in->sensors_streaming || p->sensors_streaming) {
+        p->active_until_ms = now_ms + p->cfg.active_hold_ms;
+    }
+    p->audio_streaming = in->audio_streaming;
+    p->sensors_streaming = in->sensors_streaming;
+
+    power_mode_t next = POWER_MODE_IDLE;
+    if (in->audio_streaming || before(now_ms, p->audio_until_ms)) {
+        next = POWER_MODE_AUDIO;
+    } else if (before(now_ms, p->active_until_ms)) {
+        next = POWER_MODE_ACTIVE;
+    }
+    if (next != p->mode) {
+        p->mode = next;
+        p->entries[next]++;
+    }
+    return p->mode;
+}
+
+uint32_t power_policy_next_change_ms(const power_policy_t *p, uint32_t now_ms)
+{
+    uint32_t until_ms;
+    if (p->mode == POWER_MODE_AUDIO) {
+        until_ms = p->audio_until_ms;
+    } else if (p->mode == POWER_MODE_ACTIVE) {
+        until_ms = p->active_until_ms;
+    } else {
+        return UINT32_MAX;
+    }
+    return before(now_ms, until_ms) ? until_ms - now_ms : 0;
+}
+
+void power_policy_residency(const power_policy_t *p, uint32_t now_ms, uint64_t residency_ms[POWER_MODE_COUNT])
+{
+    memcpy(residency_ms, p->residency_ms, sizeof(p->residency_ms));
+    residency_ms[p->mode] += now_ms - p->last_step_ms;
+}
+
+const char *power_mode_name(power_mode_t mode)
+{
+    return mode < POWER_MODE_COUNT ? mode_names[mode] : "?";
+}
@@ -0,0 +1,69 @@
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Politica de energia sin dependencias del IDF: recibe el estado del audio y de los sensores y
+// decide el modo. Los tiempos de espera evitan saltar de modo en cada pausa entre temas o entre
+// dos giros de un pot. El power_manager traduce el modo a locks de esp_pm.
+
+typedef enum {
+    POWER_MODE_AUDIO = 0,       // Stream A2DP: CPU a la frecuencia maxima y sin light sleep
+    POWER_MODE_ACTIVE,          // Sensores en uso: sin light sleep para no cortar el ADC continuo
+    POWER_MODE_IDLE,            // Nada en curso: frecuencia minima y light sleep automatico
+    POWER_MODE_COUNT
+} power_mode_t;
+
+typedef struct {
+    uint32_t audio_hold_ms;     // Se sigue en AUDIO este tiempo despues de que para el stream
+    uint32_t active_hold_ms;    // Se sigue en ACTIVE este tiempo despues del ultimo gesto o giro
+} power_policy_config_t;
+
+// Entradas de un paso de la politica
+typedef struct {
+    bool audio_streaming;       // Audio A2DP iniciado
+    bool sensors_streaming;     // Alguien recibe los sensores en continuo (UART, BT o asociaciones)
+    bool activity;              // Hubo gestos o cambios de pots desde el paso anterior
+} power_inputs_t;
+
+typedef struct {
+    power_policy_config_t cfg;
+    power_mode_t mode;
+    uint32_t last_step_ms;
+    bool audio_streaming;       // Entradas del paso anterior
+    bool sensors_streaming;
+    uint32_t audio_until_ms;
+    uint32_t active_until_ms;
+    uint64_t residency_ms[POWER_MODE_COUNT];
+    uint32_t entries[POWER_MODE_COUNT];
+} power_policy_t;
+
+/**
+ * @brief Arranca la politica en ACTIVE: el arranque cuenta como actividad
+ */
+void power_policy_init(power_policy_t *p, const power_policy_config_t *cfg, uint32_t now_ms);
+
+/**
+ * @brief Avanza la politica con las entradas actuales y acumula el tiempo en el modo anterior
+ *
+ * @return power_mode_t Modo vigente despues del paso
+ */
+power_mode_t power_policy_step(power_policy_t *p, const power_inputs_t *in, uint32_t now_ms);
+
+/**
+ * @brief Milisegundos hasta que vence la espera del modo actual, UINT32_MAX si no hay ninguna
+ */
+uint32_t power_policy_next_change_ms(const power_policy_t *p, uint32_t now_ms);
+
+/**
+ * @brief Tiempo en cada modo incluyendo el tramo en curso hasta now_ms
+ */
+void power_policy_residency(const power_policy_t *p, uint32_t now_ms, uint64_t residency_ms[POWER_MODE_COUNT]);
+
+/**
+ * @brief Nombre corto del modo para el shell
+ */
+const char *power_mode_name(power_mode_t mode);
+
+#endif // POWER_POLICY_H
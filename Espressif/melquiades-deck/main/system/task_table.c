@@ -0,0 +1,225 @@
+#include "task_table.h"
+//Bibliotecas de sistema
+#include <stdio.h>
+#include "esp_log.h"
+
+#define TAG "TASK_TABLE"
+
+// Tamanos de stack en bytes (StackType_t es de un byte en el ESP32)
+#define AUDIO_I2S_STACK     4096
+#define AUDIO_BOOT_STACK    3072
+#define SPP_TX_STACK        3072
+#define BUTTONS_STACK       2560
+#define SENSORS_STACK       3072
+#define BT_SHELL_STACK      4096
+#define UART_SHELL_STACK    4096
+#define LED_BOARD_STACK     2048
+#define AUDIO_PROFILE_STACK 3072
+#define POWER_STACK         2560
+
+// Stacks y TCBs en .bss: el mapa de memoria queda fijo en el link y no pasa por el heap
+static StackType_t audio_i2s_stack[AUDIO_I2S_STACK];
+static StackType_t audio_boot_stack[AUDIO_BOOT_STACK];
+static StackType_t spp_tx_stack[SPP_TX_STACK];
+static StackType_t buttons_stack[BUTTONS_STACK];
+static StackType_t sensors_stack[SENSORS_STACK];
+static StackType_t bt_shell_stack[BT_SHELL_STACK];
+static StackType_t uart_shell_stack[UART_SHELL_STACK];
+static StackType_t led_board_stack[LED_BOARD_STACK];
+static StackType_t audio_profile_stack[AUDIO_PROFILE_STACK];
+static StackType_t power_stack[POWER_STACK];
+static StaticTask_t tcbs[TASK_COUNT];
+
+// Parametros fijos de cada tarea
+typedef struct {
+    const char *name;
+    StackType_t *stack;
+    uint32_t stack_size;
+    UBaseType_t priority;
+    BaseType_t core;
+    bool pausable;              // Arranca detenida y se controla con task_table_run/stop
+} task_spec_t;
+
+static const task_spec_t specs[TASK_COUNT] = {
+    [TASK_AUDIO_I2S] = {"audio_i2s_task", audio_i2s_stack, AUDIO_I2S_STACK,
+                        TASK_PRIO_AUDIO, TASK_CORE_AUDIO, true},
+    [TASK_AUDIO_BOOT] = {"audio_boot_task", audio_boot_stack, AUDIO_BOOT_STACK,
+                         TASK_PRIO_AUDIO_BOOT, TASK_CORE_AUDIO, false},
+    [TASK_SPP_TX] = {"spp_tx_task", spp_tx_stack, SPP_TX_STACK,
+                     TASK_PRIO_BT, TASK_CORE_SYSTEM, false},
+    [TASK_BUTTONS] = {"buttons_engine", buttons_stack, BUTTONS_STACK,
+                      TASK_PRIO_BUTTONS, TASK_CORE_SYSTEM, false},
+    [TASK_SENSORS] = {"sensor_scheduler", sensors_stack, SENSORS_STACK,
+                      TASK_PRIO_SENSORS, TASK_CORE_SYSTEM, false},
+    [TASK_BT_SHELL] = {"bt_shell_task", bt_shell_stack, BT_SHELL_STACK,
+                       TASK_PRIO_SHELL, TASK_CORE_SYSTEM, false},
+    [TASK_UART_SHELL] = {"uart_shell_task", uart_shell_stack, UART_SHELL_STACK,
+                         TASK_PRIO_SHELL, TASK_CORE_SYSTEM, false},
+    [TASK_LED_BOARD] = {"manage_led_board", led_board_stack, LED_BOARD_STACK,
+                        TASK_PRIO_LED, TASK_CORE_SYSTEM, true},
+    [TASK_AUDIO_PROFILE] = {"audio_profile", audio_profile_stack, AUDIO_PROFILE_STACK,
+                            TASK_PRIO_STORAGE, TASK_CORE_SYSTEM, false},
+    [TASK_POWER] = {"power_manager", power_stack, POWER_STACK,
+                    TASK_PRIO_POWER, TASK_CORE_SYSTEM, false},
+};
+
+// Estado de cada tarea; run lo escribe quien la controla, parked solo la propia tarea
+typedef struct {
+    TaskHandle_t handle;
+    volatile bool run;
+    volatile bool parked;
+    bool reserved;              // La entrada ya se uso: su stack no vuelve a entregarse
+    bool finished;
+} task_slot_t;
+
+static task_slot_t slots[TASK_COUNT];
+static portMUX_TYPE table_lock = portMUX_INITIALIZER_UNLOCKED;
+
+TaskHandle_t task_table_create(task_id_t id, TaskFunction_t fn, void *arg)
+{
+    if (id >= TASK_COUNT || fn == NULL) {
+        return NULL;
+    }
+    const task_spec_t *spec = &specs[id];
+    task_slot_t *slot = &slots[id];
+
+    // Reservamos la entrada antes de crear: una segunda llamada no debe tocar el mismo stack
+    portENTER_CRITICAL(&table_lock);
+    bool taken = slot->reserved;
+    if (!taken) {
+        slot->reserved = true;
+        slot->run = !spec->pausable;
+        slot->parked = false;
+    }
+    portEXIT_CRITICAL(&table_lock);
+    if (taken) {
+        if (slot->handle == NULL) {
+            ESP_LOGE(TAG, "%s ya termino o se esta creando", spec->name);
+        }
+        return slot->handle;
+    }
+
+    TaskHandle_t handle = xTaskCreateStaticPinnedToCore(fn, spec->name, spec->stack_size, arg, spec->priority,
+                                                        spec->stack, &tcbs[id], spec->core);
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "No se pudo crear %s", spec->name);
+        slot->reserved = false;
+        return NULL;
+    }
+    // Una tarea de una vuelta puede terminar antes de que xTaskCreate retorne
+    portENTER_CRITICAL(&table_lock);
+    if (!slot->finished) {
+        slot->handle = handle;
+    }
+    portEXIT_CRITICAL(&table_lock);
+    return handle;
+}
+
+TaskHandle_t task_table_handle(task_id_t id)
+{
+    return id < TASK_COUNT ? slots[id].handle : NULL;
+}
+
+const char *task_table_name(task_id_t id)
+{
+    return id < TASK_COUNT ? specs[id].name : "?";
+}
+
+uint32_t task_table_stack_size(task_id_t id)
+{
+    return id < TASK_COUNT ? specs[id].stack_size : 0;
+}
+
+void task_table_exit(task_id_t id)
+{
+    if (id < TASK_COUNT) {
+        portENTER_CRITICAL(&table_lock);
+        slots[id].handle = NULL;
+        slots[id].run = false;
+        slots[id].finished = true;
+        portEXIT_CRITICAL(&table_lock);
+    }
+    vTaskDelete(NULL);
+}
+
+void task_table_run(task_id_t id)
+{
+    if (id >= TASK_COUNT) {
+        return;
+    }
+    task_slot_t *slot = &slots[id];
+    slot->run = true;
+    if (slot->handle != NULL) {
+        xTaskNotifyGive(slot->handle);
+    }
+}
+
+bool task_table_stop(task_id_t id, TickType_t wait)
+{
+    if (id >= TASK_COUNT) {
+        return false;
+    }
+    task_slot_t *slot = &slots[id];
+    slot->run = false;
+    if (slot->handle == NULL || slot->handle == xTaskGetCurrentTaskHandle()) {
+        return slot->handle == NULL;
+    }
+    // La tarea se estaciona al terminar su vuelta; se consulta por tick, no hace falta mas precision
+    TickType_t start = xTaskGetTickCount();
+    while (!slot->parked) {
+        if (xTaskGetTickCount() - start >= wait) {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+bool task_table_is_running(task_id_t id)
+{
+    return id < TASK_COUNT && slots[id].handle != NULL && slots[id].run;
+}
+
+void task_table_wait_run(task_id_t id)
+{
+    task_slot_t *slot = &slots[id];
+    while (!slot->run) {
+        slot->parked = true;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    slot->parked = false;
+}
+
+size_t task_table_format_text(char *out, size_t size)
+{
+    size_t len = 0;
+    uint32_t total = 0;
+    int n;
+    if (size == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    n = snprintf(out, size, "Tarea              core prio  stack  libre  estado\n");
+    len = n > 0 && (size_t)n < size ? (size_t)n : 0;
+    for (int i = 0; i < TASK_COUNT && len < size; i++) {
+        const task_spec_t *spec = &specs[i];
+        const task_slot_t *slot = &slots[i];
+        const char *state;
+        char free_text[8] = "-";
+        if (slot->handle != NULL) {
+            snprintf(free_text, sizeof(free_text), "%u", (uint32_t)uxTaskGetStackHighWaterMark(slot->handle));
+            state = !slot->run ? (slot->parked ? "pausada" : "pausando") : "activa";
+        } else {
+            state = slot->finished ? "terminada" : "sin crear";
+        }
+        total += spec->stack_size + sizeof(StaticTask_t);
+        n = snprintf(out + len, size - len, "%-18s %4d %4u %6u %6s  %s\n", spec->name, (int)spec->core,
+                     (uint32_t)spec->priority, spec->stack_size, free_text, state);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    if (len < size) {
+        n = snprintf(out + len, size - len, "Memoria estatica de tareas: %u B (stacks y TCBs)\n", total);
+        len += n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,114 @@
+#ifndef TASK_TABLE_H
+#define TASK_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Tabla central de tareas: stack y TCB estaticos, core fijo y prioridad segun el mapa de abajo.
+// Las tareas se crean una sola vez; las que se prenden y apagan (LED, audio) se pausan con
+// notificaciones en vez de borrarse y recrearse, asi el heap no se fragmenta y una tarea nunca
+// muere a mitad de una escritura.
+
+// Mapa de prioridades: audio > BT > sensores > shell > escrituras a flash. Las tareas de Bluedroid (BTC/BTU) y el
+// controlador quedan por encima segun sdkconfig y en el core 0; el core 1 es solo del audio.
+#define TASK_PRIO_AUDIO         15
+#define TASK_PRIO_AUDIO_BOOT    14
+#define TASK_PRIO_BT            10
+#define TASK_PRIO_POWER         9       // Toma el lock de CPU apenas arranca el stream
+#define TASK_PRIO_BUTTONS       8
+#define TASK_PRIO_SENSORS       7
+#define TASK_PRIO_SHELL         4
+#define TASK_PRIO_STORAGE       3
+#define TASK_PRIO_LED           2
+
+#define TASK_CORE_AUDIO         1
+#define TASK_CORE_SYSTEM        0
+
+typedef enum {
+    TASK_AUDIO_I2S = 0,         // Ring -> DSP -> I2S
+    TASK_AUDIO_BOOT,            // Inicializa el audio en paralelo con Bluedroid y termina
+    TASK_SPP_TX,                // Envio SPP a las sesiones
+    TASK_BUTTONS,               // Antirrebote y gestos de botones
+    TASK_SENSORS,               // Planificador de sensores
+    TASK_BT_SHELL,              // Comandos recibidos por SPP
+    TASK_UART_SHELL,            // Comandos por UART
+    TASK_LED_BOARD,             // Parpadeo del LED de la placa
+    TASK_AUDIO_PROFILE,         // Escritura diferida de los perfiles de audio en NVS
+    TASK_POWER,                 // Modo de energia y locks de esp_pm
+    TASK_COUNT
+} task_id_t;
+
+/**
+ * @brief Crea la tarea con el stack, TCB, prioridad y core de su entrada en la tabla
+ *
+ * Cada tarea se crea una sola vez; si ya existe devuelve el mismo handle. Las entradas marcadas
+ * como pausables arrancan detenidas hasta task_table_run.
+ *
+ * @param id Entrada de la tabla
+ * @param fn Funcion de la tarea, la pone el modulo duenio
+ * @param arg Argumento para fn
+ * @return TaskHandle_t Handle de la tarea, NULL si no se pudo crear
+ */
+TaskHandle_t task_table_create(task_id_t id, TaskFunction_t fn, void *arg);
+
+/**
+ * @brief Handle de una tarea de la tabla, NULL si aun no se creo o ya termino
+ */
+TaskHandle_t task_table_handle(task_id_t id);
+
+/**
+ * @brief Nombre de la tarea en la tabla
+ */
+const char *task_table_name(task_id_t id);
+
+/**
+ * @brief Tamano del stack estatico de la tarea en bytes
+ */
+uint32_t task_table_stack_size(task_id_t id);
+
+/**
+ * @brief Marca la salida de una tarea de una sola vuelta y la borra; no retorna
+ *
+ * El stack estatico no se reutiliza, por eso la tarea no puede volver a crearse.
+ */
+void task_table_exit(task_id_t id);
+
+/**
+ * @brief Reanuda una tarea pausable con una notificacion
+ */
+void task_table_run(task_id_t id);
+
+/**
+ * @brief Pide a una tarea pausable que se detenga y espera a que quede estacionada
+ *
+ * La tarea termina la vuelta en curso y se bloquea en task_table_wait_run, nunca se borra.
+ *
+ * @param wait Ticks maximos de espera, 0 para solo pedirlo
+ * @return true si la tarea quedo detenida (o nunca se creo)
+ */
+bool task_table_stop(task_id_t id, TickType_t wait);
+
+/**
+ * @brief true si la tarea fue creada y no esta pausada
+ */
+bool task_table_is_running(task_id_t id);
+
+/**
+ * @brief Punto de pausa de una tarea pausable: bloquea mientras este detenida
+ *
+ * Solo la llama la propia tarea al inicio de cada vuelta. Usa la notificacion de la tarea, asi
+ * que las tareas pausables no deben usarla para otra cosa.
+ */
+void task_table_wait_run(task_id_t id);
+
+/**
+ * @brief Formatea la tabla: core, prioridad, stack, minimo libre y estado de cada tarea
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t task_table_format_text(char *out, size_t size);
+
+#endif // TASK_TABLE_H
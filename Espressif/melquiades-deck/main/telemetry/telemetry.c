@@ -0,0 +1,249 @@
+#include "telemetry.h"
+//Bibliotecas de sistema
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+//bibliotecas custom
+#include "../audio/audio_output.h"
+#include "../bluetooth/a2dp_sink.h"
+#include "../bluetooth/spp_init.h"
+#include "../sensors/buttons.h"
+#include "../sensors/potentiometers.h"
+#include "../shell/bin_protocol.h"
+#include "../system/mem_track.h"
+
+// Bytes fijos del payload binario (antes de la lista de tareas)
+#define BIN_FIXED_PAYLOAD 68
+// Bytes por tarea: nombre, stack, prioridad, core, cpu
+#define BIN_TASK_PAYLOAD  (configMAX_TASK_NAME_LEN + 6)
+
+// Contadores del snapshot anterior para calcular deltas
+static struct {
+    TaskHandle_t handle;
+    uint32_t run_time;
+} prev_tasks[TELEMETRY_MAX_TASKS];
+static uint8_t prev_task_count = 0;
+static uint32_t prev_total_run_time = 0;
+static int64_t prev_time_us = 0;
+static uint32_t prev_pot_samples = 0;
+static uint32_t prev_btn_samples = 0;
+
+static uint16_t rate_x10(uint32_t samples, uint32_t prev_samples, int64_t elapsed_us)
+{
+    if (elapsed_us <= 0) {
+        return 0;
+    }
+    return (uint16_t)((uint64_t)(samples - prev_samples) * 10000000ULL / (uint64_t)elapsed_us);
+}
+
+// Tiempo de CPU de la tarea en el snapshot anterior, 0 si es nueva
+static uint32_t prev_run_time_for(TaskHandle_t handle)
+{
+    for (int i = 0; i < prev_task_count; i++) {
+        if (prev_tasks[i].handle == handle) {
+            return prev_tasks[i].run_time;
+        }
+    }
+    return 0;
+}
+
+static void capture_tasks(telemetry_snapshot_t *snap)
+{
+    snap->task_count = 0;
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 2;
+    TaskStatus_t *status = MEM_MALLOC(MEM_MOD_TELEMETRY, capacity * sizeof(TaskStatus_t));
+    if (status == NULL) {
+        return;
+    }
+
+    uint32_t total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, capacity, &total_run_time);
+    if (count > TELEMETRY_MAX_TASKS) {
+        count = TELEMETRY_MAX_TASKS;
+    }
+
+    // En SMP el tiempo total corresponde a un solo core
+    uint64_t window = (uint64_t)(total_run_time - prev_total_run_time) * portNUM_PROCESSORS;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        telemetry_task_t *task = &snap->tasks[i];
+        strncpy(task->name, status[i].pcTaskName, sizeof(task->name) - 1);
+        task->name[sizeof(task->name) - 1] = '\0';
+        task->stack_free_min = status[i].usStackHighWaterMark;
+        task->priority = (uint8_t)status[i].uxCurrentPriority;
+        BaseType_t affinity = xTaskGetAffinity(status[i].xHandle);
+        task->core = (affinity == tskNO_AFFINITY) ? -1 : (int8_t)affinity;
+
+        uint32_t delta = status[i].ulRunTimeCounter - prev_run_time_for(status[i].xHandle);
+        task->cpu_permille = window > 0 ? (uint16_t)((uint64_t)delta * 1000 / window) : 0;
+    }
+    snap->task_count = (uint8_t)count;
+
+    // Guardamos los contadores para el proximo snapshot
+    for (UBaseType_t i = 0; i < count; i++) {
+        prev_tasks[i].handle = status[i].xHandle;
+        prev_tasks[i].run_time = status[i].ulRunTimeCounter;
+    }
+    prev_task_count = (uint8_t)count;
+    prev_total_run_time = total_run_time;
+
+    MEM_FREE(status);
+#endif
+}
+
+void telemetry_capture(telemetry_snapshot_t *snap)
+{
+    if (snap == NULL) {
+        return;
+    }
+    memset(snap, 0, sizeof(*snap));
+
+    int64_t now_us = esp_timer_get_time();
+    snap->uptime_ms = (uint32_t)(now_us / 1000);
+
+    // Memoria
+    snap->heap_free = esp_get_free_heap_size();
+    snap->heap_min_free = esp_get_minimum_free_heap_size();
+
+    // Audio
+    audio_output_stats_t audio;
+    audio_output_get_stats(&audio);
+    snap->audio_streaming = a2dp_is_streaming();
+    snap->audio_packets = a2dp_get_packet_count();
+    snap->audio_blocks = audio.blocks;
+    snap->audio_underruns = audio.underruns;
+    snap->dsp_cycles_last = audio.dsp_cycles_last;
+    snap->dsp_cycles_avg = audio.dsp_cycles_avg;
+    snap->dsp_cycles_max = audio.dsp_cycles_max;
+    snap->sample_rate = audio.sample_rate;
+    snap->ring_fill_pct = audio.ring_fill_pct;
+    snap->ring_drops = audio.ring_drops;
+
+    // SPP
+    spp_tx_stats_t spp;
+    spp_get_tx_stats(&spp);
+    snap->spp_frames = spp.frames;
+    snap->spp_bytes = spp.bytes;
+    snap->spp_errors = spp.errors;
+    snap->spp_cong_events = spp.cong_events;
+    snap->spp_in_flight = (uint16_t)spp.in_flight;
+    snap->spp_in_flight_max = (uint16_t)spp.in_flight_max;
+    snap->spp_congested = spp.congested;
+
+    // Sensores
+    uint32_t pot_samples = potentiometers_get_sample_count();
+    uint32_t btn_samples = pulsadores_get_sample_count();
+    snap->pot_rate_x10 = rate_x10(pot_samples, prev_pot_samples, now_us - prev_time_us);
+    snap->btn_rate_x10 = rate_x10(btn_samples, prev_btn_samples, now_us - prev_time_us);
+    buttons_stats_t buttons;
+    pulsadores_get_stats(&buttons);
+    snap->btn_latency_avg_us = buttons.latency_avg_us;
+    snap->btn_latency_max_us = buttons.latency_max_us;
+    pot_health_t pots;
+    potentiometers_get_health(&pots);
+    snap->pot_adc2_errors = pots.adc2_radio_busy + pots.adc2_errors;
+    snap->pot_stale = pots.stale;
+    prev_pot_samples = pot_samples;
+    prev_btn_samples = btn_samples;
+    prev_time_us = now_us;
+
+    // Tareas
+    capture_tasks(snap);
+}
+
+size_t telemetry_format_text(const telemetry_snapshot_t *snap, char *out, size_t size)
+{
+    size_t len = 0;
+    if (snap == NULL || out == NULL || size == 0) {
+        return 0;
+    }
+
+// Acumula texto sin pasarse del buffer
+#define APPEND(...) do { \
+        if (len < size) { \
+            int n = snprintf(out + len, size - len, __VA_ARGS__); \
+            if (n > 0) len += (size_t)n; \
+        } \
+    } while (0)
+
+    APPEND("Uptime: %u ms\n", snap->uptime_ms);
+    APPEND("Heap: libre %u B, minimo %u B\n", snap->heap_free, snap->heap_min_free);
+    APPEND("Audio: %s, %u Hz, paquetes %u, bloques %u, underruns %u, ring %u%% (descartes %u)\n",
+           snap->audio_streaming ? "reproduciendo" : "detenido", snap->sample_rate,
+           snap->audio_packets, snap->audio_blocks, snap->audio_underruns,
+           snap->ring_fill_pct, snap->ring_drops);
+    APPEND("DSP ciclos/bloque: ultimo %u, prom %u, max %u\n",
+           snap->dsp_cycles_last, snap->dsp_cycles_avg, snap->dsp_cycles_max);
+    APPEND("SPP TX: tramas %u, bytes %u, errores %u, congestion %u%s, pendientes %u (max %u)\n",
+           snap->spp_frames, snap->spp_bytes, snap->spp_errors, snap->spp_cong_events,
+           snap->spp_congested ? " (activa)" : "", snap->spp_in_flight, snap->spp_in_flight_max);
+    APPEND("Sensores: pots %u.%u Hz (errores ADC2 %u, caidos %u), botones %u.%u ev/s (latencia prom %u us, max %u us)\n",
+           snap->pot_rate_x10 / 10, snap->pot_rate_x10 % 10, snap->pot_adc2_errors, snap->pot_stale,
+           snap->btn_rate_x10 / 10, snap->btn_rate_x10 % 10,
+           snap->btn_latency_avg_us, snap->btn_latency_max_us);
+    APPEND("Tareas (%u): nombre stack_min prio core cpu\n", snap->task_count);
+    for (int i = 0; i < snap->task_count; i++) {
+        const telemetry_task_t *task = &snap->tasks[i];
+        APPEND("  %-16s %5u %2u %2d %3u.%u%%\n", task->name, task->stack_free_min, task->priority,
+               task->core, task->cpu_permille / 10, task->cpu_permille % 10);
+    }
+
+#undef APPEND
+
+    return len < size ? len : size - 1;
+}
+
+size_t telemetry_encode_binary(const telemetry_snapshot_t *snap, uint8_t *out, size_t size)
+{
+    if (snap == NULL || out == NULL || size < BIN_OVERHEAD) {
+        return 0;
+    }
+
+    // Serializamos el payload directamente detras de la cabecera
+    uint8_t *payload = out + BIN_HEADER_SIZE;
+    size_t max_payload = size - BIN_OVERHEAD;
+    if (BIN_FIXED_PAYLOAD + (size_t)snap->task_count * BIN_TASK_PAYLOAD > max_payload) {
+        return 0;
+    }
+
+    uint8_t *p = payload;
+    p = bin_put_u8(p, TELEMETRY_BIN_VERSION);
+    p = bin_put_u32(p, snap->uptime_ms);
+    p = bin_put_u32(p, snap->heap_free);
+    p = bin_put_u32(p, snap->heap_min_free);
+    p = bin_put_u8(p, snap->audio_streaming);
+    p = bin_put_u32(p, snap->audio_packets);
+    p = bin_put_u32(p, snap->audio_blocks);
+    p = bin_put_u32(p, snap->audio_underruns);
+    p = bin_put_u32(p, snap->dsp_cycles_last);
+    p = bin_put_u32(p, snap->dsp_cycles_avg);
+    p = bin_put_u32(p, snap->dsp_cycles_max);
+    p = bin_put_u32(p, snap->sample_rate);
+    p = bin_put_u32(p, snap->spp_frames);
+    p = bin_put_u32(p, snap->spp_bytes);
+    p = bin_put_u32(p, snap->spp_errors);
+    p = bin_put_u32(p, snap->spp_cong_events);
+    p = bin_put_u16(p, snap->spp_in_flight);
+    p = bin_put_u16(p, snap->spp_in_flight_max);
+    p = bin_put_u8(p, snap->spp_congested);
+    p = bin_put_u16(p, snap->pot_rate_x10);
+    p = bin_put_u16(p, snap->btn_rate_x10);
+    p = bin_put_u8(p, snap->task_count);
+    for (int i = 0; i < snap->task_count; i++) {
+        const telemetry_task_t *task = &snap->tasks[i];
+        memcpy(p, task->name, configMAX_TASK_NAME_LEN);
+        p += configMAX_TASK_NAME_LEN;
+        p = bin_put_u16(p, task->stack_free_min);
+        p = bin_put_u8(p, task->priority);
+        p = bin_put_u8(p, (uint8_t)task->core);
+        p = bin_put_u16(p, task->cpu_permille);
+    }
+
+    return bin_frame_encode(BIN_FRAME_STATUS, payload, (uint16_t)(p - payload), out, size);
+}
@@ -0,0 +1,84 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+// Maximo de tareas incluidas en un snapshot
+#define TELEMETRY_MAX_TASKS 24
+
+// Version del payload binario del snapshot
+#define TELEMETRY_BIN_VERSION 1
+
+// Datos de una tarea FreeRTOS
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    uint16_t stack_free_min;    // High-water mark del stack en bytes
+    uint8_t priority;
+    int8_t core;                // -1 si no tiene afinidad
+    uint16_t cpu_permille;      // Uso de CPU desde el snapshot anterior (0-1000)
+} telemetry_task_t;
+
+// Snapshot completo del estado en tiempo de ejecucion
+typedef struct {
+    uint32_t uptime_ms;
+    // Memoria
+    uint32_t heap_free;
+    uint32_t heap_min_free;
+    // Audio
+    bool audio_streaming;
+    uint32_t audio_packets;
+    uint32_t audio_blocks;
+    uint32_t audio_underruns;
+    uint32_t dsp_cycles_last;
+    uint32_t dsp_cycles_avg;
+    uint32_t dsp_cycles_max;
+    uint32_t sample_rate;
+    uint8_t ring_fill_pct;
+    uint32_t ring_drops;
+    // SPP
+    uint32_t spp_frames;
+    uint32_t spp_bytes;
+    uint32_t spp_errors;
+    uint32_t spp_cong_events;
+    uint16_t spp_in_flight;
+    uint16_t spp_in_flight_max;
+    bool spp_congested;
+    // Sensores (Hz x10)
+    uint16_t pot_rate_x10;
+    uint16_t btn_rate_x10;
+    uint32_t btn_latency_avg_us;
+    uint32_t btn_latency_max_us;
+    uint32_t pot_adc2_errors;   // Lecturas de ADC2 rechazadas (radio u otro error)
+    uint8_t pot_stale;          // Pots sin lecturas nuevas en este momento
+    // Tareas
+    uint8_t task_count;
+    telemetry_task_t tasks[TELEMETRY_MAX_TASKS];
+} telemetry_snapshot_t;
+
+/**
+ * @brief Captura el estado actual del sistema
+ *
+ * El uso de CPU y las tasas de sensores se calculan contra el snapshot anterior.
+ *
+ * @param snap Estructura a llenar
+ */
+void telemetry_capture(telemetry_snapshot_t *snap);
+
+/**
+ * @brief Formatea un snapshot como texto legible para el shell
+ *
+ * @return size_t Bytes escritos en out (sin contar el terminador)
+ */
+size_t telemetry_format_text(const telemetry_snapshot_t *snap, char *out, size_t size);
+
+/**
+ * @brief Codifica un snapshot como trama binaria BIN_FRAME_STATUS
+ *
+ * @return size_t Bytes escritos en out, 0 si no cabe
+ */
+size_t telemetry_encode_binary(const telemetry_snapshot_t *snap, uint8_t *out, size_t size);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,287 @@
+#include "trace_log.h"
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "../shell/bin_protocol.h"
+
+#define TRACE_CORES         2
+#define TRACE_SPEC_MAX      16      // Largo maximo de una conversion como "%-08.3f"
+#define TRACE_DUMP_STRINGS  48      // Formatos y tags distintos recordados por volcado binario
+
+// Ring de un nucleo: solo escribe el nucleo duenio, el candado corto solo lo disputa el volcado
+typedef struct {
+    portMUX_TYPE lock;
+    uint32_t head;              // Registros escritos desde el inicio
+    uint32_t tail;              // Registros consumidos por volcados
+    uint32_t lost;              // Pisados antes de volcarse
+    trace_record_t records[TRACE_RING_RECORDS];
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_CORES] = {
+    {.lock = portMUX_INITIALIZER_UNLOCKED},
+    {.lock = portMUX_INITIALIZER_UNLOCKED},
+};
+
+static const char level_chars[] = "NEWIDV";
+
+void trace_log_write(uint8_t level, const char *tag, const char *fmt, uint8_t argc,
+                     uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    uint32_t stamp = (uint32_t)esp_timer_get_time();
+    BaseType_t core = xPortGetCoreID();
+    trace_ring_t *ring = &rings[core < TRACE_CORES ? core : 0];
+
+    portENTER_CRITICAL(&ring->lock);
+    if (ring->head - ring->tail == TRACE_RING_RECORDS) {
+        ring->tail++;
+        ring->lost++;
+    }
+    trace_record_t *rec = &ring->records[ring->head % TRACE_RING_RECORDS];
+    rec->stamp_us = stamp;
+    rec->tag = tag;
+    rec->fmt = fmt;
+    rec->level = level;
+    rec->core = (uint8_t)core;
+    rec->argc = argc;
+    rec->args[0] = a0;
+    rec->args[1] = a1;
+    rec->args[2] = a2;
+    rec->args[3] = a3;
+    ring->head++;
+    portEXIT_CRITICAL(&ring->lock);
+}
+
+size_t trace_log_format_message(const char *fmt, const uint32_t *args, uint8_t argc, char *out, size_t size)
+{
+    size_t len = 0;
+    int next = 0;
+    if (size == 0) {
+        return 0;
+    }
+    while (*fmt != '\0' && len + 1 < size) {
+        if (*fmt != '%') {
+            out[len++] = *fmt++;
+            continue;
+        }
+        if (fmt[1] == '%') {
+            out[len++] = '%';
+            fmt += 2;
+            continue;
+        }
+        // Copia la conversion sin modificadores de largo: todos los argumentos son de 32 bits
+        char spec[TRACE_SPEC_MAX];
+        int s = 0;
+        spec[s++] = *fmt++;
+        while (*fmt != '\0' && strchr("-+ #0123456789.", *fmt) != NULL && s < TRACE_SPEC_MAX - 2) {
+            spec[s++] = *fmt++;
+        }
+        while (*fmt != '\0' && strchr("hlzjt", *fmt) != NULL) {
+            fmt++;
+        }
+        char conv = *fmt != '\0' ? *fmt++ : 'd';
+        spec[s++] = conv;
+        spec[s] = '\0';
+        uint32_t word = next < argc ? args[next] : 0;
+        next++;
+        int n;
+        if (strchr("fFeEgGaA", conv) != NULL) {
+            float f;
+            memcpy(&f, &word, sizeof(f));
+            n = snprintf(out + len, size - len, spec, (double)f);
+        } else if (conv == 'd' || conv == 'i') {
+            n = snprintf(out + len, size - len, spec, (int)(int32_t)word);
+        } else if (strchr("uxXoc", conv) != NULL) {
+            n = snprintf(out + len, size - len, spec, (unsigned)word);
+        } else {
+            n = snprintf(out + len, size - len, "<%s?>", spec);
+        }
+        if (n > 0) {
+            len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// Registro pendiente mas viejo entre ambos nucleos, -1 si no hay
+static int peek_oldest(trace_record_t *rec)
+{
+    int best = -1;
+    uint32_t best_stamp = 0;
+    for (int core = 0; core < TRACE_CORES; core++) {
+        trace_ring_t *ring = &rings[core];
+        trace_record_t candidate;
+        bool have = false;
+        portENTER_CRITICAL(&ring->lock);
+        if (ring->head != ring->tail) {
+            candidate = ring->records[ring->tail % TRACE_RING_RECORDS];
+            have = true;
+        }
+        portEXIT_CRITICAL(&ring->lock);
+        if (have && (best < 0 || (int32_t)(candidate.stamp_us - best_stamp) < 0)) {
+            best = core;
+            best_stamp = candidate.stamp_us;
+            *rec = candidate;
+        }
+    }
+    return best;
+}
+
+// Consume el registro que devolvio peek_oldest, salvo que el escritor ya lo haya pisado
+static void pop(int core, const trace_record_t *rec)
+{
+    trace_ring_t *ring = &rings[core];
+    portENTER_CRITICAL(&ring->lock);
+    if (ring->head != ring->tail && ring->records[ring->tail % TRACE_RING_RECORDS].stamp_us == rec->stamp_us &&
+        ring->records[ring->tail % TRACE_RING_RECORDS].fmt == rec->fmt) {
+        ring->tail++;
+    }
+    portEXIT_CRITICAL(&ring->lock);
+}
+
+static uint32_t take_lost(void)
+{
+    uint32_t lost = 0;
+    for (int core = 0; core < TRACE_CORES; core++) {
+        portENTER_CRITICAL(&rings[core].lock);
+        lost += rings[core].lost;
+        rings[core].lost = 0;
+        portEXIT_CRITICAL(&rings[core].lock);
+    }
+    return lost;
+}
+
+size_t trace_log_dump_text(char *out, size_t size)
+{
+    size_t len = 0;
+    trace_record_t rec;
+    int core;
+    int n;
+    if (size == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    uint32_t lost = take_lost();
+    if (lost > 0) {
+        n = snprintf(out, size, "(%u registros pisados antes de volcarse)\n", lost);
+        len = n > 0 && (size_t)n < size ? (size_t)n : 0;
+    }
+    // Cabecera como la de ESP_LOG, con el nucleo que escribio; la linea solo se consume si entra
+    while ((core = peek_oldest(&rec)) >= 0) {
+        char msg[160];
+        trace_log_format_message(rec.fmt, rec.args, rec.argc, msg, sizeof(msg));
+        n = snprintf(out + len, size - len, "%c (%u.%03u) c%u %s: %s\n",
+                     rec.level < sizeof(level_chars) - 1 ? level_chars[rec.level] : '?',
+                     rec.stamp_us / 1000, rec.stamp_us % 1000, rec.core, rec.tag, msg);
+        if (n < 0 || (size_t)n >= size - len) {
+            out[len] = '\0';
+            break;
+        }
+        len += (size_t)n;
+        pop(core, &rec);
+    }
+    if (len == 0) {
+        n = snprintf(out, size, "Traza vacia.\n");
+        len = n > 0 ? (size_t)n : 0;
+    }
+    return len < size ? len : size - 1;
+}
+
+// Agrega una trama TRACE_BIN_STRING si el texto no se mando en este volcado
+static bool put_string(const char *str, const char **sent, int *sent_count, uint8_t *out, size_t size, size_t *len)
+{
+    for (int i = 0; i < *sent_count; i++) {
+        if (sent[i] == str) {
+            return true;
+        }
+    }
+    if (*sent_count == TRACE_DUMP_STRINGS) {
+        return false;
+    }
+    uint8_t payload[5 + 255];
+    size_t str_len = strnlen(str, 255);
+    uint8_t *p = bin_put_u8(payload, TRACE_BIN_STRING);
+    p = bin_put_u32(p, (uint32_t)(uintptr_t)str);
+    memcpy(p, str, str_len);
+    p += str_len;
+    size_t n = bin_frame_encode(BIN_FRAME_TRACE, payload, (uint16_t)(p - payload), out + *len, size - *len);
+    if (n == 0) {
+        return false;
+    }
+    *len += n;
+    sent[(*sent_count)++] = str;
+    return true;
+}
+
+size_t trace_log_dump_binary(uint8_t *out, size_t size)
+{
+    const char *sent[TRACE_DUMP_STRINGS];
+    int sent_count = 0;
+    size_t len = 0;
+    trace_record_t rec;
+    int core;
+    // Se reserva lugar para la trama de cierre
+    size_t end_bytes = BIN_OVERHEAD + 7;
+    if (size < end_bytes) {
+        return 0;
+    }
+    size_t limit = size - end_bytes;
+    uint32_t lost = take_lost();
+    while ((core = peek_oldest(&rec)) >= 0) {
+        size_t mark = len;
+        int mark_count = sent_count;
+        uint8_t payload[16 + 4 * TRACE_MAX_ARGS];
+        uint8_t *p = bin_put_u8(payload, TRACE_BIN_RECORD);
+        p = bin_put_u32(p, rec.stamp_us);
+        p = bin_put_u32(p, (uint32_t)(uintptr_t)rec.tag);
+        p = bin_put_u32(p, (uint32_t)(uintptr_t)rec.fmt);
+        p = bin_put_u8(p, rec.level);
+        p = bin_put_u8(p, rec.core);
+        p = bin_put_u8(p, rec.argc);
+        for (int i = 0; i < rec.argc && i < TRACE_MAX_ARGS; i++) {
+            p = bin_put_u32(p, rec.args[i]);
+        }
+        size_t n = 0;
+        if (put_string(rec.tag, sent, &sent_count, out, limit, &len) &&
+            put_string(rec.fmt, sent, &sent_count, out, limit, &len)) {
+            n = bin_frame_encode(BIN_FRAME_TRACE, payload, (uint16_t)(p - payload), out + len, limit - len);
+        }
+        if (n == 0) {
+            // No entra: el registro y sus textos van en el proximo volcado
+            len = mark;
+            sent_count = mark_count;
+            break;
+        }
+        len += n;
+        pop(core, &rec);
+    }
+    uint8_t end[7];
+    uint8_t *p = bin_put_u8(end, TRACE_BIN_END);
+    p = bin_put_u8(p, TRACE_BIN_VERSION);
+    p = bin_put_u32(p, lost);
+    p = bin_put_u8(p, peek_oldest(&rec) >= 0);
+    len += bin_frame_encode(BIN_FRAME_TRACE, end, (uint16_t)(p - end), out + len, size - len);
+    return len;
+}
+
+void trace_log_clear(void)
+{
+    for (int core = 0; core < TRACE_CORES; core++) {
+        portENTER_CRITICAL(&rings[core].lock);
+        rings[core].tail = rings[core].head;
+        rings[core].lost = 0;
+        portEXIT_CRITICAL(&rings[core].lock);
+    }
+}
+
+void trace_log_get_counts(uint32_t *pending, uint32_t *lost)
+{
+    *pending = 0;
+    *lost = 0;
+    for (int core = 0; core < TRACE_CORES; core++) {
+        portENTER_CRITICAL(&rings[core].lock);
+        *pending += rings[core].head - rings[core].tail;
+        *lost += rings[core].lost;
+        portEXIT_CRITICAL(&rings[core].lock);
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+
+// Traza binaria con formato diferido para los caminos calientes. TRACE_I(TAG, fmt, ...) guarda
+// el puntero al formato, el tag y hasta cuatro argumentos crudos en el ring del nucleo que la
+// llama; el texto se arma recien al volcarla (comando trace) o en el host (trace-decode).
+// Los argumentos son enteros de hasta 32 bits o float/double (se guardan como float); %s no
+// se admite porque la cadena puede no existir al volcar.
+
+#define TRACE_RING_RECORDS  64      // Registros por nucleo, los mas viejos se pisan
+#define TRACE_MAX_ARGS      4
+
+// Nivel maximo compilado: las trazas por encima desaparecen en el preprocesado. Se puede
+// redefinir por archivo antes de incluir este header, como LOG_LOCAL_LEVEL.
+#ifndef TRACE_LOCAL_LEVEL
+#define TRACE_LOCAL_LEVEL   ESP_LOG_DEBUG
+#endif
+
+// Version del payload binario BIN_FRAME_TRACE
+#define TRACE_BIN_VERSION   1
+
+// Tipos de payload dentro de BIN_FRAME_TRACE
+typedef enum {
+    TRACE_BIN_STRING = 0x01,    // [tipo][u32 id][texto]: formato o tag referido por los registros
+    TRACE_BIN_RECORD = 0x02,    // [tipo][u32 t_us][u32 tag][u32 fmt][u8 nivel][u8 nucleo][u8 argc][u32 args...]
+    TRACE_BIN_END = 0x03,       // [tipo][u8 version][u32 perdidos][u8 quedan]: cierre del volcado
+} trace_bin_kind_t;
+
+// Un registro tal como queda en el ring
+typedef struct {
+    uint32_t stamp_us;          // esp_timer en microsegundos, base comun a ambos nucleos
+    const char *tag;
+    const char *fmt;
+    uint8_t level;
+    uint8_t core;
+    uint8_t argc;
+    uint32_t args[TRACE_MAX_ARGS];
+} trace_record_t;
+
+/**
+ * @brief Guarda un registro en el ring del nucleo actual; se usa a traves de las macros TRACE_x
+ */
+void trace_log_write(uint8_t level, const char *tag, const char *fmt, uint8_t argc,
+                     uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+/**
+ * @brief Formatea un registro ya leido con su formato, sin la cabecera de nivel y tiempo
+ *
+ * Interpreta el formato con los argumentos crudos; lo usan el volcado de texto y el host.
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t trace_log_format_message(const char *fmt, const uint32_t *args, uint8_t argc, char *out, size_t size);
+
+/**
+ * @brief Vuelca y consume los registros pendientes de ambos nucleos en texto, por orden de tiempo
+ *
+ * @return size_t Bytes escritos sin contar el terminador
+ */
+size_t trace_log_dump_text(char *out, size_t size);
+
+/**
+ * @brief Vuelca y consume los registros pendientes como tramas BIN_FRAME_TRACE
+ *
+ * Cada formato y tag se manda una vez por volcado antes del primer registro que lo usa. Si
+ * no cabe todo, la trama de cierre indica que quedan registros para el proximo volcado.
+ *
+ * @return size_t Bytes escritos en out
+ */
+size_t trace_log_dump_binary(uint8_t *out, size_t size);
+
+/**
+ * @brief Descarta los registros pendientes y el contador de perdidos
+ */
+void trace_log_clear(void);
+
+/**
+ * @brief Registros pendientes y pisados antes de volcarse, sumando ambos nucleos
+ */
+void trace_log_get_counts(uint32_t *pending, uint32_t *lost);
+
+// Conversion de un argumento a palabra de 32 bits segun su tipo
+static inline uint32_t trace_word_float(double value)
+{
+    float f = (float)value;
+    uint32_t word;
+    memcpy(&word, &f, sizeof(word));
+    return word;
+}
+
+static inline uint32_t trace_word_int(int32_t value)
+{
+    return (uint32_t)value;
+}
+
+// Nunca se llama: deja que el compilador revise formato y argumentos como en printf
+static inline void trace_log_check(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static inline void trace_log_check(const char *fmt, ...)
+{
+}
+
+#define TRACE_WORD(x) _Generic((x), float: trace_word_float, double: trace_word_float, default: trace_word_int)(x)
+
+#define TRACE_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+#define TRACE_NARGS(...) TRACE_NARGS_(_0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define TRACE_CAT_(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT_(a, b)
+
+#define TRACE_PACK_0(l, t, f) trace_log_write(l, t, f, 0, 0, 0, 0, 0)
+#define TRACE_PACK_1(l, t, f, a) trace_log_write(l, t, f, 1, TRACE_WORD(a), 0, 0, 0)
+#define TRACE_PACK_2(l, t, f, a, b) trace_log_write(l, t, f, 2, TRACE_WORD(a), TRACE_WORD(b), 0, 0)
+#define TRACE_PACK_3(l, t, f, a, b, c) trace_log_write(l, t, f, 3, TRACE_WORD(a), TRACE_WORD(b), TRACE_WORD(c), 0)
+#define TRACE_PACK_4(l, t, f, a, b, c, d) \
+    trace_log_write(l, t, f, 4, TRACE_WORD(a), TRACE_WORD(b), TRACE_WORD(c), TRACE_WORD(d))
+
+#define TRACE_AT(level, tag, fmt, ...) do { \
+        if ((level) <= TRACE_LOCAL_LEVEL) { \
+            if (0) { \
+                trace_log_check(fmt, ##__VA_ARGS__); \
+            } \
+            TRACE_CAT(TRACE_PACK_, TRACE_NARGS(__VA_ARGS__))(level, tag, fmt, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define TRACE_E(tag, fmt, ...) TRACE_AT(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define TRACE_W(tag, fmt, ...) TRACE_AT(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define TRACE_I(tag, fmt, ...) TRACE_AT(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define TRACE_D(tag, fmt, ...) TRACE_AT(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define TRACE_V(tag, fmt, ...) TRACE_AT(ESP_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
+
+#endif // TRACE_LOG_H
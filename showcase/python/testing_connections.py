@@ -1,12 +1,101 @@
 import bluetooth
 import time
 import sys
+import re
 import select
 import threading
 import queue
+from collections import deque
 import serial
 import serial.tools.list_ports
 
+# Marcas de tiempo del equipo: "t=1234.567 ms" (ms y us desde el arranque)
+STAMP_RE = re.compile(r"t=(\d+)\.(\d{3}) ms")
+PONG_RE = re.compile(r"pong (\d+) t=(\d+)\.(\d{3}) ms")
+SYNC_PINGS = 16         # Pings por rafaga de sincronizacion
+SYNC_PERIOD_S = 30      # Resincronizacion periodica mientras hay stream
+
+
+def host_us():
+    """Reloj monotono del host en microsegundos"""
+    return time.perf_counter_ns() // 1000
+
+
+class ClockSync:
+    """Sincronizacion estilo NTP: de cada rafaga se usa solo el ping de menor RTT,
+    que es el que menos espera en colas y el que mejor estima el desfase"""
+
+    def __init__(self):
+        self.bursts = deque(maxlen=2)   # (device_us, offset_us, rtt_us) del mejor ping de cada rafaga
+        self.drift = 0.0                # Deriva relativa entre relojes (us de host por us de equipo - 1)
+
+    @property
+    def synced(self):
+        return len(self.bursts) > 0
+
+    def add_burst(self, pings):
+        """pings: lista de (t0 host, t equipo, t3 host) en us"""
+        t0, device, t3 = min(pings, key=lambda p: p[2] - p[0])
+        rtt = t3 - t0
+        # El equipo marca al recibir; se supone que ida y vuelta tardan lo mismo
+        offset = (t0 + t3) / 2 - device
+        self.bursts.append((device, offset, rtt))
+        if len(self.bursts) == 2:
+            (d1, o1, _), (d2, o2, _) = self.bursts
+            if d2 != d1:
+                self.drift = (o2 - o1) / (d2 - d1)
+        return rtt, offset
+
+    def to_host_us(self, device_us):
+        device, offset, _ = self.bursts[-1]
+        return device_us + offset + self.drift * (device_us - device)
+
+
+class LatencyHistogram:
+    """Latencias por tipo de evento (boton, gesto, sensores) en ms"""
+    BUCKETS_MS = [1, 2, 5, 10, 20, 50, 100, 200, 500, 1000]
+
+    def __init__(self, max_samples=10000):
+        self.max_samples = max_samples
+        self.samples = {}
+
+    def add(self, kind, latency_ms):
+        self.samples.setdefault(kind, deque(maxlen=self.max_samples)).append(latency_ms)
+
+    def reset(self):
+        self.samples = {}
+
+    def report(self):
+        if not self.samples:
+            print("Sin eventos medidos. Sincronice con 'sync' e inicie 'sensors start'.")
+            return
+        for kind, values in sorted(self.samples.items()):
+            ordered = sorted(values)
+            n = len(ordered)
+            p50 = ordered[n // 2]
+            p95 = ordered[min(n - 1, (n * 95) // 100)]
+            print(f"\n{kind}: {n} eventos, min {ordered[0]:.1f} ms, p50 {p50:.1f} ms, "
+                  f"p95 {p95:.1f} ms, max {ordered[-1]:.1f} ms")
+            lower = None
+            for upper in self.BUCKETS_MS + [None]:
+                count = sum(1 for v in ordered if (lower is None or v >= lower) and (upper is None or v < upper))
+                label = f"< {upper} ms" if lower is None else (f">= {lower} ms" if upper is None else f"{lower}-{upper} ms")
+                bar = "#" * (count * 40 // n)
+                print(f"  {label:>12} {count:6d} {bar}")
+                lower = upper
+
+
+def event_kind(line):
+    """Tipo de evento de una linea del stream"""
+    if line.startswith("Boton"):
+        return "boton"
+    if line.startswith("Gesto"):
+        return "gesto " + line.split()[1].rstrip(":")
+    if line.startswith("Sensores"):
+        return "sensores"
+    return None
+
+
 class ESP32Client:
     def __init__(self):
         # Atributos comunes
@@ -25,6 +114,14 @@ class ESP32Client:
         # Serial
         self.serial_port = None
         self.serial_connection = None
+
+        # Sincronizacion de reloj y latencias
+        self.clock = ClockSync()
+        self.latency = LatencyHistogram()
+        self.pong_queue = queue.Queue()
+        self.rx_buffer = ""
+        self.io_lock = threading.Lock()
+        self.sync_thread = None
         
     def list_serial_ports(self):
         """Lista todos los puertos seriales disponibles"""
@@ -112,24 +209,9 @@ class ESP32Client:
         
         while self.connected and not self.exit_event.is_set():
             try:
-                if self.connection_type == "bluetooth" and self.bt_socket.fileno() != -1:
-                    ready = select.select([self.bt_socket], [], [], 0.5)
-                    if ready[0]:
-                        data = self.bt_socket.recv(1024).decode('utf-8', errors='replace')
-                        if data:
-                            self.data_queue.put(data)
-                            print(f"\n[STREAM] {data}")
-                            print("\nIngrese comando > ", end="", flush=True)
-                            
-                elif self.connection_type == "serial" and self.serial_connection and self.serial_connection.is_open:
-                    if self.serial_connection.in_waiting > 0:
-                        data = self.serial_connection.read(self.serial_connection.in_waiting).decode('utf-8', errors='replace')
-                        if data:
-                            self.data_queue.put(data)
-                            print(f"\n[STREAM] {data}")
-                            print("\nIngrese comando > ", end="", flush=True)
-                    else:
-                        time.sleep(0.1)  # Breve pausa para no saturar la CPU
+                data = self._read_available(0.5)
+                if data:
+                    self._handle_stream_data(data, host_us())
             except Exception as e:
                 print(f"\nError en stream: {e}")
                 self.streaming = False
@@ -138,16 +220,121 @@ class ESP32Client:
         print("\nStream finalizado")
         self.streaming = False
     
+    def _read_available(self, timeout):
+        """Lee lo que haya llegado en como maximo timeout segundos, '' si no llego nada"""
+        if self.connection_type == "bluetooth" and self.bt_socket and self.bt_socket.fileno() != -1:
+            ready = select.select([self.bt_socket], [], [], timeout)
+            if ready[0]:
+                return self.bt_socket.recv(1024).decode('utf-8', errors='replace')
+        elif self.connection_type == "serial" and self.serial_connection and self.serial_connection.is_open:
+            deadline = time.monotonic() + timeout
+            while time.monotonic() < deadline:
+                if self.serial_connection.in_waiting > 0:
+                    return self.serial_connection.read(self.serial_connection.in_waiting).decode('utf-8', errors='replace')
+                time.sleep(0.001)  # Sondeo corto para no sumar latencia a la medicion
+        return ""
+
+    def _write(self, command):
+        """Envia un comando sin esperar respuesta"""
+        with self.io_lock:
+            if self.connection_type == "bluetooth":
+                self.bt_socket.send(command.encode('utf-8'))
+            elif self.connection_type == "serial":
+                self.serial_connection.write(command.encode('utf-8'))
+                self.serial_connection.flush()
+
+    def _handle_stream_data(self, data, arrival_us):
+        """Separa el stream en lineas, responde los pong y mide la latencia de cada evento"""
+        self.rx_buffer += data
+        lines = self.rx_buffer.split("\n")
+        self.rx_buffer = lines.pop()
+        for raw in lines:
+            line = raw.strip()
+            if not line:
+                continue
+            if line.startswith("pong"):
+                self.pong_queue.put((line, arrival_us))
+                continue
+            self.data_queue.put(line)
+            self._record_latency(line, arrival_us)
+            print(f"\n[STREAM] {line}")
+            print("\nIngrese comando > ", end="", flush=True)
+
+    def _record_latency(self, line, arrival_us):
+        kind = event_kind(line)
+        match = STAMP_RE.search(line)
+        if kind is None or match is None or not self.clock.synced:
+            return
+        device_us = int(match.group(1)) * 1000 + int(match.group(2))
+        latency_ms = (arrival_us - self.clock.to_host_us(device_us)) / 1000.0
+        self.latency.add(kind, latency_ms)
+
+    def _wait_pong(self, token, timeout):
+        """Espera el pong de un token; con stream activo llega por la cola del hilo lector"""
+        deadline = time.monotonic() + timeout
+        pending = ""
+        while time.monotonic() < deadline:
+            if self.streaming:
+                try:
+                    line, arrival = self.pong_queue.get(timeout=max(0.0, deadline - time.monotonic()))
+                except queue.Empty:
+                    return None
+            else:
+                data = self._read_available(max(0.0, deadline - time.monotonic()))
+                arrival = host_us()
+                pending += data
+                line = pending
+            for match in PONG_RE.finditer(line):
+                if int(match.group(1)) == token:
+                    return int(match.group(2)) * 1000 + int(match.group(3)), arrival
+        return None
+
+    def sync_clock(self, count=SYNC_PINGS, verbose=True):
+        """Rafaga de pings; se queda con el de menor RTT para estimar el desfase"""
+        if not self.connected:
+            print("No conectado. Conecte primero.")
+            return False
+        pings = []
+        for token in range(1, count + 1):
+            t0 = host_us()
+            self._write(f"ping {token}")
+            reply = self._wait_pong(token, 1.0)
+            if reply is not None:
+                device_us, t3 = reply
+                pings.append((t0, device_us, t3))
+            time.sleep(0.02)
+        if not pings:
+            print("Sincronizacion fallida: el equipo no respondio a ping")
+            return False
+        rtts = sorted(t3 - t0 for t0, _, t3 in pings)
+        rtt, offset = self.clock.add_burst(pings)
+        if verbose:
+            print(f"Reloj sincronizado con {len(pings)}/{count} pings: RTT min {rtt / 1000:.1f} ms, "
+                  f"mediana {rtts[len(rtts) // 2] / 1000:.1f} ms, deriva {self.clock.drift * 1e6:.1f} ppm")
+        return True
+
+    def _sync_loop(self):
+        """Resincroniza periodicamente mientras el stream este activo"""
+        while self.streaming and not self.exit_event.wait(SYNC_PERIOD_S):
+            self.sync_clock(verbose=False)
+
     def start_stream(self):
         """Inicia un hilo separado para escuchar el stream de datos"""
         if self.streaming:
             print("El stream ya está activo")
             return
             
+        # Sin reloj sincronizado no se pueden medir latencias
+        if not self.clock.synced:
+            self.sync_clock()
         self.exit_event.clear()
+        self.streaming = True
         self.stream_thread = threading.Thread(target=self._stream_listener)
         self.stream_thread.daemon = True  # El hilo se cerrará cuando el programa principal termine
         self.stream_thread.start()
+        self.sync_thread = threading.Thread(target=self._sync_loop)
+        self.sync_thread.daemon = True
+        self.sync_thread.start()
     
     def stop_stream(self):
         """Detiene el stream de datos"""
@@ -168,13 +355,7 @@ class ESP32Client:
             return
             
         try:
-            command_bytes = command.encode('utf-8')
-            
-            if self.connection_type == "bluetooth":
-                self.bt_socket.send(command_bytes)
-            elif self.connection_type == "serial":
-                self.serial_connection.write(command_bytes)
-                self.serial_connection.flush()
+            self._write(command)
                 
             print(f"Comando enviado: {command}")
             
@@ -230,13 +411,23 @@ class ESP32Client:
     def interactive_mode(self):
         """Modo interactivo para enviar comandos"""
         print("\n--- Comandos disponibles ---")                
+        print("  sync - Sincroniza el reloj con el equipo (ping estilo NTP)")
+        print("  latency - Histograma de latencia por tipo de evento")
+        print("  latency reset - Borra las latencias medidas")
         print("  exit - Salir del programa")
         
         while self.connected:
             try:
                 command = input("\nIngrese comando > ")
                 if command.lower() == "exit":
-                    break                
+                    break
+                elif command == "sync":
+                    self.sync_clock()
+                elif command == "latency":
+                    self.latency.report()
+                elif command == "latency reset":
+                    self.latency.reset()
+                    print("Latencias borradas")
                 else:
                     self.send_command(command)
             except KeyboardInterrupt: